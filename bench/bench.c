@@ -0,0 +1,649 @@
+#include "beta_evolve.h"
+#include "argparse.h"
+#include "cache.h"
+#include "http.h"
+#include "json.h"
+#include "log_writer.h"
+#include "model_cache.h"
+#include "toml.h"
+#include "workspace.h"
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Microbenchmarks of Beta Evolve's own hot paths.
+// Every benchmark runs on synthetic sources of several sizes and repeats its
+// operation until min_time_ms has passed; results are written as one JSON
+// object per line (benchmark, lines, bytes, iterations, ns_per_op, mb_per_s)
+// and summarized on stderr. The end-to-end benchmark runs whole collaboration
+// iterations against a chat-completions endpoint served by this process.
+
+#define BENCH_MAX_SIZES 8
+#define BENCH_REGION_BODY 6
+
+// Inputs shared by the benchmarks of one size
+typedef struct {
+    int lines;
+    char *code;                                  // Synthetic C source with evolution regions
+    size_t code_length;
+    char *toml;                                  // Synthetic config of about the same line count
+    size_t toml_length;
+    char last_region[MAX_EVOLUTION_DESCRIPTION]; // Description of the last region (worst case lookup)
+    code_evolution_t evolution;                  // Regions parsed from code
+    conversation_t conversation;                 // Conversation whose solution is code
+    config_t *config;
+} bench_fixture_t;
+
+typedef struct {
+    const char *name;
+    size_t (*run)(bench_fixture_t *fixture);     // One operation; returns the bytes it processed
+} bench_case_t;
+
+// Chat-completions endpoint answering every request with the same solution
+typedef struct {
+    int listen_fd;
+    int port;
+    pthread_t thread;
+    char *response;                              // HTTP response, headers included
+    int requests;
+    int connections;                             // Open connections (handlers still running)
+} mock_server_t;
+
+static volatile size_t bench_sink = 0;           // Keeps results observable to the optimizer
+
+// Milliseconds between two monotonic timestamps
+static double elapsed_ms(const struct timespec *start, const struct timespec *end) {
+    return (end->tv_sec - start->tv_sec) * 1000.0 + (end->tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+// Generate a C source of about lines lines with up to MAX_EVOLUTION_REGIONS regions spread over it
+static char* synthetic_source(int lines, char *last_region, size_t last_region_size) {
+    dstring_t *code = dstring_create((size_t)lines * 40 + 256);
+    if (!code) return NULL;
+
+    dstring_append(code, "#include <stdio.h>\n#include <stdlib.h>\n\n");
+    int line = 3;
+    int regions = lines / 20 < MAX_EVOLUTION_REGIONS ? lines / 20 : MAX_EVOLUTION_REGIONS;
+    int region_every = regions > 0 ? lines / regions : lines + 1;
+    int next_region = region_every / 2;
+    int function = 0;
+    int region = 0;
+
+    while (line < lines - 8) {
+        if (region < regions && line >= next_region) {
+            snprintf(last_region, last_region_size, "hot loop %d", region);
+            dstring_append_format(code, "%s: %s\n", EVOLUTION_MARKER_START, last_region);
+            dstring_append_format(code, "static long kernel_%d(const int *values, int count) {\n", region);
+            dstring_append(code, "    long total = 0;\n");
+            dstring_append(code, "    for (int i = 0; i < count; i++) total += values[i] * (i & 7);\n");
+            dstring_append(code, "    return total;\n");
+            dstring_append(code, "}\n");
+            dstring_append_format(code, "%s\n\n", EVOLUTION_MARKER_END);
+            line += BENCH_REGION_BODY + 3;
+            region++;
+            next_region += region_every;
+            continue;
+        }
+        dstring_append_format(code, "// Helper %d: sums every third value\n", function);
+        dstring_append_format(code, "static int helper_%d(int value) {\n", function);
+        dstring_append(code, "    int total = 0;\n");
+        dstring_append(code, "    for (int i = 0; i < value; i++) {\n");
+        dstring_append_format(code, "        if (i %% 3 == 0) total += i * %d;\n", function % 17 + 1);
+        dstring_append(code, "    }\n");
+        dstring_append(code, "    return total;\n");
+        dstring_append(code, "}\n\n");
+        line += 9;
+        function++;
+    }
+    dstring_append(code, "int main(void) {\n    printf(\"%d\\n\", helper_0(10));\n    return 0;\n}\n");
+    return dstring_steal(code);
+}
+
+// Generate a TOML document of about lines lines in sections of 50 keys
+static char* synthetic_toml(int lines) {
+    dstring_t *toml = dstring_create((size_t)lines * 32 + 256);
+    if (!toml) return NULL;
+
+    dstring_append(toml, "fast_model_name = \"fast\"\niterations = 10\n");
+    for (int line = 2, key = 0; line < lines; line++, key++) {
+        if (key % 50 == 0) {
+            dstring_append_format(toml, "\n[section_%d]\n", key / 50);
+            line += 2;
+        }
+        switch (key % 4) {
+            case 0: dstring_append_format(toml, "count_%d = %d\n", key, key * 7); break;
+            case 1: dstring_append_format(toml, "ratio_%d = %d.25\n", key, key); break;
+            case 2: dstring_append_format(toml, "name_%d = \"value %d\"\n", key, key); break;
+            default: dstring_append_format(toml, "enabled_%d = %s\n", key, key % 8 == 3 ? "true" : "false"); break;
+        }
+    }
+    return dstring_steal(toml);
+}
+
+// Build the inputs of one size; returns 0 on success
+static int fixture_init(bench_fixture_t *fixture, int lines, config_t *config) {
+    memset(fixture, 0, sizeof(bench_fixture_t));
+    fixture->lines = lines;
+    fixture->config = config;
+    fixture->code = synthetic_source(lines, fixture->last_region, sizeof(fixture->last_region));
+    fixture->toml = synthetic_toml(lines);
+    if (!fixture->code || !fixture->toml) return -1;
+    fixture->code_length = strlen(fixture->code);
+    fixture->toml_length = strlen(fixture->toml);
+
+    init_code_evolution(&fixture->evolution);
+    parse_evolution_regions(&fixture->evolution, fixture->code);
+
+    // The conversation holds the source as its current solution, as after a few iterations
+    init_conversation(&fixture->conversation, "Optimize the kernels for throughput.", config);
+    conversation_t *conv = &fixture->conversation;
+    free(conv->current_solution);
+    conv->current_solution = strdup(fixture->code);
+    if (!conv->current_solution) return -1;
+    for (int i = 0; i < 4; i++) {
+        add_message(conv, i % 2 == 0 ? AGENT_FAST : AGENT_REASONING,
+                    "Unrolled the inner loop and hoisted the bounds check out of the kernel.");
+    }
+    if (conv->last_test_result.error_message) {
+        snprintf(conv->last_test_result.error_message, config->max_response_size,
+                 "warning: unused variable 'scratch' [-Wunused-variable]");
+    }
+    conv->iterations = 3;
+    parse_evolution_regions(&conv->evolution, fixture->code);
+    return 0;
+}
+
+static void fixture_cleanup(bench_fixture_t *fixture) {
+    cleanup_code_evolution(&fixture->evolution);
+    if (fixture->conversation.config) cleanup_conversation(&fixture->conversation);
+    free(fixture->code);
+    free(fixture->toml);
+}
+
+static size_t bench_parse_regions(bench_fixture_t *fixture) {
+    bench_sink += parse_evolution_regions(&fixture->evolution, fixture->code);
+    return fixture->code_length;
+}
+
+static size_t bench_assemble(bench_fixture_t *fixture) {
+    char *assembled = assemble_evolved_code(&fixture->evolution, fixture->code);
+    if (!assembled) return 0;
+    size_t length = strlen(assembled);
+    bench_sink += length;
+    free(assembled);
+    return length;
+}
+
+static size_t bench_extract_region(bench_fixture_t *fixture) {
+    char *content = NULL;
+    extract_evolution_region_content(fixture->code, fixture->last_region, &content);
+    bench_sink += content ? strlen(content) : 0;
+    free(content);
+    return fixture->code_length;
+}
+
+static size_t bench_append_format(bench_fixture_t *fixture) {
+    dstring_t *text = dstring_create(64);
+    if (!text) return 0;
+    for (int i = 0; i < fixture->lines; i++) {
+        dstring_append_format(text, "%s %d: fitness %.3f\n", "candidate", i, i * 0.001);
+    }
+    size_t length = strlen(dstring_get(text));
+    bench_sink += length;
+    dstring_destroy(text);
+    return length;
+}
+
+// Prompts are freed right away, like the main loop does
+static size_t bench_prompt(bench_fixture_t *fixture, int evolution) {
+    conversation_t *conv = &fixture->conversation;
+    conv->evolution.evolution_enabled = evolution;
+    char *prompt = evolution ? generate_evolution_prompt(conv, &conv->evolution, AGENT_REASONING)
+                             : generate_agent_prompt(conv, AGENT_REASONING);
+    conv->evolution.evolution_enabled = 1;
+    if (!prompt) return 0;
+    size_t length = strlen(prompt);
+    bench_sink += length;
+    free(prompt);
+    return length;
+}
+
+static size_t bench_agent_prompt(bench_fixture_t *fixture) {
+    return bench_prompt(fixture, 0);
+}
+
+static size_t bench_evolution_prompt(bench_fixture_t *fixture) {
+    return bench_prompt(fixture, 1);
+}
+
+static size_t bench_code_quality(bench_fixture_t *fixture) {
+    code_quality_metrics_t quality = analyze_code_quality(fixture->code);
+    bench_sink += quality.lines_of_code;
+    return fixture->code_length;
+}
+
+static size_t bench_toml_parse(bench_fixture_t *fixture) {
+    char errbuf[200];
+    toml_table_t *table = toml_parse(fixture->toml, errbuf, sizeof(errbuf));
+    if (!table) {
+        fprintf(stderr, "Error: Synthetic TOML did not parse: %s\n", errbuf);
+        return 0;
+    }
+    bench_sink += toml_table_ntab(table);
+    toml_free(table);
+    return fixture->toml_length;
+}
+
+static const bench_case_t bench_cases[] = {
+    {"parse_evolution_regions", bench_parse_regions},
+    {"assemble_evolved_code", bench_assemble},
+    {"extract_evolution_region_content", bench_extract_region},
+    {"dstring_append_format", bench_append_format},
+    {"generate_agent_prompt", bench_agent_prompt},
+    {"generate_evolution_prompt", bench_evolution_prompt},
+    {"analyze_code_quality", bench_code_quality},
+    {"toml_parse", bench_toml_parse},
+};
+
+// Write one result as a JSON line and a summary row
+static void report_result(FILE *out, const char *name, int lines, size_t bytes, long iterations, double total_ms) {
+    double ns_per_op = iterations > 0 ? total_ms * 1000000.0 / iterations : 0.0;
+    double mb_per_s = total_ms > 0.0 ? (double)bytes * iterations / (total_ms / 1000.0) / (1024.0 * 1024.0) : 0.0;
+
+    cJSON *result = cJSON_CreateObject();
+    if (!result) return;
+    cJSON_AddStringToObject(result, "benchmark", name);
+    cJSON_AddNumberToObject(result, "lines", lines);
+    cJSON_AddNumberToObject(result, "bytes", (double)bytes);
+    cJSON_AddNumberToObject(result, "iterations", (double)iterations);
+    cJSON_AddNumberToObject(result, "total_ms", total_ms);
+    cJSON_AddNumberToObject(result, "ns_per_op", ns_per_op);
+    cJSON_AddNumberToObject(result, "mb_per_s", mb_per_s);
+    char *line = cJSON_PrintUnformatted(result);
+    if (line) {
+        fprintf(out, "%s\n", line);
+        fflush(out);
+        free(line);
+    }
+    cJSON_Delete(result);
+
+    fprintf(stderr, "%-34s %7d lines %12.0f ns/op %9.1f MB/s (%ld ops)\n",
+            name, lines, ns_per_op, mb_per_s, iterations);
+}
+
+// Repeat a case until min_time_ms has passed, doubling the batch size
+static void run_case(FILE *out, const bench_case_t *bench, bench_fixture_t *fixture, double min_time_ms) {
+    size_t bytes = bench->run(fixture); // Warm-up, also the size of one operation
+    long batch = 1;
+    for (;;) {
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (long i = 0; i < batch; i++) {
+            bench->run(fixture);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double total_ms = elapsed_ms(&start, &end);
+        if (total_ms >= min_time_ms || batch >= (1L << 30)) {
+            report_result(out, bench->name, fixture->lines, bytes, batch, total_ms);
+            return;
+        }
+        batch *= 2;
+    }
+}
+
+// Send all of data; returns 0 on success
+static int send_all(int fd, const char *data, size_t length) {
+    while (length > 0) {
+        ssize_t sent = send(fd, data, length, MSG_NOSIGNAL);
+        if (sent <= 0) return -1;
+        data += sent;
+        length -= sent;
+    }
+    return 0;
+}
+
+typedef struct {
+    mock_server_t *server;
+    int fd;
+} mock_connection_t;
+
+// Answer every request of one keep-alive connection (detached thread)
+static void* mock_connection(void *arg) {
+    mock_connection_t *connection = (mock_connection_t *)arg;
+    mock_server_t *server = connection->server;
+    int fd = connection->fd;
+    free(connection);
+
+    size_t capacity = 65536, used = 0;
+    char *buffer = malloc(capacity + 1);
+    while (buffer) {
+        // Wait for a full header block and body, then answer and drop the request
+        char *headers_end = NULL;
+        size_t body_length = 0;
+        for (;;) {
+            buffer[used] = '\0';
+            headers_end = strstr(buffer, "\r\n\r\n");
+            if (headers_end) {
+                const char *length_header = strcasestr(buffer, "Content-Length:");
+                body_length = length_header && length_header < headers_end ? strtoul(length_header + 15, NULL, 10) : 0;
+                if (used >= (size_t)(headers_end + 4 - buffer) + body_length) break;
+            }
+            if (used == capacity) {
+                char *larger = realloc(buffer, capacity * 2 + 1);
+                if (!larger) break;
+                buffer = larger;
+                capacity *= 2;
+                continue;
+            }
+            ssize_t received = recv(fd, buffer + used, capacity - used, 0);
+            if (received <= 0) {
+                headers_end = NULL;
+                break;
+            }
+            used += received;
+        }
+        if (!headers_end) break;
+
+        __atomic_add_fetch(&server->requests, 1, __ATOMIC_RELAXED);
+        if (send_all(fd, server->response, strlen(server->response)) != 0) break;
+
+        size_t request_length = (size_t)(headers_end + 4 - buffer) + body_length;
+        memmove(buffer, buffer + request_length, used - request_length);
+        used -= request_length;
+    }
+    free(buffer);
+    close(fd);
+    __atomic_sub_fetch(&server->connections, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+// Accept connections until the listening socket is shut down
+static void* mock_accept_loop(void *arg) {
+    mock_server_t *server = (mock_server_t *)arg;
+    for (;;) {
+        int fd = accept(server->listen_fd, NULL, NULL);
+        if (fd < 0) break;
+
+        mock_connection_t *connection = malloc(sizeof(mock_connection_t));
+        pthread_t thread;
+        if (!connection) {
+            close(fd);
+            continue;
+        }
+        connection->server = server;
+        connection->fd = fd;
+        __atomic_add_fetch(&server->connections, 1, __ATOMIC_ACQUIRE);
+        if (pthread_create(&thread, NULL, mock_connection, connection) != 0) {
+            __atomic_sub_fetch(&server->connections, 1, __ATOMIC_RELEASE);
+            free(connection);
+            close(fd);
+            continue;
+        }
+        pthread_detach(thread);
+    }
+    return NULL;
+}
+
+// Start the endpoint on an ephemeral loopback port; returns 0 on success
+static int mock_server_start(mock_server_t *server, const char *solution) {
+    memset(server, 0, sizeof(mock_server_t));
+
+    cJSON *body = cJSON_CreateObject();
+    cJSON *choices = cJSON_CreateArray();
+    cJSON *choice = cJSON_CreateObject();
+    cJSON *message = cJSON_CreateObject();
+    cJSON *usage = cJSON_CreateObject();
+    if (!body || !choices || !choice || !message || !usage) {
+        cJSON_Delete(body);
+        cJSON_Delete(choices);
+        cJSON_Delete(choice);
+        cJSON_Delete(message);
+        cJSON_Delete(usage);
+        return -1;
+    }
+    cJSON_AddStringToObject(message, "role", "assistant");
+    cJSON_AddStringToObject(message, "content", solution);
+    cJSON_AddNumberToObject(choice, "index", 0);
+    cJSON_AddItemToObject(choice, "message", message);
+    cJSON_AddStringToObject(choice, "finish_reason", "stop");
+    cJSON_AddItemToArray(choices, choice);
+    cJSON_AddItemToObject(body, "choices", choices);
+    cJSON_AddNumberToObject(usage, "completion_tokens", 64);
+    cJSON_AddItemToObject(body, "usage", usage);
+    char *json = cJSON_PrintUnformatted(body);
+    cJSON_Delete(body);
+    if (!json) return -1;
+
+    dstring_t *response = dstring_create(strlen(json) + 256);
+    if (response) {
+        dstring_append_format(response, "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+                                        "Content-Length: %zu\r\n\r\n", strlen(json));
+        dstring_append(response, json);
+        server->response = dstring_steal(response);
+    }
+    free(json);
+    if (!server->response) return -1;
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    socklen_t address_length = sizeof(address);
+
+    server->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (server->listen_fd < 0 ||
+        bind(server->listen_fd, (struct sockaddr *)&address, sizeof(address)) != 0 ||
+        listen(server->listen_fd, 16) != 0 ||
+        getsockname(server->listen_fd, (struct sockaddr *)&address, &address_length) != 0) {
+        perror("Error: Cannot start the mock endpoint");
+        if (server->listen_fd >= 0) close(server->listen_fd);
+        free(server->response);
+        return -1;
+    }
+    fcntl(server->listen_fd, F_SETFD, FD_CLOEXEC);
+    server->port = ntohs(address.sin_port);
+
+    if (pthread_create(&server->thread, NULL, mock_accept_loop, server) != 0) {
+        close(server->listen_fd);
+        free(server->response);
+        return -1;
+    }
+    return 0;
+}
+
+// Stop accepting and wait (up to a second) for open connections to close
+static void mock_server_stop(mock_server_t *server) {
+    shutdown(server->listen_fd, SHUT_RDWR);
+    close(server->listen_fd);
+    pthread_join(server->thread, NULL);
+    for (int i = 0; i < 100 && __atomic_load_n(&server->connections, __ATOMIC_ACQUIRE) > 0; i++) {
+        usleep(10000);
+    }
+    if (__atomic_load_n(&server->connections, __ATOMIC_ACQUIRE) == 0) free(server->response);
+}
+
+// Point stdout at /dev/null (the collaboration loop prints progress); returns the saved descriptor
+static int stdout_silence(void) {
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+    if (saved >= 0 && null_fd >= 0) dup2(null_fd, STDOUT_FILENO);
+    if (null_fd >= 0) close(null_fd);
+    return saved;
+}
+
+static void stdout_restore(int saved) {
+    fflush(stdout);
+    if (saved < 0) return;
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+}
+
+// Write a config for the benchmarks into the workspace and load it; returns 0 on success
+static int load_bench_config(config_t *config, const workspace_t *workspace, int port, int max_code_size) {
+    char endpoint[128];
+    snprintf(endpoint, sizeof(endpoint), "http://127.0.0.1:%d/v1/chat/completions", port);
+
+    dstring_t *text = dstring_create(1024);
+    if (!text) return -1;
+    dstring_append_format(text,
+        "fast_model_endpoint = \"%s\"\n"
+        "reasoning_model_endpoint = \"%s\"\n"
+        "enable_streaming = false\n"
+        "use_colors = false\n"
+        "verbosity = 0\n"
+        "iteration_delay_ms = 0\n"
+        "log_file = \"\"\n"
+        "max_code_size = %d\n"
+        "max_response_size = %d\n",
+        endpoint, endpoint, max_code_size, max_code_size);
+
+    char path[1024];
+    int status = workspace_write_file(workspace, "bench.toml", dstring_get(text), path, sizeof(path));
+    dstring_destroy(text);
+    if (status != 0) return -1;
+
+    int saved = stdout_silence();
+    status = load_config(config, path);
+    stdout_restore(saved);
+    return status;
+}
+
+// Time whole collaboration iterations against the mock endpoint
+static void run_end_to_end(FILE *out, config_t *config, const workspace_t *workspace, mock_server_t *server,
+                           int iterations) {
+    char cwd[1024];
+    if (!getcwd(cwd, sizeof(cwd)) || chdir(workspace->path) != 0) {
+        fprintf(stderr, "Error: Cannot enter the benchmark workspace\n");
+        return;
+    }
+
+    config->iterations = iterations;
+    int saved = stdout_silence();
+    log_writer_init(config);
+    http_client_init();
+    model_cache_init(config);
+    eval_cache_init(config);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int status = run_collaboration("Print hello from a C program.", config);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    eval_cache_cleanup();
+    model_cache_cleanup();
+    http_client_cleanup();
+    log_writer_shutdown();
+    stdout_restore(saved);
+    if (chdir(cwd) != 0) fprintf(stderr, "Warning: Cannot return to %s\n", cwd);
+
+    if (status != 0) {
+        fprintf(stderr, "Error: End-to-end collaboration failed\n");
+        return;
+    }
+    double total_ms = elapsed_ms(&start, &end);
+    report_result(out, "collaboration_iteration", 0, 0, iterations, total_ms);
+    fprintf(stderr, "%-34s %d model requests\n", "", __atomic_load_n(&server->requests, __ATOMIC_RELAXED));
+}
+
+int main(int argc, char *argv[]) {
+    argparser_t *parser = argparse_create("beta_bench", "Benchmarks of Beta Evolve's hot paths (JSON Lines output)");
+    argparse_add_string(parser, "output", 'o', "Write results to this file instead of stdout", false, NULL);
+    argparse_add_string(parser, "filter", 'f', "Only run benchmarks whose name contains this text", false, NULL);
+    argparse_add_int(parser, "min-time", 't', "Minimum measured time per benchmark in milliseconds", false, 200);
+    argparse_add_int(parser, "max-lines", 'l', "Largest synthetic input in lines", false, 100000);
+    argparse_add_int(parser, "e2e-iterations", 'i', "Collaboration iterations of the end-to-end benchmark (0 = skip)",
+                     false, 3);
+    argparse_add_flag(parser, "quick", 'q', "Short runs on inputs up to 1000 lines");
+    argparse_add_flag(parser, "help", 'h', "Show this help message");
+
+    if (!argparse_parse(parser, argc, argv)) {
+        argparse_print_usage(parser);
+        argparse_destroy(parser);
+        return 1;
+    }
+    if (parser->help_requested || argparse_is_set(parser, "help")) {
+        argparse_print_help(parser);
+        argparse_destroy(parser);
+        return 0;
+    }
+
+    const char *output_path = argparse_get_string(parser, "output");
+    const char *filter = argparse_get_string(parser, "filter");
+    int quick = argparse_get_bool(parser, "quick");
+    double min_time_ms = quick ? 20.0 : argparse_get_int(parser, "min-time");
+    int max_lines = quick ? 1000 : argparse_get_int(parser, "max-lines");
+    int e2e_iterations = quick ? 1 : argparse_get_int(parser, "e2e-iterations");
+
+    FILE *out = stdout;
+    if (output_path && strlen(output_path) > 0) {
+        out = fopen(output_path, "w");
+        if (!out) {
+            fprintf(stderr, "Error: Cannot write results to '%s'\n", output_path);
+            argparse_destroy(parser);
+            return 1;
+        }
+    }
+
+    // Sizes grow tenfold from 100 lines up to max_lines
+    int sizes[BENCH_MAX_SIZES];
+    int size_count = 0;
+    for (int lines = 100; lines <= max_lines && size_count < BENCH_MAX_SIZES; lines *= 10) {
+        sizes[size_count++] = lines;
+    }
+    if (size_count == 0) sizes[size_count++] = max_lines > 0 ? max_lines : 100;
+
+    // The largest source must fit the conversation's solution and response buffers
+    char region[MAX_EVOLUTION_DESCRIPTION];
+    char *largest = synthetic_source(sizes[size_count - 1], region, sizeof(region));
+    int max_code_size = largest ? (int)strlen(largest) + 1024 : 65536;
+    free(largest);
+
+    colors_disable();
+    colors_init();
+
+    workspace_t workspace;
+    mock_server_t server;
+    config_t config;
+    int status = 1;
+    if (workspace_create(&workspace, "bench") != 0) {
+        fprintf(stderr, "Error: Cannot create the benchmark workspace\n");
+    } else if (mock_server_start(&server, "```c\n#include <stdio.h>\nint main(void) {\n"
+                                          "    printf(\"hello\\n\");\n    return 0;\n}\n```\n") != 0) {
+        fprintf(stderr, "Error: Cannot start the mock chat-completions endpoint\n");
+        workspace_destroy(&workspace);
+    } else {
+        if (load_bench_config(&config, &workspace, server.port, max_code_size) != 0) {
+            fprintf(stderr, "Error: Cannot load the benchmark configuration\n");
+        } else {
+            status = 0;
+            for (int s = 0; s < size_count && status == 0; s++) {
+                bench_fixture_t fixture;
+                if (fixture_init(&fixture, sizes[s], &config) != 0) {
+                    fprintf(stderr, "Error: Cannot build the %d-line inputs\n", sizes[s]);
+                    status = 1;
+                }
+                for (size_t c = 0; status == 0 && c < sizeof(bench_cases) / sizeof(bench_cases[0]); c++) {
+                    if (filter && !strstr(bench_cases[c].name, filter)) continue;
+                    run_case(out, &bench_cases[c], &fixture, min_time_ms);
+                }
+                fixture_cleanup(&fixture);
+            }
+
+            if (status == 0 && e2e_iterations > 0 && (!filter || strstr("collaboration_iteration", filter))) {
+                run_end_to_end(out, &config, &workspace, &server, e2e_iterations);
+            }
+            free_config(&config);
+        }
+        mock_server_stop(&server);
+        workspace_destroy(&workspace);
+    }
+
+    if (out != stdout) fclose(out);
+    argparse_destroy(parser);
+    return status;
+}
@@ -3,8 +3,28 @@
 
 #include "beta_evolve.h"
 
+// Per-agent model call statistics
+typedef struct {
+    int calls;                                   // Completed model calls
+    int streamed_calls;                          // Calls answered as a server-sent event stream
+    int early_cutoffs;                           // Streams cancelled once the code block closed
+    double last_ttft_ms;                         // Time to first token of the latest call
+    double total_ttft_ms;                        // Sum of time to first token over all calls
+    double last_tokens_per_sec;                  // Generation speed of the latest call
+    long total_tokens;                           // Completion tokens received
+    double total_generation_ms;                  // Time from first to last token over all calls
+} ai_agent_stats_t;
+
 // AI client functions for calling models
 char* call_ai_model(const char* prompt, agent_type_t agent, config_t *config);
+// Request n samples of one prompt in a single call; fills responses[0..] with
+// malloc'd strings and returns how many were received (a server without "n"
+// support returns 1)
+int call_ai_model_n(const char* prompt, agent_type_t agent, config_t *config, int n, char **responses);
 char* validate_and_clean_response(const char* response);
+ai_agent_stats_t get_ai_agent_stats(agent_type_t agent);
+void log_ai_agent_stats(config_t *config);
+// Wait for hedged requests that lost their race to stop (before http_client_cleanup)
+void ai_wait_hedged_requests(void);
 
 #endif // AI_H
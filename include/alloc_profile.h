@@ -0,0 +1,43 @@
+#ifndef ALLOC_PROFILE_H
+#define ALLOC_PROFILE_H
+
+#include <stdint.h>
+
+// Allocation profile written by the LD_PRELOAD shim (libbeta_alloc.so).
+// The benchmark runs one extra, untimed run with the shim preloaded and the
+// write end of a pipe in ALLOC_PROFILE_FD_ENV; when the candidate exits, the
+// shim writes one alloc_profile_t (well under PIPE_BUF, so atomically) to it.
+// Only the record whose pid matches the candidate is used, so processes the
+// candidate starts do not count. Shared by the shim and beta_evolve, so it
+// must not depend on anything else in the tree.
+
+#define ALLOC_PROFILE_FD_ENV "BETA_EVOLVE_ALLOC_FD"
+#define ALLOC_PROFILE_MAGIC 0x414c4c4fu          // "ALLO"
+
+// Size classes of the histogram: <= 16, 64, 256, 1K, 4K, 64K, 1M bytes, larger
+#define ALLOC_HISTOGRAM_BUCKETS 8
+
+typedef struct {
+    uint32_t magic;
+    int32_t pid;
+    uint64_t malloc_calls;
+    uint64_t calloc_calls;
+    uint64_t realloc_calls;
+    uint64_t free_calls;
+    uint64_t allocated_bytes;                    // Bytes requested from malloc/calloc/realloc
+    uint64_t peak_live_bytes;                    // Largest usable size in use at once
+    uint64_t histogram[ALLOC_HISTOGRAM_BUCKETS]; // Requests per size class
+} alloc_profile_t;
+
+// Histogram bucket of a request of size bytes
+static inline int alloc_histogram_bucket(uint64_t size) {
+    static const uint64_t limits[ALLOC_HISTOGRAM_BUCKETS - 1] = {
+        16, 64, 256, 1024, 4096, 65536, 1048576
+    };
+    for (int i = 0; i < ALLOC_HISTOGRAM_BUCKETS - 1; i++) {
+        if (size <= limits[i]) return i;
+    }
+    return ALLOC_HISTOGRAM_BUCKETS - 1;
+}
+
+#endif // ALLOC_PROFILE_H
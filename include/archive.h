@@ -0,0 +1,98 @@
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include "beta_evolve.h"
+#include <stdint.h>
+
+// Persistent candidate archive.
+// Every evaluated candidate is appended to a single file as a fixed-layout
+// binary record (lineage, metrics, region hashes) followed by its code and
+// last error output. The file is memory-mapped for scanning, each record
+// carries a checksum, and a torn record left by a crash is cut off when the
+// archive is reopened, so an interrupted run can resume from its last
+// iteration instead of starting over.
+
+#define ARCHIVE_VERSION 1
+
+// Record flags
+#define ARCHIVE_SYNTAX_OK   0x01
+#define ARCHIVE_COMPILED    0x02
+#define ARCHIVE_EXECUTED    0x04
+#define ARCHIVE_EVALUATED   0x08                 // Scores and metrics below were measured
+#define ARCHIVE_PASSED      0x10                 // Met the evaluation criteria
+#define ARCHIVE_SELECTED    0x20                 // Became the conversation's solution
+#define ARCHIVE_SURVIVOR    0x40                 // Kept as a parent of the next generation
+#define ARCHIVE_MIGRANT     0x80                 // Imported from another island's archive
+
+// On-disk record header, followed by region_count uint64_t region hashes,
+// code_length bytes of code, error_length bytes of errors (each NUL-terminated)
+// and padding to a multiple of 8 bytes
+typedef struct {
+    uint32_t magic;
+    uint32_t size;                               // Whole record, header to padding
+    uint64_t id;                                 // 1-based, increasing
+    uint64_t parent_id;                          // Record the candidate was bred from (0 = none)
+    uint64_t code_hash;                          // FNV-1a of the code
+    int32_t iteration;                           // Collaboration iteration (1-based)
+    int32_t generation;                          // Population generation (0 = single-candidate loop)
+    int32_t flags;                               // ARCHIVE_* bits
+    int32_t region_count;
+    uint32_t code_length;
+    uint32_t error_length;
+    uint32_t checksum;                           // FNV-1a of the record with this field zero
+    uint32_t reserved;
+    int64_t timestamp;
+    double fitness;                              // 0.0 - 1.0
+    double overall_score;
+    double correctness_score;
+    double performance_score;
+    double quality_score;
+    double execution_time_ms;
+    double p95_time_ms;
+    double stddev_time_ms;
+    double throughput;
+    int64_t memory_usage_kb;
+    int32_t lines_of_code;
+    int32_t cyclomatic_complexity;
+    double maintainability_index;
+} archive_record_t;
+
+typedef struct archive archive_t;
+
+// Open or create the archive at path for problem. An existing archive of a
+// different problem is refused. Returns NULL on error.
+archive_t* archive_open(const char *path, const char *problem);
+void archive_close(archive_t *archive);
+
+// Open another node's archive read-only. A record still being appended is
+// ignored rather than cut off. Returns NULL, without a warning, for anything
+// that is not an archive of problem.
+archive_t* archive_open_peer(const char *path, const char *problem);
+
+// Append a record: meta supplies lineage and metrics, the archive fills in
+// id, sizes, hashes, timestamp and checksum. Returns the new id, 0 on error.
+uint64_t archive_append(archive_t *archive, const archive_record_t *meta, const char *code, const char *errors);
+
+// Records in append order; pointers stay valid until the next append
+int archive_count(archive_t *archive);
+const archive_record_t* archive_get(archive_t *archive, int index);
+
+// Indices of up to max_indices survivors of the newest archived generation,
+// best fitness first. Returns how many were found.
+int archive_latest_survivors(archive_t *archive, int *indices, int max_indices);
+
+// Payload of a record
+const uint64_t* archive_region_hashes(const archive_record_t *record);
+const char* archive_code(const archive_record_t *record);
+const char* archive_errors(const archive_record_t *record);
+
+// Fill the lineage-independent fields of meta from a test or evaluation result
+void archive_record_test(archive_record_t *meta, const test_result_t *result);
+void archive_record_evaluation(archive_record_t *meta, const evaluation_result_t *result);
+
+// Restore a single-candidate run: the last selected solution, its errors and
+// the evaluation history. Returns the iteration to continue after (0 = nothing
+// to resume) and sets *parent_id to the record the next candidate descends from.
+int archive_resume(archive_t *archive, conversation_t *conv, uint64_t *parent_id);
+
+#endif // ARCHIVE_H
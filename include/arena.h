@@ -0,0 +1,44 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Region allocator for short-lived scratch memory.
+// Allocations are bumped out of large blocks and are never freed one by one;
+// arena_reset() releases everything at once and keeps the first block for
+// reuse, so a loop that resets its arena every pass stops hitting malloc.
+// No block is allocated until the first allocation, so an unused arena costs
+// only its header.
+// Heap pointers handed to arena_own() are freed by the next reset, which lets
+// code that receives malloc'd strings from other modules drop them in one shot
+// too. An arena is not thread safe.
+
+typedef struct arena arena_t;
+
+// Create an arena whose blocks hold at least block_size bytes (allocated lazily)
+arena_t* arena_create(size_t block_size);
+
+// Free every block and owned pointer, then the arena itself
+void arena_destroy(arena_t *arena);
+
+// Release all allocations and owned pointers, keeping the first block
+void arena_reset(arena_t *arena);
+
+// Allocate size bytes aligned for any type (NULL on failure)
+void* arena_alloc(arena_t *arena, size_t size);
+
+// Allocate size zeroed bytes
+void* arena_calloc(arena_t *arena, size_t size);
+
+// Copy a string (or its first length bytes) into the arena
+char* arena_strdup(arena_t *arena, const char *text);
+char* arena_strndup(arena_t *arena, const char *text, size_t length);
+
+// Free ptr (from malloc) at the next reset; returns ptr, which may be NULL
+void* arena_own(arena_t *arena, void *ptr);
+
+// Bytes handed out since the last reset, and the largest such value seen
+size_t arena_used(const arena_t *arena);
+size_t arena_peak(const arena_t *arena);
+
+#endif // ARENA_H
@@ -0,0 +1,22 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "beta_evolve.h"
+
+// Batch runs: many problems in one process.
+// The job list names one job per line (blank lines and # comments skipped):
+//   problems/sort.prompt              a problem prompt file
+//   targets/hash.c [hash.prompt]      an evolution target, optionally with its problem
+// Up to batch_jobs jobs run at once, each with its own conversation, copy of
+// the configuration and output directory (batch_output_dir/NNN-name) for its
+// solution, archive and reports. The jobs share the HTTP connection pool, the
+// per-endpoint API quota (see rate_limit.h), the evaluation cache and the
+// eval_slots local run slots, so a batch is bound by the API quota and the
+// CPUs instead of separate processes competing for them. One JSON line per job
+// is written to batch_output_dir/summary.jsonl.
+
+// Run every job of job_list; problem is used by evolution targets without a
+// prompt file (may be NULL). Returns 0 when every job succeeded.
+int run_batch(const char *job_list, const char *problem, config_t *config);
+
+#endif // BATCH_H
@@ -0,0 +1,44 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "beta_evolve.h"
+
+// Benchmark engine for evaluated candidates.
+// A binary is run benchmark_warmup_runs times untimed, then timed with
+// CLOCK_MONOTONIC until the 95% confidence interval of the mean is within
+// benchmark_target_ci_percent (bounded by min/max runs and a time budget).
+// The cost of starting an empty process is measured once and subtracted, so
+// the statistics describe the candidate rather than fork/exec. Concurrent
+// callers are serialized so parallel evaluations do not skew each other.
+//
+// With kernel_entry set, candidates are built as shared objects instead and
+// timed in-process: a persistent runner (beta_kernel_runner) loads each one,
+// calls the entry in calibrated batches over pre-generated inputs and reports
+// nanoseconds per call. The runner is supervised like a candidate run, so a
+// crash or timeout fails only that candidate and a fresh runner serves the next.
+
+// Benchmark a built binary and fill the timing statistics of metrics.
+// Returns 0 on success, -1 if the binary could not be run.
+int benchmark_binary(const char *binary_path, config_t *config, performance_metrics_t *metrics);
+
+// Environment variable that carries the input size of a scaling run
+#define SCALING_SIZE_ENV "BETA_EVOLVE_SIZE"
+
+// Benchmark a built binary with the input size passed as argv[1] and in
+// SCALING_SIZE_ENV. Fills the timing statistics only (no hardware counters).
+// Returns 0 on success, -1 if the binary could not be run at that size.
+int benchmark_binary_size(const char *binary_path, long size, config_t *config, performance_metrics_t *metrics);
+
+// Benchmark kernel_entry of a shared object in-process with input_size
+// elements per input. Fills the timing statistics (per call) and ns_per_call,
+// no hardware counters or allocation profile.
+// Returns 0 on success, -1 if the object could not be loaded or its calls
+// crashed or timed out.
+int benchmark_kernel(const char *library_path, long input_size, config_t *config, performance_metrics_t *metrics);
+
+// Compare the mean run times of two benchmarks with Welch's t-test.
+// Returns -1 if a is significantly faster, 1 if significantly slower, 0 if the
+// difference is within noise (or either side has too few samples).
+int benchmark_compare(const performance_metrics_t *a, const performance_metrics_t *b);
+
+#endif // BENCHMARK_H
@@ -7,6 +7,10 @@
 #include "toml.h"
 #include "colors.h"
 #include "json.h"
+#include "arena.h"
+#include "process.h"
+#include "alloc_profile.h"
+#include "kernel_runner.h"
 #include <time.h>
 #include <unistd.h>
 #include <stdarg.h>
@@ -43,6 +47,7 @@ typedef struct {
     int execution_ok;
     char *error_message;    // Dynamic allocation
     char *output;           // Dynamic allocation
+    process_status_t run_status; // PROCESS_TIMEOUT / PROCESS_OOM / PROCESS_OUTPUT_LIMIT when a limit was hit
 } test_result_t;
 
 // Code evolution structures and constants
@@ -57,17 +62,73 @@ typedef struct {
     char description[MAX_EVOLUTION_DESCRIPTION]; // Description/identifier for this region
     int start_line;                              // Line number where region starts
     int end_line;                                // Line number where region ends
+    size_t start_offset;                         // Byte offset of the content in the parsed code
+    size_t end_offset;                           // Byte offset of the END marker line
     int generation;                              // Evolution generation number
     double fitness_score;                        // Performance/correctness score
 } evolution_region_t;
 
+// Complexity classes fitted by the input-size scaling sweep
+typedef enum {
+    COMPLEXITY_CONSTANT,
+    COMPLEXITY_LOG,
+    COMPLEXITY_LINEAR,
+    COMPLEXITY_N_LOG_N,
+    COMPLEXITY_QUADRATIC,
+    COMPLEXITY_CUBIC,
+    COMPLEXITY_CLASS_COUNT
+} complexity_class_t;
+
+// Run times over a geometric series of input sizes and the curve fitted to them
+#define MAX_SCALING_POINTS 16
+typedef struct {
+    int point_count;                             // Sizes measured (0 = no sweep)
+    long sizes[MAX_SCALING_POINTS];              // Input sizes, ascending
+    double times_ms[MAX_SCALING_POINTS];         // Median run time at each size
+    double exponent;                             // Log-log slope over the largest sizes (t ~ n^exponent)
+    complexity_class_t complexity;               // Best fitting class of t = a + b * f(n)
+    double fit_error;                            // RMS relative error of that fit
+    double fixed_ms;                             // Fitted constant cost a
+    double crossover_size;                       // Size where b * f(n) overtakes a (0 = none)
+    int shift_count;                             // Sizes where the local slope changes by 0.5 or more
+    long shift_sizes[MAX_SCALING_POINTS];
+} scaling_profile_t;
+
 // Performance metrics structure
 typedef struct {
-    double execution_time_ms;                    // Execution time in milliseconds
+    double execution_time_ms;                    // Median execution time in milliseconds (start-up overhead removed)
+    double ns_per_call;                          // Median time of one kernel_entry call (0 = whole-binary runs)
+    long long calls_per_batch;                   // Calls per timed sample of a kernel benchmark
     long memory_usage_kb;                        // Memory usage in kilobytes
     int cpu_usage_percent;                       // CPU usage percentage
     double throughput;                           // Operations per second (if applicable)
     int cache_misses;                            // Cache misses (if profiled)
+    double mean_time_ms;                         // Mean of the timed runs
+    double median_time_ms;                       // Median of the timed runs
+    double p95_time_ms;                          // 95th percentile of the timed runs
+    double min_time_ms;                          // Fastest timed run
+    double stddev_time_ms;                       // Sample standard deviation of the timed runs
+    double ci95_time_ms;                         // Half-width of the 95% confidence interval of the mean
+    double startup_overhead_ms;                  // Process start-up cost subtracted from each run
+    int sample_count;                            // Number of timed runs
+    int warmup_runs;                             // Untimed runs before measuring
+    int counters_available;                      // 1 if the hardware counters below were collected
+    long long cycles;                            // CPU cycles (user space)
+    long long instructions;                      // Retired instructions
+    double ipc;                                  // Instructions per cycle
+    long long l1d_misses;                        // L1 data cache read misses (-1 if unsupported)
+    long long llc_misses;                        // Last level cache misses (-1 if unsupported)
+    long long branch_misses;                     // Mispredicted branches (-1 if unsupported)
+    int allocations_available;                   // 1 if the allocation profile below was collected
+    long long malloc_calls;                      // malloc (and aligned allocation) calls of one run
+    long long calloc_calls;
+    long long realloc_calls;
+    long long free_calls;
+    long long allocated_bytes;                   // Bytes requested over the run
+    long long peak_heap_bytes;                   // Largest usable heap size in use at once
+    long long allocation_histogram[ALLOC_HISTOGRAM_BUCKETS]; // Requests per size class
+    scaling_profile_t scaling;                   // Input-size sweep (if enable_scaling_sweep)
+    char build_flags[320];                       // Build configuration that produced these numbers
 } performance_metrics_t;
 
 // Code quality metrics structure
@@ -89,11 +150,43 @@ typedef struct {
     double min_test_coverage_percent;            // Minimum test coverage required
     int max_cyclomatic_complexity;               // Maximum complexity allowed
     double target_throughput;                    // Target operations per second
+    double max_scaling_exponent;                 // Largest fitted scaling exponent allowed (0 = no limit)
     int enable_performance_profiling;            // Enable detailed performance analysis
     int enable_memory_profiling;                 // Enable memory usage analysis
     int enable_quality_analysis;                 // Enable code quality analysis
 } evaluation_criteria_t;
 
+// Compiler flag sets benchmarked for every candidate
+#define MAX_BUILD_CONFIGS 8
+#define MAX_FALLBACK_ENDPOINTS 4
+
+// How one reported metric contributes to fitness
+#define MAX_FITNESS_METRICS 8
+typedef struct {
+    char name[64];                               // Name after "METRIC" or the JSON key
+    int minimize;                                // Lower values are better
+    double weight;                               // Share of the performance part of fitness
+    double scale;                                // Value that scores 0.5 (scores are v/(v+scale))
+    int has_min, has_max;
+    double min, max;                             // Correctness gate: outside [min, max] the candidate fails
+} fitness_metric_t;
+
+// Metrics reported by a test or benchmark command
+#define MAX_MEASURED_METRICS 32
+typedef struct {
+    char name[64];
+    double value;
+} metric_value_t;
+
+typedef struct {
+    metric_value_t values[MAX_MEASURED_METRICS];
+    int count;
+    int measured;                                // Metrics were collected for the solution
+    int benchmark_failed;                        // benchmark_command failed on code that passed its test
+    int gates_passed;                            // Ran correctly and every gate held
+    double fitness;                              // 0.0 - 1.0 combined metric fitness
+} metric_set_t;
+
 // Comprehensive evaluation result structure
 typedef struct {
     double overall_score;                        // Overall evaluation score (0-100)
@@ -130,7 +223,12 @@ typedef struct {
     char reasoning_model_endpoint[512];
     char fast_model_name[128];
     char reasoning_model_name[128];
+    // Streaming configuration
+    int enable_streaming;                // Request server-sent event streams from the model API
+    int stream_early_cutoff;             // Cancel a stream once its code block is complete
+    int enable_async_pipeline;           // Overlap model calls with testing (single-candidate mode)
     int iterations;
+    int iteration_delay_ms;              // Pause between iterations (0 = none)
     // Flexible configuration parameters
     int max_response_size;
     int max_prompt_size;
@@ -143,13 +241,113 @@ typedef struct {
     char args[1024];
     // Evolution configuration
     char evolution_file_path[512];       // Path to the code file to evolve
-    char test_command[1024];             // Custom command to test the evolved code
+    char test_command[1024];             // Custom command to test the evolved code (first case of a suite)
+    char **test_cases;                   // test_command list and test_manifest lines (NULL = single command)
+    int test_case_count;
+    int test_jobs;                       // Test cases run concurrently
+    int test_fail_fast;                  // Cancel the remaining cases after the first failure
     int enable_evolution;                // Enable/disable evolution mode
+    int region_scoped_prompts;           // Send only region bodies plus the declarations they use
+    int region_prompt_token_budget;      // Approximate token budget of region-scoped code (0 = unlimited)
+    int region_patch_responses;          // Ask for one replacement block per changed region
+    // Population configuration
+    int population_size;                 // Candidates per generation (1 = classic single-candidate loop)
+    int population_survivors;            // Top candidates kept as parents for the next generation
+    int evaluation_workers;              // Concurrent candidate evaluations
+    int population_shared_samples;       // One fast request with n samples per parent instead of per candidate
+    int enable_eval_cascade;             // Stage candidate evaluation and drop near-duplicates
+    char cascade_smoke_command[1024];    // Cheap test run before the full tests ("" = no smoke stage)
+    double cascade_threshold;            // Benchmark only candidates screening within this of the best
+    char workspace_dir[512];             // Where candidate workspaces are created ("" = /dev/shm or TMPDIR)
+    // Evaluation cache configuration
+    int enable_eval_cache;               // Reuse test results, metrics and binaries of identical code
+    char eval_cache_dir[512];            // Persist the cache across runs ("" = memory only)
+    // Archive configuration
+    char archive_file[512];              // Append every evaluated candidate here ("" = disabled)
+    int resume_from_archive;             // Continue an interrupted run from the archive
+    // Island configuration
+    char island_dir[512];                // Archive directory shared by all islands ("" = single island)
+    char island_name[128];               // This node's archive in island_dir (default: host-pid)
+    int island_migration_interval;       // Generations between migrations
+    int island_migrants;                 // Peer elites considered per migration
+    // Benchmark configuration
+    int benchmark_warmup_runs;           // Untimed runs before measuring
+    int benchmark_min_runs;              // Timed runs always performed
+    int benchmark_max_runs;              // Upper bound on timed runs
+    double benchmark_target_ci_percent;  // Stop once the 95% CI is within this percent of the mean
+    int benchmark_max_time_ms;           // Time budget for timed runs beyond the minimum
+    int benchmark_cpu;                   // Pin benchmark runs to this CPU (-1 = no pinning)
+    int enable_hardware_counters;        // Collect perf_event counters for benchmarked binaries
+    int enable_scaling_sweep;            // Also time the candidate over a geometric series of input sizes
+    long scaling_min_size;               // Smallest input size of the sweep
+    long scaling_max_size;               // Largest input size of the sweep
+    int scaling_factor;                  // Ratio of consecutive sizes
+    int scaling_max_point_ms;            // Stop the sweep after a size slower than this
+    char build_flags[MAX_BUILD_CONFIGS][256]; // Compiler flag sets benchmarked per candidate
+    int build_config_count;
+    char pgo_flags[256];                 // Flags of the two-stage PGO build ("" = no PGO build)
+    char alloc_shim_path[512];           // Allocation profiler to preload ("" = next to the executable)
+    // Kernel benchmark configuration
+    char kernel_entry[128];              // Time this symbol in-process instead of whole runs ("" = disabled)
+    kernel_signature_t kernel_signature; // How the entry is called
+    int kernel_input_size;               // Elements per input
+    int kernel_inputs;                   // Pre-generated inputs cycled through
+    int kernel_max_batches;              // Upper bound on timed batches
+    double kernel_target_ci_percent;     // Stop once the 95% CI is within this percent of the mean
+    char kernel_runner_path[512];        // Runner executable ("" = next to the executable)
+    // Candidate execution limits (0 = unlimited)
+    int candidate_timeout_ms;            // Wall time of one candidate run or test command
+    int candidate_cpu_time_s;            // CPU time (RLIMIT_CPU) of one candidate run
+    int candidate_memory_mb;             // Address space (RLIMIT_AS) of one candidate run
+    int candidate_max_processes;         // Processes of the user (RLIMIT_NPROC) while a candidate runs
+    int candidate_output_kb;             // Output of one candidate run
+    int compile_timeout_ms;              // Wall time of one compiler invocation
+    // Metric fitness configuration
+    char benchmark_command[1024];        // Command printing metrics for {file} ("" = parse test output)
+    fitness_metric_t metrics[MAX_FITNESS_METRICS]; // [[metric]] tables; fitness comes from these when set
+    int metric_count;
     // Evaluation configuration
     evaluation_criteria_t eval_criteria; // Evaluation criteria and thresholds
     int enable_comprehensive_evaluation; // Enable detailed evaluation
     int save_evaluation_history;         // Save evaluation results to history
     char evaluation_output_file[512];    // File to save evaluation reports
+    // Tracing configuration
+    int enable_tracing;                  // Time prompt, model, test and evaluation phases
+    char trace_file[512];                // Write every span here ("" = summary only)
+    char trace_format[16];               // "jsonl" or "chrome" (trace_event)
+    // Model response store configuration
+    char model_cache_mode[16];           // "off", "record", "replay" or "cache-first"
+    char model_cache_file[512];          // JSON lines store of recorded responses
+    // API quota configuration (0 = unlimited)
+    int fast_model_rpm;                  // Requests per minute to the fast endpoint
+    int fast_model_tpm;                  // Tokens per minute to the fast endpoint
+    int reasoning_model_rpm;             // Requests per minute to the reasoning endpoint
+    int reasoning_model_tpm;             // Tokens per minute to the reasoning endpoint
+    int rate_limit_retries;              // Retries of a call answered with HTTP 429
+    // Endpoint failover and hedging configuration
+    char fast_model_fallback_endpoints[MAX_FALLBACK_ENDPOINTS][512];
+    int fast_model_fallback_count;
+    char reasoning_model_fallback_endpoints[MAX_FALLBACK_ENDPOINTS][512];
+    int reasoning_model_fallback_count;
+    int model_call_retries;              // Further attempts after a failed model call
+    int retry_backoff_ms;                // First pause before a retry, doubling per attempt
+    int model_call_timeout_ms;           // Abandon a request running longer than this (0 = no limit)
+    int enable_hedging;                  // Race a slow call against a duplicate request
+    int hedge_percentile;                // Hedge once a call is slower than this latency percentile
+    int hedge_min_samples;               // Latencies an endpoint needs before its calls are hedged
+    // Batch configuration
+    int batch_jobs;                      // Jobs of a batch run at once
+    char batch_output_dir[512];          // Each batch job writes into a directory here
+    int eval_slots;                      // Commands and benchmarks running at once (0 = unbounded)
+    char output_dir[512];                // Where solution files are saved ("" = current directory)
+    // Log file configuration
+    char log_file[512];                  // Run log written by a background thread ("" = disabled)
+    int log_level;                       // Highest verbosity level recorded in the log file
+    int log_queue_kb;                    // Records queued in memory before new ones are dropped
+    int log_rotate_mb;                   // Rotate the log file at this size (0 = never)
+    int log_max_files;                   // Rotated files kept (<log_file>.1 ... .N)
+    int log_compress;                    // gzip rotated files
+    int log_prompt_hashes;               // Record prompts as content hashes instead of full text
     // Output control
     int verbosity;
     int use_colors;
@@ -171,8 +369,11 @@ typedef struct {
     char *current_solution;                 // Dynamic allocation for current solution
     int iterations;                         // Current iteration number
     test_result_t last_test_result;         // Last test result for the current solution
+    performance_metrics_t last_performance; // Benchmark of the current solution (sample_count 0 = none)
+    metric_set_t last_metrics;              // Reported metrics of the current solution (measured 0 = none)
     config_t *config;                       // Reference to config for limits
     code_evolution_t evolution;             // Code evolution context
+    arena_t *scratch;                       // Per-iteration scratch memory, reset by the main loop
 } conversation_t;
 
 // Include AI and config headers after types are defined
@@ -185,8 +386,11 @@ typedef struct {
 dstring_t* dstring_create(size_t initial_capacity);
 void dstring_destroy(dstring_t* ds);
 int dstring_append(dstring_t* ds, const char* str);
+int dstring_append_len(dstring_t* ds, const char* data, size_t length);
+int dstring_reserve(dstring_t* ds, size_t capacity);
 int dstring_append_format(dstring_t* ds, const char* format, ...);
 void dstring_clear(dstring_t* ds);
+char* dstring_steal(dstring_t* ds);
 char* dstring_get(const dstring_t* ds);
 
 // Core functions
@@ -205,9 +409,22 @@ int run_collaboration(const char *problem, config_t *config);
 void cleanup_conversation(conversation_t *conv);
 
 // Testing functions
-int execute_command(const char* command, char* output, size_t output_size);
-test_result_t test_generated_code(const char* code_content, const char* problem_description, config_t *config);
-char* generate_test_report(const test_result_t* test_result, const char* problem_description);
+int execute_command(const char* command, char* output, size_t output_size,
+                    const process_limits_t *limits, process_result_t *result);
+process_limits_t candidate_process_limits(const config_t *config);
+process_limits_t compile_process_limits(const config_t *config);
+int test_result_hit_limit(const test_result_t *test_result);
+void describe_limit_violation(const process_result_t *run, config_t *config, char *out, size_t out_size);
+// With scratch set, command outputs and reports are allocated from it (freed
+// at its next reset); without one they use a private arena or malloc
+test_result_t test_generated_code(const char* code_content, const char* problem_description, config_t *config,
+                                  arena_t *scratch);
+char* generate_test_report(const test_result_t* test_result, const char* problem_description, arena_t *scratch);
+char* extract_solution_code(const char *response, int max_code_size);
+char* extract_candidate_code(const char *response, const char *current_solution, config_t *config);
+test_result_t test_solution_code(const char *code, const char *problem_description, config_t *config,
+                                 arena_t *scratch);
+void apply_test_result(conversation_t *conv, test_result_t test_result);
 void update_solution_with_testing(conversation_t *conv, const char *reasoning_response);
 int has_code_errors(const test_result_t* test_result);
 test_result_t get_last_test_result(const conversation_t *conv);
@@ -234,6 +451,8 @@ void evolve_code_regions(conversation_t *conv, code_evolution_t *evolution);
 char* read_evolution_file(const char *file_path);
 int write_evolution_file(const char *file_path, const char *content);
 test_result_t run_custom_test(const char *test_command, const char *file_path, config_t *config);
+test_result_t run_custom_test_limited(const char *test_command, const char *file_path, config_t *config,
+                                      const process_limits_t *limits);
 
 // Enhanced evaluation functions
 evaluation_result_t evaluate_code_comprehensive(const char *file_path, const char *code_content, 
@@ -242,6 +461,7 @@ performance_metrics_t measure_performance(const char *file_path, config_t *confi
 code_quality_metrics_t analyze_code_quality(const char *code_content);
 double calculate_overall_score(const evaluation_result_t *result);
 char* generate_evaluation_report(const evaluation_result_t *result);
+char* generate_performance_profile(const performance_metrics_t *metrics);
 char* generate_improvement_recommendations(const evaluation_result_t *result);
 void init_evaluation_criteria(evaluation_criteria_t *criteria);
 void cleanup_evaluation_result(evaluation_result_t *result);
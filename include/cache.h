@@ -0,0 +1,40 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include "beta_evolve.h"
+#include <stdint.h>
+
+// Content-addressed evaluation cache.
+// Entries are keyed by a hash of the whitespace-normalized source plus the
+// compiler flags, config->args and (for custom tests) the test command, so a
+// candidate that only differs in formatting is never compiled or run twice.
+// Test results, performance metrics and built binaries are kept in memory and,
+// when eval_cache_dir is set, on disk so later runs can reuse them.
+
+// Cache lifecycle (init reads enable_eval_cache / eval_cache_dir from config)
+int eval_cache_init(config_t *config);
+void eval_cache_cleanup(void);
+
+// Key for code built/run with the given flags; extra may be NULL
+uint64_t eval_cache_key(const char *code, const char *flags, const char *args, const char *extra);
+
+// Hash of the token sequence of C source; code that differs only in comments
+// and layout hashes alike (near-duplicate detection)
+uint64_t source_token_hash(const char *code);
+
+// Test results: get returns 1 on a hit and fills result with freshly allocated strings
+int eval_cache_get_test(uint64_t key, test_result_t *result, config_t *config);
+void eval_cache_put_test(uint64_t key, const test_result_t *result);
+
+// Performance metrics: get returns 1 on a hit
+int eval_cache_get_performance(uint64_t key, performance_metrics_t *metrics);
+void eval_cache_put_performance(uint64_t key, const performance_metrics_t *metrics);
+
+// Path where the binary built for key is kept; returns 0 if binaries are cached,
+// sets *exists when it was already built
+int eval_cache_binary_path(uint64_t key, char *out, size_t out_size, int *exists);
+
+// Print hit/miss counters
+void log_eval_cache_stats(config_t *config);
+
+#endif // CACHE_H
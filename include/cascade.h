@@ -0,0 +1,32 @@
+#ifndef CASCADE_H
+#define CASCADE_H
+
+#include "beta_evolve.h"
+
+// Staged evaluation cascade (population mode, enable_eval_cascade).
+// Candidates pass through stages of increasing cost and stop at the first one
+// they fail: a near-duplicate check on the token hash of the code, a syntax
+// check (custom test mode only; the built-in tests begin with one), the
+// optional cascade_smoke_command, the full tests, and finally the benchmark,
+// which only candidates scoring within cascade_threshold of the best screened
+// score so far reach. Candidates that went further rank higher.
+
+// Last stage a candidate reached; later stages rank higher
+typedef enum {
+    CASCADE_OFF = 0,                             // Cascade disabled: every candidate takes the full path
+    CASCADE_DUPLICATE,                           // Dropped as a near-duplicate of evaluated code
+    CASCADE_SYNTAX,                              // Stopped by the syntax check
+    CASCADE_SMOKE,                               // Stopped by the smoke command
+    CASCADE_TESTS,                               // Ran the full tests but was not benchmarked
+    CASCADE_BENCHMARK,                           // Benchmarked
+    CASCADE_STAGE_COUNT
+} cascade_stage_t;
+
+// Run the cheap stages on code. Returns CASCADE_TESTS when it passed them,
+// otherwise the stage it failed with *result holding that stage's outcome.
+cascade_stage_t cascade_screen(const char *code, config_t *config, test_result_t *result);
+
+// Name of a stage for logs ("syntax", "smoke", ...)
+const char* cascade_stage_name(cascade_stage_t stage);
+
+#endif // CASCADE_H
@@ -0,0 +1,51 @@
+#ifndef HTTP_H
+#define HTTP_H
+
+#include "beta_evolve.h"
+
+// In-process HTTP client for model API calls.
+// Every distinct endpoint URL owns a small pool of libcurl easy handles that
+// are reused across requests, so TCP/TLS connections stay alive for the whole
+// run. Request and response bodies never touch the filesystem.
+
+// Transfer details reported back to the caller
+typedef struct {
+    long status_code;                            // HTTP status (0 if no response was received)
+    double total_time_ms;                        // Wall time of the transfer
+    int reused_connection;                       // 1 if an existing connection was reused
+    int aborted;                                 // 1 if the chunk callback stopped the transfer early
+    int cancelled;                               // 1 if the request control cancelled the transfer
+    char error[256];                             // Transport error description, empty on success
+} http_response_info_t;
+
+// Receives each chunk of a streamed response body as it arrives.
+// Return non-zero to stop the transfer (e.g. once the needed content is complete).
+typedef int (*http_chunk_callback_t)(const char *data, size_t length, void *userdata);
+
+// Optional control of one request, shared with the thread that may cancel it
+typedef struct {
+    int cancelled;                               // Set (atomically) to abort the transfer
+    long timeout_ms;                             // Abort a transfer running longer than this (0 = no limit)
+} http_request_control_t;
+
+// Cancel a request running on another thread; it fails with info->cancelled set
+void http_request_cancel(http_request_control_t *control);
+
+// Client lifecycle (init is idempotent, cleanup must run after all requests finish)
+int http_client_init(void);
+void http_client_cleanup(void);
+
+// POST a JSON body to endpoint and collect the response body into response.
+// api_key may be NULL, empty or "null" to skip the Authorization header.
+// control may be NULL. Returns 0 when a response was received (check info->status_code),
+// -1 on transport failure, timeout or cancellation.
+int http_post_json(const char *endpoint, const char *api_key, const char *body, size_t body_length,
+                   dstring_t *response, http_response_info_t *info, const http_request_control_t *control);
+
+// POST a JSON body and hand the response body to on_chunk incrementally.
+// A transfer stopped by on_chunk is not an error: it returns 0 with info->aborted set.
+int http_post_json_stream(const char *endpoint, const char *api_key, const char *body, size_t body_length,
+                          http_chunk_callback_t on_chunk, void *userdata, http_response_info_t *info,
+                          const http_request_control_t *control);
+
+#endif // HTTP_H
@@ -0,0 +1,19 @@
+#ifndef ISLAND_H
+#define ISLAND_H
+
+#include "population.h"
+
+// Island-model evolution across hosts.
+// Every node runs its own population on the same problem and keeps its
+// candidate archive in a directory shared by all nodes
+// (island_dir/<island_name>.archive). Every island_migration_interval
+// generations a node scans the peer archives for the survivors of their
+// newest generation and merges the best island_migrants of them into its own
+// parents, so the next generation is bred from the merged elite set. There is
+// no coordinator; a node that stops simply stops contributing.
+
+// Merge the elites of peer islands into the population's survivors, recording
+// adopted migrants in the local archive. Returns the number of migrants adopted.
+int island_migrate(population_t *population, const char *problem, int iteration);
+
+#endif // ISLAND_H
@@ -5,7 +5,8 @@
 #include <stdbool.h>
 
 // Utility functions for creating chat requests and extracting responses
-cJSON* json_create_chat_request(const char *model, const char *message, double temperature);
+cJSON* json_create_chat_request(const char *model, const char *message, double temperature, bool stream);
 const char* json_extract_chat_response(cJSON *response);
+const char* json_extract_chat_delta(cJSON *chunk);
 
 #endif // JSON_H
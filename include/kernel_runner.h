@@ -0,0 +1,58 @@
+#ifndef KERNEL_RUNNER_H
+#define KERNEL_RUNNER_H
+
+#include <stdint.h>
+
+// Protocol between beta_evolve and the kernel runner (beta_kernel_runner).
+// The runner is a persistent child process that receives its end of a Unix
+// socket pair as stdin. For every candidate, beta_evolve sends one
+// kernel_request_t; the runner dlopens the shared object, resolves the entry
+// symbol, generates the inputs, calibrates the calls per batch and warms up,
+// then answers with a kernel_reply_t. After that each KERNEL_COMMAND_BATCH is
+// answered with one kernel_sample_t until KERNEL_COMMAND_DONE unloads the
+// object. A crashing candidate takes the runner down with it; beta_evolve sees
+// the socket close and starts a new runner for the next candidate. Shared by
+// the runner and beta_evolve, so it must not depend on anything else in the tree.
+
+#define KERNEL_RUNNER_MAGIC 0x4b524e4cu          // "KRNL"
+#define KERNEL_BATCH_NS 2000000.0                // Calls per batch are calibrated to take at least this long
+#define KERNEL_INPUT_SEED 0x5eed5eedu            // Every candidate gets the same inputs
+
+// Entry signatures: every array kernel is called as entry(data, n) on a fresh
+// copy of one of the pre-generated inputs; return values are ignored
+typedef enum {
+    KERNEL_INT_ARRAY = 0,                        // void entry(int *data, int n)
+    KERNEL_LONG_ARRAY,                           // void entry(long *data, int n)
+    KERNEL_DOUBLE_ARRAY,                         // void entry(double *data, int n)
+    KERNEL_BYTE_ARRAY,                           // void entry(unsigned char *data, int n)
+    KERNEL_VOID                                  // void entry(void)
+} kernel_signature_t;
+
+typedef enum {
+    KERNEL_COMMAND_DONE = 0,
+    KERNEL_COMMAND_BATCH = 1
+} kernel_command_t;
+
+typedef struct {
+    uint32_t magic;
+    int32_t signature;                           // kernel_signature_t
+    int32_t input_size;                          // Elements per input
+    int32_t inputs;                              // Inputs generated and cycled through
+    int32_t warmup_batches;                      // Untimed batches before replying
+    char library[1024];                          // Absolute path of the shared object
+    char entry[128];                             // Symbol to call
+} kernel_request_t;
+
+typedef struct {
+    uint32_t magic;
+    int32_t status;                              // 0 when ready for batches, -1 with error set
+    int64_t calls_per_batch;
+    double overhead_ns;                          // Per-call cost of the loop and the input copy
+    char error[256];
+} kernel_reply_t;
+
+typedef struct {
+    double wall_ns;                              // Wall time per call of one batch, overhead included
+} kernel_sample_t;
+
+#endif // KERNEL_RUNNER_H
@@ -0,0 +1,30 @@
+#ifndef LOG_WRITER_H
+#define LOG_WRITER_H
+
+#include "beta_evolve.h"
+
+// Asynchronous run log (beta-evolve.log by default).
+// Records are formatted by the caller into a bounded in-memory queue and
+// written by a background thread, so model calls and tests never wait on the
+// disk. Records above log_level are rejected before they are formatted, and a
+// full queue drops records (the file notes how many) instead of blocking. The
+// file is rotated to <log_file>.1 ... .N once it reaches log_rotate_mb, older
+// files optionally gzip-compressed, and prompts can be recorded as content
+// hashes instead of their full text.
+
+// Writer lifecycle (init truncates the log file and starts the thread;
+// shutdown flushes everything still queued)
+int log_writer_init(config_t *config);
+void log_writer_shutdown(void);
+
+// Whether a record at level would be written
+int log_writer_enabled(int level);
+
+// Queue a formatted record; terminal color codes are stripped
+void log_writer_printf(int level, const char *format, ...);
+void log_writer_vprintf(int level, const char *format, va_list args);
+
+// Queue one prompt/response exchange of an agent
+void log_writer_exchange(agent_type_t agent, const char *prompt, const char *response);
+
+#endif // LOG_WRITER_H
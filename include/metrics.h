@@ -0,0 +1,41 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "beta_evolve.h"
+
+// Benchmark-metric protocol.
+// The test command (or a separate benchmark_command) reports what it measured
+// on stdout, either as lines of the form
+//     METRIC ops_per_sec=1250000 correct=1
+// or as a JSON object of numbers (optionally nested under "metrics").
+// The [[metric]] tables of the config say which of those count, in which
+// direction, and with what weight; min/max bounds act as correctness gates.
+// A candidate that runs and passes every gate scores 0.5 + 0.5 * the weighted
+// mean of its metric scores, anything else scores at most 0.5, so a faster
+// correct solution always beats a slower one and never loses to a broken one.
+
+// Parse METRIC lines and JSON objects out of command output; later values of
+// the same name win. Returns the number of metrics in set.
+int metrics_parse(const char *output, metric_set_t *set);
+
+// Value of a metric, NULL if it was not reported
+const metric_value_t* metrics_find(const metric_set_t *set, const char *name);
+
+// Add the built-in metrics of a benchmark to set: time_ms (median run time),
+// ns_per_call for kernel benchmarks and, when the allocation shim reported,
+// alloc_calls (malloc + calloc + realloc), free_calls, alloc_bytes and
+// peak_heap_bytes. Call metrics_score() afterwards.
+void metrics_add_performance(metric_set_t *set, const performance_metrics_t *performance);
+
+// Combine the reported metrics into set->fitness and set->gates_passed
+double metrics_score(const test_result_t *result, metric_set_t *set, const config_t *config);
+
+// Collect metrics for code that was tested with result: run benchmark_command
+// when it is set (only for code that ran), otherwise parse the test output.
+// Returns 1 if metrics are configured and set was filled, 0 otherwise.
+int metrics_measure(const char *code, const test_result_t *result, config_t *config, metric_set_t *set);
+
+// Describe measured metrics for an agent prompt (malloc'd, NULL if none)
+char* generate_metrics_report(const metric_set_t *set, const config_t *config);
+
+#endif // METRICS_H
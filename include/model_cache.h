@@ -0,0 +1,33 @@
+#ifndef MODEL_CACHE_H
+#define MODEL_CACHE_H
+
+#include "beta_evolve.h"
+
+// Record/replay store for model responses.
+// Responses are keyed by a hash of (endpoint, model, temperature, samples,
+// prompt). In "record" mode every live response is appended to
+// model_cache_file as one JSON line; "replay" serves prompts from that file
+// without any API call and fails on a prompt that was never recorded. A
+// prompt recorded several times is replayed in the recorded order, so a run
+// that makes the same calls gets the same answers. "cache-first" calls the
+// models live but answers a prompt already asked in this run from memory;
+// identical requests made concurrently wait for the first one's answer.
+
+// Start the store for config->model_cache_mode; returns -1 if replay cannot load the file
+int model_cache_init(config_t *config);
+void model_cache_cleanup(void);
+
+// Whether a missing response must fail instead of calling the model (replay mode)
+int model_cache_replay_only(void);
+
+// Fill responses[0..n-1] with malloc'd copies of a stored answer; returns how many (0 = miss).
+// After a miss the caller must report the live call through model_cache_store.
+int model_cache_lookup(const char *endpoint, const char *model, double temperature, int n,
+                       const char *prompt, char **responses);
+
+// Keep the responses of a live call (recorded to the file in record mode);
+// count 0 reports a failed call
+void model_cache_store(const char *endpoint, const char *model, double temperature, int n,
+                       const char *prompt, agent_type_t agent, char **responses, int count);
+
+#endif // MODEL_CACHE_H
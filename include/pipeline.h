@@ -0,0 +1,55 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "beta_evolve.h"
+#include "threadpool.h"
+#include <pthread.h>
+
+// Pipelined execution of the single-candidate loop.
+// Two kinds of work are overlapped with model calls:
+//  - while the reasoning agent is thinking, the fast agent's code is tested in
+//    the background so the evaluation cache already holds the result when the
+//    reasoning agent returns the same code;
+//  - while the reasoning agent's code is being tested, the next iteration's
+//    fast-agent call is issued speculatively, assuming the test passes.
+// A speculative response is only used when the prompt built from the real
+// state is byte-for-byte the prompt that was sent, so results match the
+// serial loop.
+
+// One speculative fast-agent call; freed by its worker when abandoned
+typedef struct speculative_call speculative_call_t;
+
+typedef struct {
+    config_t *config;
+    threadpool_t *model_pool;                    // Speculative model calls (an abandoned one may still run)
+    threadpool_t *test_pool;                     // Cache-prewarming test (one worker)
+    speculative_call_t *speculation;             // In-flight speculative fast turn, NULL if none
+    char *prewarm_code;                          // Code under test in the background
+    uint64_t prewarm_key;                        // Normalized-source key of prewarm_code
+    int prewarm_pending;
+    int prewarm_done;                            // Set by the worker (guarded by prewarm_mutex)
+    pthread_mutex_t prewarm_mutex;
+    int speculations;                            // Speculative fast turns issued
+    int speculation_hits;                        // ... whose response was used
+    int prewarm_hits;                            // Background tests of code the reasoning agent kept
+} pipeline_t;
+
+// Initialize pipeline workers
+int init_pipeline(pipeline_t *pipeline, config_t *config);
+
+// Wait for background work and free pipeline state
+void cleanup_pipeline(pipeline_t *pipeline);
+
+// Start testing the fast agent's code while the reasoning agent runs
+void pipeline_prewarm_test(pipeline_t *pipeline, const conversation_t *conv, const char *fast_response);
+
+// Issue the next fast turn for the state the reasoning response would produce if its test passes
+void pipeline_speculate_fast_turn(pipeline_t *pipeline, const conversation_t *conv, const char *reasoning_response);
+
+// Before testing the reasoning agent's code: wait for a background test of the same code
+void pipeline_before_test(pipeline_t *pipeline, const conversation_t *conv, const char *reasoning_response);
+
+// Take the speculative fast response if it was requested with exactly this prompt (NULL otherwise)
+char* pipeline_take_fast_response(pipeline_t *pipeline, const char *prompt);
+
+#endif // PIPELINE_H
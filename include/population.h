@@ -0,0 +1,81 @@
+#ifndef POPULATION_H
+#define POPULATION_H
+
+#include "beta_evolve.h"
+#include "archive.h"
+#include "cascade.h"
+#include "threadpool.h"
+#include <pthread.h>
+
+// Population-based evolution.
+// Each generation breeds population_size candidates from the surviving parents:
+// every candidate runs its own fast -> reasoning exchange concurrently, is then
+// tested on a bounded pool of evaluation workers, and the top
+// population_survivors candidates by fitness_score become the next parents.
+// Benchmarked candidates whose run times differ only within noise are ranked
+// on correctness and quality instead of timing. When [[metric]] tables are
+// configured, the metric fitness replaces the comprehensive score. With
+// enable_eval_cascade, candidates go through the stages of cascade.h and
+// near-duplicates of already evaluated code are not evaluated or ranked.
+
+// One candidate of a generation
+typedef struct {
+    int parent_index;                            // Survivor slot the candidate was bred from
+    char *fast_response;                         // Cleaned fast agent response
+    char *reasoning_response;                    // Cleaned reasoning agent response
+    char *code;                                  // Solution extracted from the reasoning response
+    test_result_t test_result;                   // Test outcome of code
+    double fitness_score;                        // 0.0 - 1.0, higher is better
+    double test_fitness;                         // Syntax/compile/run part of the fitness
+    int has_performance;                         // 1 if performance was benchmarked
+    performance_metrics_t performance;           // Benchmark statistics (if has_performance)
+    double non_performance_score;                // Correctness + quality part of the comprehensive score
+    int scaling_rejected;                        // Fitted scaling exponent above max_scaling_exponent
+    int has_metrics;                             // 1 if fitness comes from reported metrics
+    metric_set_t metrics;                        // Reported metrics (if has_metrics)
+    uint64_t parent_id;                          // Archive record of the parent (0 = not archived)
+    cascade_stage_t cascade_stage;               // Stage the candidate stopped at (CASCADE_OFF = no cascade)
+    double screen_score;                         // Fitness before benchmarking, compared by the cascade
+} population_candidate_t;
+
+// Parent carried over between generations
+typedef struct {
+    char *code;                                  // Parent solution
+    char *errors;                                // Error output of the parent's last test (may be NULL)
+    double fitness_score;
+    double screen_score;                         // Fitness before benchmarking (0 = unknown)
+    uint64_t archive_id;                         // Archive record of the survivor (0 = not archived)
+} population_survivor_t;
+
+// Population state for a whole run
+typedef struct {
+    config_t *config;
+    population_candidate_t *candidates;          // population_size slots, reset every generation
+    int candidate_count;
+    population_survivor_t *survivors;            // population_survivors slots
+    int survivor_count;
+    int generation;
+    threadpool_t *model_pool;                    // One worker per candidate, model calls are I/O bound
+    threadpool_t *evaluation_pool;               // evaluation_workers workers for compile/test
+    archive_t *archive;                          // Where every ranked candidate is recorded (may be NULL)
+    pthread_mutex_t cascade_mutex;               // Guards the cascade state while candidates are evaluated
+    uint64_t *seen_hashes;                       // Token hashes of every evaluated candidate and parent
+    int seen_count;
+    int seen_capacity;
+    double cascade_best;                         // Best screening score of the generation so far
+    int cascade_counts[CASCADE_STAGE_COUNT];     // Candidates of the generation per stopping stage
+} population_t;
+
+// Population lifecycle
+int init_population(population_t *population, const conversation_t *conv, config_t *config);
+void cleanup_population(population_t *population);
+
+// Breed, evaluate and select one generation; the best candidate becomes conv's solution.
+// Returns 0 on success, -1 if no candidate produced a usable solution.
+int run_population_generation(population_t *population, conversation_t *conv);
+
+// Replace the parents with the survivors of the last archived generation.
+// Returns the number of survivors restored (0 = nothing to resume).
+int restore_population(population_t *population, archive_t *archive);
+
+#endif // POPULATION_H
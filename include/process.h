@@ -0,0 +1,118 @@
+#ifndef PROCESS_H
+#define PROCESS_H
+
+#include <stddef.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <time.h>
+
+// Spawning of candidate code under hard limits.
+// Every command runs in its own process group with optional wall-time, CPU
+// time (RLIMIT_CPU), address space (RLIMIT_AS) and output size limits. When a
+// limit is exceeded the whole group is killed, so infinite loops, fork bombs
+// and runaway output cannot stall the pipeline.
+// stdout and stderr are read as separate streams and drained until EOF even
+// past what is kept: each stream keeps its first and last bytes (head buffer
+// plus tail ring), so a command that prints megabytes costs bounded memory
+// and never blocks on a full pipe.
+// A run can also be cancelled from another thread through limits->cancel_fd:
+// once that descriptor becomes readable (e.g. one byte written to a shared
+// pipe), the group is killed and the run ends as PROCESS_CANCELLED.
+// process_set_slots bounds how many commands (and benchmarks) run at once in
+// the whole process; further runs wait for a free slot.
+
+// How a spawned command ended
+typedef enum {
+    PROCESS_OK = 0,                              // Exited on its own (check exit_code)
+    PROCESS_CRASHED,                             // Killed by a signal (segfault, abort, ...)
+    PROCESS_TIMEOUT,                             // Wall or CPU time limit exceeded
+    PROCESS_OOM,                                 // Address space limit exceeded
+    PROCESS_OUTPUT_LIMIT,                        // Output limit exceeded
+    PROCESS_SPAWN_FAILED,                        // Could not start the command
+    PROCESS_CANCELLED                            // Killed because cancel_fd became readable
+} process_status_t;
+
+// Limits applied to one command (0 = unlimited)
+typedef struct {
+    int wall_time_ms;                            // Kill the group after this much wall time
+    int cpu_time_s;                              // RLIMIT_CPU of the command
+    long memory_mb;                              // RLIMIT_AS of the command
+    int max_processes;                           // RLIMIT_NPROC of the command (counts all of the user's processes)
+    size_t output_bytes;                         // Kill the group after this much output
+    int cancel_fd;                               // Kill the group once this is readable (0 = none)
+} process_limits_t;
+
+// Outcome of one command
+typedef struct {
+    process_status_t status;
+    int exit_code;                               // Exit status, or 128 + signal when killed
+    int signal;                                  // Terminating signal (0 if it exited)
+    double wall_time_ms;
+    size_t output_bytes;                         // Total output produced, including discarded bytes
+    size_t stdout_bytes;                         // ... of which on stdout
+    size_t stderr_bytes;                         // ... of which on stderr
+} process_result_t;
+
+// One captured stream: the first bytes, a ring of the last ones, and the total
+typedef struct {
+    char *head;
+    size_t head_size;
+    size_t head_length;
+    char *tail;
+    size_t tail_size;
+    size_t tail_length;
+    size_t tail_pos;                             // Next write position in the ring
+    size_t total_bytes;                          // Everything the command wrote
+} process_stream_t;
+
+// Both output streams of a command
+typedef struct {
+    process_stream_t out;
+    process_stream_t err;
+} process_capture_t;
+
+// Run command through /bin/sh under limits, capturing stdout followed by
+// stderr into output (head and tail of each when it does not fit in
+// output_size - 1 bytes; always NUL-terminated; may be NULL).
+// Returns the exit code (128 + signal when killed by a limit or crash), -1 if
+// the command could not be started. limits and result may be NULL.
+int process_run(const char *command, const process_limits_t *limits,
+                char *output, size_t output_size, process_result_t *result);
+
+// Run command through /bin/sh under limits, keeping up to keep_bytes of each
+// of stdout and stderr in capture (release with process_capture_free).
+// Returns like process_run().
+int process_capture(const char *command, const process_limits_t *limits, size_t keep_bytes,
+                    process_capture_t *capture, process_result_t *result);
+
+// Render a captured stream into dest as head, an omission marker and tail,
+// always NUL-terminated. Returns the number of bytes written.
+size_t process_stream_text(const process_stream_t *stream, char *dest, size_t dest_size);
+
+// Free the buffers of a capture
+void process_capture_free(process_capture_t *capture);
+
+// Child side of a custom spawn: start a new process group and apply the
+// resource limits. Call between fork() and exec().
+void process_apply_limits(const process_limits_t *limits);
+
+// Parent side of a custom spawn: wait for pid until the wall-time limit
+// (measured from start) and kill its process group when it is exceeded.
+// Fills status/usage like wait4 and returns PROCESS_OK, PROCESS_CRASHED,
+// PROCESS_TIMEOUT, PROCESS_OOM or PROCESS_CANCELLED.
+process_status_t process_wait(pid_t pid, const process_limits_t *limits, const struct timespec *start,
+                              int *status, struct rusage *usage);
+
+// Allow at most slots commands to run at once (0 = unbounded)
+void process_set_slots(int slots);
+
+// Take a run slot, waiting while all are busy; a thread that already holds one
+// takes it again without waiting. Returns -1 if limits->cancel_fd became
+// readable while waiting (limits may be NULL).
+int process_slot_acquire(const process_limits_t *limits);
+void process_slot_release(void);
+
+// Human readable name of a status ("timeout", "OOM", ...)
+const char* process_status_name(process_status_t status);
+
+#endif // PROCESS_H
@@ -0,0 +1,36 @@
+#ifndef RATE_LIMIT_H
+#define RATE_LIMIT_H
+
+#include "beta_evolve.h"
+
+// Per-endpoint API quota shared by every model call of the process.
+// Each endpoint URL has a token bucket for requests per minute and one for
+// tokens per minute (fast_model_rpm/tpm, reasoning_model_rpm/tpm, which also
+// cover the agent's fallback endpoints; an endpoint used by both agents gets
+// the tighter limits). A call reserves one request and
+// its estimated prompt tokens up front and waits until both buckets cover the
+// reservation, so concurrent callers are admitted in order at the quota rate.
+// Completion tokens are charged once the response reports them. An HTTP 429
+// pauses the endpoint for every caller before the request is retried.
+
+// Set up the limits of the configured endpoints (safe to call again)
+int rate_limit_init(const config_t *config);
+void rate_limit_cleanup(void);
+
+// Wait until endpoint may take one more request of about tokens tokens
+void rate_limit_acquire(const char *endpoint, long tokens);
+
+// Charge tokens that were only known after the response (completion tokens)
+void rate_limit_settle(const char *endpoint, long tokens);
+
+// After a response with status_code: on HTTP 429 pause the endpoint and return
+// 1 while attempt < max_retries (the caller retries), otherwise return 0
+int rate_limit_retry(const char *endpoint, long status_code, int attempt, int max_retries);
+
+// Rough token count of a request body (about four bytes per token)
+long rate_limit_estimate_tokens(size_t body_length);
+
+// Print how long calls waited for quota and how often the API throttled
+void log_rate_limit_stats(config_t *config);
+
+#endif // RATE_LIMIT_H
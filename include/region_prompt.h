@@ -0,0 +1,44 @@
+#ifndef REGION_PROMPT_H
+#define REGION_PROMPT_H
+
+#include "beta_evolve.h"
+
+// Region-scoped prompting.
+// Instead of the whole file, prompts carry only the evolvable region bodies
+// plus the declarations from the rest of the file that those bodies use
+// (includes, macros, types, globals and function signatures, followed
+// transitively). The model answers with the regions only, and the answer is
+// merged back into the full file.
+
+// What extract_region_context() kept and dropped
+typedef struct {
+    int declarations;                            // Declarations found outside the regions
+    int included;                                // ... sent to the model
+    int over_budget;                             // ... relevant but dropped to respect the token budget
+    int skeleton_tokens;                         // Estimated tokens of the code outside the regions
+} region_context_stats_t;
+
+// Rough token estimate for a piece of text (about four bytes per token)
+int estimate_tokens(const char *text);
+
+// The evolution regions of code as marker-wrapped text, in file order
+char* format_evolution_regions(const code_evolution_t *regions);
+
+// Declarations outside the regions of code that the region bodies depend on,
+// fitting in token_budget together with region_text. stats may be NULL.
+char* extract_region_context(const char *code, const char *region_text, int token_budget,
+                             region_context_stats_t *stats);
+
+// Apply a region-only response to the current file: matching regions are
+// replaced and missing #include lines are added. Returns NULL if the response
+// contains no region of the current file.
+char* merge_region_response(const char *current_solution, const char *response_code);
+
+// Apply a per-region patch response: every fenced block holding a marked
+// region replaces that region; regions left out stay as they are. The result
+// is rejected unless the code outside the patched regions is unchanged.
+// Returns the number of regions that changed (0 = identical file) and sets
+// *patched, -1 if the response names no region of the file, -2 if rejected.
+int apply_region_patches(const char *current_solution, const char *response, char **patched);
+
+#endif // REGION_PROMPT_H
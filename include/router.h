@@ -0,0 +1,36 @@
+#ifndef ROUTER_H
+#define ROUTER_H
+
+#include "beta_evolve.h"
+
+// Endpoint routing for model calls.
+// Each agent has its configured endpoint followed by its fallback endpoints.
+// Latency and errors are tracked per agent and endpoint, and route every call:
+// an endpoint that just failed cools down (longer after each failure in a row),
+// healthy endpoints with the best recent latency and error rate are tried
+// first, and endpoints without samples keep their configured order behind
+// them. The recent latencies give the percentile after which a call is hedged.
+
+#define MAX_AGENT_ENDPOINTS (1 + MAX_FALLBACK_ENDPOINTS)
+
+// Fill order with the agent's endpoints, best first; returns how many
+int router_order(agent_type_t agent, const config_t *config, const char **order);
+
+// Record the outcome of one request (not called for cancelled hedges)
+void router_record(agent_type_t agent, const char *endpoint, int succeeded, double latency_ms);
+
+// Latency after which a call to endpoint is hedged, or 0 when it should not be
+// (hedging disabled or fewer than hedge_min_samples latencies recorded)
+double router_hedge_delay_ms(agent_type_t agent, const char *endpoint, const config_t *config);
+
+// Count a hedge sent to endpoint, and whether it answered first
+void router_record_hedge(agent_type_t agent, const char *endpoint, int won);
+
+// Pause before retry attempt (0-based): exponential from retry_backoff_ms with jitter
+long router_backoff_ms(const config_t *config, int attempt);
+
+// Print per-endpoint latency, errors and hedges
+void log_router_stats(config_t *config);
+void router_cleanup(void);
+
+#endif // ROUTER_H
@@ -0,0 +1,31 @@
+#ifndef SCALING_H
+#define SCALING_H
+
+#include "beta_evolve.h"
+
+// Input-size scaling sweep.
+// A single run at the size hardcoded in main() says little about how a
+// candidate scales, so the benchmarked binary is also timed over the geometric
+// series scaling_min_size, * scaling_factor, ... up to scaling_max_size, with
+// the size passed as argv[1] and in BETA_EVOLVE_SIZE. The median times are
+// fitted to t = a + b * f(n) for the classes of complexity_class_t, and the
+// log-log slope over the largest sizes gives the empirical exponent that
+// max_scaling_exponent is checked against.
+
+// Time the binary over the configured sizes and fit the profile.
+// Returns 0 if at least three sizes were measured, -1 otherwise (profile left empty).
+int measure_scaling(const char *binary_path, config_t *config, scaling_profile_t *profile);
+
+// Fit complexity class, exponent, crossover and slope changes to measured points
+void fit_scaling(scaling_profile_t *profile);
+
+// "O(n log n)" style name of a complexity class
+const char* complexity_class_name(complexity_class_t complexity);
+
+// Whether a measured profile grows faster than criteria allow
+int scaling_exceeds_limit(const scaling_profile_t *profile, const evaluation_criteria_t *criteria);
+
+// Describe a measured profile, one "  - " line per fact (malloc'd, NULL if none)
+char* generate_scaling_report(const scaling_profile_t *profile);
+
+#endif // SCALING_H
@@ -0,0 +1,22 @@
+#ifndef TEST_SUITE_H
+#define TEST_SUITE_H
+
+#include "beta_evolve.h"
+
+// Sharded test-suite runner.
+// test_command may be a list of commands and test_manifest a file of them, one
+// per line. The cases run on a pool of test_jobs workers, each in its own
+// process group under the candidate limits; with test_fail_fast the first
+// failing case cancels every running case and none of the queued ones start,
+// so a broken candidate is rejected as soon as one case fails. The per-case
+// outcomes are folded into one test_result_t: the flags and message of the
+// first case that failed, and every case's output (so METRIC lines of all
+// passing cases are seen by metric fitness).
+
+// Run the configured test command on file_path, or every case of the suite
+test_result_t run_test_suite(const char *file_path, config_t *config);
+
+// Cache key component naming the configured test command(s)
+void format_test_suite_key(const config_t *config, char *out, size_t out_size);
+
+#endif // TEST_SUITE_H
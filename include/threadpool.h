@@ -0,0 +1,27 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+// Fixed-size worker pool for running independent jobs concurrently.
+// Tasks are run in submission order by whichever worker is free; the pool
+// owns no task data, callers keep it alive until threadpool_wait() returns.
+
+typedef void (*threadpool_task_fn)(void *arg);
+
+typedef struct threadpool threadpool_t;
+
+// Create a pool with worker_count threads (at least one)
+threadpool_t* threadpool_create(int worker_count);
+
+// Queue a task; returns 0 on success, -1 if it could not be queued
+int threadpool_submit(threadpool_t *pool, threadpool_task_fn fn, void *arg);
+
+// Block until every queued task has finished
+void threadpool_wait(threadpool_t *pool);
+
+// Wait for outstanding tasks, stop the workers and free the pool
+void threadpool_destroy(threadpool_t *pool);
+
+// Number of worker threads in the pool
+int threadpool_size(const threadpool_t *pool);
+
+#endif // THREADPOOL_H
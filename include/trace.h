@@ -0,0 +1,39 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "beta_evolve.h"
+
+// Per-phase latency tracing.
+// Spans around prompt building, model calls, response validation, syntax
+// checks, compiles, runs and evaluations record where beta_evolve's own wall
+// time goes. Each span is tagged with the collaboration iteration, the agent
+// (if any) and the thread that ran it. With trace_file set, spans are written
+// as JSON lines or as a Chrome trace_event file (chrome://tracing, Perfetto);
+// a per-phase summary table is printed at the end of the run. When tracing is
+// off, a span costs one branch.
+
+#define TRACE_NO_AGENT -1
+
+// An open span (name is NULL when tracing is off)
+typedef struct {
+    const char *name;                            // Phase name, must outlive the span (string literal)
+    int agent;                                   // agent_type_t or TRACE_NO_AGENT
+    int iteration;
+    struct timespec start;
+} trace_span_t;
+
+// Tracing lifecycle (init reads enable_tracing / trace_file / trace_format from config)
+int trace_init(config_t *config);
+void trace_cleanup(void);
+
+// Tag spans begun from now on with a collaboration iteration
+void trace_set_iteration(int iteration);
+
+// Open and close a span
+trace_span_t trace_begin(const char *name, int agent);
+void trace_end(trace_span_t *span);
+
+// Print count, total, mean and max time per phase and agent
+void log_trace_summary(config_t *config);
+
+#endif // TRACE_H
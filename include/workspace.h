@@ -0,0 +1,31 @@
+#ifndef WORKSPACE_H
+#define WORKSPACE_H
+
+#include <stddef.h>
+
+// Private scratch directories for compiling and running candidates.
+// Each workspace is a unique directory (on tmpfs when /dev/shm is available),
+// so any number of evaluations can run at once within one process and across
+// processes on the same host. Workspaces still alive at exit are removed.
+
+typedef struct {
+    char path[512];                              // Directory path, empty when not created
+} workspace_t;
+
+// Override the directory new workspaces are created in (NULL or "" = automatic)
+void workspace_set_root(const char *root);
+
+// Create a fresh workspace; tag is used in the directory name to ease debugging
+int workspace_create(workspace_t *workspace, const char *tag);
+
+// Build the path of a file inside the workspace
+int workspace_path(const workspace_t *workspace, const char *name, char *out, size_t out_size);
+
+// Write content to a file in the workspace and optionally return its path
+int workspace_write_file(const workspace_t *workspace, const char *name, const char *content,
+                         char *out_path, size_t out_size);
+
+// Remove the workspace directory and everything in it
+void workspace_destroy(workspace_t *workspace);
+
+#endif // WORKSPACE_H
@@ -1,139 +1,226 @@
 #include "ai.h"
 #include "json.h"
-#include <sys/wait.h>
+#include "http.h"
+#include "log_writer.h"
+#include "model_cache.h"
+#include "rate_limit.h"
+#include "router.h"
+#include "trace.h"
+#include <errno.h>
+#include <pthread.h>
 
-// Call AI model via API using curl
-char* call_ai_model(const char* prompt, agent_type_t agent, config_t *config) {
-    if (!prompt || !config) {
-        fprintf(stderr, "Error: Invalid parameters for AI model call\n");
-        return NULL;
+// Per-agent call statistics, shared by every caller
+static ai_agent_stats_t agent_stats[2];
+static pthread_mutex_t agent_stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Hedged requests still running, including losers being cancelled
+static pthread_mutex_t hedge_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t hedge_idle = PTHREAD_COND_INITIALIZER;
+static int hedge_requests_running = 0;
+
+// Milliseconds elapsed between two monotonic timestamps
+static double elapsed_ms(const struct timespec *start, const struct timespec *end) {
+    return (end->tv_sec - start->tv_sec) * 1000.0 + (end->tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+// Record timing of one completed call for an agent
+static void record_agent_stats(agent_type_t agent, int streamed, int early_cutoff,
+                               double ttft_ms, double generation_ms, long tokens) {
+    pthread_mutex_lock(&agent_stats_mutex);
+    ai_agent_stats_t *stats = &agent_stats[agent == AGENT_FAST ? 0 : 1];
+    stats->calls++;
+    if (streamed) stats->streamed_calls++;
+    if (early_cutoff) stats->early_cutoffs++;
+    stats->last_ttft_ms = ttft_ms;
+    stats->total_ttft_ms += ttft_ms;
+    stats->total_tokens += tokens;
+    stats->total_generation_ms += generation_ms;
+    stats->last_tokens_per_sec = (tokens > 0 && generation_ms > 0) ? tokens / (generation_ms / 1000.0) : 0.0;
+    pthread_mutex_unlock(&agent_stats_mutex);
+}
+
+// Get a snapshot of an agent's call statistics
+ai_agent_stats_t get_ai_agent_stats(agent_type_t agent) {
+    pthread_mutex_lock(&agent_stats_mutex);
+    ai_agent_stats_t stats = agent_stats[agent == AGENT_FAST ? 0 : 1];
+    pthread_mutex_unlock(&agent_stats_mutex);
+    return stats;
+}
+
+// Print per-agent latency and throughput
+void log_ai_agent_stats(config_t *config) {
+    for (int i = 0; i < 2; i++) {
+        agent_type_t agent = i == 0 ? AGENT_FAST : AGENT_REASONING;
+        ai_agent_stats_t stats = get_ai_agent_stats(agent);
+        if (stats.calls == 0) continue;
+        
+        double tokens_per_sec = stats.total_generation_ms > 0 ? 
+                                stats.total_tokens / (stats.total_generation_ms / 1000.0) : 0.0;
+        log_message(config, VERBOSITY_VERBOSE,
+                   "%s%s Agent:%s %d calls, avg time-to-first-token %.0fms, %.1f tokens/sec, %d early cutoffs\n",
+                   C_EMPHASIS, agent == AGENT_FAST ? "Fast" : "Reasoning", C_RESET,
+                   stats.calls, stats.total_ttft_ms / stats.calls, tokens_per_sec, stats.early_cutoffs);
     }
-    
-    // Get model configuration
-    const char *endpoint = agent == AGENT_FAST ? config->fast_model_endpoint : config->reasoning_model_endpoint;
-    const char *model_name = agent == AGENT_FAST ? config->fast_model_name : config->reasoning_model_name;
-    const char *api_key = agent == AGENT_FAST ? config->fast_model_api_key : config->reasoning_model_api_key;
-    
-    // Create JSON request
-    double temperature = agent == AGENT_FAST ? 0.8 : 0.3;
-    cJSON *request_json = json_create_chat_request(model_name, prompt, temperature);
-    if (!request_json) {
-        fprintf(stderr, "Error: Failed to create JSON request\n");
-        return NULL;
+}
+
+// Incremental state for a streamed chat completion
+typedef struct {
+    dstring_t *pending;                          // Bytes of an SSE line not yet terminated
+    dstring_t *raw;                              // Body copy kept until the first SSE event (non-streaming fallback)
+    dstring_t *content;                          // Completion text assembled from deltas
+    int saw_event;                               // At least one "data:" line was received
+    int done;                                    // "[DONE]" sentinel received
+    int early_cutoff;                            // Stop once the code block is complete
+    int code_blocks_needed;                      // Closed code blocks required before cutting off
+    int code_blocks_closed;                      // Closed code blocks seen so far
+    int in_code_block;                           // Inside an open ``` fence
+    int fence_line_pending;                      // Opening fence seen, waiting for end of its line
+    size_t scan_offset;                          // Where the next fence search starts in content
+    size_t cutoff_length;                        // Content length at the last closing fence
+    long delta_count;                            // Deltas received (approximate token count)
+    long usage_tokens;                           // completion_tokens reported by the server, if any
+    int have_first_token;
+    struct timespec first_token_time;
+    struct timespec last_token_time;
+    char error[256];                             // API error reported in the stream
+} ai_stream_state_t;
+
+// Advance code fence detection over newly appended content
+static void stream_scan_fences(ai_stream_state_t *state) {
+    const char *data = dstring_get(state->content);
+    size_t length = state->content->length;
+    
+    while (state->scan_offset < length) {
+        if (state->fence_line_pending) {
+            // The code starts after the newline that ends the opening fence line
+            const char *newline = memchr(data + state->scan_offset, '\n', length - state->scan_offset);
+            if (!newline) {
+                state->scan_offset = length;
+                return;
+            }
+            state->fence_line_pending = 0;
+            state->scan_offset = (newline - data) + 1;
+            continue;
+        }
+        
+        const char *fence = strstr(data + state->scan_offset, "```");
+        if (!fence) {
+            // Keep the last two bytes so a fence split across deltas is still found
+            state->scan_offset = length > state->scan_offset + 2 ? length - 2 : state->scan_offset;
+            return;
+        }
+        
+        state->scan_offset = (fence - data) + 3;
+        if (state->in_code_block) {
+            state->in_code_block = 0;
+            state->code_blocks_closed++;
+            state->cutoff_length = state->scan_offset;
+        } else {
+            state->in_code_block = 1;
+            state->fence_line_pending = 1;
+        }
     }
-    
-    char *json_string = cJSON_Print(request_json);
-    cJSON_Delete(request_json);
-    
-    if (!json_string) {
-        fprintf(stderr, "Error: Failed to stringify JSON request\n");
-        return NULL;
+}
+
+// Handle one complete SSE line; returns non-zero to stop the stream
+static int stream_handle_line(ai_stream_state_t *state, const char *line, size_t length) {
+    if (length >= 1 && line[length - 1] == '\r') length--;
+    if (length < 5 || strncmp(line, "data:", 5) != 0) {
+        return 0; // Comments, event names and keep-alive blank lines
     }
     
-    // Create temporary files for curl
-    char temp_request_file[] = "/tmp/beta_evolve_request_XXXXXX";
-    char temp_response_file[] = "/tmp/beta_evolve_response_XXXXXX";
-    
-    int request_fd = mkstemp(temp_request_file);
-    int response_fd = mkstemp(temp_response_file);
-    
-    if (request_fd == -1 || response_fd == -1) {
-        fprintf(stderr, "Error: Failed to create temporary files\n");
-        free(json_string);
-        return NULL;
+    const char *payload = line + 5;
+    size_t payload_length = length - 5;
+    while (payload_length > 0 && *payload == ' ') {
+        payload++;
+        payload_length--;
     }
     
-    // Write JSON to temp file
-    write(request_fd, json_string, strlen(json_string));
-    close(request_fd);
-    free(json_string);
+    state->saw_event = 1;
     
-    // Build curl command
-    char curl_command[2048];
-    
-    if (api_key && strlen(api_key) > 0 && strcmp(api_key, "null") != 0) {
-        snprintf(curl_command, sizeof(curl_command),
-            "curl -s -X POST '%s' "
-            "-H 'Content-Type: application/json' "
-            "-H 'Authorization: Bearer %s' "
-            "-d @%s "
-            "-o %s",
-            endpoint, api_key, temp_request_file, temp_response_file);
-    } else {
-        printf("Info: Skipping Authorization header (no API key provided)\n");
-        snprintf(curl_command, sizeof(curl_command),
-            "curl -s -X POST '%s' "
-            "-H 'Content-Type: application/json' "
-            "-d @%s "
-            "-o %s",
-            endpoint, temp_request_file, temp_response_file);
+    if (payload_length == 6 && strncmp(payload, "[DONE]", 6) == 0) {
+        state->done = 1;
+        return 1;
     }
     
-    // Make HTTP request
-    printf("%s Agent: Making API call...\n", agent == AGENT_FAST ? "Fast" : "Reasoning");
-    int curl_result = system(curl_command);
+    cJSON *chunk = cJSON_ParseWithLength(payload, payload_length);
+    if (!chunk) return 0; // Ignore malformed events
     
-    // Clean up request file
-    unlink(temp_request_file);
+    cJSON *error_obj = cJSON_GetObjectItem(chunk, "error");
+    if (error_obj) {
+        const char *error_text = cJSON_GetStringValue(cJSON_GetObjectItem(error_obj, "message"));
+        snprintf(state->error, sizeof(state->error), "%s", error_text ? error_text : "Unknown error");
+        cJSON_Delete(chunk);
+        return 1;
+    }
     
-    if (curl_result != 0) {
-        fprintf(stderr, "Error: curl command failed\n");
-        close(response_fd);
-        unlink(temp_response_file);
-        return NULL;
+    cJSON *usage = cJSON_GetObjectItem(chunk, "usage");
+    cJSON *completion_tokens = usage ? cJSON_GetObjectItem(usage, "completion_tokens") : NULL;
+    if (completion_tokens && cJSON_IsNumber(completion_tokens)) {
+        state->usage_tokens = (long)cJSON_GetNumberValue(completion_tokens);
     }
     
-    // Read response from temp file
-    close(response_fd);
-    FILE *response_file = fopen(temp_response_file, "r");
-    if (!response_file) {
-        fprintf(stderr, "Error: Failed to open response file\n");
-        unlink(temp_response_file);
-        return NULL;
+    const char *delta = json_extract_chat_delta(chunk);
+    if (delta && *delta) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (!state->have_first_token) {
+            state->first_token_time = now;
+            state->have_first_token = 1;
+        }
+        state->last_token_time = now;
+        state->delta_count++;
+        
+        dstring_append(state->content, delta);
+        stream_scan_fences(state);
     }
     
-    // Get file size
-    fseek(response_file, 0, SEEK_END);
-    long file_size = ftell(response_file);
-    fseek(response_file, 0, SEEK_SET);
+    cJSON_Delete(chunk);
     
-    if (file_size <= 0) {
-        fprintf(stderr, "Error: Empty response received\n");
-        fclose(response_file);
-        unlink(temp_response_file);
-        return NULL;
-    }
+    return state->early_cutoff && state->code_blocks_closed >= state->code_blocks_needed;
+}
+
+// HTTP chunk callback splitting the body into SSE lines
+static int stream_on_chunk(const char *data, size_t length, void *userdata) {
+    ai_stream_state_t *state = (ai_stream_state_t *)userdata;
     
-    // Read response data
-    char *response_data = malloc(file_size + 1);
-    if (!response_data) {
-        fprintf(stderr, "Error: Failed to allocate memory for response\n");
-        fclose(response_file);
-        unlink(temp_response_file);
-        return NULL;
+    if (!state->saw_event) {
+        dstring_append_len(state->raw, data, length);
     }
     
-    fread(response_data, 1, file_size, response_file);
-    response_data[file_size] = '\0';
+    dstring_append_len(state->pending, data, length);
     
-    fclose(response_file);
-    unlink(temp_response_file);
+    int stop = 0;
+    size_t consumed = 0;
+    char *buffer = state->pending->data;
+    while (!stop) {
+        char *newline = memchr(buffer + consumed, '\n', state->pending->length - consumed);
+        if (!newline) break;
+        stop = stream_handle_line(state, buffer + consumed, newline - (buffer + consumed));
+        consumed = (newline - buffer) + 1;
+    }
     
-    // Parse JSON response
-    cJSON *response_json = cJSON_Parse(response_data);
+    // Drop the processed lines, keep any partial line for the next chunk
+    memmove(buffer, buffer + consumed, state->pending->length - consumed);
+    state->pending->length -= consumed;
+    buffer[state->pending->length] = '\0';
+    
+    return stop;
+}
+
+// Extract content (and usage) from a complete, non-streamed completion body
+static char* parse_completion_body(const char *body, long status_code, long *completion_tokens) {
+    cJSON *response_json = cJSON_Parse(body);
     if (!response_json) {
         const char *error_ptr = cJSON_GetErrorPtr();
-        fprintf(stderr, "Error: Failed to parse response JSON\n");
+        fprintf(stderr, "Error: Failed to parse response JSON (HTTP %ld)\n", status_code);
         if (error_ptr != NULL) {
             fprintf(stderr, "JSON parse error before: %s\n", error_ptr);
         }
-        fprintf(stderr, "Raw response: %s\n", response_data);
-        free(response_data);
+        fprintf(stderr, "Raw response: %s\n", body);
         return NULL;
     }
     
-    free(response_data);
-    
     // Check for API errors
     cJSON *error_obj = cJSON_GetObjectItem(response_json, "error");
     if (error_obj) {
@@ -152,24 +239,584 @@ char* call_ai_model(const char* prompt, agent_type_t agent, config_t *config) {
         return NULL;
     }
     
-    char *result = strdup(content);
+    cJSON *usage = cJSON_GetObjectItem(response_json, "usage");
+    cJSON *tokens = usage ? cJSON_GetObjectItem(usage, "completion_tokens") : NULL;
+    if (completion_tokens && tokens && cJSON_IsNumber(tokens)) {
+        *completion_tokens = (long)cJSON_GetNumberValue(tokens);
+    }
     
-    // Cleanup
+    char *result = strdup(content);
     cJSON_Delete(response_json);
+    return result;
+}
+
+// Blocking request: wait for the whole completion (reports the HTTP status and completion tokens)
+static char* call_ai_model_blocking(const char *endpoint, const char *api_key, const char *json_string,
+                                    agent_type_t agent, config_t *config, const http_request_control_t *control,
+                                    long *status_code, long *tokens_used) {
+    dstring_t *response_body = dstring_create(config->max_response_size);
+    if (!response_body) {
+        fprintf(stderr, "Error: Failed to allocate memory for response\n");
+        return NULL;
+    }
+    
+    http_response_info_t http_info;
+    int http_result = http_post_json(endpoint, api_key, json_string, strlen(json_string),
+                                     response_body, &http_info, control);
+    
+    if (http_result != 0) {
+        if (!http_info.cancelled) {
+            fprintf(stderr, "Error: HTTP request to %s failed: %s\n", endpoint, http_info.error);
+        }
+        dstring_destroy(response_body);
+        return NULL;
+    }
+    *status_code = http_info.status_code;
+    
+    log_message(config, VERBOSITY_DEBUG, "HTTP %ld in %.1fms (%s connection)\n",
+               http_info.status_code, http_info.total_time_ms,
+               http_info.reused_connection ? "reused" : "new");
+    
+    if (response_body->length == 0) {
+        fprintf(stderr, "Error: Empty response received (HTTP %ld)\n", http_info.status_code);
+        dstring_destroy(response_body);
+        return NULL;
+    }
+    
+    long completion_tokens = 0;
+    char *result = parse_completion_body(dstring_get(response_body), http_info.status_code, &completion_tokens);
+    dstring_destroy(response_body);
+    *tokens_used = completion_tokens;
+    
+    if (result) {
+        // Without streaming the first token arrives with the last one
+        record_agent_stats(agent, 0, 0, http_info.total_time_ms, http_info.total_time_ms, completion_tokens);
+    }
+    
+    return result;
+}
+
+// Streaming request: assemble SSE deltas and optionally stop after the code block
+static char* call_ai_model_streaming(const char *endpoint, const char *api_key, const char *json_string,
+                                     agent_type_t agent, config_t *config, const http_request_control_t *control,
+                                     long *status_code, long *tokens_used) {
+    ai_stream_state_t state;
+    memset(&state, 0, sizeof(state));
+    state.pending = dstring_create(4096);
+    state.raw = dstring_create(4096);
+    state.content = dstring_create(config->max_response_size);
+    // A per-region patch has one code block per changed region, so it must stream to the end
+    state.early_cutoff = config->stream_early_cutoff && !config->region_patch_responses;
+    state.code_blocks_needed = 1;
+    
+    if (!state.pending || !state.raw || !state.content) {
+        fprintf(stderr, "Error: Failed to allocate memory for streamed response\n");
+        dstring_destroy(state.pending);
+        dstring_destroy(state.raw);
+        dstring_destroy(state.content);
+        return NULL;
+    }
+    
+    struct timespec start_time;
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+    
+    http_response_info_t http_info;
+    int http_result = http_post_json_stream(endpoint, api_key, json_string, strlen(json_string),
+                                            stream_on_chunk, &state, &http_info, control);
     
-    // Write to log file
-    FILE *log_file = fopen("beta-evolve.log", "a");
-    if (log_file) {
-        fprintf(log_file, "Agent: %s\nPrompt: %s\nResponse: %s\n\n", 
-                agent == AGENT_FAST ? "Fast" : "Reasoning", prompt, result ? result : "No response");
-        fclose(log_file);
+    // Flush a final event that was not newline terminated
+    if (http_result == 0 && !http_info.aborted && state.pending->length > 0) {
+        stream_handle_line(&state, dstring_get(state.pending), state.pending->length);
+    }
+    
+    char *result = NULL;
+    int early_cutoff = http_info.aborted && !state.done && state.error[0] == '\0';
+    if (http_result == 0) *status_code = http_info.status_code;
+    
+    if (http_result != 0) {
+        if (!http_info.cancelled) {
+            fprintf(stderr, "Error: HTTP request to %s failed: %s\n", endpoint, http_info.error);
+        }
+    } else if (state.error[0] != '\0') {
+        fprintf(stderr, "API Error: %s\n", state.error);
+    } else if (!state.saw_event) {
+        // Server ignored "stream": parse the body as a regular completion
+        long completion_tokens = 0;
+        result = parse_completion_body(dstring_get(state.raw), http_info.status_code, &completion_tokens);
+        *tokens_used = completion_tokens;
+        if (result) {
+            record_agent_stats(agent, 0, 0, http_info.total_time_ms, http_info.total_time_ms, completion_tokens);
+        }
     } else {
-        fprintf(stderr, "Error: Failed to open log file for writing\n");
+        if (early_cutoff && state.cutoff_length > 0) {
+            // Drop any prose that arrived after the closing fence
+            state.content->length = state.cutoff_length;
+            state.content->data[state.cutoff_length] = '\0';
+        }
+        result = dstring_steal(state.content);
+        state.content = NULL;
+        
+        double ttft_ms = state.have_first_token ? elapsed_ms(&start_time, &state.first_token_time) : http_info.total_time_ms;
+        double generation_ms = state.have_first_token ? elapsed_ms(&state.first_token_time, &state.last_token_time) : 0.0;
+        long tokens = state.usage_tokens > 0 ? state.usage_tokens : state.delta_count;
+        *tokens_used = tokens;
+        record_agent_stats(agent, 1, early_cutoff, ttft_ms, generation_ms, tokens);
+        
+        log_message(config, VERBOSITY_DEBUG, "Stream: first token after %.1fms, %ld tokens%s\n",
+                   ttft_ms, tokens, early_cutoff ? ", cut off after code block" : "");
+    }
+    
+    dstring_destroy(state.pending);
+    dstring_destroy(state.raw);
+    dstring_destroy(state.content);
+    
+    return result;
+}
+
+// Whether a request was cancelled from another thread
+static int request_cancelled(const http_request_control_t *control) {
+    return control && __atomic_load_n(&control->cancelled, __ATOMIC_ACQUIRE);
+}
+
+// Send one completion request to endpoint, retrying HTTP 429 within its quota, and record the outcome
+static char* request_completion(const char *endpoint, const char *api_key, const char *json_string,
+                                agent_type_t agent, config_t *config, const http_request_control_t *control) {
+    long prompt_tokens = rate_limit_estimate_tokens(strlen(json_string));
+    struct timespec start_time, end_time;
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+    end_time = start_time;
+    char *result = NULL;
+    for (int attempt = 0; !request_cancelled(control); attempt++) {
+        long status_code = 0, completion_tokens = 0;
+        rate_limit_acquire(endpoint, prompt_tokens);
+        clock_gettime(CLOCK_MONOTONIC, &start_time); // Latency excludes waiting for quota
+        trace_span_t span = trace_begin("api_call", agent);
+        result = config->enable_streaming
+            ? call_ai_model_streaming(endpoint, api_key, json_string, agent, config, control, &status_code, &completion_tokens)
+            : call_ai_model_blocking(endpoint, api_key, json_string, agent, config, control, &status_code, &completion_tokens);
+        trace_end(&span);
+        clock_gettime(CLOCK_MONOTONIC, &end_time);
+        rate_limit_settle(endpoint, completion_tokens);
+        if (result || !rate_limit_retry(endpoint, status_code, attempt, config->rate_limit_retries)) break;
+    }
+    
+    // A cancelled hedge says nothing about the endpoint
+    if (result || !request_cancelled(control)) {
+        router_record(agent, endpoint, result != NULL, elapsed_ms(&start_time, &end_time));
+    }
+    return result;
+}
+
+// A call raced against a duplicate request to a second endpoint
+typedef struct hedged_call hedged_call_t;
+
+typedef struct {
+    hedged_call_t *call;
+    int index;                                   // 0 = original request, 1 = hedge
+} hedged_request_t;
+
+struct hedged_call {
+    pthread_mutex_t mutex;
+    pthread_cond_t finished_cond;
+    int references;                              // The caller plus every running request
+    config_t config;                             // Copy: a cancelled request may outlive the caller's
+    agent_type_t agent;
+    char *json_string;
+    char api_key[256];
+    char endpoints[2][512];
+    http_request_control_t controls[2];
+    hedged_request_t requests[2];
+    int launched;
+    int finished;
+    int winner;                                  // Request that answered first (-1 = none yet)
+    char *result;
+};
+
+// Free a hedged call once nothing refers to it
+static void free_hedged_call(hedged_call_t *call) {
+    pthread_mutex_destroy(&call->mutex);
+    pthread_cond_destroy(&call->finished_cond);
+    free(call->json_string);
+    free(call->result);
+    free(call);
+}
+
+// Drop one reference to a hedged call (caller holds call->mutex, which this releases)
+static void release_hedged_call(hedged_call_t *call) {
+    int last = --call->references == 0;
+    pthread_mutex_unlock(&call->mutex);
+    if (last) free_hedged_call(call);
+}
+
+// Thread running one request of a hedged call
+static void* run_hedged_request(void *arg) {
+    hedged_request_t *request = (hedged_request_t *)arg;
+    hedged_call_t *call = request->call;
+    int index = request->index;
+    
+    char *result = request_completion(call->endpoints[index], call->api_key, call->json_string,
+                                      call->agent, &call->config, &call->controls[index]);
+    
+    pthread_mutex_lock(&call->mutex);
+    call->finished++;
+    if (result && call->winner < 0) {
+        call->winner = index;
+        call->result = result;
+        result = NULL;
+    }
+    pthread_cond_broadcast(&call->finished_cond);
+    release_hedged_call(call);
+    free(result); // Answered second: the caller already has a response
+    
+    pthread_mutex_lock(&hedge_mutex);
+    hedge_requests_running--;
+    pthread_cond_broadcast(&hedge_idle);
+    pthread_mutex_unlock(&hedge_mutex);
+    return NULL;
+}
+
+// Start request index of a hedged call (caller holds call->mutex); returns 0 on success
+static int launch_hedged_request(hedged_call_t *call, int index) {
+    call->requests[index].call = call;
+    call->requests[index].index = index;
+    call->references++;
+    pthread_mutex_lock(&hedge_mutex);
+    hedge_requests_running++;
+    pthread_mutex_unlock(&hedge_mutex);
+    
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, run_hedged_request, &call->requests[index]) != 0) {
+        call->references--;
+        pthread_mutex_lock(&hedge_mutex);
+        hedge_requests_running--;
+        pthread_mutex_unlock(&hedge_mutex);
+        return -1;
+    }
+    pthread_detach(thread);
+    call->launched++;
+    return 0;
+}
+
+// Request a completion from endpoint; if it has not answered after delay_ms, send the same
+// request to hedge_endpoint and return whichever answers first (the other is cancelled)
+static char* request_completion_hedged(const char *endpoint, const char *hedge_endpoint, double delay_ms,
+                                       const char *api_key, const char *json_string, agent_type_t agent,
+                                       config_t *config) {
+    http_request_control_t direct_control = { 0, config->model_call_timeout_ms };
+    hedged_call_t *call = calloc(1, sizeof(hedged_call_t));
+    if (call) call->json_string = strdup(json_string);
+    if (!call || !call->json_string) {
+        free(call);
+        return request_completion(endpoint, api_key, json_string, agent, config, &direct_control);
+    }
+    
+    pthread_mutex_init(&call->mutex, NULL);
+    pthread_cond_init(&call->finished_cond, NULL);
+    call->references = 1;
+    call->config = *config;
+    call->agent = agent;
+    call->winner = -1;
+    snprintf(call->api_key, sizeof(call->api_key), "%s", api_key ? api_key : "");
+    snprintf(call->endpoints[0], sizeof(call->endpoints[0]), "%s", endpoint);
+    snprintf(call->endpoints[1], sizeof(call->endpoints[1]), "%s", hedge_endpoint);
+    call->controls[0].timeout_ms = config->model_call_timeout_ms;
+    call->controls[1].timeout_ms = config->model_call_timeout_ms;
+    
+    pthread_mutex_lock(&call->mutex);
+    if (launch_hedged_request(call, 0) != 0) {
+        release_hedged_call(call);
+        return request_completion(endpoint, api_key, json_string, agent, config, &direct_control);
+    }
+    
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    long delay_ns = (long)(delay_ms * 1000000.0);
+    deadline.tv_sec += delay_ns / 1000000000L;
+    deadline.tv_nsec += delay_ns % 1000000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    while (call->finished == 0) {
+        if (pthread_cond_timedwait(&call->finished_cond, &call->mutex, &deadline) == ETIMEDOUT) break;
+    }
+    
+    int hedged = 0;
+    if (call->finished == 0) {
+        log_message(config, VERBOSITY_NORMAL, "%s%s Agent: no answer after %.0fms (p%d), hedging on %s%s\n",
+                   C_WARNING, agent == AGENT_FAST ? "Fast" : "Reasoning", delay_ms, config->hedge_percentile,
+                   hedge_endpoint, C_RESET);
+        hedged = launch_hedged_request(call, 1) == 0;
+    }
+    while (call->winner < 0 && call->finished < call->launched) {
+        pthread_cond_wait(&call->finished_cond, &call->mutex);
+    }
+    
+    char *result = call->result;
+    call->result = NULL;
+    int winner = call->winner;
+    for (int i = 0; i < call->launched; i++) {
+        if (i != winner) http_request_cancel(&call->controls[i]);
+    }
+    release_hedged_call(call);
+    
+    if (hedged) {
+        router_record_hedge(agent, hedge_endpoint, winner == 1);
+        if (winner == 1) {
+            log_message(config, VERBOSITY_VERBOSE, "%s Agent: hedge on %s answered first\n",
+                       agent == AGENT_FAST ? "Fast" : "Reasoning", hedge_endpoint);
+        }
+    }
+    return result;
+}
+
+// Wait for hedged requests that lost their race to stop
+void ai_wait_hedged_requests(void) {
+    pthread_mutex_lock(&hedge_mutex);
+    while (hedge_requests_running > 0) {
+        pthread_cond_wait(&hedge_idle, &hedge_mutex);
+    }
+    pthread_mutex_unlock(&hedge_mutex);
+}
+
+// Sleep before retry attempt and say where it goes
+static void wait_before_retry(agent_type_t agent, config_t *config, int attempt) {
+    const char *order[MAX_AGENT_ENDPOINTS];
+    router_order(agent, config, order);
+    long delay_ms = router_backoff_ms(config, attempt);
+    fprintf(stderr, "Warning: %s agent call failed, retrying on %s in %ldms (%d/%d)\n",
+            agent == AGENT_FAST ? "Fast" : "Reasoning", order[0], delay_ms, attempt + 1, config->model_call_retries);
+    if (delay_ms > 0) usleep((useconds_t)delay_ms * 1000);
+}
+
+// Send one chat request for a prompt the model cache could not answer
+static char* call_ai_model_live(const char *prompt, agent_type_t agent, config_t *config,
+                                const char *api_key, const char *model_name, double temperature) {
+    // Create JSON request
+    cJSON *request_json = json_create_chat_request(model_name, prompt, temperature, config->enable_streaming);
+    if (!request_json) {
+        fprintf(stderr, "Error: Failed to create JSON request\n");
+        return NULL;
     }
     
+    char *json_string = cJSON_PrintUnformatted(request_json);
+    cJSON_Delete(request_json);
+    
+    if (!json_string) {
+        fprintf(stderr, "Error: Failed to stringify JSON request\n");
+        return NULL;
+    }
+    
+    if (!api_key || strlen(api_key) == 0 || strcmp(api_key, "null") == 0) {
+        printf("Info: Skipping Authorization header (no API key provided)\n");
+    }
+    
+    // Make HTTP requests over the persistent connections, best endpoint first, within each endpoint's quota
+    printf("%s Agent: Making API call...\n", agent == AGENT_FAST ? "Fast" : "Reasoning");
+    char *result = NULL;
+    for (int attempt = 0; attempt <= config->model_call_retries; attempt++) {
+        if (attempt > 0) wait_before_retry(agent, config, attempt - 1);
+    
+        const char *order[MAX_AGENT_ENDPOINTS];
+        int endpoint_count = router_order(agent, config, order);
+        double hedge_delay_ms = router_hedge_delay_ms(agent, order[0], config);
+        if (hedge_delay_ms > 0) {
+            // With a single endpoint the hedge is a second connection to it
+            result = request_completion_hedged(order[0], endpoint_count > 1 ? order[1] : order[0], hedge_delay_ms,
+                                               api_key, json_string, agent, config);
+        } else {
+            http_request_control_t control = { 0, config->model_call_timeout_ms };
+            result = request_completion(order[0], api_key, json_string, agent, config,
+                                        config->model_call_timeout_ms > 0 ? &control : NULL);
+        }
+        if (result) break;
+    }
+    free(json_string);
+    
+    if (!result) {
+        return NULL;
+    }
+    
+    log_writer_exchange(agent, prompt, result);
     return result;
 }
 
+// Send one n-sample request to endpoint, retrying HTTP 429 within its quota; returns the samples received
+static int request_samples(const char *prompt, agent_type_t agent, config_t *config, int n, char **responses,
+                           const char *endpoint, const char *api_key, const char *json_string,
+                           dstring_t *response_body) {
+    long prompt_tokens = rate_limit_estimate_tokens(strlen(json_string));
+    http_request_control_t control = { 0, config->model_call_timeout_ms };
+    http_response_info_t http_info;
+    int http_result;
+    struct timespec start_time, end_time;
+    for (int attempt = 0; ; attempt++) {
+        dstring_clear(response_body);
+        rate_limit_acquire(endpoint, prompt_tokens);
+        clock_gettime(CLOCK_MONOTONIC, &start_time);
+        trace_span_t span = trace_begin("api_call", agent);
+        http_result = http_post_json(endpoint, api_key, json_string, strlen(json_string),
+                                     response_body, &http_info,
+                                     config->model_call_timeout_ms > 0 ? &control : NULL);
+        trace_end(&span);
+        clock_gettime(CLOCK_MONOTONIC, &end_time);
+        if (http_result != 0 ||
+            !rate_limit_retry(endpoint, http_info.status_code, attempt, config->rate_limit_retries)) break;
+    }
+    
+    if (http_result != 0) {
+        fprintf(stderr, "Error: HTTP request to %s failed: %s\n", endpoint, http_info.error);
+        router_record(agent, endpoint, 0, elapsed_ms(&start_time, &end_time));
+        return 0;
+    }
+    
+    cJSON *response_json = cJSON_Parse(dstring_get(response_body));
+    if (!response_json) {
+        fprintf(stderr, "Error: Failed to parse response JSON (HTTP %ld)\n", http_info.status_code);
+        router_record(agent, endpoint, 0, elapsed_ms(&start_time, &end_time));
+        return 0;
+    }
+    
+    cJSON *error_obj = cJSON_GetObjectItem(response_json, "error");
+    if (error_obj) {
+        const char *error_text = cJSON_GetStringValue(cJSON_GetObjectItem(error_obj, "message"));
+        fprintf(stderr, "API Error: %s\n", error_text ? error_text : "Unknown error");
+    }
+    
+    // A server without "n" support answers with a single choice
+    int count = 0;
+    cJSON *choices = error_obj ? NULL : cJSON_GetObjectItem(response_json, "choices");
+    cJSON *choice;
+    cJSON_ArrayForEach(choice, choices) {
+        if (count == n) break;
+        const char *content = cJSON_GetStringValue(cJSON_GetObjectItem(cJSON_GetObjectItem(choice, "message"), "content"));
+        if (!content) continue;
+        responses[count] = strdup(content);
+        if (!responses[count]) break;
+        log_writer_exchange(agent, prompt, responses[count]);
+        count++;
+    }
+    
+    if (count > 0) {
+        cJSON *usage = cJSON_GetObjectItem(response_json, "usage");
+        cJSON *tokens = usage ? cJSON_GetObjectItem(usage, "completion_tokens") : NULL;
+        long completion_tokens = tokens && cJSON_IsNumber(tokens) ? (long)cJSON_GetNumberValue(tokens) : 0;
+        rate_limit_settle(endpoint, completion_tokens);
+        record_agent_stats(agent, 0, 0, http_info.total_time_ms, http_info.total_time_ms, completion_tokens);
+    }
+    router_record(agent, endpoint, count > 0, elapsed_ms(&start_time, &end_time));
+    
+    log_message(config, VERBOSITY_DEBUG, "HTTP %ld in %.1fms: %d of %d samples\n",
+               http_info.status_code, http_info.total_time_ms, count, n);
+    
+    cJSON_Delete(response_json);
+    return count;
+}
+
+// Send one chat request for n samples the model cache could not answer (never hedged: it costs n samples)
+static int call_ai_model_n_live(const char *prompt, agent_type_t agent, config_t *config, int n, char **responses,
+                                const char *api_key, const char *model_name, double temperature) {
+    // Samples are never streamed: every choice arrives in one body
+    cJSON *request_json = json_create_chat_request(model_name, prompt, temperature, false);
+    if (!request_json) {
+        fprintf(stderr, "Error: Failed to create JSON request\n");
+        return 0;
+    }
+    cJSON_AddNumberToObject(request_json, "n", n);
+    
+    char *json_string = cJSON_PrintUnformatted(request_json);
+    cJSON_Delete(request_json);
+    if (!json_string) {
+        fprintf(stderr, "Error: Failed to stringify JSON request\n");
+        return 0;
+    }
+    
+    dstring_t *response_body = dstring_create(config->max_response_size);
+    if (!response_body) {
+        fprintf(stderr, "Error: Failed to allocate memory for response\n");
+        free(json_string);
+        return 0;
+    }
+    
+    printf("%s Agent: Making API call for %d samples...\n", agent == AGENT_FAST ? "Fast" : "Reasoning", n);
+    int count = 0;
+    for (int attempt = 0; attempt <= config->model_call_retries && count == 0; attempt++) {
+        if (attempt > 0) wait_before_retry(agent, config, attempt - 1);
+        const char *order[MAX_AGENT_ENDPOINTS];
+        router_order(agent, config, order);
+        count = request_samples(prompt, agent, config, n, responses, order[0], api_key, json_string, response_body);
+    }
+    
+    free(json_string);
+    dstring_destroy(response_body);
+    return count;
+}
+
+// Call AI model via the in-process HTTP client
+char* call_ai_model(const char* prompt, agent_type_t agent, config_t *config) {
+    if (!prompt || !config) {
+        fprintf(stderr, "Error: Invalid parameters for AI model call\n");
+        return NULL;
+    }
+    
+    // Get model configuration
+    const char *endpoint = agent == AGENT_FAST ? config->fast_model_endpoint : config->reasoning_model_endpoint;
+    const char *model_name = agent == AGENT_FAST ? config->fast_model_name : config->reasoning_model_name;
+    const char *api_key = agent == AGENT_FAST ? config->fast_model_api_key : config->reasoning_model_api_key;
+    
+    // Recorded or repeated prompts are answered without calling the model
+    double temperature = agent == AGENT_FAST ? 0.8 : 0.3;
+    char *stored = NULL;
+    if (model_cache_lookup(endpoint, model_name, temperature, 1, prompt, &stored) == 1) {
+        log_message(config, VERBOSITY_DEBUG, "%s Agent: response served from the model cache\n",
+                   agent == AGENT_FAST ? "Fast" : "Reasoning");
+        log_writer_exchange(agent, prompt, stored);
+        return stored;
+    }
+    if (model_cache_replay_only()) {
+        fprintf(stderr, "Error: No recorded %s agent response for this prompt (replay mode)\n",
+                agent == AGENT_FAST ? "fast" : "reasoning");
+        return NULL;
+    }
+    
+    // Every miss is reported back so concurrent identical requests can share the answer
+    char *result = call_ai_model_live(prompt, agent, config, api_key, model_name, temperature);
+    model_cache_store(endpoint, model_name, temperature, 1, prompt, agent, result ? &result : NULL, result ? 1 : 0);
+    return result;
+}
+
+// Call AI model once for n samples of the same prompt (OpenAI "n" parameter)
+int call_ai_model_n(const char* prompt, agent_type_t agent, config_t *config, int n, char **responses) {
+    if (!prompt || !config || n <= 0 || !responses) {
+        fprintf(stderr, "Error: Invalid parameters for AI model call\n");
+        return 0;
+    }
+    
+    const char *endpoint = agent == AGENT_FAST ? config->fast_model_endpoint : config->reasoning_model_endpoint;
+    const char *model_name = agent == AGENT_FAST ? config->fast_model_name : config->reasoning_model_name;
+    const char *api_key = agent == AGENT_FAST ? config->fast_model_api_key : config->reasoning_model_api_key;
+    
+    double temperature = agent == AGENT_FAST ? 0.8 : 0.3;
+    int stored = model_cache_lookup(endpoint, model_name, temperature, n, prompt, responses);
+    if (stored > 0) {
+        log_message(config, VERBOSITY_DEBUG, "%s Agent: %d samples served from the model cache\n",
+                   agent == AGENT_FAST ? "Fast" : "Reasoning", stored);
+        for (int i = 0; i < stored; i++) {
+            log_writer_exchange(agent, prompt, responses[i]);
+        }
+        return stored;
+    }
+    if (model_cache_replay_only()) {
+        fprintf(stderr, "Error: No recorded %s agent samples for this prompt (replay mode)\n",
+                agent == AGENT_FAST ? "fast" : "reasoning");
+        return 0;
+    }
+    
+    int count = call_ai_model_n_live(prompt, agent, config, n, responses, api_key, model_name, temperature);
+    model_cache_store(endpoint, model_name, temperature, n, prompt, agent, responses, count);
+    return count;
+}
+
 // Validate and clean AI response
 char* validate_and_clean_response(const char* response) {
     if (!response) return NULL;
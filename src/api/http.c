@@ -0,0 +1,301 @@
+#include "http.h"
+#include <curl/curl.h>
+#include <pthread.h>
+
+// Maximum idle handles kept per endpoint; extra handles are closed on release
+#define HTTP_MAX_IDLE_HANDLES 8
+
+// Pool of reusable easy handles for one endpoint URL
+typedef struct http_endpoint_pool {
+    char *endpoint;                              // Full URL, so long endpoints still find their pool
+    CURL *idle[HTTP_MAX_IDLE_HANDLES];
+    int idle_count;
+    struct http_endpoint_pool *next;
+} http_endpoint_pool_t;
+
+static pthread_once_t http_init_once = PTHREAD_ONCE_INIT;
+static int http_initialized = 0;
+static pthread_mutex_t http_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static http_endpoint_pool_t *http_pools = NULL;
+
+// Share handle for DNS and TLS session caches across all easy handles
+static CURLSH *http_share = NULL;
+static pthread_mutex_t http_share_locks[CURL_LOCK_DATA_LAST];
+
+static void http_share_lock(CURL *handle, curl_lock_data data, curl_lock_access access, void *userptr) {
+    (void)handle; (void)access; (void)userptr;
+    pthread_mutex_lock(&http_share_locks[data]);
+}
+
+static void http_share_unlock(CURL *handle, curl_lock_data data, void *userptr) {
+    (void)handle; (void)userptr;
+    pthread_mutex_unlock(&http_share_locks[data]);
+}
+
+static void http_do_init(void) {
+    if (curl_global_init(CURL_GLOBAL_DEFAULT) != CURLE_OK) {
+        fprintf(stderr, "Error: Failed to initialize libcurl\n");
+        return;
+    }
+
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++) {
+        pthread_mutex_init(&http_share_locks[i], NULL);
+    }
+
+    http_share = curl_share_init();
+    if (http_share) {
+        curl_share_setopt(http_share, CURLSHOPT_LOCKFUNC, http_share_lock);
+        curl_share_setopt(http_share, CURLSHOPT_UNLOCKFUNC, http_share_unlock);
+        curl_share_setopt(http_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(http_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    }
+
+    http_initialized = 1;
+}
+
+// Initialize the HTTP client (safe to call more than once)
+int http_client_init(void) {
+    pthread_once(&http_init_once, http_do_init);
+    return http_initialized ? 0 : -1;
+}
+
+// Close every pooled connection and release libcurl
+void http_client_cleanup(void) {
+    if (!http_initialized) return;
+
+    pthread_mutex_lock(&http_pool_mutex);
+    http_endpoint_pool_t *pool = http_pools;
+    while (pool) {
+        http_endpoint_pool_t *next = pool->next;
+        for (int i = 0; i < pool->idle_count; i++) {
+            curl_easy_cleanup(pool->idle[i]);
+        }
+        free(pool->endpoint);
+        free(pool);
+        pool = next;
+    }
+    http_pools = NULL;
+    pthread_mutex_unlock(&http_pool_mutex);
+
+    if (http_share) {
+        curl_share_cleanup(http_share);
+        http_share = NULL;
+    }
+
+    curl_global_cleanup();
+    http_initialized = 0;
+}
+
+// Find the pool for an endpoint, creating it on first use (caller holds http_pool_mutex)
+static http_endpoint_pool_t* http_find_pool(const char *endpoint) {
+    for (http_endpoint_pool_t *pool = http_pools; pool; pool = pool->next) {
+        if (strcmp(pool->endpoint, endpoint) == 0) {
+            return pool;
+        }
+    }
+
+    http_endpoint_pool_t *pool = calloc(1, sizeof(http_endpoint_pool_t));
+    if (!pool) return NULL;
+
+    pool->endpoint = strdup(endpoint);
+    if (!pool->endpoint) {
+        free(pool);
+        return NULL;
+    }
+    pool->next = http_pools;
+    http_pools = pool;
+    return pool;
+}
+
+// Take an idle handle for endpoint, or create a new one
+static CURL* http_acquire_handle(const char *endpoint) {
+    CURL *handle = NULL;
+
+    pthread_mutex_lock(&http_pool_mutex);
+    http_endpoint_pool_t *pool = http_find_pool(endpoint);
+    if (pool && pool->idle_count > 0) {
+        handle = pool->idle[--pool->idle_count];
+    }
+    pthread_mutex_unlock(&http_pool_mutex);
+
+    if (handle) {
+        // Reset options but keep the live connection and caches
+        curl_easy_reset(handle);
+    } else {
+        handle = curl_easy_init();
+    }
+
+    return handle;
+}
+
+// Return a handle to its endpoint pool so its connection stays alive
+static void http_release_handle(const char *endpoint, CURL *handle) {
+    if (!handle) return;
+
+    pthread_mutex_lock(&http_pool_mutex);
+    http_endpoint_pool_t *pool = http_find_pool(endpoint);
+    if (pool && pool->idle_count < HTTP_MAX_IDLE_HANDLES) {
+        pool->idle[pool->idle_count++] = handle;
+        handle = NULL;
+    }
+    pthread_mutex_unlock(&http_pool_mutex);
+
+    if (handle) {
+        curl_easy_cleanup(handle);
+    }
+}
+
+// libcurl write callback appending body bytes to a dstring_t
+static size_t http_write_to_dstring(char *data, size_t size, size_t nmemb, void *userdata) {
+    size_t length = size * nmemb;
+    if (dstring_append_len((dstring_t *)userdata, data, length) != 0) {
+        return 0; // Signals an error to libcurl
+    }
+    return length;
+}
+
+// State for streaming writes through a caller callback
+typedef struct {
+    http_chunk_callback_t on_chunk;
+    void *userdata;
+    int aborted;
+} http_stream_context_t;
+
+// libcurl write callback forwarding body bytes to the caller
+static size_t http_write_to_callback(char *data, size_t size, size_t nmemb, void *userdata) {
+    http_stream_context_t *context = (http_stream_context_t *)userdata;
+    size_t length = size * nmemb;
+    if (context->on_chunk(data, length, context->userdata) != 0) {
+        context->aborted = 1;
+        return 0; // Stops the transfer
+    }
+    return length;
+}
+
+// Cancel a request running on another thread
+void http_request_cancel(http_request_control_t *control) {
+    if (control) __atomic_store_n(&control->cancelled, 1, __ATOMIC_RELEASE);
+}
+
+// libcurl progress callback aborting a cancelled transfer (called even while no data arrives)
+static int http_check_cancelled(void *userdata, curl_off_t dltotal, curl_off_t dlnow,
+                                curl_off_t ultotal, curl_off_t ulnow) {
+    (void)dltotal; (void)dlnow; (void)ultotal; (void)ulnow;
+    const http_request_control_t *control = (const http_request_control_t *)userdata;
+    return __atomic_load_n(&control->cancelled, __ATOMIC_ACQUIRE) ? 1 : 0;
+}
+
+// Perform a POST on a pooled handle with the given body writer
+static int http_perform_post(const char *endpoint, const char *api_key, const char *body, size_t body_length,
+                             curl_write_callback writer, void *writer_data, const int *aborted,
+                             const http_request_control_t *control, http_response_info_t *info) {
+    if (http_client_init() != 0) {
+        snprintf(info->error, sizeof(info->error), "HTTP client not initialized");
+        return -1;
+    }
+
+    CURL *handle = http_acquire_handle(endpoint);
+    if (!handle) {
+        snprintf(info->error, sizeof(info->error), "Failed to create HTTP handle");
+        return -1;
+    }
+
+    // Build request headers
+    struct curl_slist *headers = NULL;
+    headers = curl_slist_append(headers, "Content-Type: application/json");
+    headers = curl_slist_append(headers, "Expect:"); // Skip the 100-continue round trip
+    if (api_key && strlen(api_key) > 0 && strcmp(api_key, "null") != 0) {
+        char auth_header[320];
+        snprintf(auth_header, sizeof(auth_header), "Authorization: Bearer %s", api_key);
+        headers = curl_slist_append(headers, auth_header);
+    }
+
+    curl_easy_setopt(handle, CURLOPT_URL, endpoint);
+    curl_easy_setopt(handle, CURLOPT_POST, 1L);
+    curl_easy_setopt(handle, CURLOPT_POSTFIELDS, body);
+    curl_easy_setopt(handle, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)body_length);
+    curl_easy_setopt(handle, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, writer);
+    curl_easy_setopt(handle, CURLOPT_WRITEDATA, writer_data);
+    curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(handle, CURLOPT_TCP_NODELAY, 1L);
+    curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT, 30L);
+    curl_easy_setopt(handle, CURLOPT_ACCEPT_ENCODING, "");
+    if (http_share) {
+        curl_easy_setopt(handle, CURLOPT_SHARE, http_share);
+    }
+    // Cancellation and the per-request timeout come from control; without one, progress callbacks stay off
+    curl_easy_setopt(handle, CURLOPT_NOPROGRESS, control ? 0L : 1L);
+    curl_easy_setopt(handle, CURLOPT_XFERINFOFUNCTION, control ? http_check_cancelled : NULL);
+    curl_easy_setopt(handle, CURLOPT_XFERINFODATA, (void *)control);
+    curl_easy_setopt(handle, CURLOPT_TIMEOUT_MS, control ? control->timeout_ms : 0L);
+
+    CURLcode code = curl_easy_perform(handle);
+
+    curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &info->status_code);
+
+    double total_time = 0.0;
+    curl_easy_getinfo(handle, CURLINFO_TOTAL_TIME, &total_time);
+    info->total_time_ms = total_time * 1000.0;
+
+    long connects = 0;
+    curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &connects);
+    info->reused_connection = (connects == 0);
+
+    curl_slist_free_all(headers);
+
+    if (code == CURLE_WRITE_ERROR && aborted && *aborted) {
+        // Stopped on purpose; libcurl closes the half-read connection itself
+        info->aborted = 1;
+        http_release_handle(endpoint, handle);
+        return 0;
+    }
+
+    if (code == CURLE_ABORTED_BY_CALLBACK) {
+        info->cancelled = 1;
+    }
+    if (code != CURLE_OK) {
+        snprintf(info->error, sizeof(info->error), "%s", curl_easy_strerror(code));
+        // A failed transfer may leave the connection in an unknown state
+        curl_easy_cleanup(handle);
+        return -1;
+    }
+
+    http_release_handle(endpoint, handle);
+    return 0;
+}
+
+// POST a JSON body and collect the response in memory
+int http_post_json(const char *endpoint, const char *api_key, const char *body, size_t body_length,
+                   dstring_t *response, http_response_info_t *info, const http_request_control_t *control) {
+    http_response_info_t local_info;
+    if (!info) info = &local_info;
+    memset(info, 0, sizeof(http_response_info_t));
+
+    if (!endpoint || !body || !response) {
+        snprintf(info->error, sizeof(info->error), "Invalid parameters for HTTP request");
+        return -1;
+    }
+
+    return http_perform_post(endpoint, api_key, body, body_length,
+                             http_write_to_dstring, response, NULL, control, info);
+}
+
+// POST a JSON body and stream the response through a callback
+int http_post_json_stream(const char *endpoint, const char *api_key, const char *body, size_t body_length,
+                          http_chunk_callback_t on_chunk, void *userdata, http_response_info_t *info,
+                          const http_request_control_t *control) {
+    http_response_info_t local_info;
+    if (!info) info = &local_info;
+    memset(info, 0, sizeof(http_response_info_t));
+
+    if (!endpoint || !body || !on_chunk) {
+        snprintf(info->error, sizeof(info->error), "Invalid parameters for HTTP request");
+        return -1;
+    }
+
+    http_stream_context_t context = { on_chunk, userdata, 0 };
+    return http_perform_post(endpoint, api_key, body, body_length,
+                             http_write_to_callback, &context, &context.aborted, control, info);
+}
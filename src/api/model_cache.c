@@ -0,0 +1,276 @@
+#include "model_cache.h"
+#include "json.h"
+#include <pthread.h>
+#include <stdint.h>
+
+#define MODEL_CACHE_BUCKETS 256
+
+typedef enum {
+    MODEL_CACHE_OFF = 0,
+    MODEL_CACHE_RECORD,
+    MODEL_CACHE_REPLAY,
+    MODEL_CACHE_FIRST
+} model_cache_mode_t;
+
+// Responses of one call
+typedef struct {
+    char **responses;
+    int count;
+} model_answer_t;
+
+// Every answer recorded for one key, in call order
+typedef struct model_cache_entry {
+    uint64_t key;
+    model_answer_t *answers;
+    int answer_count;
+    int next_answer;                             // Replay position
+    int pending;                                 // A live call for the key is in flight (cache-first)
+    struct model_cache_entry *next;
+} model_cache_entry_t;
+
+static pthread_mutex_t model_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t model_cache_ready = PTHREAD_COND_INITIALIZER;
+static model_cache_entry_t *model_cache_buckets[MODEL_CACHE_BUCKETS];
+static model_cache_mode_t model_cache_mode = MODEL_CACHE_OFF;
+static FILE *model_cache_out = NULL;
+
+// FNV-1a over a byte range
+static uint64_t fnv1a_update(uint64_t hash, const char *data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// Key of a request; fields are separated by NUL so they cannot run into each other
+static uint64_t request_key(const char *endpoint, const char *model, double temperature, int n, const char *prompt) {
+    char numbers[64];
+    snprintf(numbers, sizeof(numbers), "%.3f/%d", temperature, n);
+
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    hash = fnv1a_update(hash, endpoint ? endpoint : "", strlen(endpoint ? endpoint : "") + 1);
+    hash = fnv1a_update(hash, model ? model : "", strlen(model ? model : "") + 1);
+    hash = fnv1a_update(hash, numbers, strlen(numbers) + 1);
+    hash = fnv1a_update(hash, prompt ? prompt : "", strlen(prompt ? prompt : ""));
+    return hash;
+}
+
+// Find or create the entry for key (caller holds model_cache_mutex)
+static model_cache_entry_t* cache_entry(uint64_t key, int create) {
+    model_cache_entry_t **bucket = &model_cache_buckets[key % MODEL_CACHE_BUCKETS];
+    for (model_cache_entry_t *entry = *bucket; entry; entry = entry->next) {
+        if (entry->key == key) return entry;
+    }
+    if (!create) return NULL;
+
+    model_cache_entry_t *entry = calloc(1, sizeof(model_cache_entry_t));
+    if (!entry) return NULL;
+    entry->key = key;
+    entry->next = *bucket;
+    *bucket = entry;
+    return entry;
+}
+
+// Append copies of responses as a new answer of entry (caller holds model_cache_mutex)
+static void add_answer(model_cache_entry_t *entry, char **responses, int count) {
+    model_answer_t *answers = realloc(entry->answers, (entry->answer_count + 1) * sizeof(model_answer_t));
+    if (!answers) return;
+    entry->answers = answers;
+
+    model_answer_t *answer = &entry->answers[entry->answer_count];
+    answer->responses = calloc(count, sizeof(char *));
+    answer->count = 0;
+    if (!answer->responses) return;
+    for (int i = 0; i < count; i++) {
+        answer->responses[i] = strdup(responses[i]);
+        if (!answer->responses[i]) break;
+        answer->count++;
+    }
+    entry->answer_count++;
+}
+
+// Load every complete line of a recorded store; returns the number of answers
+static int load_store(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) return -1;
+
+    int loaded = 0;
+    dstring_t *line = dstring_create(4096);
+    char chunk[4096];
+    while (line && fgets(chunk, sizeof(chunk), file)) {
+        dstring_append(line, chunk);
+        size_t length = strlen(chunk);
+        if (length > 0 && chunk[length - 1] != '\n' && !feof(file)) continue; // Line continues
+
+        // A line cut short by a crash does not parse and is skipped
+        cJSON *record = cJSON_Parse(dstring_get(line));
+        dstring_clear(line);
+        if (!record) continue;
+
+        const char *key_text = cJSON_GetStringValue(cJSON_GetObjectItem(record, "key"));
+        cJSON *responses = cJSON_GetObjectItem(record, "responses");
+        int count = cJSON_GetArraySize(responses);
+        char **texts = count > 0 ? calloc(count, sizeof(char *)) : NULL;
+        int valid = key_text && texts;
+        for (int i = 0; valid && i < count; i++) {
+            texts[i] = cJSON_GetStringValue(cJSON_GetArrayItem(responses, i));
+            if (!texts[i]) valid = 0;
+        }
+        if (valid) {
+            model_cache_entry_t *entry = cache_entry(strtoull(key_text, NULL, 16), 1);
+            if (entry) {
+                add_answer(entry, texts, count);
+                loaded++;
+            }
+        }
+        free(texts);
+        cJSON_Delete(record);
+    }
+    dstring_destroy(line);
+    fclose(file);
+    return loaded;
+}
+
+// Start the store for config->model_cache_mode
+int model_cache_init(config_t *config) {
+    if (!config) return -1;
+
+    pthread_mutex_lock(&model_cache_mutex);
+    model_cache_mode = MODEL_CACHE_OFF;
+    if (strcmp(config->model_cache_mode, "record") == 0) model_cache_mode = MODEL_CACHE_RECORD;
+    else if (strcmp(config->model_cache_mode, "replay") == 0) model_cache_mode = MODEL_CACHE_REPLAY;
+    else if (strcmp(config->model_cache_mode, "cache-first") == 0) model_cache_mode = MODEL_CACHE_FIRST;
+
+    int status = 0;
+    if (model_cache_mode == MODEL_CACHE_RECORD) {
+        // A recording replaces any earlier one, so the store matches exactly one run
+        model_cache_out = fopen(config->model_cache_file, "w");
+        if (!model_cache_out) {
+            fprintf(stderr, "Warning: Cannot write model responses to '%s', not recording\n", config->model_cache_file);
+            model_cache_mode = MODEL_CACHE_OFF;
+        }
+    } else if (model_cache_mode == MODEL_CACHE_REPLAY) {
+        int loaded = load_store(config->model_cache_file);
+        if (loaded < 0) {
+            fprintf(stderr, "Error: Cannot read recorded model responses from '%s'\n", config->model_cache_file);
+            status = -1;
+        } else {
+            log_message(config, VERBOSITY_VERBOSE, "%sReplaying %d recorded model responses%s\n",
+                       C_INFO, loaded, C_RESET);
+        }
+    }
+    pthread_mutex_unlock(&model_cache_mutex);
+    return status;
+}
+
+// Free every stored answer and close the recording
+void model_cache_cleanup(void) {
+    pthread_mutex_lock(&model_cache_mutex);
+    for (int i = 0; i < MODEL_CACHE_BUCKETS; i++) {
+        model_cache_entry_t *entry = model_cache_buckets[i];
+        while (entry) {
+            model_cache_entry_t *next = entry->next;
+            for (int a = 0; a < entry->answer_count; a++) {
+                for (int r = 0; r < entry->answers[a].count; r++) {
+                    free(entry->answers[a].responses[r]);
+                }
+                free(entry->answers[a].responses);
+            }
+            free(entry->answers);
+            free(entry);
+            entry = next;
+        }
+        model_cache_buckets[i] = NULL;
+    }
+    if (model_cache_out) {
+        fclose(model_cache_out);
+        model_cache_out = NULL;
+    }
+    model_cache_mode = MODEL_CACHE_OFF;
+    pthread_mutex_unlock(&model_cache_mutex);
+}
+
+// Whether a missing response must fail instead of calling the model
+int model_cache_replay_only(void) {
+    pthread_mutex_lock(&model_cache_mutex);
+    int replay = model_cache_mode == MODEL_CACHE_REPLAY;
+    pthread_mutex_unlock(&model_cache_mutex);
+    return replay;
+}
+
+// Fill responses with copies of a stored answer
+int model_cache_lookup(const char *endpoint, const char *model, double temperature, int n,
+                       const char *prompt, char **responses) {
+    if (!responses || n <= 0) return 0;
+
+    uint64_t key = request_key(endpoint, model, temperature, n, prompt);
+    int count = 0;
+    pthread_mutex_lock(&model_cache_mutex);
+    model_cache_entry_t *entry = NULL;
+    if (model_cache_mode == MODEL_CACHE_REPLAY || model_cache_mode == MODEL_CACHE_FIRST) {
+        entry = cache_entry(key, model_cache_mode == MODEL_CACHE_FIRST);
+    }
+    // Concurrent identical requests wait for the one in flight instead of calling the model too
+    while (entry && entry->answer_count == 0 && entry->pending) {
+        pthread_cond_wait(&model_cache_ready, &model_cache_mutex);
+    }
+    if (entry && entry->answer_count > 0) {
+        // Replay walks the recorded answers in order (wrapping around); cache-first keeps the first
+        int index = 0;
+        if (model_cache_mode == MODEL_CACHE_REPLAY) {
+            index = entry->next_answer % entry->answer_count;
+            entry->next_answer++;
+        }
+        const model_answer_t *answer = &entry->answers[index];
+        for (int i = 0; i < answer->count && count < n; i++) {
+            responses[count] = strdup(answer->responses[i]);
+            if (!responses[count]) break;
+            count++;
+        }
+    } else if (entry && model_cache_mode == MODEL_CACHE_FIRST) {
+        entry->pending = 1; // The caller calls the model and reports back through model_cache_store
+    }
+    pthread_mutex_unlock(&model_cache_mutex);
+    return count;
+}
+
+// Keep the responses of a live call
+void model_cache_store(const char *endpoint, const char *model, double temperature, int n,
+                       const char *prompt, agent_type_t agent, char **responses, int count) {
+    if (!responses) count = 0;
+
+    uint64_t key = request_key(endpoint, model, temperature, n, prompt);
+    pthread_mutex_lock(&model_cache_mutex);
+    if (model_cache_mode == MODEL_CACHE_FIRST) {
+        model_cache_entry_t *entry = cache_entry(key, 1);
+        if (entry) {
+            if (count > 0 && entry->answer_count == 0) add_answer(entry, responses, count);
+            entry->pending = 0;
+            pthread_cond_broadcast(&model_cache_ready); // On failure one waiter retries live
+        }
+    } else if (model_cache_mode == MODEL_CACHE_RECORD && model_cache_out && count > 0) {
+        cJSON *record = cJSON_CreateObject();
+        char key_text[17];
+        snprintf(key_text, sizeof(key_text), "%016llx", (unsigned long long)key);
+        cJSON_AddStringToObject(record, "key", key_text);
+        cJSON_AddStringToObject(record, "agent", agent == AGENT_FAST ? "fast" : "reasoning");
+        cJSON_AddStringToObject(record, "model", model ? model : "");
+        cJSON_AddNumberToObject(record, "temperature", temperature);
+        cJSON_AddNumberToObject(record, "n", n);
+        cJSON *texts = cJSON_CreateArray();
+        cJSON_AddItemToObject(record, "responses", texts);
+        for (int i = 0; texts && i < count; i++) {
+            cJSON_AddItemToArray(texts, cJSON_CreateString(responses[i]));
+        }
+
+        char *line = cJSON_PrintUnformatted(record);
+        if (line) {
+            fprintf(model_cache_out, "%s\n", line);
+            fflush(model_cache_out); // Keep what was recorded if the run is interrupted
+            free(line);
+        }
+        cJSON_Delete(record);
+    }
+    pthread_mutex_unlock(&model_cache_mutex);
+}
@@ -0,0 +1,216 @@
+#include "rate_limit.h"
+#include <pthread.h>
+
+#define RATE_LIMIT_MAX_PAUSE_S 30.0
+
+// Quota state of one endpoint URL
+typedef struct rate_bucket {
+    char endpoint[512];
+    double requests_per_minute;                  // 0 = unlimited
+    double tokens_per_minute;                    // 0 = unlimited
+    double requests;                             // Available requests (negative = reserved ahead)
+    double tokens;                               // Available tokens (negative = reserved ahead)
+    double refilled_at;                          // Monotonic seconds of the last refill
+    double paused_until;                         // No request starts before this (after a 429)
+    long calls;
+    long waits;                                  // Calls that had to wait for quota
+    double wait_ms;
+    long throttled;                              // HTTP 429 responses
+    struct rate_bucket *next;
+} rate_bucket_t;
+
+static pthread_mutex_t rate_limit_mutex = PTHREAD_MUTEX_INITIALIZER;
+static rate_bucket_t *rate_buckets = NULL;
+
+// Monotonic clock in seconds
+static double now_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Find or create the bucket of endpoint (caller holds rate_limit_mutex)
+static rate_bucket_t* find_bucket(const char *endpoint) {
+    for (rate_bucket_t *bucket = rate_buckets; bucket; bucket = bucket->next) {
+        if (strcmp(bucket->endpoint, endpoint) == 0) return bucket;
+    }
+
+    rate_bucket_t *bucket = calloc(1, sizeof(rate_bucket_t));
+    if (!bucket) return NULL;
+    snprintf(bucket->endpoint, sizeof(bucket->endpoint), "%s", endpoint);
+    bucket->refilled_at = now_seconds();
+    bucket->next = rate_buckets;
+    rate_buckets = bucket;
+    return bucket;
+}
+
+// The tighter of two limits, where 0 means unlimited
+static double tighter_limit(double a, double b) {
+    if (a <= 0) return b;
+    if (b <= 0) return a;
+    return a < b ? a : b;
+}
+
+// Add what accrued since the last refill; a full bucket holds one minute of quota
+static void refill(rate_bucket_t *bucket, double now) {
+    double elapsed = now - bucket->refilled_at;
+    bucket->refilled_at = now;
+    if (elapsed <= 0) return;
+
+    if (bucket->requests_per_minute > 0) {
+        bucket->requests += elapsed * bucket->requests_per_minute / 60.0;
+        if (bucket->requests > bucket->requests_per_minute) bucket->requests = bucket->requests_per_minute;
+    }
+    if (bucket->tokens_per_minute > 0) {
+        bucket->tokens += elapsed * bucket->tokens_per_minute / 60.0;
+        if (bucket->tokens > bucket->tokens_per_minute) bucket->tokens = bucket->tokens_per_minute;
+    }
+}
+
+// Register the limits of one agent's endpoint
+static void add_endpoint_limits(const char *endpoint, int requests_per_minute, int tokens_per_minute) {
+    if (!endpoint || strlen(endpoint) == 0) return;
+
+    rate_bucket_t *bucket = find_bucket(endpoint);
+    if (!bucket) return;
+    bucket->requests_per_minute = tighter_limit(bucket->requests_per_minute, requests_per_minute);
+    bucket->tokens_per_minute = tighter_limit(bucket->tokens_per_minute, tokens_per_minute);
+    bucket->requests = bucket->requests_per_minute; // Start with a full minute of quota
+    bucket->tokens = bucket->tokens_per_minute;
+}
+
+// Set up the limits of the configured endpoints
+int rate_limit_init(const config_t *config) {
+    if (!config) return -1;
+
+    pthread_mutex_lock(&rate_limit_mutex);
+    add_endpoint_limits(config->fast_model_endpoint, config->fast_model_rpm, config->fast_model_tpm);
+    add_endpoint_limits(config->reasoning_model_endpoint, config->reasoning_model_rpm, config->reasoning_model_tpm);
+    // Fallback endpoints are held to the quota of the agent they serve
+    for (int i = 0; i < config->fast_model_fallback_count; i++) {
+        add_endpoint_limits(config->fast_model_fallback_endpoints[i], config->fast_model_rpm, config->fast_model_tpm);
+    }
+    for (int i = 0; i < config->reasoning_model_fallback_count; i++) {
+        add_endpoint_limits(config->reasoning_model_fallback_endpoints[i], config->reasoning_model_rpm,
+                            config->reasoning_model_tpm);
+    }
+    pthread_mutex_unlock(&rate_limit_mutex);
+    return 0;
+}
+
+void rate_limit_cleanup(void) {
+    pthread_mutex_lock(&rate_limit_mutex);
+    while (rate_buckets) {
+        rate_bucket_t *next = rate_buckets->next;
+        free(rate_buckets);
+        rate_buckets = next;
+    }
+    pthread_mutex_unlock(&rate_limit_mutex);
+}
+
+// Reserve one request and tokens, then sleep until the reservation is covered
+void rate_limit_acquire(const char *endpoint, long tokens) {
+    if (!endpoint) return;
+
+    pthread_mutex_lock(&rate_limit_mutex);
+    rate_bucket_t *bucket = find_bucket(endpoint);
+    if (!bucket) {
+        pthread_mutex_unlock(&rate_limit_mutex);
+        return;
+    }
+
+    double now = now_seconds();
+    refill(bucket, now);
+    bucket->calls++;
+
+    // Reserving ahead makes later callers wait behind earlier ones
+    double wait_s = bucket->paused_until > now ? bucket->paused_until - now : 0.0;
+    if (bucket->requests_per_minute > 0) {
+        bucket->requests -= 1.0;
+        if (bucket->requests < 0) {
+            double needed = -bucket->requests * 60.0 / bucket->requests_per_minute;
+            if (needed > wait_s) wait_s = needed;
+        }
+    }
+    if (bucket->tokens_per_minute > 0 && tokens > 0) {
+        // A request larger than a minute of quota still goes through once the bucket is full
+        double cost = tokens < bucket->tokens_per_minute ? (double)tokens : bucket->tokens_per_minute;
+        bucket->tokens -= cost;
+        if (bucket->tokens < 0) {
+            double needed = -bucket->tokens * 60.0 / bucket->tokens_per_minute;
+            if (needed > wait_s) wait_s = needed;
+        }
+    }
+    if (wait_s > 0) {
+        bucket->waits++;
+        bucket->wait_ms += wait_s * 1000.0;
+    }
+    pthread_mutex_unlock(&rate_limit_mutex);
+
+    if (wait_s > 0) {
+        struct timespec delay;
+        delay.tv_sec = (time_t)wait_s;
+        delay.tv_nsec = (long)((wait_s - (double)delay.tv_sec) * 1e9);
+        while (nanosleep(&delay, &delay) != 0) {
+            // Interrupted: sleep for the remainder
+        }
+    }
+}
+
+// Charge tokens known after the response
+void rate_limit_settle(const char *endpoint, long tokens) {
+    if (!endpoint || tokens <= 0) return;
+
+    pthread_mutex_lock(&rate_limit_mutex);
+    rate_bucket_t *bucket = find_bucket(endpoint);
+    if (bucket && bucket->tokens_per_minute > 0) {
+        refill(bucket, now_seconds());
+        bucket->tokens -= tokens; // May go negative: the next calls wait for it
+    }
+    pthread_mutex_unlock(&rate_limit_mutex);
+}
+
+// Pause the endpoint after HTTP 429 and tell the caller whether to retry
+int rate_limit_retry(const char *endpoint, long status_code, int attempt, int max_retries) {
+    if (!endpoint || status_code != 429) return 0;
+
+    pthread_mutex_lock(&rate_limit_mutex);
+    rate_bucket_t *bucket = find_bucket(endpoint);
+    double pause_s = 0.0;
+    if (bucket) {
+        // Back off exponentially, but never for less than one request interval
+        pause_s = attempt < 5 ? (double)(1 << attempt) : RATE_LIMIT_MAX_PAUSE_S;
+        if (bucket->requests_per_minute > 0 && 60.0 / bucket->requests_per_minute > pause_s) {
+            pause_s = 60.0 / bucket->requests_per_minute;
+        }
+        if (pause_s > RATE_LIMIT_MAX_PAUSE_S) pause_s = RATE_LIMIT_MAX_PAUSE_S;
+
+        double until = now_seconds() + pause_s;
+        if (until > bucket->paused_until) bucket->paused_until = until;
+        bucket->throttled++;
+    }
+    pthread_mutex_unlock(&rate_limit_mutex);
+
+    if (attempt >= max_retries) return 0;
+    fprintf(stderr, "Warning: %s is rate limiting (HTTP 429), retrying in %.0fs (%d/%d)\n",
+            endpoint, pause_s, attempt + 1, max_retries);
+    return 1;
+}
+
+// Rough token count of a request body
+long rate_limit_estimate_tokens(size_t body_length) {
+    return (long)(body_length / 4) + 1;
+}
+
+// Print quota waits and throttling per endpoint
+void log_rate_limit_stats(config_t *config) {
+    pthread_mutex_lock(&rate_limit_mutex);
+    for (rate_bucket_t *bucket = rate_buckets; bucket; bucket = bucket->next) {
+        if (bucket->calls == 0 || (bucket->waits == 0 && bucket->throttled == 0)) continue;
+        log_message(config, VERBOSITY_VERBOSE,
+                   "%sRate limit:%s %s: %ld calls, %ld waited for quota (%.1fs total), %ld throttled (HTTP 429)\n",
+                   C_EMPHASIS, C_RESET, bucket->endpoint, bucket->calls, bucket->waits,
+                   bucket->wait_ms / 1000.0, bucket->throttled);
+    }
+    pthread_mutex_unlock(&rate_limit_mutex);
+}
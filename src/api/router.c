@@ -0,0 +1,265 @@
+#include "router.h"
+#include <math.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#define ROUTER_LATENCY_SAMPLES 128               // Recent latencies kept per endpoint
+#define ROUTER_COOLDOWN_MS 1000.0                // Cooldown after a first failure, doubling per failure in a row
+#define ROUTER_MAX_COOLDOWN_MS 30000.0
+#define ROUTER_ERROR_DECAY_S 60.0                // Old failures stop counting against an endpoint
+#define ROUTER_MAX_BACKOFF_MS 30000L
+
+// Health of one endpoint as used by one agent
+typedef struct router_endpoint {
+    agent_type_t agent;
+    char endpoint[512];
+    double latencies[ROUTER_LATENCY_SAMPLES];    // Ring of recent successful latencies
+    int latency_count;
+    int latency_next;
+    double latency_ewma_ms;                      // Smoothed latency of successful requests
+    double error_ewma;                           // Smoothed failure rate
+    double error_updated_at;                     // When error_ewma was last updated (monotonic seconds)
+    double cooldown_until;                       // Not preferred before this (monotonic seconds)
+    int consecutive_failures;
+    long requests;
+    long failures;
+    long hedges;                                 // Hedges sent to this endpoint
+    long hedge_wins;                             // Hedges that answered first
+    double total_latency_ms;
+    struct router_endpoint *next;
+} router_endpoint_t;
+
+static pthread_mutex_t router_mutex = PTHREAD_MUTEX_INITIALIZER;
+static router_endpoint_t *router_endpoints = NULL;
+static uint64_t router_random_state = 0;
+
+// Monotonic clock in seconds
+static double now_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Find or create the state of an agent's endpoint (caller holds router_mutex)
+static router_endpoint_t* find_endpoint(agent_type_t agent, const char *endpoint) {
+    for (router_endpoint_t *entry = router_endpoints; entry; entry = entry->next) {
+        if (entry->agent == agent && strcmp(entry->endpoint, endpoint) == 0) return entry;
+    }
+
+    router_endpoint_t *entry = calloc(1, sizeof(router_endpoint_t));
+    if (!entry) return NULL;
+    entry->agent = agent;
+    snprintf(entry->endpoint, sizeof(entry->endpoint), "%s", endpoint);
+    entry->next = router_endpoints;
+    router_endpoints = entry;
+    return entry;
+}
+
+// Failure rate fading out once the endpoint stops failing
+static double recent_error_rate(const router_endpoint_t *entry, double now) {
+    if (entry->error_ewma <= 0) return 0.0;
+    return entry->error_ewma * exp(-(now - entry->error_updated_at) / ROUTER_ERROR_DECAY_S);
+}
+
+// Percentile of the recent latencies (caller holds router_mutex)
+static double latency_percentile(const router_endpoint_t *entry, int percentile) {
+    int count = entry->latency_count;
+    if (count == 0) return 0.0;
+
+    double sorted[ROUTER_LATENCY_SAMPLES];
+    memcpy(sorted, entry->latencies, count * sizeof(double));
+    // Insertion sort: at most ROUTER_LATENCY_SAMPLES values
+    for (int i = 1; i < count; i++) {
+        double value = sorted[i];
+        int j = i - 1;
+        while (j >= 0 && sorted[j] > value) {
+            sorted[j + 1] = sorted[j];
+            j--;
+        }
+        sorted[j + 1] = value;
+    }
+
+    int index = (int)ceil(percentile / 100.0 * count) - 1;
+    if (index < 0) index = 0;
+    if (index >= count) index = count - 1;
+    return sorted[index];
+}
+
+// Routing state of one candidate endpoint
+typedef struct {
+    const char *endpoint;
+    int position;                                // Configured order
+    int cooling;
+    double cooldown_until;
+    int sampled;
+    double score;                                // Expected latency, inflated by recent failures
+} route_candidate_t;
+
+// Whether candidate a should be tried before b
+static int route_before(const route_candidate_t *a, const route_candidate_t *b) {
+    if (a->cooling != b->cooling) return !a->cooling;
+    if (a->cooling) return a->cooldown_until < b->cooldown_until;
+    if (a->sampled != b->sampled) return a->sampled;
+    if (a->sampled && a->score != b->score) return a->score < b->score;
+    return a->position < b->position;
+}
+
+// Fill order with the agent's endpoints, best first; returns how many
+int router_order(agent_type_t agent, const config_t *config, const char **order) {
+    const char *configured[MAX_AGENT_ENDPOINTS];
+    int configured_count = 0;
+    configured[configured_count++] = agent == AGENT_FAST ? config->fast_model_endpoint : config->reasoning_model_endpoint;
+    int fallback_count = agent == AGENT_FAST ? config->fast_model_fallback_count : config->reasoning_model_fallback_count;
+    for (int i = 0; i < fallback_count; i++) {
+        const char *fallback = agent == AGENT_FAST ? config->fast_model_fallback_endpoints[i]
+                                                   : config->reasoning_model_fallback_endpoints[i];
+        int duplicate = 0;
+        for (int j = 0; j < configured_count; j++) {
+            if (strcmp(configured[j], fallback) == 0) duplicate = 1;
+        }
+        if (!duplicate) configured[configured_count++] = fallback;
+    }
+    if (configured_count == 1) {
+        order[0] = configured[0];
+        return 1;
+    }
+
+    route_candidate_t candidates[MAX_AGENT_ENDPOINTS];
+    double now = now_seconds();
+    pthread_mutex_lock(&router_mutex);
+    for (int i = 0; i < configured_count; i++) {
+        route_candidate_t *candidate = &candidates[i];
+        memset(candidate, 0, sizeof(route_candidate_t));
+        candidate->endpoint = configured[i];
+        candidate->position = i;
+        router_endpoint_t *entry = find_endpoint(agent, configured[i]);
+        if (!entry) continue;
+        candidate->cooling = entry->cooldown_until > now;
+        candidate->cooldown_until = entry->cooldown_until;
+        candidate->sampled = entry->latency_count > 0;
+        candidate->score = entry->latency_ewma_ms * (1.0 + 4.0 * recent_error_rate(entry, now));
+    }
+    pthread_mutex_unlock(&router_mutex);
+
+    // Insertion sort keeps equal candidates in configured order
+    for (int i = 1; i < configured_count; i++) {
+        route_candidate_t candidate = candidates[i];
+        int j = i - 1;
+        while (j >= 0 && route_before(&candidate, &candidates[j])) {
+            candidates[j + 1] = candidates[j];
+            j--;
+        }
+        candidates[j + 1] = candidate;
+    }
+    for (int i = 0; i < configured_count; i++) {
+        order[i] = candidates[i].endpoint;
+    }
+    return configured_count;
+}
+
+// Record the outcome of one request
+void router_record(agent_type_t agent, const char *endpoint, int succeeded, double latency_ms) {
+    if (!endpoint) return;
+
+    double now = now_seconds();
+    pthread_mutex_lock(&router_mutex);
+    router_endpoint_t *entry = find_endpoint(agent, endpoint);
+    if (entry) {
+        entry->requests++;
+        double error_rate = recent_error_rate(entry, now);
+        entry->error_updated_at = now;
+        if (succeeded) {
+            entry->latencies[entry->latency_next] = latency_ms;
+            entry->latency_next = (entry->latency_next + 1) % ROUTER_LATENCY_SAMPLES;
+            if (entry->latency_count < ROUTER_LATENCY_SAMPLES) entry->latency_count++;
+            entry->latency_ewma_ms = entry->latency_count == 1 ? latency_ms
+                                   : 0.8 * entry->latency_ewma_ms + 0.2 * latency_ms;
+            entry->total_latency_ms += latency_ms;
+            entry->error_ewma = 0.8 * error_rate;
+            entry->consecutive_failures = 0;
+            entry->cooldown_until = 0;
+        } else {
+            entry->failures++;
+            entry->error_ewma = 0.8 * error_rate + 0.2;
+            entry->consecutive_failures++;
+            int doublings = entry->consecutive_failures - 1 < 5 ? entry->consecutive_failures - 1 : 5;
+            double cooldown_ms = ROUTER_COOLDOWN_MS * (1 << doublings);
+            if (cooldown_ms > ROUTER_MAX_COOLDOWN_MS) cooldown_ms = ROUTER_MAX_COOLDOWN_MS;
+            entry->cooldown_until = now + cooldown_ms / 1000.0;
+        }
+    }
+    pthread_mutex_unlock(&router_mutex);
+}
+
+// Latency after which a call to endpoint is hedged (0 = do not hedge)
+double router_hedge_delay_ms(agent_type_t agent, const char *endpoint, const config_t *config) {
+    if (!config->enable_hedging || !endpoint) return 0.0;
+
+    double delay_ms = 0.0;
+    pthread_mutex_lock(&router_mutex);
+    router_endpoint_t *entry = find_endpoint(agent, endpoint);
+    if (entry && entry->latency_count >= config->hedge_min_samples && entry->latency_count > 0) {
+        delay_ms = latency_percentile(entry, config->hedge_percentile);
+    }
+    pthread_mutex_unlock(&router_mutex);
+    return delay_ms;
+}
+
+// Count a hedge sent to endpoint, and whether it answered first
+void router_record_hedge(agent_type_t agent, const char *endpoint, int won) {
+    pthread_mutex_lock(&router_mutex);
+    router_endpoint_t *entry = find_endpoint(agent, endpoint);
+    if (entry) {
+        entry->hedges++;
+        if (won) entry->hedge_wins++;
+    }
+    pthread_mutex_unlock(&router_mutex);
+}
+
+// Pause before a retry: retry_backoff_ms doubling per attempt, drawn from its upper half
+long router_backoff_ms(const config_t *config, int attempt) {
+    long base = config->retry_backoff_ms;
+    for (int i = 0; i < attempt && base < ROUTER_MAX_BACKOFF_MS; i++) base *= 2;
+    if (base > ROUTER_MAX_BACKOFF_MS) base = ROUTER_MAX_BACKOFF_MS;
+    if (base <= 1) return base;
+
+    // Jitter keeps concurrent callers that failed together from retrying together
+    pthread_mutex_lock(&router_mutex);
+    if (router_random_state == 0) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        router_random_state = ((uint64_t)now.tv_sec << 32) ^ (uint64_t)now.tv_nsec ^ 0x9E3779B97F4A7C15ULL;
+    }
+    router_random_state ^= router_random_state << 13;
+    router_random_state ^= router_random_state >> 7;
+    router_random_state ^= router_random_state << 17;
+    uint64_t random = router_random_state;
+    pthread_mutex_unlock(&router_mutex);
+
+    return base / 2 + (long)(random % (uint64_t)(base / 2 + 1));
+}
+
+// Print per-endpoint latency, errors and hedges
+void log_router_stats(config_t *config) {
+    pthread_mutex_lock(&router_mutex);
+    for (router_endpoint_t *entry = router_endpoints; entry; entry = entry->next) {
+        if (entry->requests == 0) continue;
+        long succeeded = entry->requests - entry->failures;
+        log_message(config, VERBOSITY_VERBOSE,
+                   "%s%s Endpoint:%s %s: %ld requests, %ld failed, avg %.0fms, p50 %.0fms, p95 %.0fms, %ld hedges (%ld won)\n",
+                   C_EMPHASIS, entry->agent == AGENT_FAST ? "Fast" : "Reasoning", C_RESET, entry->endpoint,
+                   entry->requests, entry->failures, succeeded > 0 ? entry->total_latency_ms / succeeded : 0.0,
+                   latency_percentile(entry, 50), latency_percentile(entry, 95), entry->hedges, entry->hedge_wins);
+    }
+    pthread_mutex_unlock(&router_mutex);
+}
+
+void router_cleanup(void) {
+    pthread_mutex_lock(&router_mutex);
+    while (router_endpoints) {
+        router_endpoint_t *next = router_endpoints->next;
+        free(router_endpoints);
+        router_endpoints = next;
+    }
+    pthread_mutex_unlock(&router_mutex);
+}
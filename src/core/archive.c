@@ -0,0 +1,474 @@
+#include "archive.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define ARCHIVE_FILE_MAGIC "BEARCHV1"
+#define ARCHIVE_RECORD_MAGIC 0x43524542u            // "BERC"
+
+// File header, written once when the archive is created
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t problem_hash;                       // Resuming a different problem is refused
+    int64_t created;
+} archive_file_header_t;
+
+struct archive {
+    int fd;
+    char path[512];
+    const char *map;                             // Read-only mapping of the first map_size bytes
+    size_t map_size;
+    size_t file_size;                            // End of the last valid record
+    size_t *offsets;                             // Record offsets in append order
+    int count;
+    int capacity;
+    uint64_t next_id;
+};
+
+// FNV-1a over a byte range, continuing from hash
+static uint64_t fnv1a(const void *data, size_t length, uint64_t hash) {
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+#define FNV_OFFSET 14695981039346656037ULL
+
+// Checksum of a whole record, treating its checksum field as zero
+static uint32_t record_checksum(const archive_record_t *record) {
+    const char *bytes = (const char *)record;
+    size_t field = offsetof(archive_record_t, checksum);
+    uint32_t zero = 0;
+
+    uint64_t hash = fnv1a(bytes, field, FNV_OFFSET);
+    hash = fnv1a(&zero, sizeof(zero), hash);
+    hash = fnv1a(bytes + field + sizeof(uint32_t), record->size - field - sizeof(uint32_t), hash);
+    return (uint32_t)(hash ^ (hash >> 32));
+}
+
+// Size of a record with the given payload, padded to 8 bytes
+static size_t record_size(int region_count, size_t code_length, size_t error_length) {
+    size_t size = sizeof(archive_record_t) + (size_t)region_count * sizeof(uint64_t) +
+                  code_length + 1 + error_length + 1;
+    return (size + 7) / 8 * 8;
+}
+
+// Whether the bytes at offset hold a complete, intact record
+static int record_is_valid(const char *map, size_t offset, size_t file_size) {
+    if (file_size - offset < sizeof(archive_record_t) || offset % 8 != 0) return 0;
+
+    const archive_record_t *record = (const archive_record_t *)(map + offset);
+    if (record->magic != ARCHIVE_RECORD_MAGIC || record->size % 8 != 0 ||
+        record->size > file_size - offset || record->region_count < 0 ||
+        record->region_count > MAX_EVOLUTION_REGIONS) {
+        return 0;
+    }
+    if (record_size(record->region_count, record->code_length, record->error_length) != record->size) return 0;
+    return record_checksum(record) == record->checksum;
+}
+
+// Map the valid part of the file
+static int remap(archive_t *archive) {
+    if (archive->map) munmap((void *)archive->map, archive->map_size);
+    archive->map = NULL;
+    archive->map_size = 0;
+
+    void *map = mmap(NULL, archive->file_size, PROT_READ, MAP_SHARED, archive->fd, 0);
+    if (map == MAP_FAILED) return -1;
+    archive->map = map;
+    archive->map_size = archive->file_size;
+    return 0;
+}
+
+// Remember the offset of a record
+static int add_offset(archive_t *archive, size_t offset) {
+    if (archive->count == archive->capacity) {
+        int capacity = archive->capacity ? archive->capacity * 2 : 64;
+        size_t *offsets = realloc(archive->offsets, capacity * sizeof(size_t));
+        if (!offsets) return -1;
+        archive->offsets = offsets;
+        archive->capacity = capacity;
+    }
+    archive->offsets[archive->count++] = offset;
+    return 0;
+}
+
+// Write all of buffer at offset
+static int write_all(int fd, const char *buffer, size_t length, size_t offset) {
+    while (length > 0) {
+        ssize_t written = pwrite(fd, buffer, length, (off_t)offset);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return -1;
+        buffer += written;
+        length -= (size_t)written;
+        offset += (size_t)written;
+    }
+    return 0;
+}
+
+// Open an archive; peers are opened read-only, quietly, and never repaired
+static archive_t* open_archive(const char *path, const char *problem, int writable) {
+    if (!path || strlen(path) == 0) return NULL;
+
+    archive_t *archive = calloc(1, sizeof(archive_t));
+    if (!archive) return NULL;
+    snprintf(archive->path, sizeof(archive->path), "%s", path);
+    archive->next_id = 1;
+
+    archive->fd = writable ? open(path, O_RDWR | O_CREAT, 0644) : open(path, O_RDONLY);
+    if (archive->fd < 0) {
+        if (writable) fprintf(stderr, "Warning: Cannot open archive '%s': %s\n", path, strerror(errno));
+        free(archive);
+        return NULL;
+    }
+
+    uint64_t problem_hash = fnv1a(problem ? problem : "", problem ? strlen(problem) : 0, FNV_OFFSET);
+    struct stat st;
+    if (fstat(archive->fd, &st) != 0) {
+        archive_close(archive);
+        return NULL;
+    }
+
+    archive_file_header_t header;
+    if (st.st_size == 0) {
+        if (!writable) {
+            archive_close(archive);
+            return NULL;
+        }
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, ARCHIVE_FILE_MAGIC, sizeof(header.magic));
+        header.version = ARCHIVE_VERSION;
+        header.header_size = sizeof(header);
+        header.problem_hash = problem_hash;
+        header.created = (int64_t)time(NULL);
+        if (write_all(archive->fd, (const char *)&header, sizeof(header), 0) != 0) {
+            fprintf(stderr, "Warning: Cannot write archive '%s': %s\n", path, strerror(errno));
+            archive_close(archive);
+            return NULL;
+        }
+        archive->file_size = sizeof(header);
+        return archive;
+    }
+
+    if ((size_t)st.st_size < sizeof(header) || pread(archive->fd, &header, sizeof(header), 0) != sizeof(header) ||
+        memcmp(header.magic, ARCHIVE_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != ARCHIVE_VERSION || header.header_size != sizeof(header)) {
+        if (writable) fprintf(stderr, "Warning: '%s' is not a version %d archive, not using it\n", path, ARCHIVE_VERSION);
+        archive_close(archive);
+        return NULL;
+    }
+    if (header.problem_hash != problem_hash) {
+        if (writable) fprintf(stderr, "Warning: Archive '%s' belongs to a different problem, not using it\n", path);
+        archive_close(archive);
+        return NULL;
+    }
+
+    // Index every intact record; anything after the first bad one is a torn append
+    archive->file_size = (size_t)st.st_size;
+    if (remap(archive) != 0) {
+        if (writable) fprintf(stderr, "Warning: Cannot map archive '%s': %s\n", path, strerror(errno));
+        archive_close(archive);
+        return NULL;
+    }
+
+    size_t offset = sizeof(header);
+    while (offset < archive->file_size && record_is_valid(archive->map, offset, archive->file_size)) {
+        const archive_record_t *record = (const archive_record_t *)(archive->map + offset);
+        if (add_offset(archive, offset) != 0) break;
+        if (record->id >= archive->next_id) archive->next_id = record->id + 1;
+        offset += record->size;
+    }
+
+    // A peer may be in the middle of an append: ignore the tail instead
+    if (offset < archive->file_size && writable) {
+        fprintf(stderr, "Warning: Dropping %zu bytes of an incomplete record at the end of archive '%s'\n",
+                archive->file_size - offset, path);
+        if (ftruncate(archive->fd, (off_t)offset) != 0) {
+            archive_close(archive);
+            return NULL;
+        }
+        archive->file_size = offset;
+        if (remap(archive) != 0) {
+            archive_close(archive);
+            return NULL;
+        }
+    }
+    archive->file_size = offset;
+    return archive;
+}
+
+// Open or create an archive
+archive_t* archive_open(const char *path, const char *problem) {
+    return open_archive(path, problem, 1);
+}
+
+// Open another node's archive for reading
+archive_t* archive_open_peer(const char *path, const char *problem) {
+    return open_archive(path, problem, 0);
+}
+
+// Close an archive
+void archive_close(archive_t *archive) {
+    if (!archive) return;
+    if (archive->map) munmap((void *)archive->map, archive->map_size);
+    if (archive->fd >= 0) close(archive->fd);
+    free(archive->offsets);
+    free(archive);
+}
+
+// Hash the body of every evolution region of code, in file order
+static int hash_regions(const char *code, uint64_t *hashes) {
+    int count = 0;
+    const char *cursor = code;
+    while (count < MAX_EVOLUTION_REGIONS && (cursor = strstr(cursor, EVOLUTION_MARKER_START))) {
+        const char *body = strchr(cursor, '\n');
+        if (!body) break;
+        body++;
+
+        const char *end = strstr(body, EVOLUTION_MARKER_END);
+        if (!end) break;
+        const char *body_end = end;
+        while (body_end > body && body_end[-1] != '\n') body_end--;
+
+        hashes[count++] = fnv1a(body, (size_t)(body_end - body), FNV_OFFSET);
+        cursor = end + strlen(EVOLUTION_MARKER_END);
+    }
+    return count;
+}
+
+// Append a record
+uint64_t archive_append(archive_t *archive, const archive_record_t *meta, const char *code, const char *errors) {
+    if (!archive || !meta || !code) return 0;
+    if (!errors) errors = "";
+
+    uint64_t hashes[MAX_EVOLUTION_REGIONS];
+    int region_count = hash_regions(code, hashes);
+    size_t code_length = strlen(code);
+    size_t error_length = strlen(errors);
+    if (code_length > UINT32_MAX / 2 || error_length > UINT32_MAX / 2) return 0;
+
+    size_t size = record_size(region_count, code_length, error_length);
+    char *buffer = calloc(1, size);
+    if (!buffer) return 0;
+
+    archive_record_t *record = (archive_record_t *)buffer;
+    *record = *meta;
+    record->magic = ARCHIVE_RECORD_MAGIC;
+    record->size = (uint32_t)size;
+    record->id = archive->next_id;
+    record->code_hash = fnv1a(code, code_length, FNV_OFFSET);
+    record->region_count = region_count;
+    record->code_length = (uint32_t)code_length;
+    record->error_length = (uint32_t)error_length;
+    record->reserved = 0;
+    record->timestamp = (int64_t)time(NULL);
+
+    char *payload = buffer + sizeof(archive_record_t);
+    memcpy(payload, hashes, (size_t)region_count * sizeof(uint64_t));
+    payload += (size_t)region_count * sizeof(uint64_t);
+    memcpy(payload, code, code_length + 1);
+    memcpy(payload + code_length + 1, errors, error_length + 1);
+    record->checksum = record_checksum(record);
+
+    // The record only counts once it is fully on disk
+    if (write_all(archive->fd, buffer, size, archive->file_size) != 0 || fdatasync(archive->fd) != 0) {
+        fprintf(stderr, "Warning: Cannot append to archive '%s': %s\n", archive->path, strerror(errno));
+        // A torn record left behind is dropped when the archive is reopened
+        if (ftruncate(archive->fd, (off_t)archive->file_size) != 0) {
+            fprintf(stderr, "Warning: Cannot truncate archive '%s'\n", archive->path);
+        }
+        free(buffer);
+        return 0;
+    }
+    free(buffer);
+
+    if (add_offset(archive, archive->file_size) != 0) return 0;
+    archive->file_size += size;
+    return archive->next_id++;
+}
+
+// Number of records
+int archive_count(archive_t *archive) {
+    return archive ? archive->count : 0;
+}
+
+// Record by index, remapping when it was appended after the last mapping
+const archive_record_t* archive_get(archive_t *archive, int index) {
+    if (!archive || index < 0 || index >= archive->count) return NULL;
+    if (archive->map_size < archive->file_size && remap(archive) != 0) return NULL;
+    return (const archive_record_t *)(archive->map + archive->offsets[index]);
+}
+
+// Indices of the survivors of the newest archived generation, best first
+int archive_latest_survivors(archive_t *archive, int *indices, int max_indices) {
+    int last = archive_count(archive) - 1;
+    while (last >= 0 && !(archive_get(archive, last)->flags & ARCHIVE_SURVIVOR)) last--;
+    if (last < 0) return 0;
+
+    // A generation's records are appended together
+    const archive_record_t *newest = archive_get(archive, last);
+    int generation = newest->generation;
+    int iteration = newest->iteration;
+    int first = last;
+    while (first > 0) {
+        const archive_record_t *record = archive_get(archive, first - 1);
+        if (record->generation != generation || record->iteration != iteration) break;
+        first--;
+    }
+
+    // Insertion sort by fitness; earlier records win ties
+    int count = 0;
+    for (int i = first; i <= last; i++) {
+        const archive_record_t *record = archive_get(archive, i);
+        if (!(record->flags & ARCHIVE_SURVIVOR)) continue;
+
+        int pos = count < max_indices ? count++ : max_indices;
+        while (pos > 0 && archive_get(archive, indices[pos - 1])->fitness < record->fitness) {
+            if (pos < max_indices) indices[pos] = indices[pos - 1];
+            pos--;
+        }
+        if (pos < max_indices) indices[pos] = i;
+    }
+    return count;
+}
+
+// Region hashes of a record
+const uint64_t* archive_region_hashes(const archive_record_t *record) {
+    return (const uint64_t *)(record + 1);
+}
+
+// Code of a record
+const char* archive_code(const archive_record_t *record) {
+    return (const char *)(archive_region_hashes(record) + record->region_count);
+}
+
+// Error output of a record
+const char* archive_errors(const archive_record_t *record) {
+    return archive_code(record) + record->code_length + 1;
+}
+
+// Test flags and fitness of a test result
+void archive_record_test(archive_record_t *meta, const test_result_t *result) {
+    if (!meta || !result) return;
+
+    meta->flags &= ~(ARCHIVE_SYNTAX_OK | ARCHIVE_COMPILED | ARCHIVE_EXECUTED);
+    meta->fitness = 0.0;
+    if (result->syntax_ok) {
+        meta->flags |= ARCHIVE_SYNTAX_OK;
+        meta->fitness += 0.3;
+    }
+    if (result->compilation_ok) {
+        meta->flags |= ARCHIVE_COMPILED;
+        meta->fitness += 0.3;
+    }
+    if (result->execution_ok) {
+        meta->flags |= ARCHIVE_EXECUTED;
+        meta->fitness += 0.4;
+    }
+}
+
+// Scores and metrics of a comprehensive evaluation
+void archive_record_evaluation(archive_record_t *meta, const evaluation_result_t *result) {
+    if (!meta || !result) return;
+
+    meta->flags |= ARCHIVE_EVALUATED;
+    if (result->passed_criteria) meta->flags |= ARCHIVE_PASSED;
+    meta->fitness = result->overall_score / 100.0;
+    meta->overall_score = result->overall_score;
+    meta->correctness_score = result->correctness_score;
+    meta->performance_score = result->performance_score;
+    meta->quality_score = result->quality_score;
+    meta->execution_time_ms = result->performance.execution_time_ms;
+    meta->p95_time_ms = result->performance.p95_time_ms;
+    meta->stddev_time_ms = result->performance.stddev_time_ms;
+    meta->throughput = result->performance.throughput;
+    meta->memory_usage_kb = result->performance.memory_usage_kb;
+    meta->lines_of_code = result->quality.lines_of_code;
+    meta->cyclomatic_complexity = result->quality.cyclomatic_complexity;
+    meta->maintainability_index = result->quality.maintainability_index;
+}
+
+// Evaluation history entry of an evaluated record
+static void record_to_evaluation(const archive_record_t *record, evaluation_result_t *result) {
+    memset(result, 0, sizeof(evaluation_result_t));
+    result->overall_score = record->overall_score;
+    result->correctness_score = record->correctness_score;
+    result->performance_score = record->performance_score;
+    result->quality_score = record->quality_score;
+    result->performance.execution_time_ms = record->execution_time_ms;
+    result->performance.p95_time_ms = record->p95_time_ms;
+    result->performance.stddev_time_ms = record->stddev_time_ms;
+    result->performance.throughput = record->throughput;
+    result->performance.memory_usage_kb = (long)record->memory_usage_kb;
+    result->quality.lines_of_code = record->lines_of_code;
+    result->quality.cyclomatic_complexity = record->cyclomatic_complexity;
+    result->quality.maintainability_index = record->maintainability_index;
+    result->test_result.syntax_ok = (record->flags & ARCHIVE_SYNTAX_OK) != 0;
+    result->test_result.compilation_ok = (record->flags & ARCHIVE_COMPILED) != 0;
+    result->test_result.execution_ok = (record->flags & ARCHIVE_EXECUTED) != 0;
+    result->evaluation_timestamp = (time_t)record->timestamp;
+    result->passed_criteria = (record->flags & ARCHIVE_PASSED) != 0;
+}
+
+// Restore the last selected solution of an interrupted run
+int archive_resume(archive_t *archive, conversation_t *conv, uint64_t *parent_id) {
+    if (parent_id) *parent_id = 0;
+    if (!archive || !conv || !conv->config) return 0;
+    config_t *config = conv->config;
+
+    int last = -1;
+    for (int i = archive_count(archive) - 1; i >= 0 && last < 0; i--) {
+        const archive_record_t *record = archive_get(archive, i);
+        if (record && (record->flags & ARCHIVE_SELECTED)) last = i;
+    }
+    if (last < 0) return 0;
+
+    const archive_record_t *record = archive_get(archive, last);
+    if (record->code_length >= (uint32_t)config->max_code_size) {
+        fprintf(stderr, "Warning: Archived solution exceeds max_code_size, not resuming\n");
+        return 0;
+    }
+    memcpy(conv->current_solution, archive_code(record), record->code_length + 1);
+
+    // The next prompt sees the errors the solution was left with
+    test_result_t test_result = {0};
+    test_result.error_message = calloc(1, config->max_response_size);
+    test_result.output = calloc(1, config->max_response_size);
+    if (test_result.error_message) {
+        snprintf(test_result.error_message, config->max_response_size, "%s", archive_errors(record));
+    }
+    test_result.syntax_ok = (record->flags & ARCHIVE_SYNTAX_OK) != 0;
+    test_result.compilation_ok = (record->flags & ARCHIVE_COMPILED) != 0;
+    test_result.execution_ok = (record->flags & ARCHIVE_EXECUTED) != 0;
+    cleanup_test_result(&conv->last_test_result);
+    conv->last_test_result = test_result;
+
+    // Evaluations of the solutions that were kept, for progress comparisons
+    if (config->save_evaluation_history) {
+        for (int i = 0; i <= last; i++) {
+            const archive_record_t *entry = archive_get(archive, i);
+            if (!entry || (entry->flags & (ARCHIVE_SELECTED | ARCHIVE_EVALUATED)) != (ARCHIVE_SELECTED | ARCHIVE_EVALUATED)) {
+                continue;
+            }
+            evaluation_result_t evaluation;
+            record_to_evaluation(entry, &evaluation);
+            save_evaluation_history(&conv->evolution, &evaluation);
+        }
+    }
+
+    if (conv->evolution.evolution_enabled) {
+        parse_evolution_regions(&conv->evolution, conv->current_solution);
+    }
+
+    record = archive_get(archive, last);
+    if (parent_id) *parent_id = record->id;
+    return record->iteration;
+}
@@ -0,0 +1,312 @@
+#include "batch.h"
+#include "json.h"
+#include "threadpool.h"
+#include <ctype.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <sys/stat.h>
+
+// One job of a batch
+typedef struct {
+    int index;
+    char name[160];                              // NNN-basename, also the output directory name
+    char source[1024];                           // Prompt file or evolution target
+    char prompt_file[1024];                      // Problem of an evolution target ("" = batch problem)
+    int evolution;                               // source is an evolution target
+    char output_dir[1024];
+    char fallback_problem[1200];                 // Problem of a target without any prompt
+    const char *batch_problem;
+    config_t config;                             // Copy of the batch configuration
+    int status;                                  // run_collaboration result (-1 = not started)
+    double wall_time_ms;
+} batch_job_t;
+
+// Shared state of a batch run
+typedef struct {
+    batch_job_t *jobs;
+    int job_count;
+    int finished;
+    int failed;
+    config_t *config;
+    pthread_mutex_t mutex;
+} batch_run_t;
+
+typedef struct {
+    batch_run_t *batch;
+    batch_job_t *job;
+} batch_task_t;
+
+// Milliseconds since start
+static double elapsed_since(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000.0 + (now.tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+// File name of path without directories
+static const char* path_basename(const char *path) {
+    const char *slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+// Whether path ends in extension
+static int has_extension(const char *path, const char *extension) {
+    size_t length = strlen(path), extension_length = strlen(extension);
+    return length > extension_length && strcmp(path + length - extension_length, extension) == 0;
+}
+
+// Format a path of job into a buffer of size bytes; returns -1 with an error if it does not fit
+static int format_job_path(const batch_job_t *job, char *path, size_t size, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(path, size, format, args);
+    va_end(args);
+    if (length < 0 || (size_t)length >= size) {
+        fprintf(stderr, "Error: Batch job %s: path longer than %zu bytes\n", job->name, size - 1);
+        return -1;
+    }
+    return 0;
+}
+
+// NNN-basename without extension, limited to characters safe in a directory name
+static void make_job_name(batch_job_t *job) {
+    char stem[128];
+    snprintf(stem, sizeof(stem), "%s", path_basename(job->source));
+    char *dot = strrchr(stem, '.');
+    if (dot && dot != stem) *dot = '\0';
+    for (char *p = stem; *p; p++) {
+        if (!isalnum((unsigned char)*p) && *p != '-' && *p != '_' && *p != '.') *p = '_';
+    }
+    snprintf(job->name, sizeof(job->name), "%03d-%s", job->index + 1, stem);
+}
+
+// Read the job list; returns the number of jobs or -1 if it cannot be read
+static int load_job_list(const char *path, batch_job_t **jobs_out) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot open batch job list %s\n", path);
+        return -1;
+    }
+
+    batch_job_t *jobs = NULL;
+    int count = 0, capacity = 0;
+    char line[2560];
+    while (fgets(line, sizeof(line), file)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        char *source = line;
+        while (*source == ' ' || *source == '\t') source++;
+        if (*source == '\0' || *source == '#') continue;
+
+        // "<source> [prompt file]"
+        char *prompt = source + strcspn(source, " \t");
+        if (*prompt) {
+            *prompt++ = '\0';
+            while (*prompt == ' ' || *prompt == '\t') prompt++;
+            prompt[strcspn(prompt, " \t")] = '\0';
+        }
+        if (strlen(source) >= sizeof(jobs[0].source) || strlen(prompt) >= sizeof(jobs[0].prompt_file)) {
+            printf("Warning: Batch job path too long, ignoring: %.80s...\n", source);
+            continue;
+        }
+
+        if (count == capacity) {
+            int new_capacity = capacity ? capacity * 2 : 16;
+            batch_job_t *larger = realloc(jobs, new_capacity * sizeof(batch_job_t));
+            if (!larger) break;
+            jobs = larger;
+            capacity = new_capacity;
+        }
+        batch_job_t *job = &jobs[count];
+        memset(job, 0, sizeof(batch_job_t));
+        job->index = count;
+        job->status = -1;
+        strcpy(job->source, source);
+        strcpy(job->prompt_file, prompt);
+        job->evolution = !has_extension(source, ".prompt");
+        if (!job->evolution && strlen(prompt) > 0) {
+            printf("Warning: Batch job %s is a prompt file, ignoring '%s'\n", source, prompt);
+            job->prompt_file[0] = '\0';
+        }
+        make_job_name(job);
+        count++;
+    }
+    fclose(file);
+
+    *jobs_out = jobs;
+    return count;
+}
+
+// Give a job its own copy of the configuration and its own output files; returns 0 on success
+static int prepare_job(batch_job_t *job, const config_t *base) {
+    // Shallow copy: the test cases stay owned (and freed) by the batch configuration
+    job->config = *base;
+    config_t *config = &job->config;
+    config->loaded_problem_prompt = NULL;
+
+    if (format_job_path(job, job->output_dir, sizeof(job->output_dir), "%s/%s", base->batch_output_dir, job->name) != 0 ||
+        format_job_path(job, config->output_dir, sizeof(config->output_dir), "%s", job->output_dir) != 0) {
+        return -1;
+    }
+    if (mkdir(job->output_dir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Error: Cannot create %s: %s\n", job->output_dir, strerror(errno));
+        return -1;
+    }
+
+    if (job->evolution) {
+        config->enable_evolution = 1;
+        if (format_job_path(job, config->evolution_file_path, sizeof(config->evolution_file_path), "%s", job->source) != 0) {
+            return -1;
+        }
+    } else {
+        config->enable_evolution = 0;
+        config->evolution_file_path[0] = '\0';
+    }
+
+    // Archives, islands and reports of different problems must not mix
+    if (strlen(base->island_dir) > 0) {
+        if (format_job_path(job, config->island_dir, sizeof(config->island_dir), "%s/%s", base->island_dir, job->name) != 0 ||
+            format_job_path(job, config->archive_file, sizeof(config->archive_file), "%s/%s.archive",
+                            config->island_dir, config->island_name) != 0) {
+            return -1;
+        }
+        mkdir(config->island_dir, 0755);
+    } else if (strlen(base->archive_file) > 0 &&
+               format_job_path(job, config->archive_file, sizeof(config->archive_file), "%s/%s",
+                               job->output_dir, path_basename(base->archive_file)) != 0) {
+        return -1;
+    }
+    if (strlen(base->evaluation_output_file) > 0 &&
+        format_job_path(job, config->evaluation_output_file, sizeof(config->evaluation_output_file), "%s/%s",
+                        job->output_dir, path_basename(base->evaluation_output_file)) != 0) {
+        return -1;
+    }
+
+    const char *prompt_file = job->evolution ? job->prompt_file : job->source;
+    if (strlen(prompt_file) > 0 && load_problem_prompt_file(config, prompt_file) != 0) {
+        return -1;
+    }
+    if (job->evolution && strlen(job->prompt_file) == 0 && !job->batch_problem) {
+        snprintf(job->fallback_problem, sizeof(job->fallback_problem),
+                 "Improve the code in the BETA EVOLVE regions of %s.", path_basename(job->source));
+    }
+    return 0;
+}
+
+// Run one job (pool task)
+static void run_batch_job(void *arg) {
+    batch_task_t *task = (batch_task_t *)arg;
+    batch_run_t *batch = task->batch;
+    batch_job_t *job = task->job;
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    log_message(batch->config, VERBOSITY_NORMAL, "%s▶ Job %d/%d: %s%s\n", C_INFO, job->index + 1, batch->job_count,
+               job->source, C_RESET);
+
+    if (prepare_job(job, batch->config) == 0) {
+        const char *problem = job->config.loaded_problem_prompt ? job->config.loaded_problem_prompt
+                            : job->batch_problem ? job->batch_problem : job->fallback_problem;
+        job->status = run_collaboration(problem, &job->config);
+    }
+    job->wall_time_ms = elapsed_since(&start);
+    free(job->config.loaded_problem_prompt);
+    job->config.loaded_problem_prompt = NULL;
+
+    pthread_mutex_lock(&batch->mutex);
+    batch->finished++;
+    if (job->status != 0) batch->failed++;
+    int finished = batch->finished;
+    pthread_mutex_unlock(&batch->mutex);
+
+    log_message(batch->config, VERBOSITY_NORMAL, "%s%s Job %d/%d: %s %s in %.1fs (%d/%d done)%s\n",
+               job->status == 0 ? C_SUCCESS : C_ERROR, job->status == 0 ? "✅" : "❌", job->index + 1,
+               batch->job_count, job->name, job->status == 0 ? "finished" : "failed",
+               job->wall_time_ms / 1000.0, finished, batch->job_count, C_RESET);
+}
+
+// Write one JSON line per job to batch_output_dir/summary.jsonl
+static void write_batch_summary(const batch_run_t *batch) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/summary.jsonl", batch->config->batch_output_dir);
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Warning: Cannot write batch summary %s\n", path);
+        return;
+    }
+
+    for (int i = 0; i < batch->job_count; i++) {
+        const batch_job_t *job = &batch->jobs[i];
+        cJSON *record = cJSON_CreateObject();
+        if (!record) continue;
+        cJSON_AddStringToObject(record, "job", job->name);
+        cJSON_AddStringToObject(record, "source", job->source);
+        cJSON_AddStringToObject(record, "kind", job->evolution ? "evolution" : "prompt");
+        cJSON_AddStringToObject(record, "status", job->status == 0 ? "ok" : "failed");
+        cJSON_AddNumberToObject(record, "wall_ms", job->wall_time_ms);
+        cJSON_AddStringToObject(record, "output_dir", job->output_dir);
+        char *line = cJSON_PrintUnformatted(record);
+        if (line) {
+            fprintf(file, "%s\n", line);
+            free(line);
+        }
+        cJSON_Delete(record);
+    }
+    fclose(file);
+}
+
+// Run every job of job_list on batch_jobs workers
+int run_batch(const char *job_list, const char *problem, config_t *config) {
+    batch_run_t batch;
+    memset(&batch, 0, sizeof(batch));
+    batch.config = config;
+    batch.job_count = load_job_list(job_list, &batch.jobs);
+    if (batch.job_count < 0) return 1;
+    if (batch.job_count == 0) {
+        fprintf(stderr, "Error: Batch job list %s names no jobs\n", job_list);
+        free(batch.jobs);
+        return 1;
+    }
+    if (mkdir(config->batch_output_dir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Error: Cannot create %s: %s\n", config->batch_output_dir, strerror(errno));
+        free(batch.jobs);
+        return 1;
+    }
+
+    batch_task_t *tasks = calloc(batch.job_count, sizeof(batch_task_t));
+    if (!tasks) {
+        free(batch.jobs);
+        return 1;
+    }
+    pthread_mutex_init(&batch.mutex, NULL);
+
+    int workers = config->batch_jobs < batch.job_count ? config->batch_jobs : batch.job_count;
+    log_message(config, VERBOSITY_NORMAL, "%s📦 Batch: %d jobs, %d at once, output in %s%s\n\n",
+               C_INFO, batch.job_count, workers, config->batch_output_dir, C_RESET);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // Jobs start in list order as workers free up
+    threadpool_t *pool = workers > 1 ? threadpool_create(workers) : NULL;
+    for (int i = 0; i < batch.job_count; i++) {
+        batch.jobs[i].batch_problem = problem;
+        tasks[i].batch = &batch;
+        tasks[i].job = &batch.jobs[i];
+        if (!pool || threadpool_submit(pool, run_batch_job, &tasks[i]) != 0) {
+            run_batch_job(&tasks[i]);
+        }
+    }
+    if (pool) threadpool_destroy(pool);
+
+    write_batch_summary(&batch);
+    log_message(config, VERBOSITY_NORMAL, "\n%s📦 Batch: %d/%d jobs succeeded in %.1fs (summary in %s/summary.jsonl)%s\n",
+               batch.failed == 0 ? C_SUCCESS : C_WARNING, batch.job_count - batch.failed, batch.job_count,
+               elapsed_since(&start) / 1000.0, config->batch_output_dir, C_RESET);
+
+    int failed = batch.failed;
+    pthread_mutex_destroy(&batch.mutex);
+    free(tasks);
+    free(batch.jobs);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,880 @@
+#include "benchmark.h"
+#include "workspace.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+extern char **environ;
+
+// Hardware counters collected per profiled run
+typedef enum {
+    COUNTER_CYCLES,
+    COUNTER_INSTRUCTIONS,
+    COUNTER_L1D_MISSES,
+    COUNTER_LLC_MISSES,
+    COUNTER_BRANCH_MISSES,
+    COUNTER_COUNT
+} counter_id_t;
+
+// Benchmarks run one at a time so concurrent evaluations do not disturb each other
+static pthread_mutex_t benchmark_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Process start cost, measured once with an empty program (guarded by benchmark_mutex)
+static int startup_measured = 0;
+static double startup_overhead_ms = 0.0;
+static long long startup_counters[COUNTER_COUNT];
+static int startup_counters_available = 0;
+static int counters_warning_shown = 0;
+
+// Allocation shim resolved once (guarded by benchmark_mutex)
+static int shim_resolved = 0;
+static char shim_path[1024];
+
+// Kernel runner kept alive across kernel benchmarks (guarded by benchmark_mutex)
+#define KERNEL_RUNNER_MAX_LIBRARIES 64          // Candidates served before the runner is replaced
+static int runner_resolved = 0;
+static char runner_path[1024];
+static pid_t runner_pid = -1;
+static int runner_channel = -1;
+static int runner_libraries = 0;
+static long runner_memory_mb = 0;               // Limits the runner was started with
+static int runner_max_processes = 0;
+static int runner_cpu = -1;
+
+// Two-sided 95% critical values of Student's t for 1..30 degrees of freedom
+static const double t_critical_95[] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+};
+
+// 95% critical t value for the given degrees of freedom
+static double t_critical(double degrees_of_freedom) {
+    if (degrees_of_freedom < 1.0) return t_critical_95[0];
+    if (degrees_of_freedom > 30.0) return 1.96;
+    return t_critical_95[(int)degrees_of_freedom - 1];
+}
+
+// Milliseconds between two monotonic timestamps
+static double elapsed_ms(const struct timespec *start, const struct timespec *end) {
+    return (end->tv_sec - start->tv_sec) * 1000.0 + (end->tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Command line and environment of a sized benchmark run, built before forking
+typedef struct {
+    char *argv[3];
+    char **envp;
+} run_args_t;
+
+// Optional pinning keeps benchmarks on one core (less migration noise)
+static void pin_benchmark_cpu(int cpu) {
+#ifdef __linux__
+    if (cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        sched_setaffinity(0, sizeof(set), &set);
+    }
+#else
+    (void)cpu;
+#endif
+}
+
+// Child side of a benchmark run: limit, pin, silence output and exec the binary
+// (with args' command line and environment when args is set)
+static void exec_benchmark_child(const char *binary_path, const run_args_t *args, config_t *config) {
+    process_limits_t limits = candidate_process_limits(config);
+    process_apply_limits(&limits);
+    pin_benchmark_cpu(config->benchmark_cpu);
+
+    // Terminal output would dominate the timing
+    int null_fd = open("/dev/null", O_WRONLY);
+    if (null_fd >= 0) {
+        dup2(null_fd, STDOUT_FILENO);
+        dup2(null_fd, STDERR_FILENO);
+        close(null_fd);
+    }
+    if (args) {
+        execve(binary_path, args->argv, args->envp);
+    } else {
+        execl(binary_path, binary_path, (char *)NULL);
+    }
+    _exit(127);
+}
+
+// Run the binary once; returns wall time in ms or a negative value on failure
+static double run_once(const char *binary_path, const run_args_t *args, config_t *config, struct rusage *usage) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        exec_benchmark_child(binary_path, args, config);
+    }
+    if (pid < 0) return -1.0;
+
+    int status;
+    process_limits_t limits = candidate_process_limits(config);
+    process_status_t run_status = process_wait(pid, &limits, &start, &status, usage);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    // A crashed or failing run did not do the work it is timed for
+    if (run_status != PROCESS_OK) {
+        log_message(config, VERBOSITY_DEBUG, "Benchmark: run stopped (%s)\n", process_status_name(run_status));
+        return -1.0;
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        log_message(config, VERBOSITY_DEBUG, "Benchmark: run exited with status %d\n",
+                   WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+        return -1.0;
+    }
+    return elapsed_ms(&start, &end);
+}
+
+#ifdef __linux__
+// Open one counter on pid, armed to start when the child calls exec
+static int open_counter(counter_id_t id, pid_t pid) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.disabled = 1;
+    attr.enable_on_exec = 1;
+    attr.inherit = 1;                            // Include threads and children of the candidate
+    attr.exclude_kernel = 1;                     // Allowed at perf_event_paranoid <= 2
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    switch (id) {
+        case COUNTER_CYCLES:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case COUNTER_INSTRUCTIONS:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case COUNTER_L1D_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_L1D |
+                          (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        case COUNTER_LLC_MISSES:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        case COUNTER_BRANCH_MISSES:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        default:
+            return -1;
+    }
+
+    return (int)syscall(__NR_perf_event_open, &attr, pid, -1, -1, PERF_FLAG_FD_CLOEXEC);
+}
+
+// Read a counter, scaling for time it was multiplexed off the PMU
+static long long read_counter(int fd) {
+    struct { uint64_t value, time_enabled, time_running; } data;
+    if (fd < 0 || read(fd, &data, sizeof(data)) != (ssize_t)sizeof(data)) return -1;
+    if (data.time_running == 0) return data.time_enabled == 0 ? (long long)data.value : -1;
+    if (data.time_running < data.time_enabled) {
+        return (long long)((double)data.value * data.time_enabled / data.time_running);
+    }
+    return (long long)data.value;
+}
+#endif
+
+// Run the binary once under hardware counters; returns 0 if cycles and instructions were counted
+static int count_once(const char *binary_path, config_t *config, long long counts[COUNTER_COUNT]) {
+#ifdef __linux__
+    int go[2];
+    if (pipe(go) != 0) return -1;
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        // Wait until the parent has attached the counters
+        char ready;
+        close(go[1]);
+        if (read(go[0], &ready, 1) != 1) _exit(127);
+        close(go[0]);
+        exec_benchmark_child(binary_path, NULL, config);
+    }
+    close(go[0]);
+    if (pid < 0) {
+        close(go[1]);
+        return -1;
+    }
+
+    int fds[COUNTER_COUNT];
+    int open_error = 0;
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        fds[i] = open_counter((counter_id_t)i, pid);
+        if (fds[i] < 0 && i <= COUNTER_INSTRUCTIONS && !open_error) open_error = errno;
+    }
+
+    // Unblock the child even when counting failed so it does not linger
+    char ready = 1;
+    if (write(go[1], &ready, 1) != 1) open_error = open_error ? open_error : EPIPE;
+    close(go[1]);
+
+    int status = 0;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    process_limits_t limits = candidate_process_limits(config);
+    process_status_t run_status = process_wait(pid, &limits, &start, &status, NULL);
+
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        counts[i] = read_counter(fds[i]);
+        if (fds[i] >= 0) close(fds[i]);
+    }
+
+    if (open_error) {
+        if (!counters_warning_shown) {
+            counters_warning_shown = 1;
+            log_message(config, VERBOSITY_VERBOSE,
+                       "Hardware counters unavailable (%s), reporting timing only\n", strerror(open_error));
+        }
+        return -1;
+    }
+    if (run_status != PROCESS_OK || !WIFEXITED(status) || WEXITSTATUS(status) != 0) return -1;
+    return (counts[COUNTER_CYCLES] >= 0 && counts[COUNTER_INSTRUCTIONS] >= 0) ? 0 : -1;
+#else
+    (void)binary_path; (void)config; (void)counts;
+    return -1;
+#endif
+}
+
+// Profile one run with hardware counters and store them, net of start-up counts
+static void collect_counters(const char *binary_path, config_t *config, performance_metrics_t *metrics) {
+    long long counts[COUNTER_COUNT];
+    metrics->counters_available = 0;
+    if (!config->enable_hardware_counters || count_once(binary_path, config, counts) != 0) return;
+
+    if (startup_counters_available) {
+        for (int i = 0; i < COUNTER_COUNT; i++) {
+            if (counts[i] < 0 || startup_counters[i] < 0) continue;
+            counts[i] = counts[i] > startup_counters[i] ? counts[i] - startup_counters[i] : 0;
+        }
+    }
+
+    metrics->counters_available = 1;
+    metrics->cycles = counts[COUNTER_CYCLES];
+    metrics->instructions = counts[COUNTER_INSTRUCTIONS];
+    metrics->ipc = metrics->cycles > 0 ? (double)metrics->instructions / metrics->cycles : 0.0;
+    metrics->l1d_misses = counts[COUNTER_L1D_MISSES];
+    metrics->llc_misses = counts[COUNTER_LLC_MISSES];
+    metrics->branch_misses = counts[COUNTER_BRANCH_MISSES];
+    if (metrics->llc_misses >= 0) {
+        metrics->cache_misses = metrics->llc_misses > INT_MAX ? INT_MAX : (int)metrics->llc_misses;
+    }
+}
+
+// Resolve a helper built by the Makefile: configured when set, otherwise file_name
+// next to the executable. Fills path with its absolute path, or with the name
+// that was looked for and returns -1 when it is missing or its path is too long.
+static int resolve_helper(const char *configured, const char *file_name, int mode, char *path, size_t path_size) {
+    char candidate[1024] = "";
+    int length = 0;
+    if (strlen(configured) > 0) {
+        length = snprintf(candidate, sizeof(candidate), "%s", configured);
+    } else {
+        // Installed next to the executable by the Makefile
+        char executable[1024];
+        ssize_t executable_length = readlink("/proc/self/exe", executable, sizeof(executable) - 1);
+        if (executable_length > 0) {
+            executable[executable_length] = '\0';
+            char *slash = strrchr(executable, '/');
+            if (slash) *slash = '\0';
+            length = snprintf(candidate, sizeof(candidate), "%s/%s", executable, file_name);
+        }
+    }
+    if (length < 0 || (size_t)length >= sizeof(candidate)) {
+        fprintf(stderr, "Error: Path of %s is longer than %zu bytes\n", file_name, sizeof(candidate) - 1);
+        snprintf(path, path_size, "%s", file_name);
+        return -1;
+    }
+
+    // The dynamic loader needs an absolute path
+    char resolved[PATH_MAX];
+    if (strlen(candidate) == 0 || !realpath(candidate, resolved) || access(resolved, mode) != 0) {
+        snprintf(path, path_size, "%s", strlen(candidate) > 0 ? candidate : file_name);
+        return -1;
+    }
+    length = snprintf(path, path_size, "%s", resolved);
+    if (length < 0 || (size_t)length >= path_size) {
+        fprintf(stderr, "Error: Path of %s is longer than %zu bytes: %s\n", file_name, path_size - 1, resolved);
+        snprintf(path, path_size, "%s", file_name);
+        return -1;
+    }
+    return 0;
+}
+
+// Absolute path of the allocation shim, NULL when it is not installed
+static const char* allocation_shim(config_t *config) {
+    if (!shim_resolved) {
+        shim_resolved = 1;
+        if (resolve_helper(config->alloc_shim_path, "libbeta_alloc.so", R_OK, shim_path, sizeof(shim_path)) != 0) {
+            log_message(config, VERBOSITY_VERBOSE, "Allocation shim %s not found, reporting peak RSS only\n", shim_path);
+            shim_path[0] = '\0';
+        }
+    }
+    return strlen(shim_path) > 0 ? shim_path : NULL;
+}
+
+// Run the binary once with the allocation shim preloaded and store the profile it reports
+static void collect_allocations(const char *binary_path, config_t *config, performance_metrics_t *metrics) {
+    metrics->allocations_available = 0;
+    if (!config->eval_criteria.enable_memory_profiling) return;
+    const char *shim = allocation_shim(config);
+    if (!shim) return;
+
+    int report[2];
+    if (pipe(report) != 0) return;
+
+    // The environment is built before forking: LD_PRELOAD gains the shim, which reports to report[1]
+    char preload_env[2200], fd_env[64];
+    const char *preload = getenv("LD_PRELOAD");
+    snprintf(preload_env, sizeof(preload_env), "LD_PRELOAD=%s%s%s", shim, preload ? " " : "", preload ? preload : "");
+    snprintf(fd_env, sizeof(fd_env), "%s=%d", ALLOC_PROFILE_FD_ENV, report[1]);
+    size_t env_count = 0;
+    while (environ[env_count]) env_count++;
+    run_args_t args = { { (char *)binary_path, NULL, NULL }, malloc((env_count + 3) * sizeof(char *)) };
+    if (!args.envp) {
+        close(report[0]);
+        close(report[1]);
+        return;
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < env_count; i++) {
+        if (strncmp(environ[i], "LD_PRELOAD=", 11) != 0 &&
+            strncmp(environ[i], ALLOC_PROFILE_FD_ENV "=", strlen(ALLOC_PROFILE_FD_ENV) + 1) != 0) {
+            args.envp[kept++] = environ[i];
+        }
+    }
+    args.envp[kept++] = preload_env;
+    args.envp[kept++] = fd_env;
+    args.envp[kept] = NULL;
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(report[0]);
+        exec_benchmark_child(binary_path, &args, config);
+    }
+    close(report[1]);
+    free(args.envp);
+    if (pid < 0) {
+        close(report[0]);
+        return;
+    }
+
+    int status = 0;
+    process_limits_t limits = candidate_process_limits(config);
+    process_status_t run_status = process_wait(pid, &limits, &start, &status, NULL);
+
+    // Processes the candidate started may hold the pipe open, so never block on it
+    fcntl(report[0], F_SETFL, fcntl(report[0], F_GETFL) | O_NONBLOCK);
+    alloc_profile_t record;
+    while (run_status == PROCESS_OK && read(report[0], &record, sizeof(record)) == (ssize_t)sizeof(record)) {
+        if (record.magic != ALLOC_PROFILE_MAGIC || record.pid != pid) continue;
+        metrics->allocations_available = 1;
+        metrics->malloc_calls = (long long)record.malloc_calls;
+        metrics->calloc_calls = (long long)record.calloc_calls;
+        metrics->realloc_calls = (long long)record.realloc_calls;
+        metrics->free_calls = (long long)record.free_calls;
+        metrics->allocated_bytes = (long long)record.allocated_bytes;
+        metrics->peak_heap_bytes = (long long)record.peak_live_bytes;
+        for (int i = 0; i < ALLOC_HISTOGRAM_BUCKETS; i++) {
+            metrics->allocation_histogram[i] = (long long)record.histogram[i];
+        }
+        break;
+    }
+    close(report[0]);
+}
+
+// Whether the 95% confidence interval of the mean of count samples is within target_ci_percent of it
+static int precise_enough(int count, double sum, double sum_squares, double target_ci_percent) {
+    double mean = sum / count;
+    double variance = count > 1 ? (sum_squares - count * mean * mean) / (count - 1) : 0.0;
+    double ci = count > 1 ? t_critical(count - 1) * sqrt(fmax(variance, 0.0) / count) : INFINITY;
+    if (mean > 0.0 && ci / mean * 100.0 <= target_ci_percent) return 1;
+    return mean <= 0.0 && ci == 0.0;
+}
+
+// Fill the timing statistics of metrics from count samples (sorts samples)
+static void summarize_samples(double *samples, int count, double sum, double sum_squares,
+                              performance_metrics_t *metrics) {
+    double mean = sum / count;
+    double variance = count > 1 ? (sum_squares - count * mean * mean) / (count - 1) : 0.0;
+    metrics->mean_time_ms = mean;
+    metrics->stddev_time_ms = sqrt(fmax(variance, 0.0));
+    metrics->ci95_time_ms = count > 1 ? t_critical(count - 1) * metrics->stddev_time_ms / sqrt(count) : 0.0;
+
+    qsort(samples, count, sizeof(double), compare_doubles);
+    metrics->min_time_ms = samples[0];
+    metrics->median_time_ms = count % 2 ? samples[count / 2] : (samples[count / 2 - 1] + samples[count / 2]) / 2.0;
+    int p95_index = (int)ceil(0.95 * count) - 1;
+    metrics->p95_time_ms = samples[p95_index < 0 ? 0 : p95_index];
+    metrics->sample_count = count;
+}
+
+// Collect timed samples until the confidence target, run limit or time budget is reached
+static int collect_samples(const char *binary_path, const run_args_t *args, config_t *config, int subtract_startup,
+                           performance_metrics_t *metrics) {
+    int max_runs = config->benchmark_max_runs > 0 ? config->benchmark_max_runs : 1;
+    int min_runs = config->benchmark_min_runs < 1 ? 1 : config->benchmark_min_runs;
+    if (min_runs > max_runs) min_runs = max_runs;
+
+    double *samples = malloc(max_runs * sizeof(double));
+    if (!samples) return -1;
+
+    // Warm up caches, the page cache and CPU frequency before timing
+    struct rusage usage;
+    for (int i = 0; i < config->benchmark_warmup_runs; i++) {
+        if (run_once(binary_path, args, config, &usage) < 0) {
+            free(samples);
+            return -1;
+        }
+    }
+
+    struct timespec budget_start, now;
+    clock_gettime(CLOCK_MONOTONIC, &budget_start);
+
+    double total_cpu_ms = 0.0;
+    double total_wall_ms = 0.0;
+    long max_memory = 0;
+    int count = 0;
+    double sum = 0.0, sum_squares = 0.0;
+    double overhead = subtract_startup ? startup_overhead_ms : 0.0;
+
+    while (count < max_runs) {
+        double wall = run_once(binary_path, args, config, &usage);
+        if (wall < 0) break;
+
+        double sample = wall - overhead;
+        if (sample < 0.0) sample = 0.0;
+        samples[count++] = sample;
+        sum += sample;
+        sum_squares += sample * sample;
+
+        total_wall_ms += wall;
+        total_cpu_ms += (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0 +
+                        (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0;
+
+        long memory_kb = usage.ru_maxrss;
+        #ifdef __APPLE__
+        memory_kb /= 1024; // macOS reports in bytes, convert to KB
+        #endif
+        if (memory_kb > max_memory) max_memory = memory_kb;
+
+        if (count < min_runs) continue;
+
+        // Stop once the mean is known precisely enough
+        if (precise_enough(count, sum, sum_squares, config->benchmark_target_ci_percent)) break;
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (elapsed_ms(&budget_start, &now) >= config->benchmark_max_time_ms) break;
+    }
+
+    if (count == 0) {
+        free(samples);
+        return -1;
+    }
+
+    summarize_samples(samples, count, sum, sum_squares, metrics);
+    metrics->warmup_runs = config->benchmark_warmup_runs;
+    metrics->startup_overhead_ms = overhead;
+    metrics->memory_usage_kb = max_memory;
+    metrics->cpu_usage_percent = total_wall_ms > 0 ? (int)(total_cpu_ms / total_wall_ms * 100.0) : 0;
+
+    free(samples);
+    return 0;
+}
+
+// Measure the cost of starting an empty program once per process
+static void measure_startup_overhead(config_t *config) {
+    if (startup_measured) return;
+    startup_measured = 1;
+
+    workspace_t workspace;
+    char source_path[1024], binary_path[1024], compile_cmd[2300];
+    if (workspace_create(&workspace, "startup") == 0 &&
+        workspace_write_file(&workspace, "empty.c", "int main(void) { return 0; }", source_path, sizeof(source_path)) == 0 &&
+        workspace_path(&workspace, "empty", binary_path, sizeof(binary_path)) == 0) {
+        snprintf(compile_cmd, sizeof(compile_cmd), "gcc -O2 -o %s %s 2>/dev/null", binary_path, source_path);
+
+        performance_metrics_t baseline = {0};
+        process_limits_t compile_limits = compile_process_limits(config);
+        if (process_run(compile_cmd, &compile_limits, NULL, 0, NULL) == 0 && collect_samples(binary_path, NULL, config, 0, &baseline) == 0) {
+            // The minimum is the least disturbed estimate of pure start-up cost
+            startup_overhead_ms = baseline.min_time_ms;
+            log_message(config, VERBOSITY_DEBUG, "Benchmark: process start-up overhead %.3fms\n", startup_overhead_ms);
+        }
+        if (config->enable_hardware_counters) {
+            startup_counters_available = count_once(binary_path, config, startup_counters) == 0;
+        }
+    }
+    workspace_destroy(&workspace);
+}
+
+// Benchmark a built binary and fill the timing statistics of metrics
+int benchmark_binary(const char *binary_path, config_t *config, performance_metrics_t *metrics) {
+    if (!binary_path || !config || !metrics) return -1;
+
+    // One benchmark at a time, and it counts against the run slots of concurrent jobs
+    pthread_mutex_lock(&benchmark_mutex);
+    process_slot_acquire(NULL);
+    measure_startup_overhead(config);
+    int status = collect_samples(binary_path, NULL, config, 1, metrics);
+    if (status == 0) {
+        collect_counters(binary_path, config, metrics);
+        collect_allocations(binary_path, config, metrics);
+    }
+    process_slot_release();
+    pthread_mutex_unlock(&benchmark_mutex);
+
+    if (status != 0) {
+        log_message(config, VERBOSITY_DEBUG, "Benchmark: failed to run %s\n", binary_path);
+        return -1;
+    }
+
+    // The median is robust against the occasional preempted run
+    metrics->execution_time_ms = metrics->median_time_ms;
+
+    log_message(config, VERBOSITY_DEBUG,
+               "Benchmark: %d runs, median %.3fms, p95 %.3fms, stddev %.3fms, 95%% CI ±%.3fms\n",
+               metrics->sample_count, metrics->median_time_ms, metrics->p95_time_ms,
+               metrics->stddev_time_ms, metrics->ci95_time_ms);
+    if (metrics->counters_available) {
+        log_message(config, VERBOSITY_DEBUG,
+                   "Benchmark: %lld cycles, %lld instructions, IPC %.2f, %lld L1d / %lld LLC misses, %lld branch misses\n",
+                   metrics->cycles, metrics->instructions, metrics->ipc,
+                   metrics->l1d_misses, metrics->llc_misses, metrics->branch_misses);
+    }
+    if (metrics->allocations_available) {
+        log_message(config, VERBOSITY_DEBUG,
+                   "Benchmark: %lld malloc, %lld calloc, %lld realloc, %lld free, %lld bytes requested, %lld peak heap bytes\n",
+                   metrics->malloc_calls, metrics->calloc_calls, metrics->realloc_calls, metrics->free_calls,
+                   metrics->allocated_bytes, metrics->peak_heap_bytes);
+    }
+    return 0;
+}
+
+// Benchmark a built binary at one input size (timing statistics only)
+int benchmark_binary_size(const char *binary_path, long size, config_t *config, performance_metrics_t *metrics) {
+    if (!binary_path || !config || !metrics) return -1;
+
+    // The environment is copied here because the child must not allocate after fork
+    char size_arg[32], size_env[64];
+    snprintf(size_arg, sizeof(size_arg), "%ld", size);
+    snprintf(size_env, sizeof(size_env), "%s=%ld", SCALING_SIZE_ENV, size);
+    size_t env_count = 0;
+    while (environ[env_count]) env_count++;
+
+    run_args_t args = { { (char *)binary_path, size_arg, NULL }, malloc((env_count + 2) * sizeof(char *)) };
+    if (!args.envp) return -1;
+    size_t kept = 0;
+    for (size_t i = 0; i < env_count; i++) {
+        if (strncmp(environ[i], SCALING_SIZE_ENV "=", strlen(SCALING_SIZE_ENV) + 1) != 0) {
+            args.envp[kept++] = environ[i];
+        }
+    }
+    args.envp[kept++] = size_env;
+    args.envp[kept] = NULL;
+
+    pthread_mutex_lock(&benchmark_mutex);
+    process_slot_acquire(NULL);
+    measure_startup_overhead(config);
+    int status = collect_samples(binary_path, &args, config, 1, metrics);
+    process_slot_release();
+    pthread_mutex_unlock(&benchmark_mutex);
+    free(args.envp);
+
+    if (status != 0) {
+        log_message(config, VERBOSITY_DEBUG, "Benchmark: failed to run %s at size %ld\n", binary_path, size);
+        return -1;
+    }
+    metrics->execution_time_ms = metrics->median_time_ms;
+    return 0;
+}
+
+// Absolute path of the kernel runner, NULL when it is not installed
+static const char* kernel_runner(config_t *config) {
+    if (!runner_resolved) {
+        runner_resolved = 1;
+        if (resolve_helper(config->kernel_runner_path, "beta_kernel_runner", X_OK, runner_path, sizeof(runner_path)) != 0) {
+            log_message(config, VERBOSITY_VERBOSE, "%sKernel runner %s not found, kernel benchmarks fail%s\n",
+                       C_WARNING, runner_path, C_RESET);
+            runner_path[0] = '\0';
+        }
+    }
+    return strlen(runner_path) > 0 ? runner_path : NULL;
+}
+
+// Start the runner under the candidate limits, pinned like benchmark runs
+static int start_runner(config_t *config) {
+    const char *path = kernel_runner(config);
+    if (!path) return -1;
+
+    int channel[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, channel) != 0) return -1;
+
+    // RLIMIT_CPU would add up over the candidates the runner serves, so candidate_timeout_ms bounds them instead
+    process_limits_t limits = candidate_process_limits(config);
+    limits.cpu_time_s = 0;
+    pid_t pid = fork();
+    if (pid == 0) {
+        process_apply_limits(&limits);
+        pin_benchmark_cpu(config->benchmark_cpu);
+        dup2(channel[1], STDIN_FILENO);          // dup2 clears close-on-exec for the runner
+        int null_fd = open("/dev/null", O_WRONLY);
+        if (null_fd >= 0) {
+            dup2(null_fd, STDOUT_FILENO);
+            dup2(null_fd, STDERR_FILENO);
+            close(null_fd);
+        }
+        execl(path, path, (char *)NULL);
+        _exit(127);
+    }
+    close(channel[1]);
+    if (pid < 0) {
+        close(channel[0]);
+        return -1;
+    }
+    setpgid(pid, pid);
+
+    runner_pid = pid;
+    runner_channel = channel[0];
+    runner_libraries = 0;
+    runner_memory_mb = limits.memory_mb;
+    runner_max_processes = limits.max_processes;
+    runner_cpu = config->benchmark_cpu;
+    return 0;
+}
+
+// Stop the runner. After a failed request, log how the candidate ended it.
+static void stop_runner(config_t *config, int failed, int timed_out) {
+    if (runner_pid <= 0) return;
+
+    // An idle runner exits once its channel closes; anything else is killed
+    close(runner_channel);
+    runner_channel = -1;
+    if (timed_out) killpg(runner_pid, SIGKILL);
+    process_limits_t limits = {0};
+    limits.wall_time_ms = 1000;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int status = 0;
+    process_status_t run_status = process_wait(runner_pid, &limits, &start, &status, NULL);
+    runner_pid = -1;
+
+    if (!failed) return;
+    if (timed_out) {
+        log_message(config, VERBOSITY_VERBOSE, "%sKernel benchmark: candidate timed out after %dms%s\n",
+                   C_WARNING, config->candidate_timeout_ms, C_RESET);
+    } else if (WIFSIGNALED(status)) {
+        log_message(config, VERBOSITY_VERBOSE, "%sKernel benchmark: candidate stopped the runner (%s, signal %d, %s)%s\n",
+                   C_WARNING, process_status_name(run_status), WTERMSIG(status), strsignal(WTERMSIG(status)), C_RESET);
+    } else {
+        log_message(config, VERBOSITY_VERBOSE, "%sKernel benchmark: runner exited with status %d%s\n",
+                   C_WARNING, WIFEXITED(status) ? WEXITSTATUS(status) : -1, C_RESET);
+    }
+}
+
+// Send (or receive) exactly size bytes over the runner channel within
+// timeout_ms (0 = no limit); sets *timed_out when the time ran out
+static int runner_transfer(int sending, void *buffer, size_t size, int timeout_ms, int *timed_out) {
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    size_t done = 0;
+    while (done < size) {
+        int wait_ms = -1;
+        if (timeout_ms > 0) {
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            double remaining = timeout_ms - elapsed_ms(&start, &now);
+            if (remaining <= 0) {
+                *timed_out = 1;
+                return -1;
+            }
+            wait_ms = (int)ceil(remaining);
+        }
+        struct pollfd pfd = { runner_channel, sending ? POLLOUT : POLLIN, 0 };
+        int ready = poll(&pfd, 1, wait_ms);
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready < 0) return -1;
+        if (ready == 0) continue;
+
+        // MSG_NOSIGNAL: a runner that died must not take beta_evolve down with SIGPIPE
+        ssize_t n = sending ? send(runner_channel, (char *)buffer + done, size - done, MSG_NOSIGNAL)
+                            : recv(runner_channel, (char *)buffer + done, size - done, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        done += (size_t)n;
+    }
+    return 0;
+}
+
+// Time batches of calls of a loaded kernel until the confidence target, batch
+// limit or time budget is reached, then release it
+static int collect_kernel_samples(const kernel_reply_t *reply, config_t *config, performance_metrics_t *metrics,
+                                  int *timed_out) {
+    int timeout_ms = config->candidate_timeout_ms;
+    int max_batches = config->kernel_max_batches > 0 ? config->kernel_max_batches : 1;
+    int min_batches = config->benchmark_min_runs < 1 ? 1 : config->benchmark_min_runs;
+    if (min_batches > max_batches) min_batches = max_batches;
+
+    double *samples = malloc(max_batches * sizeof(double));
+    if (!samples) return -1;
+
+    struct timespec budget_start, now;
+    clock_gettime(CLOCK_MONOTONIC, &budget_start);
+
+    int count = 0;
+    double sum = 0.0, sum_squares = 0.0;
+    int status = 0;
+    while (count < max_batches) {
+        unsigned char command = KERNEL_COMMAND_BATCH;
+        kernel_sample_t sample;
+        if (runner_transfer(1, &command, 1, timeout_ms, timed_out) != 0 ||
+            runner_transfer(0, &sample, sizeof(sample), timeout_ms, timed_out) != 0) {
+            status = -1;
+            break;
+        }
+
+        // Samples are kept in milliseconds like whole-run samples, so comparisons work on both
+        double sample_ms = fmax(sample.wall_ns - reply->overhead_ns, 0.0) / 1e6;
+        samples[count++] = sample_ms;
+        sum += sample_ms;
+        sum_squares += sample_ms * sample_ms;
+
+        if (count < min_batches) continue;
+        if (precise_enough(count, sum, sum_squares, config->kernel_target_ci_percent)) break;
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (elapsed_ms(&budget_start, &now) >= config->benchmark_max_time_ms) break;
+    }
+
+    unsigned char done = KERNEL_COMMAND_DONE;
+    if (status == 0 && runner_transfer(1, &done, 1, timeout_ms, timed_out) != 0) status = -1;
+    if (status == 0) {
+        summarize_samples(samples, count, sum, sum_squares, metrics);
+        metrics->warmup_runs = config->benchmark_warmup_runs;
+        metrics->startup_overhead_ms = reply->overhead_ns / 1e6;
+        metrics->calls_per_batch = reply->calls_per_batch;
+    }
+    free(samples);
+    return status;
+}
+
+// Benchmark one shared object in the runner; the caller holds benchmark_mutex
+static int run_kernel(const char *library_path, long input_size, config_t *config, performance_metrics_t *metrics) {
+    // A runner started with other limits, or one that has loaded many candidates, is replaced
+    if (runner_pid > 0 && (runner_libraries >= KERNEL_RUNNER_MAX_LIBRARIES ||
+                           runner_memory_mb != config->candidate_memory_mb ||
+                           runner_max_processes != config->candidate_max_processes || runner_cpu != config->benchmark_cpu)) {
+        stop_runner(config, 0, 0);
+    }
+    if (runner_pid <= 0 && start_runner(config) != 0) return -1;
+    runner_libraries++;
+
+    kernel_request_t request;
+    memset(&request, 0, sizeof(request));
+    request.magic = KERNEL_RUNNER_MAGIC;
+    request.signature = config->kernel_signature;
+    request.input_size = input_size > INT_MAX ? INT_MAX : (int32_t)input_size;
+    request.inputs = config->kernel_inputs;
+    request.warmup_batches = config->benchmark_warmup_runs;
+    snprintf(request.library, sizeof(request.library), "%s", library_path);
+    snprintf(request.entry, sizeof(request.entry), "%s", config->kernel_entry);
+
+    // candidate_timeout_ms bounds each step: loading with calibration and warmup, then every batch
+    int timed_out = 0;
+    kernel_reply_t reply;
+    if (runner_transfer(1, &request, sizeof(request), config->candidate_timeout_ms, &timed_out) != 0 ||
+        runner_transfer(0, &reply, sizeof(reply), config->candidate_timeout_ms, &timed_out) != 0 ||
+        reply.magic != KERNEL_RUNNER_MAGIC) {
+        stop_runner(config, 1, timed_out);
+        return -1;
+    }
+    if (reply.status != 0) {
+        // The runner is still usable: only this candidate could not be loaded
+        reply.error[sizeof(reply.error) - 1] = '\0';
+        log_message(config, VERBOSITY_VERBOSE, "%sKernel benchmark: %s%s\n", C_WARNING, reply.error, C_RESET);
+        return -1;
+    }
+    if (collect_kernel_samples(&reply, config, metrics, &timed_out) != 0) {
+        stop_runner(config, 1, timed_out);
+        return -1;
+    }
+    return 0;
+}
+
+// Benchmark kernel_entry of a shared object in-process at one input size
+int benchmark_kernel(const char *library_path, long input_size, config_t *config, performance_metrics_t *metrics) {
+    if (!library_path || !config || !metrics) return -1;
+
+    char absolute_path[PATH_MAX];
+    if (!realpath(library_path, absolute_path)) return -1;
+
+    pthread_mutex_lock(&benchmark_mutex);
+    process_slot_acquire(NULL);
+    int status = run_kernel(absolute_path, input_size, config, metrics);
+    process_slot_release();
+    pthread_mutex_unlock(&benchmark_mutex);
+
+    if (status != 0) {
+        log_message(config, VERBOSITY_DEBUG, "Benchmark: failed to run kernel %s of %s\n", config->kernel_entry, library_path);
+        return -1;
+    }
+    metrics->execution_time_ms = metrics->median_time_ms;
+    metrics->ns_per_call = metrics->median_time_ms * 1e6;
+
+    log_message(config, VERBOSITY_DEBUG,
+               "Benchmark: %d batches of %lld calls, median %.1fns/call, p95 %.1fns, 95%% CI ±%.1fns, %.1fns overhead removed\n",
+               metrics->sample_count, metrics->calls_per_batch, metrics->ns_per_call, metrics->p95_time_ms * 1e6,
+               metrics->ci95_time_ms * 1e6, metrics->startup_overhead_ms * 1e6);
+    return 0;
+}
+
+// Compare the mean run times of two benchmarks with Welch's t-test
+int benchmark_compare(const performance_metrics_t *a, const performance_metrics_t *b) {
+    if (!a || !b || a->sample_count < 2 || b->sample_count < 2) return 0;
+
+    double var_a = a->stddev_time_ms * a->stddev_time_ms / a->sample_count;
+    double var_b = b->stddev_time_ms * b->stddev_time_ms / b->sample_count;
+    double difference = a->mean_time_ms - b->mean_time_ms;
+
+    if (var_a + var_b <= 0.0) {
+        return (difference < 0) ? -1 : (difference > 0 ? 1 : 0);
+    }
+
+    double t = difference / sqrt(var_a + var_b);
+    double df = (var_a + var_b) * (var_a + var_b) /
+                (var_a * var_a / (a->sample_count - 1) + var_b * var_b / (b->sample_count - 1));
+
+    if (fabs(t) < t_critical(df)) return 0;
+    return t < 0 ? -1 : 1;
+}
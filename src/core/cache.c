@@ -0,0 +1,516 @@
+#include "cache.h"
+#include "workspace.h"
+#include <errno.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#define EVAL_CACHE_BUCKETS 1024
+#define EVAL_CACHE_MAGIC 0x42455643u             // "BEVC"
+#define EVAL_CACHE_VERSION 2
+
+// Cached evaluation data for one key
+typedef struct eval_cache_entry {
+    uint64_t key;
+    int has_test;
+    test_result_t test_result;                   // Owned copy (strings malloc'd)
+    int has_performance;
+    performance_metrics_t performance;
+    struct eval_cache_entry *next;
+} eval_cache_entry_t;
+
+// Header of an on-disk test entry, followed by the error and output strings
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    int32_t syntax_ok;
+    int32_t compilation_ok;
+    int32_t execution_ok;
+    int32_t run_status;
+    uint32_t error_length;
+    uint32_t output_length;
+} eval_cache_test_header_t;
+
+// Header of an on-disk performance entry, followed by the metrics struct
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t metrics_size;                       // Entries from an older struct layout are ignored
+} eval_cache_performance_header_t;
+
+static pthread_mutex_t eval_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static eval_cache_entry_t *eval_cache_buckets[EVAL_CACHE_BUCKETS];
+static int eval_cache_enabled = 0;
+static char eval_cache_dir[512] = "";            // Disk cache directory, empty for memory only
+static workspace_t eval_cache_binaries;          // Binary store when there is no disk cache
+static long eval_cache_hits = 0;
+static long eval_cache_misses = 0;
+
+// FNV-1a over a byte range
+static uint64_t fnv1a_update(uint64_t hash, const char *data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// Hash source with indentation, trailing whitespace, blank lines and repeated
+// blanks removed; string and character literals are hashed verbatim
+static uint64_t hash_normalized_source(uint64_t hash, const char *code) {
+    char quote = 0;
+    int pending_space = 0;
+    int line_has_content = 0;
+
+    for (const char *p = code; *p; p++) {
+        char c = *p;
+
+        if (quote) {
+            hash = fnv1a_update(hash, &c, 1);
+            if (c == '\\' && p[1]) {
+                p++;
+                hash = fnv1a_update(hash, p, 1);
+            } else if (c == quote) {
+                quote = 0;
+            }
+            continue;
+        }
+
+        if (c == '\n') {
+            if (line_has_content) hash = fnv1a_update(hash, "\n", 1);
+            pending_space = 0;
+            line_has_content = 0;
+            continue;
+        }
+
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v') {
+            pending_space = line_has_content;
+            continue;
+        }
+
+        if (pending_space) {
+            hash = fnv1a_update(hash, " ", 1);
+            pending_space = 0;
+        }
+        if (c == '"' || c == '\'') quote = c;
+        hash = fnv1a_update(hash, &c, 1);
+        line_has_content = 1;
+    }
+
+    return hash;
+}
+
+// Whether c can be part of an identifier, keyword or number
+static int is_word_char(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+// Hash the token sequence of C source: comments and layout are dropped, a gap is
+// kept only between two word tokens and preprocessor lines keep their end
+uint64_t source_token_hash(const char *code) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    if (!code) return hash;
+
+    char last = 0;
+    int gap = 0;
+    int at_line_start = 1;
+    int in_directive = 0;
+    for (const char *p = code; *p; p++) {
+        char c = *p;
+
+        if (c == '\\' && p[1] == '\n') {
+            p++; // Line continuation
+            gap = 1;
+            continue;
+        }
+        if (c == '\n') {
+            if (in_directive) {
+                hash = fnv1a_update(hash, "\n", 1);
+                last = '\n';
+                in_directive = 0;
+            }
+            gap = 1;
+            at_line_start = 1;
+            continue;
+        }
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v') {
+            gap = 1;
+            continue;
+        }
+        if (c == '/' && p[1] == '/') {
+            while (p[1] && p[1] != '\n') p++;
+            gap = 1;
+            continue;
+        }
+        if (c == '/' && p[1] == '*') {
+            p += 2;
+            while (*p && !(*p == '*' && p[1] == '/')) p++;
+            if (!*p) break;
+            p++;
+            gap = 1;
+            continue;
+        }
+
+        if (at_line_start && c == '#') in_directive = 1;
+        at_line_start = 0;
+        if (gap && is_word_char(last) && is_word_char(c)) hash = fnv1a_update(hash, " ", 1);
+        gap = 0;
+
+        if (c == '"' || c == '\'') {
+            // Literals are hashed verbatim
+            const char *start = p++;
+            while (*p && *p != c && *p != '\n') {
+                if (*p == '\\' && p[1]) p++;
+                p++;
+            }
+            size_t length = (size_t)(p - start) + (*p == c ? 1 : 0);
+            hash = fnv1a_update(hash, start, length);
+            if (*p != c) p--;
+            last = c;
+            continue;
+        }
+
+        hash = fnv1a_update(hash, &c, 1);
+        last = c;
+    }
+
+    return hash;
+}
+
+// Key for code built/run with the given flags
+uint64_t eval_cache_key(const char *code, const char *flags, const char *args, const char *extra) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    const char separator = '\0';
+
+    hash = hash_normalized_source(hash, code ? code : "");
+    hash = fnv1a_update(hash, &separator, 1);
+    hash = fnv1a_update(hash, flags ? flags : "", strlen(flags ? flags : ""));
+    hash = fnv1a_update(hash, &separator, 1);
+    hash = fnv1a_update(hash, args ? args : "", strlen(args ? args : ""));
+    hash = fnv1a_update(hash, &separator, 1);
+    hash = fnv1a_update(hash, extra ? extra : "", strlen(extra ? extra : ""));
+
+    return hash;
+}
+
+// Find or create the memory entry for key (caller holds eval_cache_mutex)
+static eval_cache_entry_t* cache_entry(uint64_t key, int create) {
+    eval_cache_entry_t **bucket = &eval_cache_buckets[key % EVAL_CACHE_BUCKETS];
+    for (eval_cache_entry_t *entry = *bucket; entry; entry = entry->next) {
+        if (entry->key == key) return entry;
+    }
+    if (!create) return NULL;
+
+    eval_cache_entry_t *entry = calloc(1, sizeof(eval_cache_entry_t));
+    if (!entry) return NULL;
+    entry->key = key;
+    entry->next = *bucket;
+    *bucket = entry;
+    return entry;
+}
+
+// Path of a disk cache file for key
+static int cache_file_path(uint64_t key, const char *suffix, char *out, size_t out_size) {
+    if (eval_cache_dir[0] == '\0') return -1;
+    int written = snprintf(out, out_size, "%s/%016llx.%s", eval_cache_dir, (unsigned long long)key, suffix);
+    return (written < 0 || (size_t)written >= out_size) ? -1 : 0;
+}
+
+// Write a file atomically so concurrent runs never see a partial entry
+static void cache_write_file(const char *path, const void *header, size_t header_size,
+                             const char *first, size_t first_length, const char *second, size_t second_length) {
+    char temp_path[1100];
+    snprintf(temp_path, sizeof(temp_path), "%s.%ld.tmp", path, (long)getpid());
+
+    FILE *file = fopen(temp_path, "wb");
+    if (!file) return;
+
+    int ok = fwrite(header, 1, header_size, file) == header_size;
+    if (ok && first_length > 0) ok = fwrite(first, 1, first_length, file) == first_length;
+    if (ok && second_length > 0) ok = fwrite(second, 1, second_length, file) == second_length;
+    ok = (fclose(file) == 0) && ok;
+
+    if (!ok || rename(temp_path, path) != 0) {
+        unlink(temp_path);
+    }
+}
+
+// Copy a cached string into a max_response_size buffer like the test runners allocate
+static char* copy_result_string(const char *source, size_t length, config_t *config) {
+    size_t size = (size_t)config->max_response_size;
+    char *copy = malloc(size);
+    if (!copy) return NULL;
+    if (length >= size) length = size - 1;
+    memcpy(copy, source ? source : "", source ? length : 0);
+    copy[source ? length : 0] = '\0';
+    return copy;
+}
+
+// Load a test entry from disk into memory (caller holds eval_cache_mutex)
+static eval_cache_entry_t* cache_load_test(uint64_t key) {
+    char path[1024];
+    if (cache_file_path(key, "test", path, sizeof(path)) != 0) return NULL;
+
+    FILE *file = fopen(path, "rb");
+    if (!file) return NULL;
+
+    eval_cache_test_header_t header;
+    eval_cache_entry_t *entry = NULL;
+    if (fread(&header, 1, sizeof(header), file) == sizeof(header) &&
+        header.magic == EVAL_CACHE_MAGIC && header.version == EVAL_CACHE_VERSION) {
+        char *error_message = calloc(1, header.error_length + 1);
+        char *output = calloc(1, header.output_length + 1);
+        if (error_message && output &&
+            fread(error_message, 1, header.error_length, file) == header.error_length &&
+            fread(output, 1, header.output_length, file) == header.output_length &&
+            (entry = cache_entry(key, 1)) != NULL) {
+            cleanup_test_result(&entry->test_result);
+            entry->test_result.syntax_ok = header.syntax_ok;
+            entry->test_result.compilation_ok = header.compilation_ok;
+            entry->test_result.execution_ok = header.execution_ok;
+            entry->test_result.run_status = (process_status_t)header.run_status;
+            entry->test_result.error_message = error_message;
+            entry->test_result.output = output;
+            entry->has_test = 1;
+        } else {
+            free(error_message);
+            free(output);
+        }
+    }
+
+    fclose(file);
+    return entry;
+}
+
+// Load a performance entry from disk into memory (caller holds eval_cache_mutex)
+static eval_cache_entry_t* cache_load_performance(uint64_t key) {
+    char path[1024];
+    if (cache_file_path(key, "perf", path, sizeof(path)) != 0) return NULL;
+
+    FILE *file = fopen(path, "rb");
+    if (!file) return NULL;
+
+    eval_cache_performance_header_t header;
+    performance_metrics_t metrics;
+    eval_cache_entry_t *entry = NULL;
+    if (fread(&header, 1, sizeof(header), file) == sizeof(header) &&
+        header.magic == EVAL_CACHE_MAGIC && header.version == EVAL_CACHE_VERSION &&
+        header.metrics_size == sizeof(performance_metrics_t) &&
+        fread(&metrics, 1, sizeof(metrics), file) == sizeof(metrics) &&
+        (entry = cache_entry(key, 1)) != NULL) {
+        entry->performance = metrics;
+        entry->has_performance = 1;
+    }
+
+    fclose(file);
+    return entry;
+}
+
+// Initialize the cache from configuration
+int eval_cache_init(config_t *config) {
+    if (!config) return -1;
+
+    pthread_mutex_lock(&eval_cache_mutex);
+    eval_cache_enabled = config->enable_eval_cache;
+    snprintf(eval_cache_dir, sizeof(eval_cache_dir), "%s", config->eval_cache_dir);
+    pthread_mutex_unlock(&eval_cache_mutex);
+
+    if (!eval_cache_enabled || eval_cache_dir[0] == '\0') return 0;
+
+    // Create the disk cache directory and its binary store
+    char bin_dir[600];
+    snprintf(bin_dir, sizeof(bin_dir), "%s/bin", eval_cache_dir);
+    if ((mkdir(eval_cache_dir, 0755) != 0 && errno != EEXIST) ||
+        (mkdir(bin_dir, 0755) != 0 && errno != EEXIST)) {
+        fprintf(stderr, "Warning: Cannot create evaluation cache directory '%s', using memory only\n", eval_cache_dir);
+        eval_cache_dir[0] = '\0';
+    }
+
+    return 0;
+}
+
+// Free all cached entries
+void eval_cache_cleanup(void) {
+    pthread_mutex_lock(&eval_cache_mutex);
+    for (int i = 0; i < EVAL_CACHE_BUCKETS; i++) {
+        eval_cache_entry_t *entry = eval_cache_buckets[i];
+        while (entry) {
+            eval_cache_entry_t *next = entry->next;
+            cleanup_test_result(&entry->test_result);
+            free(entry);
+            entry = next;
+        }
+        eval_cache_buckets[i] = NULL;
+    }
+    workspace_destroy(&eval_cache_binaries);
+    eval_cache_enabled = 0;
+    pthread_mutex_unlock(&eval_cache_mutex);
+}
+
+// Look up a test result
+int eval_cache_get_test(uint64_t key, test_result_t *result, config_t *config) {
+    if (!result || !config) return 0;
+
+    pthread_mutex_lock(&eval_cache_mutex);
+    if (!eval_cache_enabled) {
+        pthread_mutex_unlock(&eval_cache_mutex);
+        return 0;
+    }
+
+    eval_cache_entry_t *entry = cache_entry(key, 0);
+    if (!entry || !entry->has_test) {
+        entry = cache_load_test(key);
+    }
+
+    int hit = 0;
+    if (entry && entry->has_test) {
+        const test_result_t *cached = &entry->test_result;
+        memset(result, 0, sizeof(test_result_t));
+        result->syntax_ok = cached->syntax_ok;
+        result->compilation_ok = cached->compilation_ok;
+        result->execution_ok = cached->execution_ok;
+        result->run_status = cached->run_status;
+        result->error_message = copy_result_string(cached->error_message, strlen(cached->error_message), config);
+        result->output = copy_result_string(cached->output, strlen(cached->output), config);
+        hit = result->error_message && result->output;
+        if (!hit) cleanup_test_result(result);
+    }
+
+    if (hit) eval_cache_hits++; else eval_cache_misses++;
+    pthread_mutex_unlock(&eval_cache_mutex);
+
+    return hit;
+}
+
+// Store a test result
+void eval_cache_put_test(uint64_t key, const test_result_t *result) {
+    if (!result) return;
+
+    const char *error_message = result->error_message ? result->error_message : "";
+    const char *output = result->output ? result->output : "";
+
+    pthread_mutex_lock(&eval_cache_mutex);
+    if (!eval_cache_enabled) {
+        pthread_mutex_unlock(&eval_cache_mutex);
+        return;
+    }
+
+    eval_cache_entry_t *entry = cache_entry(key, 1);
+    if (entry) {
+        cleanup_test_result(&entry->test_result);
+        entry->test_result.syntax_ok = result->syntax_ok;
+        entry->test_result.compilation_ok = result->compilation_ok;
+        entry->test_result.execution_ok = result->execution_ok;
+        entry->test_result.run_status = result->run_status;
+        entry->test_result.error_message = strdup(error_message);
+        entry->test_result.output = strdup(output);
+        entry->has_test = entry->test_result.error_message && entry->test_result.output;
+    }
+
+    char path[1024];
+    if (cache_file_path(key, "test", path, sizeof(path)) == 0) {
+        eval_cache_test_header_t header = {
+            EVAL_CACHE_MAGIC, EVAL_CACHE_VERSION,
+            result->syntax_ok, result->compilation_ok, result->execution_ok, result->run_status,
+            (uint32_t)strlen(error_message), (uint32_t)strlen(output)
+        };
+        cache_write_file(path, &header, sizeof(header), error_message, header.error_length,
+                         output, header.output_length);
+    }
+    pthread_mutex_unlock(&eval_cache_mutex);
+}
+
+// Look up performance metrics
+int eval_cache_get_performance(uint64_t key, performance_metrics_t *metrics) {
+    if (!metrics) return 0;
+
+    pthread_mutex_lock(&eval_cache_mutex);
+    if (!eval_cache_enabled) {
+        pthread_mutex_unlock(&eval_cache_mutex);
+        return 0;
+    }
+
+    eval_cache_entry_t *entry = cache_entry(key, 0);
+    if (!entry || !entry->has_performance) {
+        entry = cache_load_performance(key);
+    }
+
+    int hit = entry && entry->has_performance;
+    if (hit) {
+        *metrics = entry->performance;
+        eval_cache_hits++;
+    } else {
+        eval_cache_misses++;
+    }
+    pthread_mutex_unlock(&eval_cache_mutex);
+
+    return hit;
+}
+
+// Store performance metrics
+void eval_cache_put_performance(uint64_t key, const performance_metrics_t *metrics) {
+    if (!metrics) return;
+
+    pthread_mutex_lock(&eval_cache_mutex);
+    if (!eval_cache_enabled) {
+        pthread_mutex_unlock(&eval_cache_mutex);
+        return;
+    }
+
+    eval_cache_entry_t *entry = cache_entry(key, 1);
+    if (entry) {
+        entry->performance = *metrics;
+        entry->has_performance = 1;
+    }
+
+    char path[1024];
+    if (cache_file_path(key, "perf", path, sizeof(path)) == 0) {
+        eval_cache_performance_header_t header = {
+            EVAL_CACHE_MAGIC, EVAL_CACHE_VERSION, (uint32_t)sizeof(performance_metrics_t)
+        };
+        cache_write_file(path, &header, sizeof(header), (const char *)metrics, sizeof(performance_metrics_t), NULL, 0);
+    }
+    pthread_mutex_unlock(&eval_cache_mutex);
+}
+
+// Path where the binary built for key is kept
+int eval_cache_binary_path(uint64_t key, char *out, size_t out_size, int *exists) {
+    if (!out || out_size == 0) return -1;
+    if (exists) *exists = 0;
+
+    pthread_mutex_lock(&eval_cache_mutex);
+    if (!eval_cache_enabled) {
+        pthread_mutex_unlock(&eval_cache_mutex);
+        return -1;
+    }
+
+    int written;
+    if (eval_cache_dir[0] != '\0') {
+        written = snprintf(out, out_size, "%s/bin/%016llx", eval_cache_dir, (unsigned long long)key);
+    } else {
+        // Memory-only cache: binaries live in a workspace removed at exit
+        if (eval_cache_binaries.path[0] == '\0' && workspace_create(&eval_cache_binaries, "cache") != 0) {
+            pthread_mutex_unlock(&eval_cache_mutex);
+            return -1;
+        }
+        written = snprintf(out, out_size, "%s/%016llx", eval_cache_binaries.path, (unsigned long long)key);
+    }
+    pthread_mutex_unlock(&eval_cache_mutex);
+
+    if (written < 0 || (size_t)written >= out_size) return -1;
+    if (exists) *exists = access(out, X_OK) == 0;
+    return 0;
+}
+
+// Print hit/miss counters
+void log_eval_cache_stats(config_t *config) {
+    pthread_mutex_lock(&eval_cache_mutex);
+    long hits = eval_cache_hits;
+    long misses = eval_cache_misses;
+    int enabled = eval_cache_enabled;
+    pthread_mutex_unlock(&eval_cache_mutex);
+
+    if (!enabled || hits + misses == 0) return;
+
+    log_message(config, VERBOSITY_VERBOSE, "%sEvaluation cache:%s %ld hits, %ld misses (%.0f%% hit rate)\n",
+               C_EMPHASIS, C_RESET, hits, misses, 100.0 * hits / (hits + misses));
+}
@@ -0,0 +1,78 @@
+#include "cascade.h"
+#include "trace.h"
+#include "workspace.h"
+
+static const char *stage_names[CASCADE_STAGE_COUNT] = {
+    "off", "duplicate", "syntax", "smoke", "tests", "benchmark"
+};
+
+// Name of a stage for logs
+const char* cascade_stage_name(cascade_stage_t stage) {
+    if (stage < 0 || stage >= CASCADE_STAGE_COUNT) return "unknown";
+    return stage_names[stage];
+}
+
+// Syntax-check the file with the compiler only; returns 0 if it passed, filling result otherwise
+static int check_syntax(const char *file_path, config_t *config, test_result_t *result) {
+    char command[2048];
+    snprintf(command, sizeof(command), "gcc -fsyntax-only %s %s 2>&1", file_path, config->args);
+
+    char *output = calloc(1, config->max_response_size);
+    if (!output) return 0; // Let the full tests decide
+
+    process_limits_t limits = compile_process_limits(config);
+    trace_span_t span = trace_begin("cascade_syntax", TRACE_NO_AGENT);
+    int exit_code = execute_command(command, output, config->max_response_size, &limits, NULL);
+    trace_end(&span);
+    if (exit_code == 0) {
+        free(output);
+        return 0;
+    }
+
+    memset(result, 0, sizeof(test_result_t));
+    result->output = output;
+    result->error_message = calloc(1, config->max_response_size);
+    if (result->error_message) {
+        snprintf(result->error_message, config->max_response_size, "Syntax check failed:\n%s", output);
+    }
+    return -1;
+}
+
+// Run the cheap stages on code
+cascade_stage_t cascade_screen(const char *code, config_t *config, test_result_t *result) {
+    int custom_tests = strlen(config->test_command) > 0;
+    int has_smoke = strlen(config->cascade_smoke_command) > 0;
+    if (!custom_tests && !has_smoke) return CASCADE_TESTS;
+
+    const char *file_name = "test.c";
+    if (config->enable_evolution && strlen(config->evolution_file_path) > 0) {
+        const char *base_name = strrchr(config->evolution_file_path, '/');
+        file_name = base_name ? base_name + 1 : config->evolution_file_path;
+    }
+
+    workspace_t workspace;
+    char file_path[1024];
+    if (workspace_create(&workspace, "screen") != 0 ||
+        workspace_write_file(&workspace, file_name, code, file_path, sizeof(file_path)) != 0) {
+        workspace_destroy(&workspace);
+        return CASCADE_TESTS; // The full tests report the problem
+    }
+
+    cascade_stage_t stage = CASCADE_TESTS;
+    size_t name_length = strlen(file_name);
+    int is_c_source = name_length > 2 && strcmp(file_name + name_length - 2, ".c") == 0;
+    if (custom_tests && is_c_source && check_syntax(file_path, config, result) != 0) {
+        stage = CASCADE_SYNTAX;
+    } else if (has_smoke) {
+        test_result_t smoke = run_custom_test(config->cascade_smoke_command, file_path, config);
+        if (smoke.execution_ok) {
+            cleanup_test_result(&smoke);
+        } else {
+            *result = smoke;
+            stage = CASCADE_SMOKE;
+        }
+    }
+
+    workspace_destroy(&workspace);
+    return stage;
+}
@@ -0,0 +1,479 @@
+#include "beta_evolve.h"
+#include "archive.h"
+#include "cache.h"
+#include "island.h"
+#include "pipeline.h"
+#include "population.h"
+#include "trace.h"
+#include <sys/stat.h>
+
+// Build an agent prompt inside a trace span
+static char* build_agent_prompt(conversation_t *conv, agent_type_t agent) {
+    trace_span_t span = trace_begin("prompt", agent);
+    char *prompt = generate_agent_prompt(conv, agent);
+    trace_end(&span);
+    return prompt;
+}
+
+// Validate and clean an agent response inside a trace span
+static char* validate_agent_response(const char *response, agent_type_t agent) {
+    trace_span_t span = trace_begin("validate", agent);
+    char *cleaned = validate_and_clean_response(response);
+    trace_end(&span);
+    return cleaned;
+}
+
+// Run code evolution on the current solution if evolution markers are detected
+static void run_evolution_step(conversation_t *conv) {
+    config_t *config = conv->config;
+    
+    if (conv->current_solution && strstr(conv->current_solution, EVOLUTION_MARKER_START)) {
+        log_message(config, VERBOSITY_NORMAL, "%s🧬 Evolution markers detected - running code evolution...%s\n", 
+                   C_INFO, C_RESET);
+        evolve_code_regions(conv, &conv->evolution);
+        
+        if (config->verbosity >= VERBOSITY_VERBOSE) {
+            log_message(config, VERBOSITY_VERBOSE, 
+                       "%s🧬 Evolution status: %d regions, generation %d%s\n",
+                       C_INFO, conv->evolution.region_count, 
+                       conv->evolution.current_generation, C_RESET);
+        }
+    }
+}
+
+// Record the solution at the end of a single-candidate iteration; returns its archive id
+static uint64_t archive_iteration(archive_t *archive, const conversation_t *conv, uint64_t parent_id,
+                                  int evaluations_before) {
+    archive_record_t meta = {0};
+    archive_record_test(&meta, &conv->last_test_result);
+    if (conv->evolution.evaluation_count > evaluations_before) {
+        archive_record_evaluation(&meta, &conv->evolution.evaluation_history[conv->evolution.evaluation_count - 1]);
+    }
+    meta.parent_id = parent_id;
+    meta.iteration = conv->iterations;
+    meta.flags |= ARCHIVE_SELECTED;
+
+    uint64_t id = archive_append(archive, &meta, conv->current_solution, conv->last_test_result.error_message);
+    return id ? id : parent_id;
+}
+
+// Run the dual-AI collaboration
+int run_collaboration(const char *problem, config_t *config) {
+    conversation_t conv;
+    init_conversation(&conv, problem, config);
+    
+    // Initialize evolution if enabled
+    if (config->enable_evolution && strlen(config->evolution_file_path) > 0) {
+        log_message(config, VERBOSITY_NORMAL, "%s🧬 Evolution mode enabled for file: %s%s\n", 
+                   C_INFO, config->evolution_file_path, C_RESET);
+        
+        // Read the initial evolution file
+        char *file_content = read_evolution_file(config->evolution_file_path);
+        if (file_content) {
+            // Parse evolution regions
+            parse_evolution_regions(&conv.evolution, file_content);
+            
+            if (conv.evolution.region_count > 0) {
+                log_message(config, VERBOSITY_NORMAL, "%s🧬 Found %d evolution regions%s\n", 
+                           C_INFO, conv.evolution.region_count, C_RESET);
+                conv.evolution.evolution_enabled = 1;
+                
+                // Set the current solution to the file content
+                if (strlen(file_content) < (unsigned long)config->max_code_size) {
+                    strcpy(conv.current_solution, file_content);
+                }
+            }
+            free(file_content);
+        } else {
+            log_message(config, VERBOSITY_NORMAL, "%s❌ Failed to read evolution file: %s%s\n", 
+                       C_ERROR, config->evolution_file_path, C_RESET);
+        }
+    }
+    
+    print_header("Beta Evolve: Starting dual-AI collaboration");
+    log_message(config, VERBOSITY_NORMAL, "%sProblem:%s %s\n\n", C_EMPHASIS, C_RESET, problem);
+    
+    // Every evaluated candidate is archived; a resumed run continues after the last archived iteration
+    archive_t *archive = strlen(config->archive_file) > 0 ? archive_open(config->archive_file, problem) : NULL;
+    uint64_t archive_parent = 0;
+    int resume_iteration = 0;
+    if (archive && config->resume_from_archive) {
+        resume_iteration = archive_resume(archive, &conv, &archive_parent);
+        if (resume_iteration > 0) {
+            log_message(config, VERBOSITY_NORMAL, "%s🔁 Resuming after iteration %d from %s (%d archived candidates)%s\n",
+                       C_INFO, resume_iteration, config->archive_file, archive_count(archive), C_RESET);
+        } else {
+            log_message(config, VERBOSITY_NORMAL, "%sNothing to resume in %s, starting fresh%s\n",
+                       C_INFO, config->archive_file, C_RESET);
+        }
+    }
+    
+    // Population mode breeds several candidates per normal iteration
+    population_t population;
+    int use_population = config->population_size > 1;
+    if (use_population && init_population(&population, &conv, config) != 0) {
+        log_message(config, VERBOSITY_NORMAL, "%sError: Failed to initialize population%s\n", C_ERROR, C_RESET);
+        archive_close(archive);
+        cleanup_conversation(&conv);
+        return -1;
+    }
+    if (use_population) {
+        population.archive = archive;
+        if (resume_iteration > 0) {
+            int restored = restore_population(&population, archive);
+            log_message(config, VERBOSITY_VERBOSE, "%sRestored %d survivors of generation %d%s\n",
+                       C_INFO, restored, population.generation, C_RESET);
+        }
+    }
+    
+    // Pipelined mode overlaps model calls with testing in the single-candidate loop
+    pipeline_t pipeline;
+    int use_pipeline = config->enable_async_pipeline && !use_population;
+    if (use_pipeline && init_pipeline(&pipeline, config) != 0) {
+        use_pipeline = 0;
+    }
+    
+    int status = 0;
+    trace_span_t iteration_span = {0};           // Ended on every path, including failed iterations
+    int max_error_iterations = config->iterations * 3; // Allow up to 3x normal iterations for error fixing
+    int total_iterations = 0;
+    
+    for (int iteration = resume_iteration; iteration < config->iterations || has_code_errors(&conv.last_test_result); iteration++) {
+        // Safety check to prevent infinite loops
+        if (total_iterations >= max_error_iterations) {
+            log_message(config, VERBOSITY_NORMAL, 
+                       "%s🛑 Maximum iterations reached (%d). Stopping to prevent infinite loop.%s\n", 
+                       C_WARNING, max_error_iterations, C_RESET);
+            break;
+        }
+        
+        conv.iterations = iteration + 1;
+        total_iterations++;
+        
+        int evaluations_before = conv.evolution.evaluation_count;
+        trace_set_iteration(conv.iterations);
+        iteration_span = trace_begin("iteration", TRACE_NO_AGENT);
+        
+        // Log iteration start with appropriate verbosity
+        log_iteration_start(config, conv.iterations, total_iterations);
+        
+        // Show current error status if we have a solution
+        if (strlen(conv.current_solution) > 0) {
+            log_code_status(config, &conv.last_test_result);
+        }
+        
+        // Check if this is a normal iteration or error fix iteration
+        if (iteration < config->iterations && use_population) {
+            // Population iteration: breed and select candidates concurrently
+            trace_span_t generation_span = trace_begin("generation", TRACE_NO_AGENT);
+            int generation_result = run_population_generation(&population, &conv);
+            trace_end(&generation_span);
+            if (generation_result != 0) {
+                status = -1;
+                goto cleanup;
+            }
+            if (strlen(config->island_dir) > 0 &&
+                population.generation % config->island_migration_interval == 0) {
+                island_migrate(&population, problem, conv.iterations);
+            }
+            
+            // Run code evolution if evolution markers are detected
+            run_evolution_step(&conv);
+        } else if (iteration < config->iterations) {
+            // Normal iteration: Use both fast and reasoning agents
+            
+            // Fast Agent turn
+            log_message(config, VERBOSITY_NORMAL, "%s🏃 Fast Agent thinking...%s\n", C_INFO, C_RESET);
+            char *fast_prompt = arena_own(conv.scratch, build_agent_prompt(&conv, AGENT_FAST));
+            if (!fast_prompt) {
+                log_message(config, VERBOSITY_NORMAL, "%sError: Failed to generate fast agent prompt%s\n", C_ERROR, C_RESET);
+                status = -1;
+                goto cleanup;
+            }
+            
+            char *fast_response = use_pipeline ? pipeline_take_fast_response(&pipeline, fast_prompt) : NULL;
+            if (!fast_response) {
+                fast_response = call_ai_model(fast_prompt, AGENT_FAST, config);
+            }
+            arena_own(conv.scratch, fast_response);
+            
+            // Log the AI interaction in debug mode
+            log_ai_interaction(config, AGENT_FAST, fast_prompt, fast_response);
+            
+            if (!fast_response) {
+                log_message(config, VERBOSITY_NORMAL, "%sError: Fast agent failed to respond%s\n", C_ERROR, C_RESET);
+                status = -1;
+                goto cleanup;
+            }
+            
+            // Validate and clean the response
+            char *cleaned_fast_response = arena_own(conv.scratch, validate_agent_response(fast_response, AGENT_FAST));
+            
+            if (!cleaned_fast_response) {
+                log_message(config, VERBOSITY_NORMAL, "%sError: Failed to validate fast agent response%s\n", C_ERROR, C_RESET);
+                status = -1;
+                goto cleanup;
+            }
+            
+            add_message(&conv, AGENT_FAST, cleaned_fast_response);
+            if (use_pipeline) {
+                pipeline_prewarm_test(&pipeline, &conv, cleaned_fast_response);
+            }
+            
+            // Extract and show analysis if present
+            const char *analysis = strstr(cleaned_fast_response, "Analysis:");
+            if (analysis && config->verbosity >= VERBOSITY_VERBOSE) {
+                const char *analysis_end = strstr(analysis, "\n\n```");
+                if (analysis_end) {
+                    int analysis_len = analysis_end - analysis;
+                    log_message(config, VERBOSITY_VERBOSE, "%sFast Agent Analysis:%s %.*s\n", 
+                               C_INFO, C_RESET, analysis_len, analysis);
+                }
+            }
+            log_message(config, VERBOSITY_NORMAL, "%s🏃 Fast Agent provided code solution%s\n\n", C_SUCCESS, C_RESET);
+            
+            // Reasoning Agent turn
+            log_message(config, VERBOSITY_NORMAL, "%s🧠 Reasoning Agent analyzing...%s\n", C_INFO, C_RESET);
+            char *reasoning_prompt = arena_own(conv.scratch, build_agent_prompt(&conv, AGENT_REASONING));
+            if (!reasoning_prompt) {
+                log_message(config, VERBOSITY_NORMAL, "%sError: Failed to generate reasoning agent prompt%s\n", C_ERROR, C_RESET);
+                status = -1;
+                goto cleanup;
+            }
+            
+            char *reasoning_response = arena_own(conv.scratch, call_ai_model(reasoning_prompt, AGENT_REASONING, config));
+            
+            // Log the AI interaction in debug mode
+            log_ai_interaction(config, AGENT_REASONING, reasoning_prompt, reasoning_response);
+            
+            if (!reasoning_response) {
+                log_message(config, VERBOSITY_NORMAL, "%sError: Reasoning agent failed to respond%s\n", C_ERROR, C_RESET);
+                status = -1;
+                goto cleanup;
+            }
+            
+            // Validate and clean the response
+            char *cleaned_reasoning_response = arena_own(conv.scratch, validate_agent_response(reasoning_response, AGENT_REASONING));
+            
+            if (!cleaned_reasoning_response) {
+                log_message(config, VERBOSITY_NORMAL, "%sError: Failed to validate reasoning agent response%s\n", C_ERROR, C_RESET);
+                status = -1;
+                goto cleanup;
+            }
+            
+            add_message(&conv, AGENT_REASONING, cleaned_reasoning_response);
+            
+            // Extract and show analysis if present
+            const char *reasoning_analysis = strstr(cleaned_reasoning_response, "Analysis:");
+            if (reasoning_analysis && config->verbosity >= VERBOSITY_VERBOSE) {
+                const char *analysis_end = strstr(reasoning_analysis, "\n\n```");
+                if (analysis_end) {
+                    int analysis_len = analysis_end - reasoning_analysis;
+                    log_message(config, VERBOSITY_VERBOSE, "%sReasoning Agent Analysis:%s %.*s\n", 
+                               C_INFO, C_RESET, analysis_len, reasoning_analysis);
+                }
+            }
+            log_message(config, VERBOSITY_NORMAL, "%s🧠 Reasoning Agent provided refined solution%s\n\n", C_SUCCESS, C_RESET);
+            
+            // The next fast turn only depends on this code and its test outcome, so issue it now
+            if (use_pipeline) {
+                if (iteration + 1 < config->iterations) {
+                    pipeline_speculate_fast_turn(&pipeline, &conv, cleaned_reasoning_response);
+                }
+                pipeline_before_test(&pipeline, &conv, cleaned_reasoning_response);
+            }
+            
+            // Update solution with testing
+            trace_span_t test_span = trace_begin("test", TRACE_NO_AGENT);
+            update_solution_with_testing(&conv, cleaned_reasoning_response);
+            trace_end(&test_span);
+            
+            // Run code evolution if evolution markers are detected
+            run_evolution_step(&conv);
+        } else {
+            // Error fix iteration: Only use reasoning agent for bug fixes
+            log_message(config, VERBOSITY_NORMAL, "%s🧠 Reasoning Agent fixing bugs...%s\n", C_INFO, C_RESET);
+            char *reasoning_prompt = arena_own(conv.scratch, build_agent_prompt(&conv, AGENT_REASONING));
+            if (!reasoning_prompt) {
+                log_message(config, VERBOSITY_NORMAL, "%sError: Failed to generate reasoning agent prompt%s\n", C_ERROR, C_RESET);
+                status = -1;
+                goto cleanup;
+            }
+            
+            char *reasoning_response = arena_own(conv.scratch, call_ai_model(reasoning_prompt, AGENT_REASONING, config));
+            
+            // Log the AI interaction in debug mode
+            log_ai_interaction(config, AGENT_REASONING, reasoning_prompt, reasoning_response);
+            
+            if (!reasoning_response) {
+                log_message(config, VERBOSITY_NORMAL, "%sError: Reasoning agent failed to respond%s\n", C_ERROR, C_RESET);
+                status = -1;
+                goto cleanup;
+            }
+            
+            // Validate and clean the response
+            char *cleaned_reasoning_response = arena_own(conv.scratch, validate_agent_response(reasoning_response, AGENT_REASONING));
+            
+            if (!cleaned_reasoning_response) {
+                log_message(config, VERBOSITY_NORMAL, "%sError: Failed to validate reasoning agent response%s\n", C_ERROR, C_RESET);
+                status = -1;
+                goto cleanup;
+            }
+            
+            add_message(&conv, AGENT_REASONING, cleaned_reasoning_response);
+            
+            // Extract and show analysis if present
+            const char *reasoning_analysis = strstr(cleaned_reasoning_response, "Analysis:");
+            if (reasoning_analysis && config->verbosity >= VERBOSITY_VERBOSE) {
+                const char *analysis_end = strstr(reasoning_analysis, "\n\n```");
+                if (analysis_end) {
+                    int analysis_len = analysis_end - reasoning_analysis;
+                    log_message(config, VERBOSITY_VERBOSE, "%sReasoning Agent Analysis:%s %.*s\n", 
+                               C_INFO, C_RESET, analysis_len, reasoning_analysis);
+                }
+            }
+            log_message(config, VERBOSITY_NORMAL, "%s🧠 Reasoning Agent provided bug fix%s\n\n", C_SUCCESS, C_RESET);
+            
+            if (use_pipeline) {
+                pipeline_before_test(&pipeline, &conv, cleaned_reasoning_response);
+            }
+            
+            // Update solution with testing
+            trace_span_t test_span = trace_begin("test", TRACE_NO_AGENT);
+            update_solution_with_testing(&conv, cleaned_reasoning_response);
+            trace_end(&test_span);
+        }
+        
+        if (archive && !use_population && strlen(conv.current_solution) > 0) {
+            archive_parent = archive_iteration(archive, &conv, archive_parent, evaluations_before);
+        }
+        trace_end(&iteration_span);
+        
+        // Show progress
+        if (strlen(conv.current_solution) > 0) {
+            log_message(config, VERBOSITY_NORMAL, "%s💡 Current solution updated!%s\n", C_SUCCESS, C_RESET);
+            
+            // Check if we've resolved all errors
+            if (!has_code_errors(&conv.last_test_result)) {
+                log_message(config, VERBOSITY_NORMAL, "%s🎉 All code errors resolved! Code compiles and runs successfully.%s\n", C_SUCCESS, C_RESET);
+                if (iteration >= config->iterations) {
+                    log_message(config, VERBOSITY_NORMAL, "%s✅ Error fixing phase completed.%s\n", C_SUCCESS, C_RESET);
+                    break;
+                }
+            }
+            printf("\n");
+        }
+        
+        // Everything this iteration produced has been consumed or copied
+        arena_reset(conv.scratch);
+        
+        // Add delay between iterations
+        if (config->iteration_delay_ms > 0) usleep((useconds_t)config->iteration_delay_ms * 1000);
+    }
+    
+cleanup:
+    trace_end(&iteration_span);                  // No-op unless an iteration failed
+    // Every exit comes through here: pipeline tasks point into this stack frame
+    if (use_pipeline) {
+        cleanup_pipeline(&pipeline);
+    }
+    if (use_population) {
+        cleanup_population(&population);
+    }
+    archive_close(archive);
+    if (status != 0) {
+        cleanup_conversation(&conv);
+        return status;
+    }
+    
+    // Print final conversation and solution
+    print_conversation(&conv);
+    log_ai_agent_stats(config);
+    log_eval_cache_stats(config);
+    
+    // Save solution to file
+    if (strlen(conv.current_solution) > 0) {
+        char filename[1024];
+        time_t now = time(NULL);
+        struct tm tm_info;
+        localtime_r(&now, &tm_info);
+        if (strlen(config->output_dir) > 0) mkdir(config->output_dir, 0755);
+        snprintf(filename, sizeof(filename), "%s%ssolution_%04d%02d%02d_%02d%02d%02d.c",
+                config->output_dir, strlen(config->output_dir) > 0 ? "/" : "",
+                tm_info.tm_year + 1900, tm_info.tm_mon + 1, tm_info.tm_mday,
+                tm_info.tm_hour, tm_info.tm_min, tm_info.tm_sec);
+        
+        FILE *file = fopen(filename, "w");
+        if (file) {
+            fprintf(file, "%s\n", conv.current_solution);
+            fclose(file);
+            log_message(config, VERBOSITY_NORMAL, "%s💾 Solution saved to: %s%s\n", C_SUCCESS, filename, C_RESET);
+            
+            // Run final comprehensive evaluation if enabled
+            if (config->enable_comprehensive_evaluation) {
+                log_message(config, VERBOSITY_NORMAL, "%s🏁 Running final comprehensive evaluation...%s\n", C_INFO, C_RESET);
+                
+                evaluation_result_t final_eval = evaluate_code_comprehensive(
+                    filename, conv.current_solution, &config->eval_criteria, config);
+                
+                // Display final evaluation summary
+                printf("\n%s=== FINAL EVALUATION SUMMARY ===%s\n", C_HEADER, C_RESET);
+                printf("%sOverall Score:%s %.1f/100\n", C_EMPHASIS, C_RESET, final_eval.overall_score);
+                printf("%sCorrectness:%s %.1f/100\n", C_EMPHASIS, C_RESET, final_eval.correctness_score);
+                printf("%sPerformance:%s %.1f/100\n", C_EMPHASIS, C_RESET, final_eval.performance_score);
+                printf("%sCode Quality:%s %.1f/100\n", C_EMPHASIS, C_RESET, final_eval.quality_score);
+                
+                if (final_eval.passed_criteria) {
+                    printf("%s✅ All evaluation criteria met!%s\n", C_SUCCESS, C_RESET);
+                } else {
+                    printf("%s⚠️  Some criteria not met - see evaluation report for details%s\n", C_WARNING, C_RESET);
+                }
+                
+                // Save final evaluation report
+                if (final_eval.detailed_report && strlen(config->evaluation_output_file) > 0) {
+                    // Room for output_dir/final_<report name> without truncation
+                    char final_report_path[sizeof(config->output_dir) + sizeof(config->evaluation_output_file) + 8];
+                    const char *report_name = strrchr(config->evaluation_output_file, '/');
+                    report_name = report_name ? report_name + 1 : config->evaluation_output_file;
+                    snprintf(final_report_path, sizeof(final_report_path), "%s%sfinal_%s", config->output_dir,
+                             strlen(config->output_dir) > 0 ? "/" : "", report_name);
+                    
+                    FILE *report_file = fopen(final_report_path, "w");
+                    if (report_file) {
+                        fprintf(report_file, "%s", final_eval.detailed_report);
+                        fclose(report_file);
+                        printf("%s📄 Final evaluation report saved to: %s%s\n", C_INFO, final_report_path, C_RESET);
+                    }
+                }
+                
+                // Show performance summary
+                if (config->verbosity >= VERBOSITY_NORMAL) {
+                    printf("\n%sPerformance Summary:%s\n", C_EMPHASIS, C_RESET);
+                    if (final_eval.performance.ns_per_call > 0) {
+                        printf("  Time Per Call: %.1f ns (%s)\n", final_eval.performance.ns_per_call, config->kernel_entry);
+                    } else {
+                        printf("  Execution Time: %.2f ms\n", final_eval.performance.execution_time_ms);
+                    }
+                    if (strlen(final_eval.performance.build_flags) > 0) {
+                        printf("  Fastest Build: %s\n", final_eval.performance.build_flags);
+                    }
+                    printf("  Memory Usage: %ld KB\n", final_eval.performance.memory_usage_kb);
+                    printf("  Throughput: %.1f ops/sec\n", final_eval.performance.throughput);
+                    
+                    printf("\n%sCode Quality Summary:%s\n", C_EMPHASIS, C_RESET);
+                    printf("  Lines of Code: %d\n", final_eval.quality.lines_of_code);
+                    printf("  Cyclomatic Complexity: %d\n", final_eval.quality.cyclomatic_complexity);
+                    printf("  Test Coverage: %.1f%%\n", final_eval.quality.test_coverage_percent);
+                    printf("  Maintainability Index: %.1f/100\n", final_eval.quality.maintainability_index);
+                }
+                
+                cleanup_evaluation_result(&final_eval);
+            }
+        } else {
+            log_message(config, VERBOSITY_NORMAL, "%s❌ Failed to save solution to file%s\n", C_ERROR, C_RESET);
+        }
+    }
+    
+    cleanup_conversation(&conv);
+    return 0;
+}
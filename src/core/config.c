@@ -1,6 +1,8 @@
 #include "config.h"
 #include "toml.h"
 #include "colors.h"
+#include "workspace.h"
+#include <sys/stat.h>
 
 // Check if endpoint is a local server
 int is_local_server(const char *endpoint) {
@@ -9,6 +11,126 @@ int is_local_server(const char *endpoint) {
             strstr(endpoint, "::1") != NULL);
 }
 
+// Read a number that may be written as an integer or a float
+static int toml_number_in(const toml_table_t *table, const char *key, double *value) {
+    toml_datum_t number = toml_double_in(table, key);
+    if (number.ok) {
+        *value = number.u.d;
+        return 1;
+    }
+    number = toml_int_in(table, key);
+    if (number.ok) {
+        *value = (double)number.u.i;
+        return 1;
+    }
+    return 0;
+}
+
+// Load the [[metric]] tables that define metric fitness
+static void load_fitness_metrics(config_t *config, toml_table_t *toml) {
+    config->metric_count = 0;
+    toml_array_t *metrics = toml_array_in(toml, "metric");
+    if (!metrics) return;
+
+    for (int i = 0; i < toml_array_nelem(metrics); i++) {
+        toml_table_t *table = toml_table_at(metrics, i);
+        if (!table) continue;
+
+        toml_datum_t name = toml_string_in(table, "name");
+        if (!name.ok || strlen(name.u.s) == 0 || strlen(name.u.s) >= sizeof(config->metrics[0].name)) {
+            printf("Warning: Ignoring [[metric]] %d without a valid name\n", i + 1);
+            if (name.ok) free(name.u.s);
+            continue;
+        }
+        if (config->metric_count == MAX_FITNESS_METRICS) {
+            printf("Warning: Only %d [[metric]] tables are used, ignoring '%s'\n", MAX_FITNESS_METRICS, name.u.s);
+            free(name.u.s);
+            continue;
+        }
+
+        fitness_metric_t *metric = &config->metrics[config->metric_count++];
+        memset(metric, 0, sizeof(fitness_metric_t));
+        strcpy(metric->name, name.u.s);
+        free(name.u.s);
+
+        toml_datum_t direction = toml_string_in(table, "direction");
+        if (direction.ok) {
+            metric->minimize = strcmp(direction.u.s, "minimize") == 0;
+            if (!metric->minimize && strcmp(direction.u.s, "maximize") != 0) {
+                printf("Warning: Unknown direction '%s' for metric '%s', maximizing it\n", direction.u.s, metric->name);
+            }
+            free(direction.u.s);
+        }
+
+        if (!toml_number_in(table, "weight", &metric->weight) || metric->weight < 0.0) {
+            metric->weight = 1.0;
+        }
+        if (!toml_number_in(table, "scale", &metric->scale) || metric->scale <= 0.0) {
+            metric->scale = 1.0; // Default to scoring 1.0 as 0.5
+        }
+        metric->has_min = toml_number_in(table, "min", &metric->min);
+        metric->has_max = toml_number_in(table, "max", &metric->max);
+    }
+}
+
+// Append a command to the test suite; returns 0 on success
+static int add_test_case(config_t *config, const char *command) {
+    if (strlen(command) >= sizeof(config->test_command)) {
+        printf("Warning: Test case too long, ignoring: %.80s...\n", command);
+        return -1;
+    }
+    char **cases = realloc(config->test_cases, (config->test_case_count + 1) * sizeof(char *));
+    if (!cases) return -1;
+    config->test_cases = cases;
+    config->test_cases[config->test_case_count] = strdup(command);
+    if (!config->test_cases[config->test_case_count]) return -1;
+    config->test_case_count++;
+    return 0;
+}
+
+// Add every command line of a test manifest (blank lines and # comments are skipped)
+static int load_test_manifest(config_t *config, const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot open test manifest %s\n", path);
+        return -1;
+    }
+
+    char line[2048];
+    int added = 0;
+    while (fgets(line, sizeof(line), file)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        char *command = line;
+        while (*command == ' ' || *command == '\t') command++;
+        if (*command == '\0' || *command == '#') continue;
+        if (add_test_case(config, command) == 0) added++;
+    }
+    fclose(file);
+    return added;
+}
+
+// Load an agent's fallback endpoints (a list of URLs or a single URL); returns how many
+static int load_fallback_endpoints(toml_table_t *toml, const char *key,
+                                   char endpoints[][512], const char *primary) {
+    int count = 0;
+    toml_array_t *list = toml_array_in(toml, key);
+    toml_datum_t single = toml_string_in(toml, key);
+    int total = list ? toml_array_nelem(list) : (single.ok ? 1 : 0);
+    for (int i = 0; i < total; i++) {
+        toml_datum_t endpoint = list ? toml_string_at(list, i) : single;
+        if (!endpoint.ok) continue;
+        if (strlen(endpoint.u.s) == 0 || strcmp(endpoint.u.s, primary) == 0) {
+            // Nothing to fail over to
+        } else if (count == MAX_FALLBACK_ENDPOINTS) {
+            printf("Warning: Only %d %s entries are used, ignoring \"%s\"\n", MAX_FALLBACK_ENDPOINTS, key, endpoint.u.s);
+        } else {
+            snprintf(endpoints[count++], 512, "%s", endpoint.u.s);
+        }
+        free(endpoint.u.s);
+    }
+    return count;
+}
+
 // Load configuration from TOML file
 int load_config(config_t *config, const char *config_file) {
     // Initialize new fields
@@ -18,6 +140,8 @@ int load_config(config_t *config, const char *config_file) {
     memset(config->test_command, 0, sizeof(config->test_command));
     config->enable_evolution = 0;
     config->loaded_problem_prompt = NULL;
+    config->test_cases = NULL;
+    config->test_case_count = 0;
     
     FILE *file = fopen(config_file, "r");
     if (!file) {
@@ -113,6 +237,31 @@ int load_config(config_t *config, const char *config_file) {
         if (reasoning_model_name.ok) free(reasoning_model_name.u.s);
     }
 
+    // Load streaming configuration
+    toml_datum_t enable_streaming = toml_bool_in(toml, "enable_streaming");
+    if (enable_streaming.ok) {
+        config->enable_streaming = enable_streaming.u.b;
+    } else {
+        config->enable_streaming = 0; // Default to disabled
+    }
+
+    toml_datum_t stream_early_cutoff = toml_bool_in(toml, "stream_early_cutoff");
+    if (stream_early_cutoff.ok) {
+        config->stream_early_cutoff = stream_early_cutoff.u.b;
+    } else {
+        config->stream_early_cutoff = 1; // Default to enabled
+    }
+
+    toml_datum_t enable_async_pipeline = toml_bool_in(toml, "enable_async_pipeline");
+    if (enable_async_pipeline.ok) {
+        config->enable_async_pipeline = enable_async_pipeline.u.b;
+    } else {
+        config->enable_async_pipeline = 0; // Default to the serial loop
+    }
+    if (config->enable_async_pipeline) {
+        printf("Info: Async pipeline enabled (speculative fast turns, background tests)\n");
+    }
+
     // Load iteration count with default value of 3
     toml_datum_t iterations = toml_int_in(toml, "iterations");
     if (iterations.ok && iterations.u.i > 0) {
@@ -122,6 +271,9 @@ int load_config(config_t *config, const char *config_file) {
         printf("Info: Using default iteration count: %d\n", config->iterations);
     }
 
+    toml_datum_t iteration_delay = toml_int_in(toml, "iteration_delay_ms");
+    config->iteration_delay_ms = iteration_delay.ok && iteration_delay.u.i >= 0 ? (int)iteration_delay.u.i : 1000;
+
     // Load flexible configuration parameters with defaults
     toml_datum_t max_response_size = toml_int_in(toml, "max_response_size");
     if (max_response_size.ok && max_response_size.u.i > 0) {
@@ -217,13 +369,45 @@ int load_config(config_t *config, const char *config_file) {
     }
 
     toml_datum_t test_command = toml_string_in(toml, "test_command");
-    if (test_command.ok && strlen(test_command.u.s) > 0) {
+    toml_array_t *test_commands = toml_array_in(toml, "test_command");
+    toml_datum_t test_manifest = toml_string_in(toml, "test_manifest");
+    if (test_commands || (test_manifest.ok && strlen(test_manifest.u.s) > 0)) {
+        // A list of commands and/or a manifest make a test suite; a single string stays one command
+        for (int i = 0; test_commands && i < toml_array_nelem(test_commands); i++) {
+            toml_datum_t command = toml_string_at(test_commands, i);
+            if (!command.ok) continue;
+            if (strlen(command.u.s) > 0) add_test_case(config, command.u.s);
+            free(command.u.s);
+        }
+        if (test_command.ok && strlen(test_command.u.s) > 0) add_test_case(config, test_command.u.s);
+        if (test_manifest.ok && strlen(test_manifest.u.s) > 0 && load_test_manifest(config, test_manifest.u.s) == 0) {
+            printf("Warning: Test manifest %s has no test cases\n", test_manifest.u.s);
+        }
+    }
+    if (config->test_case_count > 0) {
+        strcpy(config->test_command, config->test_cases[0]);
+    } else if (test_command.ok && strlen(test_command.u.s) > 0) {
         strcpy(config->test_command, test_command.u.s);
-        free(test_command.u.s);
         printf("Info: Test command: '%s'\n", config->test_command);
     } else {
         strcpy(config->test_command, "");
-        if (test_command.ok) free(test_command.u.s);
+    }
+    if (test_command.ok) free(test_command.u.s);
+    if (test_manifest.ok) free(test_manifest.u.s);
+
+    toml_datum_t test_jobs = toml_int_in(toml, "test_jobs");
+    if (test_jobs.ok && test_jobs.u.i > 0) {
+        config->test_jobs = (int)test_jobs.u.i;
+    } else {
+        long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+        config->test_jobs = cpu_count > 0 ? (int)cpu_count : 1; // Default to one per CPU
+    }
+
+    toml_datum_t test_fail_fast = toml_bool_in(toml, "test_fail_fast");
+    config->test_fail_fast = test_fail_fast.ok ? test_fail_fast.u.b : 1; // Default to cancelling on failure
+    if (config->test_case_count > 0) {
+        printf("Info: Test suite: %d cases, %d jobs%s\n", config->test_case_count, config->test_jobs,
+               config->test_fail_fast ? ", fail-fast" : "");
     }
 
     toml_datum_t enable_evolution = toml_bool_in(toml, "enable_evolution");
@@ -237,6 +421,462 @@ int load_config(config_t *config, const char *config_file) {
         printf("Info: Evolution mode enabled\n");
     }
 
+    toml_datum_t region_scoped_prompts = toml_bool_in(toml, "region_scoped_prompts");
+    if (region_scoped_prompts.ok) {
+        config->region_scoped_prompts = region_scoped_prompts.u.b;
+    } else {
+        config->region_scoped_prompts = 0; // Default to sending the whole file
+    }
+
+    toml_datum_t region_prompt_token_budget = toml_int_in(toml, "region_prompt_token_budget");
+    if (region_prompt_token_budget.ok && region_prompt_token_budget.u.i >= 0) {
+        config->region_prompt_token_budget = (int)region_prompt_token_budget.u.i;
+    } else {
+        config->region_prompt_token_budget = 4000;
+    }
+
+    if (config->region_scoped_prompts) {
+        printf("Info: Region-scoped prompts enabled (budget: %d tokens)\n", config->region_prompt_token_budget);
+    }
+
+    toml_datum_t region_patch_responses = toml_bool_in(toml, "region_patch_responses");
+    if (region_patch_responses.ok) {
+        config->region_patch_responses = region_patch_responses.u.b;
+    } else {
+        config->region_patch_responses = 0; // Default to full code blocks
+    }
+
+    if (config->region_patch_responses) {
+        printf("Info: Per-region patch responses enabled\n");
+    }
+
+    // Load population configuration
+    toml_datum_t population_size = toml_int_in(toml, "population_size");
+    if (population_size.ok && population_size.u.i > 0) {
+        config->population_size = (int)population_size.u.i;
+    } else {
+        config->population_size = 1; // Default to a single candidate per iteration
+    }
+
+    toml_datum_t population_survivors = toml_int_in(toml, "population_survivors");
+    if (population_survivors.ok && population_survivors.u.i > 0) {
+        config->population_survivors = (int)population_survivors.u.i;
+    } else {
+        config->population_survivors = 2;
+    }
+    if (config->population_survivors > config->population_size) {
+        config->population_survivors = config->population_size;
+    }
+
+    toml_datum_t evaluation_workers = toml_int_in(toml, "evaluation_workers");
+    if (evaluation_workers.ok && evaluation_workers.u.i > 0) {
+        config->evaluation_workers = (int)evaluation_workers.u.i;
+    } else {
+        long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+        config->evaluation_workers = cpu_count > 0 ? (int)cpu_count : 1; // Default to one per CPU
+    }
+
+    toml_datum_t workspace_dir = toml_string_in(toml, "workspace_dir");
+    if (workspace_dir.ok && strlen(workspace_dir.u.s) > 0) {
+        strncpy(config->workspace_dir, workspace_dir.u.s, sizeof(config->workspace_dir) - 1);
+        config->workspace_dir[sizeof(config->workspace_dir) - 1] = '\0';
+        free(workspace_dir.u.s);
+        printf("Info: Workspace directory: '%s'\n", config->workspace_dir);
+    } else {
+        strcpy(config->workspace_dir, "");
+        if (workspace_dir.ok) free(workspace_dir.u.s);
+    }
+    workspace_set_root(config->workspace_dir);
+
+    // Load evaluation cache configuration
+    toml_datum_t enable_eval_cache = toml_bool_in(toml, "enable_eval_cache");
+    if (enable_eval_cache.ok) {
+        config->enable_eval_cache = enable_eval_cache.u.b;
+    } else {
+        config->enable_eval_cache = 1; // Default to enabled
+    }
+
+    toml_datum_t eval_cache_dir = toml_string_in(toml, "eval_cache_dir");
+    if (eval_cache_dir.ok && strlen(eval_cache_dir.u.s) > 0) {
+        strncpy(config->eval_cache_dir, eval_cache_dir.u.s, sizeof(config->eval_cache_dir) - 1);
+        config->eval_cache_dir[sizeof(config->eval_cache_dir) - 1] = '\0';
+        free(eval_cache_dir.u.s);
+        if (config->enable_eval_cache) {
+            printf("Info: Evaluation cache directory: '%s'\n", config->eval_cache_dir);
+        }
+    } else {
+        strcpy(config->eval_cache_dir, "");
+        if (eval_cache_dir.ok) free(eval_cache_dir.u.s);
+    }
+
+    // Load archive configuration
+    toml_datum_t archive_file = toml_string_in(toml, "archive_file");
+    if (archive_file.ok && strlen(archive_file.u.s) > 0) {
+        strncpy(config->archive_file, archive_file.u.s, sizeof(config->archive_file) - 1);
+        config->archive_file[sizeof(config->archive_file) - 1] = '\0';
+        free(archive_file.u.s);
+        printf("Info: Candidate archive: '%s'\n", config->archive_file);
+    } else {
+        strcpy(config->archive_file, "");
+        if (archive_file.ok) free(archive_file.u.s);
+    }
+
+    toml_datum_t resume_from_archive = toml_bool_in(toml, "resume_from_archive");
+    if (resume_from_archive.ok) {
+        config->resume_from_archive = resume_from_archive.u.b;
+    } else {
+        config->resume_from_archive = 0; // Default to starting fresh
+    }
+    if (config->resume_from_archive && strlen(config->archive_file) > 0) {
+        printf("Info: Resuming from the candidate archive\n");
+    }
+
+    // Load benchmark configuration
+    toml_datum_t benchmark_warmup_runs = toml_int_in(toml, "benchmark_warmup_runs");
+    if (benchmark_warmup_runs.ok && benchmark_warmup_runs.u.i >= 0) {
+        config->benchmark_warmup_runs = (int)benchmark_warmup_runs.u.i;
+    } else {
+        config->benchmark_warmup_runs = 2; // Default to two untimed runs
+    }
+
+    toml_datum_t benchmark_min_runs = toml_int_in(toml, "benchmark_min_runs");
+    if (benchmark_min_runs.ok && benchmark_min_runs.u.i > 0) {
+        config->benchmark_min_runs = (int)benchmark_min_runs.u.i;
+    } else {
+        config->benchmark_min_runs = 5; // Default to five timed runs
+    }
+
+    toml_datum_t benchmark_max_runs = toml_int_in(toml, "benchmark_max_runs");
+    if (benchmark_max_runs.ok && benchmark_max_runs.u.i > 0) {
+        config->benchmark_max_runs = (int)benchmark_max_runs.u.i;
+    } else {
+        config->benchmark_max_runs = 30; // Default to at most thirty timed runs
+    }
+    if (config->benchmark_min_runs > config->benchmark_max_runs) {
+        config->benchmark_min_runs = config->benchmark_max_runs;
+    }
+
+    toml_datum_t benchmark_target_ci_percent = toml_double_in(toml, "benchmark_target_ci_percent");
+    if (benchmark_target_ci_percent.ok && benchmark_target_ci_percent.u.d > 0) {
+        config->benchmark_target_ci_percent = benchmark_target_ci_percent.u.d;
+    } else {
+        config->benchmark_target_ci_percent = 2.0; // Default to a CI within 2% of the mean
+    }
+
+    toml_datum_t benchmark_max_time_ms = toml_int_in(toml, "benchmark_max_time_ms");
+    if (benchmark_max_time_ms.ok && benchmark_max_time_ms.u.i > 0) {
+        config->benchmark_max_time_ms = (int)benchmark_max_time_ms.u.i;
+    } else {
+        config->benchmark_max_time_ms = 5000; // Default to a 5 second budget
+    }
+
+    toml_datum_t benchmark_cpu = toml_int_in(toml, "benchmark_cpu");
+    if (benchmark_cpu.ok) {
+        config->benchmark_cpu = (int)benchmark_cpu.u.i;
+    } else {
+        config->benchmark_cpu = -1; // Default to no pinning
+    }
+
+    toml_datum_t enable_hardware_counters = toml_bool_in(toml, "enable_hardware_counters");
+    if (enable_hardware_counters.ok) {
+        config->enable_hardware_counters = enable_hardware_counters.u.b;
+    } else {
+        config->enable_hardware_counters = 1; // Default to enabled (falls back when unavailable)
+    }
+
+    toml_datum_t enable_scaling_sweep = toml_bool_in(toml, "enable_scaling_sweep");
+    if (enable_scaling_sweep.ok) {
+        config->enable_scaling_sweep = enable_scaling_sweep.u.b;
+    } else {
+        config->enable_scaling_sweep = 0; // Default to the single size in main()
+    }
+
+    toml_datum_t scaling_min_size = toml_int_in(toml, "scaling_min_size");
+    if (scaling_min_size.ok && scaling_min_size.u.i > 0) {
+        config->scaling_min_size = (long)scaling_min_size.u.i;
+    } else {
+        config->scaling_min_size = 1000;
+    }
+
+    toml_datum_t scaling_max_size = toml_int_in(toml, "scaling_max_size");
+    if (scaling_max_size.ok && scaling_max_size.u.i > 0) {
+        config->scaling_max_size = (long)scaling_max_size.u.i;
+    } else {
+        config->scaling_max_size = 1000000;
+    }
+    if (config->scaling_max_size < config->scaling_min_size) {
+        printf("Warning: scaling_max_size is below scaling_min_size, using %ld\n", config->scaling_min_size);
+        config->scaling_max_size = config->scaling_min_size;
+    }
+
+    toml_datum_t scaling_factor = toml_int_in(toml, "scaling_factor");
+    if (scaling_factor.ok && scaling_factor.u.i >= 2) {
+        config->scaling_factor = (int)scaling_factor.u.i;
+    } else {
+        config->scaling_factor = 4; // Default to quadrupling the size
+    }
+
+    toml_datum_t scaling_max_point_ms = toml_int_in(toml, "scaling_max_point_ms");
+    if (scaling_max_point_ms.ok && scaling_max_point_ms.u.i >= 0) {
+        config->scaling_max_point_ms = (int)scaling_max_point_ms.u.i;
+    } else {
+        config->scaling_max_point_ms = 1000; // Default to stopping after a 1 second size
+    }
+
+    // Load the build matrix benchmarked for every candidate
+    config->build_config_count = 0;
+    toml_array_t *build_flags = toml_array_in(toml, "build_flags");
+    for (int i = 0; build_flags && i < toml_array_nelem(build_flags); i++) {
+        toml_datum_t flags = toml_string_at(build_flags, i);
+        if (!flags.ok) continue;
+        if (config->build_config_count == MAX_BUILD_CONFIGS) {
+            printf("Warning: Only %d build_flags entries are used, ignoring \"%s\"\n", MAX_BUILD_CONFIGS, flags.u.s);
+        } else {
+            snprintf(config->build_flags[config->build_config_count++], sizeof(config->build_flags[0]), "%s", flags.u.s);
+        }
+        free(flags.u.s);
+    }
+    if (config->build_config_count == 0) {
+        strcpy(config->build_flags[0], "-O2"); // Default to a single -O2 build
+        config->build_config_count = 1;
+    }
+
+    toml_datum_t pgo_flags = toml_string_in(toml, "pgo_flags");
+    if (pgo_flags.ok) {
+        snprintf(config->pgo_flags, sizeof(config->pgo_flags), "%s", pgo_flags.u.s);
+        free(pgo_flags.u.s);
+    } else {
+        strcpy(config->pgo_flags, ""); // Default to no PGO build
+    }
+
+    toml_datum_t alloc_shim_path = toml_string_in(toml, "alloc_shim_path");
+    if (alloc_shim_path.ok) {
+        snprintf(config->alloc_shim_path, sizeof(config->alloc_shim_path), "%s", alloc_shim_path.u.s);
+        free(alloc_shim_path.u.s);
+    } else {
+        strcpy(config->alloc_shim_path, ""); // Default to libbeta_alloc.so next to the executable
+    }
+
+    // Load the in-process kernel benchmark
+    static const char *kernel_signatures[] = { "int_array", "long_array", "double_array", "byte_array", "void" };
+    static const char *kernel_prototypes[] = {
+        "(int *data, int n)", "(long *data, int n)", "(double *data, int n)", "(unsigned char *data, int n)", "(void)"
+    };
+    toml_datum_t kernel_entry = toml_string_in(toml, "kernel_entry");
+    if (kernel_entry.ok) {
+        snprintf(config->kernel_entry, sizeof(config->kernel_entry), "%s", kernel_entry.u.s);
+        free(kernel_entry.u.s);
+    } else {
+        strcpy(config->kernel_entry, ""); // Default to benchmarking whole runs of main()
+    }
+
+    config->kernel_signature = KERNEL_INT_ARRAY; // Default to void entry(int *data, int n)
+    toml_datum_t kernel_signature = toml_string_in(toml, "kernel_signature");
+    if (kernel_signature.ok) {
+        int known = 0;
+        for (int i = 0; i <= KERNEL_VOID; i++) {
+            if (strcmp(kernel_signature.u.s, kernel_signatures[i]) == 0) {
+                config->kernel_signature = (kernel_signature_t)i;
+                known = 1;
+            }
+        }
+        if (!known) printf("Warning: Unknown kernel_signature '%s', using int_array\n", kernel_signature.u.s);
+        free(kernel_signature.u.s);
+    }
+
+    toml_datum_t kernel_input_size = toml_int_in(toml, "kernel_input_size");
+    if (kernel_input_size.ok && kernel_input_size.u.i > 0 && kernel_input_size.u.i <= 100000000) {
+        config->kernel_input_size = (int)kernel_input_size.u.i;
+    } else {
+        config->kernel_input_size = 1000; // Default to 1000 elements
+    }
+
+    toml_datum_t kernel_inputs = toml_int_in(toml, "kernel_inputs");
+    if (kernel_inputs.ok && kernel_inputs.u.i > 0 && kernel_inputs.u.i <= 1024) {
+        config->kernel_inputs = (int)kernel_inputs.u.i;
+    } else {
+        config->kernel_inputs = 16; // Default to sixteen inputs
+    }
+
+    toml_datum_t kernel_max_batches = toml_int_in(toml, "kernel_max_batches");
+    if (kernel_max_batches.ok && kernel_max_batches.u.i > 0) {
+        config->kernel_max_batches = (int)kernel_max_batches.u.i;
+    } else {
+        config->kernel_max_batches = 500; // Default to at most 500 timed batches
+    }
+
+    toml_datum_t kernel_target_ci_percent = toml_double_in(toml, "kernel_target_ci_percent");
+    if (kernel_target_ci_percent.ok && kernel_target_ci_percent.u.d > 0) {
+        config->kernel_target_ci_percent = kernel_target_ci_percent.u.d;
+    } else {
+        config->kernel_target_ci_percent = 0.5; // Default to a CI within 0.5% of the mean
+    }
+
+    toml_datum_t kernel_runner_path = toml_string_in(toml, "kernel_runner_path");
+    if (kernel_runner_path.ok) {
+        snprintf(config->kernel_runner_path, sizeof(config->kernel_runner_path), "%s", kernel_runner_path.u.s);
+        free(kernel_runner_path.u.s);
+    } else {
+        strcpy(config->kernel_runner_path, ""); // Default to beta_kernel_runner next to the executable
+    }
+
+    if (strlen(config->kernel_entry) > 0) {
+        printf("Info: Kernel benchmark: void %s%s in-process, n = %d\n", config->kernel_entry,
+               kernel_prototypes[config->kernel_signature], config->kernel_input_size);
+        if (strlen(config->pgo_flags) > 0) {
+            printf("Warning: pgo_flags is not used by the kernel benchmark\n");
+        }
+    }
+
+    if (config->build_config_count > 1 || strlen(config->pgo_flags) > 0) {
+        printf("Info: Benchmarking %d build configurations%s\n", config->build_config_count,
+               strlen(config->pgo_flags) > 0 ? " plus a PGO build" : "");
+    }
+
+    if (config->enable_scaling_sweep) {
+        printf("Info: Scaling sweep over n = %ld..%ld (x%d)\n",
+               config->scaling_min_size, config->scaling_max_size, config->scaling_factor);
+    }
+
+    // Load candidate execution limits
+    toml_datum_t candidate_timeout_ms = toml_int_in(toml, "candidate_timeout_ms");
+    if (candidate_timeout_ms.ok && candidate_timeout_ms.u.i >= 0) {
+        config->candidate_timeout_ms = (int)candidate_timeout_ms.u.i;
+    } else {
+        config->candidate_timeout_ms = 10000; // Default to 10 seconds
+    }
+
+    toml_datum_t candidate_cpu_time_s = toml_int_in(toml, "candidate_cpu_time_s");
+    if (candidate_cpu_time_s.ok && candidate_cpu_time_s.u.i >= 0) {
+        config->candidate_cpu_time_s = (int)candidate_cpu_time_s.u.i;
+    } else {
+        config->candidate_cpu_time_s = 10; // Default to 10 CPU seconds
+    }
+
+    toml_datum_t candidate_memory_mb = toml_int_in(toml, "candidate_memory_mb");
+    if (candidate_memory_mb.ok && candidate_memory_mb.u.i >= 0) {
+        config->candidate_memory_mb = (int)candidate_memory_mb.u.i;
+    } else {
+        config->candidate_memory_mb = 2048; // Default to 2GB of address space
+    }
+
+    toml_datum_t candidate_max_processes = toml_int_in(toml, "candidate_max_processes");
+    if (candidate_max_processes.ok && candidate_max_processes.u.i >= 0) {
+        config->candidate_max_processes = (int)candidate_max_processes.u.i;
+    } else {
+        config->candidate_max_processes = 4096; // Default to 4096 processes of the user
+    }
+
+    toml_datum_t candidate_output_kb = toml_int_in(toml, "candidate_output_kb");
+    if (candidate_output_kb.ok && candidate_output_kb.u.i >= 0) {
+        config->candidate_output_kb = (int)candidate_output_kb.u.i;
+    } else {
+        config->candidate_output_kb = 1024; // Default to 1MB of output
+    }
+
+    toml_datum_t compile_timeout_ms = toml_int_in(toml, "compile_timeout_ms");
+    if (compile_timeout_ms.ok && compile_timeout_ms.u.i >= 0) {
+        config->compile_timeout_ms = (int)compile_timeout_ms.u.i;
+    } else {
+        config->compile_timeout_ms = 60000; // Default to 1 minute
+    }
+
+    if (config->population_size > 1) {
+        printf("Info: Population mode: %d candidates per generation, %d survivors, %d evaluation workers\n",
+               config->population_size, config->population_survivors, config->evaluation_workers);
+    }
+
+    toml_datum_t population_shared_samples = toml_bool_in(toml, "population_shared_samples");
+    if (population_shared_samples.ok) {
+        config->population_shared_samples = population_shared_samples.u.b;
+    } else {
+        config->population_shared_samples = 0; // Default to one fast request per candidate
+    }
+
+    if (config->population_shared_samples && config->population_size > 1) {
+        printf("Info: Candidates of the same parent share one multi-sample fast request\n");
+    }
+
+    toml_datum_t enable_eval_cascade = toml_bool_in(toml, "enable_eval_cascade");
+    config->enable_eval_cascade = enable_eval_cascade.ok ? enable_eval_cascade.u.b : 0; // Default to the full path
+
+    toml_datum_t cascade_smoke_command = toml_string_in(toml, "cascade_smoke_command");
+    if (cascade_smoke_command.ok && strlen(cascade_smoke_command.u.s) < sizeof(config->cascade_smoke_command)) {
+        strcpy(config->cascade_smoke_command, cascade_smoke_command.u.s);
+    } else {
+        strcpy(config->cascade_smoke_command, "");
+    }
+    if (cascade_smoke_command.ok) free(cascade_smoke_command.u.s);
+
+    if (!toml_number_in(toml, "cascade_threshold", &config->cascade_threshold) || config->cascade_threshold < 0.0) {
+        config->cascade_threshold = 0.1; // Default to a tenth of the fitness range
+    }
+
+    if (config->enable_eval_cascade && config->population_size > 1) {
+        printf("Info: Evaluation cascade: near-duplicate check, syntax%s, tests, benchmark within %.2f of the best\n",
+               strlen(config->cascade_smoke_command) > 0 ? ", smoke test" : "", config->cascade_threshold);
+    }
+
+    // Load island configuration (needs population mode; overrides archive_file)
+    toml_datum_t island_dir = toml_string_in(toml, "island_dir");
+    if (island_dir.ok && strlen(island_dir.u.s) > 0) {
+        strncpy(config->island_dir, island_dir.u.s, sizeof(config->island_dir) - 1);
+        config->island_dir[sizeof(config->island_dir) - 1] = '\0';
+        free(island_dir.u.s);
+    } else {
+        strcpy(config->island_dir, "");
+        if (island_dir.ok) free(island_dir.u.s);
+    }
+
+    toml_datum_t island_name = toml_string_in(toml, "island_name");
+    if (island_name.ok && strlen(island_name.u.s) > 0) {
+        strncpy(config->island_name, island_name.u.s, sizeof(config->island_name) - 1);
+        config->island_name[sizeof(config->island_name) - 1] = '\0';
+        free(island_name.u.s);
+    } else {
+        // Unique per process; set island_name explicitly to resume an island
+        char host[64] = "localhost";
+        gethostname(host, sizeof(host) - 1);
+        host[sizeof(host) - 1] = '\0';
+        snprintf(config->island_name, sizeof(config->island_name), "%s-%d", host, (int)getpid());
+        if (island_name.ok) free(island_name.u.s);
+    }
+
+    toml_datum_t island_migration_interval = toml_int_in(toml, "island_migration_interval");
+    if (island_migration_interval.ok && island_migration_interval.u.i > 0) {
+        config->island_migration_interval = (int)island_migration_interval.u.i;
+    } else {
+        config->island_migration_interval = 5; // Default to every 5 generations
+    }
+
+    toml_datum_t island_migrants = toml_int_in(toml, "island_migrants");
+    if (island_migrants.ok && island_migrants.u.i >= 0) {
+        config->island_migrants = (int)island_migrants.u.i;
+    } else {
+        config->island_migrants = 2; // Default to the two best peer elites
+    }
+
+    if (strlen(config->island_dir) > 0) {
+        if (config->population_size <= 1) {
+            printf("Warning: island_dir needs population mode (population_size > 1), ignoring it\n");
+            strcpy(config->island_dir, "");
+        } else {
+            // A truncated path would be an archive no other island looks for
+            int length = snprintf(config->archive_file, sizeof(config->archive_file), "%s/%s.archive",
+                                  config->island_dir, config->island_name);
+            if (length < 0 || (size_t)length >= sizeof(config->archive_file)) {
+                fprintf(stderr, "Error: island_dir and island_name make an archive path longer than %zu bytes\n",
+                        sizeof(config->archive_file) - 1);
+                toml_free(toml);
+                return -1;
+            }
+            mkdir(config->island_dir, 0755);
+            printf("Info: Island '%s' in %s, migrating %d elites every %d generations\n",
+                   config->island_name, config->island_dir, config->island_migrants,
+                   config->island_migration_interval);
+        }
+    }
+
     // Load evaluation configuration
     toml_datum_t enable_comprehensive_evaluation = toml_bool_in(toml, "enable_comprehensive_evaluation");
     if (enable_comprehensive_evaluation.ok) {
@@ -294,6 +934,11 @@ int load_config(config_t *config, const char *config_file) {
         config->eval_criteria.target_throughput = target_throughput.u.d;
     }
 
+    double max_scaling_exponent;
+    if (toml_number_in(toml, "max_scaling_exponent", &max_scaling_exponent) && max_scaling_exponent >= 0.0) {
+        config->eval_criteria.max_scaling_exponent = max_scaling_exponent;
+    }
+
     toml_datum_t enable_performance_profiling = toml_bool_in(toml, "enable_performance_profiling");
     if (enable_performance_profiling.ok) {
         config->eval_criteria.enable_performance_profiling = enable_performance_profiling.u.b;
@@ -313,6 +958,244 @@ int load_config(config_t *config, const char *config_file) {
         printf("Info: Comprehensive evaluation enabled\n");
     }
 
+    // Load log file configuration
+    toml_datum_t log_file = toml_string_in(toml, "log_file");
+    if (log_file.ok) {
+        strncpy(config->log_file, log_file.u.s, sizeof(config->log_file) - 1);
+        config->log_file[sizeof(config->log_file) - 1] = '\0';
+        free(log_file.u.s);
+    } else {
+        strcpy(config->log_file, "beta-evolve.log");
+    }
+
+    toml_datum_t log_level = toml_int_in(toml, "log_level");
+    if (log_level.ok && log_level.u.i >= VERBOSITY_QUIET && log_level.u.i <= VERBOSITY_DEBUG) {
+        config->log_level = (int)log_level.u.i;
+    } else {
+        config->log_level = VERBOSITY_NORMAL; // Default to exchanges, test output and normal messages
+    }
+
+    toml_datum_t log_queue_kb = toml_int_in(toml, "log_queue_kb");
+    if (log_queue_kb.ok && log_queue_kb.u.i > 0) {
+        config->log_queue_kb = (int)log_queue_kb.u.i;
+    } else {
+        config->log_queue_kb = 1024; // Default to 1MB
+    }
+
+    toml_datum_t log_rotate_mb = toml_int_in(toml, "log_rotate_mb");
+    if (log_rotate_mb.ok && log_rotate_mb.u.i >= 0) {
+        config->log_rotate_mb = (int)log_rotate_mb.u.i;
+    } else {
+        config->log_rotate_mb = 64;
+    }
+
+    toml_datum_t log_max_files = toml_int_in(toml, "log_max_files");
+    if (log_max_files.ok && log_max_files.u.i >= 0) {
+        config->log_max_files = (int)log_max_files.u.i;
+    } else {
+        config->log_max_files = 3;
+    }
+
+    toml_datum_t log_compress = toml_bool_in(toml, "log_compress");
+    if (log_compress.ok) {
+        config->log_compress = log_compress.u.b;
+    } else {
+        config->log_compress = 0; // Default to plain rotated files
+    }
+
+    toml_datum_t log_prompt_hashes = toml_bool_in(toml, "log_prompt_hashes");
+    if (log_prompt_hashes.ok) {
+        config->log_prompt_hashes = log_prompt_hashes.u.b;
+    } else {
+        config->log_prompt_hashes = 0; // Default to full prompts
+    }
+
+    if (strlen(config->log_file) > 0 && config->log_prompt_hashes) {
+        printf("Info: Prompts are logged as content hashes\n");
+    }
+
+    // Load metric fitness configuration
+    toml_datum_t benchmark_command = toml_string_in(toml, "benchmark_command");
+    if (benchmark_command.ok) {
+        strncpy(config->benchmark_command, benchmark_command.u.s, sizeof(config->benchmark_command) - 1);
+        config->benchmark_command[sizeof(config->benchmark_command) - 1] = '\0';
+        free(benchmark_command.u.s);
+    } else {
+        strcpy(config->benchmark_command, ""); // Default to metrics printed by the test
+    }
+
+    load_fitness_metrics(config, toml);
+    if (config->metric_count > 0) {
+        printf("Info: Fitness from %d reported metrics (%s)\n", config->metric_count,
+               strlen(config->benchmark_command) > 0 ? "benchmark_command" : "test output");
+    }
+
+    // Load tracing configuration
+    toml_datum_t enable_tracing = toml_bool_in(toml, "enable_tracing");
+    if (enable_tracing.ok) {
+        config->enable_tracing = enable_tracing.u.b;
+    } else {
+        config->enable_tracing = 0; // Default to disabled
+    }
+
+    toml_datum_t trace_file = toml_string_in(toml, "trace_file");
+    if (trace_file.ok) {
+        strncpy(config->trace_file, trace_file.u.s, sizeof(config->trace_file) - 1);
+        config->trace_file[sizeof(config->trace_file) - 1] = '\0';
+        free(trace_file.u.s);
+    } else {
+        strcpy(config->trace_file, "");
+    }
+
+    toml_datum_t trace_format = toml_string_in(toml, "trace_format");
+    if (trace_format.ok && (strcmp(trace_format.u.s, "jsonl") == 0 || strcmp(trace_format.u.s, "chrome") == 0)) {
+        strcpy(config->trace_format, trace_format.u.s);
+    } else {
+        if (trace_format.ok) {
+            printf("Warning: Unknown trace_format '%s', using jsonl\n", trace_format.u.s);
+        }
+        strcpy(config->trace_format, "jsonl"); // Default to JSON lines
+    }
+    if (trace_format.ok) free(trace_format.u.s);
+
+    if (strlen(config->trace_file) > 0) {
+        printf("Info: Tracing phases to '%s' (%s)\n", config->trace_file, config->trace_format);
+    } else if (config->enable_tracing) {
+        printf("Info: Phase tracing enabled\n");
+    }
+
+    toml_datum_t model_cache_mode = toml_string_in(toml, "model_cache_mode");
+    if (model_cache_mode.ok && (strcmp(model_cache_mode.u.s, "off") == 0 || strcmp(model_cache_mode.u.s, "record") == 0 ||
+                                strcmp(model_cache_mode.u.s, "replay") == 0 ||
+                                strcmp(model_cache_mode.u.s, "cache-first") == 0)) {
+        strcpy(config->model_cache_mode, model_cache_mode.u.s);
+    } else {
+        if (model_cache_mode.ok) {
+            printf("Warning: Unknown model_cache_mode '%s', calling the models directly\n", model_cache_mode.u.s);
+        }
+        strcpy(config->model_cache_mode, "off"); // Default to live calls only
+    }
+    if (model_cache_mode.ok) free(model_cache_mode.u.s);
+
+    toml_datum_t model_cache_file = toml_string_in(toml, "model_cache_file");
+    if (model_cache_file.ok && strlen(model_cache_file.u.s) > 0) {
+        strncpy(config->model_cache_file, model_cache_file.u.s, sizeof(config->model_cache_file) - 1);
+        config->model_cache_file[sizeof(config->model_cache_file) - 1] = '\0';
+    } else {
+        strcpy(config->model_cache_file, "model-responses.jsonl");
+    }
+    if (model_cache_file.ok) free(model_cache_file.u.s);
+
+    if (strcmp(config->model_cache_mode, "record") == 0 || strcmp(config->model_cache_mode, "replay") == 0) {
+        printf("Info: Model responses %s '%s'\n",
+               strcmp(config->model_cache_mode, "record") == 0 ? "recorded to" : "replayed from", config->model_cache_file);
+    } else if (strcmp(config->model_cache_mode, "cache-first") == 0) {
+        printf("Info: Repeated identical prompts are answered from memory\n");
+    }
+
+    // Load API quota configuration
+    toml_datum_t fast_model_rpm = toml_int_in(toml, "fast_model_rpm");
+    config->fast_model_rpm = fast_model_rpm.ok && fast_model_rpm.u.i > 0 ? (int)fast_model_rpm.u.i : 0;
+    toml_datum_t fast_model_tpm = toml_int_in(toml, "fast_model_tpm");
+    config->fast_model_tpm = fast_model_tpm.ok && fast_model_tpm.u.i > 0 ? (int)fast_model_tpm.u.i : 0;
+    toml_datum_t reasoning_model_rpm = toml_int_in(toml, "reasoning_model_rpm");
+    config->reasoning_model_rpm = reasoning_model_rpm.ok && reasoning_model_rpm.u.i > 0 ? (int)reasoning_model_rpm.u.i : 0;
+    toml_datum_t reasoning_model_tpm = toml_int_in(toml, "reasoning_model_tpm");
+    config->reasoning_model_tpm = reasoning_model_tpm.ok && reasoning_model_tpm.u.i > 0 ? (int)reasoning_model_tpm.u.i : 0;
+
+    toml_datum_t rate_limit_retries = toml_int_in(toml, "rate_limit_retries");
+    if (rate_limit_retries.ok && rate_limit_retries.u.i >= 0) {
+        config->rate_limit_retries = (int)rate_limit_retries.u.i;
+    } else {
+        config->rate_limit_retries = 3; // Default to three retries after HTTP 429
+    }
+
+    if (config->fast_model_rpm > 0 || config->fast_model_tpm > 0 ||
+        config->reasoning_model_rpm > 0 || config->reasoning_model_tpm > 0) {
+        printf("Info: API quota: fast %d req/min, %d tokens/min; reasoning %d req/min, %d tokens/min (0 = unlimited)\n",
+               config->fast_model_rpm, config->fast_model_tpm, config->reasoning_model_rpm, config->reasoning_model_tpm);
+    }
+
+    // Load endpoint failover and hedging configuration
+    config->fast_model_fallback_count = load_fallback_endpoints(toml, "fast_model_fallback_endpoints",
+                                                                config->fast_model_fallback_endpoints,
+                                                                config->fast_model_endpoint);
+    config->reasoning_model_fallback_count = load_fallback_endpoints(toml, "reasoning_model_fallback_endpoints",
+                                                                     config->reasoning_model_fallback_endpoints,
+                                                                     config->reasoning_model_endpoint);
+    if (config->fast_model_fallback_count > 0 || config->reasoning_model_fallback_count > 0) {
+        printf("Info: Fallback endpoints: %d for the fast model, %d for the reasoning model\n",
+               config->fast_model_fallback_count, config->reasoning_model_fallback_count);
+    }
+
+    toml_datum_t model_call_retries = toml_int_in(toml, "model_call_retries");
+    if (model_call_retries.ok && model_call_retries.u.i >= 0) {
+        config->model_call_retries = (int)model_call_retries.u.i;
+    } else {
+        config->model_call_retries = 2; // Default to two more attempts after a failed call
+    }
+
+    toml_datum_t retry_backoff_ms = toml_int_in(toml, "retry_backoff_ms");
+    if (retry_backoff_ms.ok && retry_backoff_ms.u.i >= 0) {
+        config->retry_backoff_ms = (int)retry_backoff_ms.u.i;
+    } else {
+        config->retry_backoff_ms = 500; // Default to half a second, doubling per attempt
+    }
+
+    toml_datum_t model_call_timeout_ms = toml_int_in(toml, "model_call_timeout_ms");
+    config->model_call_timeout_ms = model_call_timeout_ms.ok && model_call_timeout_ms.u.i > 0
+                                  ? (int)model_call_timeout_ms.u.i : 0; // Default to no limit
+
+    toml_datum_t enable_hedging = toml_bool_in(toml, "enable_hedging");
+    config->enable_hedging = enable_hedging.ok ? enable_hedging.u.b : 0;
+
+    toml_datum_t hedge_percentile = toml_int_in(toml, "hedge_percentile");
+    if (hedge_percentile.ok && hedge_percentile.u.i >= 50 && hedge_percentile.u.i <= 99) {
+        config->hedge_percentile = (int)hedge_percentile.u.i;
+    } else {
+        config->hedge_percentile = 95; // Default to hedging the slowest 5% of calls
+    }
+
+    toml_datum_t hedge_min_samples = toml_int_in(toml, "hedge_min_samples");
+    if (hedge_min_samples.ok && hedge_min_samples.u.i > 0) {
+        config->hedge_min_samples = (int)hedge_min_samples.u.i;
+    } else {
+        config->hedge_min_samples = 10; // Default to ten latencies before the percentile is trusted
+    }
+
+    if (config->enable_hedging) {
+        printf("Info: Hedging model calls slower than their endpoint's p%d latency\n", config->hedge_percentile);
+    }
+
+    // Load batch configuration
+    toml_datum_t batch_jobs = toml_int_in(toml, "batch_jobs");
+    if (batch_jobs.ok && batch_jobs.u.i > 0) {
+        config->batch_jobs = (int)batch_jobs.u.i;
+    } else {
+        config->batch_jobs = 4; // Default to four jobs at once
+    }
+
+    toml_datum_t batch_output_dir = toml_string_in(toml, "batch_output_dir");
+    if (batch_output_dir.ok && strlen(batch_output_dir.u.s) > 0) {
+        strncpy(config->batch_output_dir, batch_output_dir.u.s, sizeof(config->batch_output_dir) - 1);
+        config->batch_output_dir[sizeof(config->batch_output_dir) - 1] = '\0';
+    } else {
+        strcpy(config->batch_output_dir, "batch-output");
+    }
+    if (batch_output_dir.ok) free(batch_output_dir.u.s);
+
+    toml_datum_t eval_slots = toml_int_in(toml, "eval_slots");
+    config->eval_slots = eval_slots.ok && eval_slots.u.i > 0 ? (int)eval_slots.u.i : 0; // Batch runs default to one per CPU
+
+    toml_datum_t output_dir = toml_string_in(toml, "output_dir");
+    if (output_dir.ok) {
+        strncpy(config->output_dir, output_dir.u.s, sizeof(config->output_dir) - 1);
+        config->output_dir[sizeof(config->output_dir) - 1] = '\0';
+        free(output_dir.u.s);
+    } else {
+        strcpy(config->output_dir, "");
+    }
+
     toml_free(toml);
     return 0;
 }
@@ -386,4 +1269,11 @@ void free_config(config_t *config) {
         free(config->loaded_problem_prompt);
         config->loaded_problem_prompt = NULL;
     }
+
+    for (int i = 0; i < config->test_case_count; i++) {
+        free(config->test_cases[i]);
+    }
+    free(config->test_cases);
+    config->test_cases = NULL;
+    config->test_case_count = 0;
 }
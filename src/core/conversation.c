@@ -1,4 +1,7 @@
 #include "beta_evolve.h"
+#include "benchmark.h"
+#include "metrics.h"
+#include "scaling.h"
 
 
 // Generate base prompt template for agents
@@ -70,14 +73,13 @@ void init_conversation(conversation_t *conv, const char *problem, config_t *conf
     
     // Initialize test result with dynamic allocation
     memset(&conv->last_test_result, 0, sizeof(test_result_t));
-    conv->last_test_result.error_message = malloc(config->max_response_size);
-    conv->last_test_result.output = malloc(config->max_response_size);
-    if (conv->last_test_result.error_message) {
-        memset(conv->last_test_result.error_message, 0, config->max_response_size);
-    }
-    if (conv->last_test_result.output) {
-        memset(conv->last_test_result.output, 0, config->max_response_size);
-    }
+    conv->last_test_result.error_message = calloc(1, config->max_response_size);
+    conv->last_test_result.output = calloc(1, config->max_response_size);
+    
+    // Test outputs and reports of one iteration come from here, and its prompts and
+    // responses are released with them; the block (sized for one test's three command
+    // outputs and its report) is only allocated once the first test runs
+    conv->scratch = arena_create((size_t)config->max_response_size * 4);
     
     // Initialize code evolution context
     init_code_evolution(&conv->evolution);
@@ -142,9 +144,10 @@ void print_conversation(const conversation_t *conv) {
 char* generate_agent_prompt(const conversation_t *conv, agent_type_t agent) {
     if (!conv || !conv->config) return NULL;
     
-    // Check if the current solution contains evolution markers
+    // Check if the current solution contains evolution markers (outside evolution
+    // mode markers are plain comments; the evolution prompt would fall back here)
     int has_evolution_markers = 0;
-    if (conv->current_solution && strlen(conv->current_solution) > 0) {
+    if (conv->evolution.evolution_enabled && conv->current_solution && strlen(conv->current_solution) > 0) {
         has_evolution_markers = (strstr(conv->current_solution, EVOLUTION_MARKER_START) != NULL);
     }
     
@@ -190,31 +193,66 @@ char* generate_agent_prompt(const conversation_t *conv, agent_type_t agent) {
             }
             dstring_append(prompt, "\n");
         }
+        
+        // Hardware counters tell memory-bound code apart from compute-bound code
+        char *profile = generate_performance_profile(&conv->last_performance);
+        if (profile && conv->last_performance.ns_per_call > 0) {
+            dstring_append_format(prompt, "PERFORMANCE PROFILE (current solution, %s() in-process):\n",
+                                 conv->config->kernel_entry);
+            dstring_append(prompt, profile);
+            dstring_append(prompt, "\n");
+            free(profile);
+        } else if (profile) {
+            dstring_append_format(prompt, "PERFORMANCE PROFILE (current solution, median %.2f ms):\n",
+                                 conv->last_performance.execution_time_ms);
+            dstring_append(prompt, profile);
+            dstring_append(prompt, "\n");
+            free(profile);
+        }
+
+        // The fitted curve shows how the solution behaves beyond the default size
+        char *scaling = generate_scaling_report(&conv->last_performance.scaling);
+        if (scaling) {
+            dstring_append(prompt, "SCALING PROFILE (run time over input sizes):\n");
+            dstring_append(prompt, scaling);
+            dstring_append(prompt, "\n");
+            free(scaling);
+        }
     }
     
-    // Add the base prompt template
-    dstring_append(prompt, _prompt());
-    
-    // Create final prompt with substitutions
-    dstring_t* final_prompt = dstring_create(dstring_get(prompt) ? strlen(dstring_get(prompt)) + 1000 : 1000);
-    if (!final_prompt) {
-        dstring_destroy(prompt);
-        return NULL;
+    // What the benchmark measured is the target both agents optimize
+    char *metrics_report = generate_metrics_report(&conv->last_metrics, conv->config);
+    if (metrics_report) {
+        dstring_append(prompt, metrics_report);
+        dstring_append(prompt, "Improve these measured values without failing any gate.\n\n");
+        free(metrics_report);
+    }
+
+    // The sweep only measures code that sizes its workload from the input size
+    if (conv->config->enable_scaling_sweep) {
+        dstring_append(prompt,
+            "INPUT SIZE: Benchmarks run the program with the input size n as argv[1] (also in the "
+            SCALING_SIZE_ENV " environment variable). main() must size its workload from it and fall back "
+            "to a default when it is absent.\n\n");
     }
     
+    // Add the base prompt template, substituting problem, code and errors in place
     const char *problem_desc = conv->problem_description ? conv->problem_description : "No problem description";
-    dstring_append_format(final_prompt, dstring_get(prompt), problem_desc, current_code, errors);
-    
-    // Extract the final string
-    char* result = NULL;
-    if (dstring_get(final_prompt)) {
-        result = strdup(dstring_get(final_prompt));
+    const char *values[] = { problem_desc, current_code, errors };
+    const char *template = _prompt();
+    dstring_reserve(prompt, prompt->length + strlen(template) + strlen(problem_desc) +
+                            strlen(current_code) + strlen(errors) + 1);
+    
+    int value_index = 0;
+    const char *placeholder;
+    while ((placeholder = strstr(template, "%s")) != NULL && value_index < 3) {
+        dstring_append_len(prompt, template, placeholder - template);
+        dstring_append(prompt, values[value_index++]);
+        template = placeholder + 2;
     }
+    dstring_append(prompt, template);
     
-    dstring_destroy(prompt);
-    dstring_destroy(final_prompt);
-    
-    return result;
+    return dstring_steal(prompt);
 }
 
 // Update current solution from reasoning agent response
@@ -289,6 +327,9 @@ void cleanup_conversation(conversation_t *conv) {
     // Cleanup code evolution context
     cleanup_code_evolution(&conv->evolution);
 
+    arena_destroy(conv->scratch);
+    conv->scratch = NULL;
+
     // Reset other fields
     conv->iterations = 0;
     conv->message_count = 0;
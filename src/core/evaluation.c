@@ -1,9 +1,19 @@
 #include "beta_evolve.h"
+#include "benchmark.h"
+#include "cache.h"
+#include "scaling.h"
+#include "trace.h"
+#include "workspace.h"
 #include <math.h>
-#include <sys/resource.h>
-#include <sys/time.h>
-#include <sys/wait.h>
-#include <signal.h>
+
+// Allocations per run above which a candidate counts as allocation-heavy
+#define ALLOCATION_HEAVY_CALLS 1000
+
+// Compiler of performance builds; the build_flags of each configuration follow it
+#define PERFORMANCE_COMPILER "gcc -std=c99"
+
+// Appended to the build_flags of kernel benchmark builds
+#define KERNEL_LIBRARY_FLAGS "-shared -fPIC"
 
 // Initialize evaluation criteria with default values
 void init_evaluation_criteria(evaluation_criteria_t *criteria) {
@@ -14,6 +24,7 @@ void init_evaluation_criteria(evaluation_criteria_t *criteria) {
     criteria->max_execution_time_ms = 1000.0;    // Maximum 1 second execution time
     criteria->max_memory_usage_kb = 10240;       // Maximum 10MB memory usage
     criteria->target_throughput = 1000.0;        // Target 1000 ops/sec
+    criteria->max_scaling_exponent = 0.0;        // No limit on the fitted scaling exponent
     
     // Quality criteria
     criteria->min_test_coverage_percent = 80.0;  // Minimum 80% test coverage
@@ -25,90 +36,185 @@ void init_evaluation_criteria(evaluation_criteria_t *criteria) {
     criteria->enable_quality_analysis = 1;
 }
 
-// Measure performance metrics for code execution
-performance_metrics_t measure_performance(const char *file_path, config_t *config) {
-    performance_metrics_t metrics = {0};
-    
-    if (!file_path || !config) return metrics;
-    
-    // Create temporary executable
-    char binary_path[1024];
-    snprintf(binary_path, sizeof(binary_path), "/tmp/perf_test_%d", getpid());
+// Compile file_path with the performance compiler and flags into binary_path.
+// A binary_path inside the shared binary cache is built under a unique name and
+// renamed into place atomically.
+static int compile_performance_binary(const char *file_path, const char *flags, const char *binary_path,
+                                      int cached_binary, config_t *config) {
+    char build_path[1100];
+    snprintf(build_path, sizeof(build_path), "%s%s", binary_path, cached_binary ? ".XXXXXX" : "");
+    if (cached_binary) {
+        int fd = mkstemp(build_path);
+        if (fd < 0) {
+            log_message(config, VERBOSITY_DEBUG, "Performance measurement: cannot create %s\n", build_path);
+            return -1;
+        }
+        close(fd);
+    }
     
-    // Compile the code
-    char compile_cmd[2048];
+    char compile_cmd[2560];
     snprintf(compile_cmd, sizeof(compile_cmd), 
-             "gcc -O2 -Wall -Wextra -std=c99 -o %s %s 2>/dev/null", 
-             binary_path, file_path);
+             "%s %s -o %s %s 2>/dev/null", 
+             PERFORMANCE_COMPILER, flags, build_path, file_path);
+    
+    process_limits_t compile_limits = compile_process_limits(config);
+    if (process_run(compile_cmd, &compile_limits, NULL, 0, NULL) != 0 ||
+        (cached_binary && rename(build_path, binary_path) != 0)) {
+        log_message(config, VERBOSITY_DEBUG, "Performance measurement: compilation with \"%s\" failed\n", flags);
+        if (cached_binary) unlink(build_path);
+        return -1;
+    }
+    return 0;
+}
+
+// Two-stage PGO build: instrumented binary, one training run, then a rebuild with the profile
+static int compile_pgo_binary(const char *file_path, workspace_t *workspace, char *binary_path,
+                              size_t binary_path_size, config_t *config) {
+    char profile_dir[1024];
+    if (workspace_path(workspace, "pgo_profile", profile_dir, sizeof(profile_dir)) != 0 ||
+        workspace_path(workspace, "pgo_bin", binary_path, binary_path_size) != 0) {
+        return -1;
+    }
     
-    if (system(compile_cmd) != 0) {
-        log_message(config, VERBOSITY_DEBUG, "Performance measurement: compilation failed\n");
-        return metrics;
+    // Both stages build the same output name so the profile matches
+    char flags[1400];
+    snprintf(flags, sizeof(flags), "%s -fprofile-generate=%s", config->pgo_flags, profile_dir);
+    if (compile_performance_binary(file_path, flags, binary_path, 0, config) != 0) return -1;
+    
+    char train_cmd[1100];
+    snprintf(train_cmd, sizeof(train_cmd), "%s >/dev/null 2>&1", binary_path);
+    process_limits_t limits = candidate_process_limits(config);
+    process_result_t train = {0};
+    process_run(train_cmd, &limits, NULL, 0, &train);
+    if (train.status != PROCESS_OK) {
+        log_message(config, VERBOSITY_DEBUG, "Performance measurement: PGO training run failed (%s)\n",
+                   process_status_name(train.status));
+        return -1;
     }
     
-    // Measure execution time and memory usage
-    struct timeval start_time, end_time;
-    struct rusage usage_start, usage_end;
+    snprintf(flags, sizeof(flags), "%s -fprofile-use=%s -fprofile-correction -Wno-missing-profile",
+             config->pgo_flags, profile_dir);
+    return compile_performance_binary(file_path, flags, binary_path, 0, config);
+}
+
+// Benchmark one build; it replaces best if it is significantly faster (or best is empty)
+static void benchmark_build(const char *binary_path, const char *label, config_t *config,
+                            performance_metrics_t *best, char *best_binary, size_t best_binary_size) {
+    performance_metrics_t metrics = {0};
+    int status = strlen(config->kernel_entry) > 0
+                 ? benchmark_kernel(binary_path, config->kernel_input_size, config, &metrics)
+                 : benchmark_binary(binary_path, config, &metrics);
+    if (status != 0) {
+        log_message(config, VERBOSITY_DEBUG, "Performance measurement: benchmark of \"%s\" failed\n", label);
+        return;
+    }
+    snprintf(metrics.build_flags, sizeof(metrics.build_flags), "%s", label);
+    if (metrics.ns_per_call > 0) {
+        log_message(config, VERBOSITY_DEBUG, "Build \"%s\": median %.1fns per call\n", label, metrics.ns_per_call);
+    } else {
+        log_message(config, VERBOSITY_DEBUG, "Build \"%s\": median %.3fms\n", label, metrics.median_time_ms);
+    }
+    
+    // Earlier configurations win ties, so the list order expresses preference
+    if (best->sample_count == 0 || benchmark_compare(&metrics, best) < 0) {
+        *best = metrics;
+        snprintf(best_binary, best_binary_size, "%s", binary_path);
+    }
+}
+
+// Measure performance metrics for code execution: benchmark every build
+// configuration and keep the fastest
+performance_metrics_t measure_performance(const char *file_path, config_t *config) {
+    performance_metrics_t metrics = {0};
     
-    // Get initial resource usage
-    getrusage(RUSAGE_CHILDREN, &usage_start);
-    gettimeofday(&start_time, NULL);
+    if (!file_path || !config) return metrics;
+    int kernel_mode = strlen(config->kernel_entry) > 0;
+    
+    // Metrics of an identical build matrix are reused
+    char *source = read_evolution_file(file_path);
+    int have_source = source != NULL;
+    dstring_t *matrix_key = dstring_create(512);
+    if (!matrix_key) {
+        free(source);
+        return metrics;
+    }
+    for (int i = 0; i < config->build_config_count; i++) {
+        dstring_append_format(matrix_key, "%s;", config->build_flags[i]);
+    }
+    dstring_append_format(matrix_key, "pgo:%s;", kernel_mode ? "" : config->pgo_flags);
+    dstring_append_format(matrix_key, "bench:%d,%d,%d,%g,%d,%d;", config->benchmark_warmup_runs,
+                          config->benchmark_min_runs, config->benchmark_max_runs, config->benchmark_target_ci_percent,
+                          config->benchmark_max_time_ms, config->benchmark_cpu);
+    dstring_append_format(matrix_key, "counters:%d;", config->enable_hardware_counters);
+    dstring_append_format(matrix_key, "alloc:%d;", config->eval_criteria.enable_memory_profiling);
+    if (kernel_mode) {
+        dstring_append_format(matrix_key, "kernel:%s,%d,%d,%d,%d,%g;", config->kernel_entry, config->kernel_signature,
+                              config->kernel_input_size, config->kernel_inputs, config->kernel_max_batches,
+                              config->kernel_target_ci_percent);
+    }
+    if (config->enable_scaling_sweep) {
+        dstring_append_format(matrix_key, "sweep:%ld,%ld,%d,%d", config->scaling_min_size,
+                              config->scaling_max_size, config->scaling_factor, config->scaling_max_point_ms);
+    }
+    uint64_t cache_key = eval_cache_key(have_source ? source : "", PERFORMANCE_COMPILER, NULL, matrix_key->data);
+    dstring_destroy(matrix_key);
+    if (have_source && eval_cache_get_performance(cache_key, &metrics)) {
+        log_message(config, VERBOSITY_DEBUG, "Performance metrics reused from evaluation cache\n");
+        free(source);
+        return metrics;
+    }
     
-    // Run the executable multiple times for average
-    int runs = 5;
-    double total_time = 0.0;
-    long max_memory = 0;
+    // Binaries go to the cache's binary store, or to a private workspace without a cache
+    workspace_t workspace = {""};
+    if (workspace_create(&workspace, "perf") != 0) {
+        log_message(config, VERBOSITY_DEBUG, "Performance measurement: failed to create workspace\n");
+        free(source);
+        return metrics;
+    }
     
-    for (int i = 0; i < runs; i++) {
-        struct timeval run_start, run_end;
-        gettimeofday(&run_start, NULL);
+    char best_binary[1024] = "";
+    for (int i = 0; i < config->build_config_count; i++) {
+        const char *flags = config->build_flags[i];
+        char binary_path[1024], flags_key[320], build_flags[300];
+        int have_binary = 0;
+        // Kernel benchmarks load the candidate as a shared object
+        snprintf(build_flags, sizeof(build_flags), "%s%s%s", flags, kernel_mode ? " " : "",
+                 kernel_mode ? KERNEL_LIBRARY_FLAGS : "");
+        snprintf(flags_key, sizeof(flags_key), "%s %s", PERFORMANCE_COMPILER, build_flags);
+        uint64_t binary_key = eval_cache_key(have_source ? source : "", flags_key, NULL, NULL);
+        int cached_binary = have_source &&
+                            eval_cache_binary_path(binary_key, binary_path, sizeof(binary_path), &have_binary) == 0;
+        if (!cached_binary) {
+            char name[32];
+            snprintf(name, sizeof(name), "perf_test_%d", i);
+            if (workspace_path(&workspace, name, binary_path, sizeof(binary_path)) != 0) continue;
+        }
         
-        // Execute with timeout
-        pid_t pid = fork();
-        if (pid == 0) {
-            // Child process - execute the binary
-            execl(binary_path, binary_path, NULL);
-            exit(1);
-        } else if (pid > 0) {
-            // Parent process - wait and measure
-            int status;
-            struct rusage child_usage;
-            
-            if (wait4(pid, &status, 0, &child_usage) == pid) {
-                gettimeofday(&run_end, NULL);
-                
-                // Calculate execution time for this run
-                double run_time = (run_end.tv_sec - run_start.tv_sec) * 1000.0 + 
-                                 (run_end.tv_usec - run_start.tv_usec) / 1000.0;
-                total_time += run_time;
-                
-                // Track maximum memory usage
-                long memory_kb = child_usage.ru_maxrss;
-                #ifdef __APPLE__
-                memory_kb /= 1024; // macOS reports in bytes, convert to KB
-                #endif
-                if (memory_kb > max_memory) {
-                    max_memory = memory_kb;
-                }
-            }
+        if (!have_binary && compile_performance_binary(file_path, build_flags, binary_path, cached_binary, config) != 0) {
+            continue;
         }
+        benchmark_build(binary_path, flags, config, &metrics, best_binary, sizeof(best_binary));
     }
     
-    gettimeofday(&end_time, NULL);
-    getrusage(RUSAGE_CHILDREN, &usage_end);
-    
-    // Calculate average metrics
-    metrics.execution_time_ms = total_time / runs;
-    metrics.memory_usage_kb = max_memory;
+    // The PGO training run executes main(), which kernel benchmarks never do
+    if (strlen(config->pgo_flags) > 0 && !kernel_mode) {
+        char pgo_binary[1024], label[320];
+        snprintf(label, sizeof(label), "PGO %s", config->pgo_flags);
+        if (compile_pgo_binary(file_path, &workspace, pgo_binary, sizeof(pgo_binary), config) == 0) {
+            benchmark_build(pgo_binary, label, config, &metrics, best_binary, sizeof(best_binary));
+        }
+    }
+    free(source);
     
-    // Calculate CPU usage (simplified)
-    double total_cpu_time = (usage_end.ru_utime.tv_sec - usage_start.ru_utime.tv_sec) +
-                           (usage_end.ru_utime.tv_usec - usage_start.ru_utime.tv_usec) / 1000000.0;
-    double wall_time = (end_time.tv_sec - start_time.tv_sec) +
-                      (end_time.tv_usec - start_time.tv_usec) / 1000000.0;
+    if (metrics.sample_count == 0) {
+        log_message(config, VERBOSITY_DEBUG, "Performance measurement: no build configuration could be benchmarked\n");
+        workspace_destroy(&workspace);
+        return metrics;
+    }
     
-    if (wall_time > 0) {
-        metrics.cpu_usage_percent = (int)((total_cpu_time / wall_time) * 100);
+    // Time the fastest build over a series of input sizes
+    if (config->enable_scaling_sweep) {
+        measure_scaling(best_binary, config, &metrics.scaling);
     }
     
     // Estimate throughput (operations per second)
@@ -117,12 +223,21 @@ performance_metrics_t measure_performance(const char *file_path, config_t *confi
     }
     
     // Clean up
-    unlink(binary_path);
+    workspace_destroy(&workspace);
     
-    log_message(config, VERBOSITY_DEBUG, 
-               "Performance: %.2fms execution, %ldKB memory, %d%% CPU, %.1f ops/sec\n",
-               metrics.execution_time_ms, metrics.memory_usage_kb, 
-               metrics.cpu_usage_percent, metrics.throughput);
+    if (have_source) {
+        eval_cache_put_performance(cache_key, &metrics);
+    }
+    
+    if (kernel_mode) {
+        log_message(config, VERBOSITY_DEBUG, "Performance: %.1fns per %s call, %.0f calls/sec (build \"%s\")\n",
+                   metrics.ns_per_call, config->kernel_entry, metrics.throughput, metrics.build_flags);
+    } else {
+        log_message(config, VERBOSITY_DEBUG, 
+                   "Performance: %.2fms execution, %ldKB memory, %d%% CPU, %.1f ops/sec (build \"%s\")\n",
+                   metrics.execution_time_ms, metrics.memory_usage_kb, 
+                   metrics.cpu_usage_percent, metrics.throughput, metrics.build_flags);
+    }
     
     return metrics;
 }
@@ -229,6 +344,108 @@ double calculate_overall_score(const evaluation_result_t *result) {
            (result->quality_score * 0.3);
 }
 
+// Misses per thousand instructions, or -1 when the event was not counted
+static double misses_per_kilo_instruction(long long misses, long long instructions) {
+    if (misses < 0 || instructions <= 0) return -1.0;
+    return misses * 1000.0 / instructions;
+}
+
+// Optimization advice matching the bottleneck the hardware counters point to
+static const char* performance_bottleneck_advice(const performance_metrics_t *metrics) {
+    if (!metrics->counters_available || metrics->instructions <= 0) return NULL;
+
+    double llc_mpki = misses_per_kilo_instruction(metrics->llc_misses, metrics->instructions);
+    double l1d_mpki = misses_per_kilo_instruction(metrics->l1d_misses, metrics->instructions);
+    double branch_mpki = misses_per_kilo_instruction(metrics->branch_misses, metrics->instructions);
+
+    if (metrics->ipc < 1.0 && (llc_mpki > 1.0 || l1d_mpki > 20.0)) {
+        return "Memory-bound: stalls on cache misses dominate. Improve data locality (contiguous arrays, "
+               "struct-of-arrays, loop blocking/tiling), shrink the working set and avoid pointer chasing.";
+    }
+    if (branch_mpki > 5.0) {
+        return "Branch-bound: frequent mispredictions. Make hot branches predictable or branchless "
+               "(conditional moves, lookup tables, sorting or partitioning data before the loop).";
+    }
+    if (metrics->ipc >= 2.0) {
+        return "Compute-bound: the core is busy retiring instructions. Reduce the instruction count with a "
+               "better algorithm, strength reduction, hoisting invariant work and vectorizable loops.";
+    }
+    return "Mixed: no single bottleneck stands out. Prefer algorithmic improvements, then reduce "
+           "memory traffic in the hottest loop.";
+}
+
+// Total allocation calls of a profiled run
+static long long allocation_calls(const performance_metrics_t *metrics) {
+    return metrics->malloc_calls + metrics->calloc_calls + metrics->realloc_calls;
+}
+
+// Append the allocation profile collected through the shim
+static void append_allocation_profile(dstring_t *profile, const performance_metrics_t *metrics) {
+    static const char *bucket_names[ALLOC_HISTOGRAM_BUCKETS] = {
+        "<=16", "<=64", "<=256", "<=1K", "<=4K", "<=64K", "<=1M", ">1M"
+    };
+    
+    dstring_append_format(profile, "  - Allocations: %lld (%lld malloc, %lld calloc, %lld realloc), %lld free\n",
+                         allocation_calls(metrics), metrics->malloc_calls, metrics->calloc_calls,
+                         metrics->realloc_calls, metrics->free_calls);
+    dstring_append_format(profile, "  - Heap: %lld bytes requested, %lld bytes peak\n",
+                         metrics->allocated_bytes, metrics->peak_heap_bytes);
+    dstring_append(profile, "  - Allocation Sizes:");
+    for (int i = 0; i < ALLOC_HISTOGRAM_BUCKETS; i++) {
+        dstring_append_format(profile, " %s: %lld%s", bucket_names[i], metrics->allocation_histogram[i],
+                             i + 1 < ALLOC_HISTOGRAM_BUCKETS ? "," : "\n");
+    }
+    if (allocation_calls(metrics) > ALLOCATION_HEAVY_CALLS) {
+        dstring_append(profile, "  - Allocation-heavy: allocate once outside loops, reuse buffers, "
+                                "or carve small objects out of one arena.\n");
+    }
+}
+
+// Append the hardware counter profile
+static void append_counter_profile(dstring_t *profile, const performance_metrics_t *metrics) {
+    dstring_append_format(profile, "  - Cycles: %lld\n", metrics->cycles);
+    dstring_append_format(profile, "  - Instructions: %lld (IPC %.2f)\n", metrics->instructions, metrics->ipc);
+    
+    double l1d_mpki = misses_per_kilo_instruction(metrics->l1d_misses, metrics->instructions);
+    double llc_mpki = misses_per_kilo_instruction(metrics->llc_misses, metrics->instructions);
+    double branch_mpki = misses_per_kilo_instruction(metrics->branch_misses, metrics->instructions);
+    if (l1d_mpki >= 0) {
+        dstring_append_format(profile, "  - L1d Misses: %lld (%.2f per 1k instructions)\n", metrics->l1d_misses, l1d_mpki);
+    }
+    if (llc_mpki >= 0) {
+        dstring_append_format(profile, "  - LLC Misses: %lld (%.2f per 1k instructions)\n", metrics->llc_misses, llc_mpki);
+    }
+    if (branch_mpki >= 0) {
+        dstring_append_format(profile, "  - Branch Misses: %lld (%.2f per 1k instructions)\n", metrics->branch_misses, branch_mpki);
+    }
+    
+    const char *advice = performance_bottleneck_advice(metrics);
+    if (advice) {
+        dstring_append_format(profile, "  - Bottleneck: %s\n", advice);
+    }
+}
+
+// Describe the kernel timing, hardware counter and allocation profile of a benchmark (NULL if none was collected)
+char* generate_performance_profile(const performance_metrics_t *metrics) {
+    if (!metrics || (!metrics->counters_available && !metrics->allocations_available && metrics->ns_per_call <= 0)) {
+        return NULL;
+    }
+    
+    dstring_t *profile = dstring_create(1024);
+    if (!profile) return NULL;
+    
+    if (metrics->ns_per_call > 0) {
+        dstring_append_format(profile, "  - Per Call: %.1f ns median, %.1f ns min, ±%.1f ns (95%% CI) over %d batches of %lld calls\n",
+                             metrics->ns_per_call, metrics->min_time_ms * 1e6, metrics->ci95_time_ms * 1e6,
+                             metrics->sample_count, metrics->calls_per_batch);
+    }
+    if (metrics->counters_available) append_counter_profile(profile, metrics);
+    if (metrics->allocations_available) append_allocation_profile(profile, metrics);
+    
+    char *profile_str = dstring_steal(profile);
+    return profile_str;
+}
+
 // Generate detailed evaluation report
 char* generate_evaluation_report(const evaluation_result_t *result) {
     if (!result) return NULL;
@@ -255,11 +472,68 @@ char* generate_evaluation_report(const evaluation_result_t *result) {
     
     // Performance metrics
     dstring_append(report, "PERFORMANCE ANALYSIS:\n");
-    dstring_append_format(report, "  - Execution Time: %.2f ms\n", result->performance.execution_time_ms);
-    dstring_append_format(report, "  - Memory Usage: %ld KB\n", result->performance.memory_usage_kb);
-    dstring_append_format(report, "  - CPU Usage: %d%%\n", result->performance.cpu_usage_percent);
+    if (result->performance.ns_per_call > 0) {
+        dstring_append_format(report, "  - Time Per Call: %.1f ns (median, in-process kernel benchmark)\n",
+                             result->performance.ns_per_call);
+    } else {
+        dstring_append_format(report, "  - Execution Time: %.2f ms (median)\n", result->performance.execution_time_ms);
+    }
+    if (strlen(result->performance.build_flags) > 0) {
+        dstring_append_format(report, "  - Fastest Build: %s\n", result->performance.build_flags);
+    }
+    if (result->performance.ns_per_call > 0) {
+        const performance_metrics_t *kernel = &result->performance;
+        dstring_append_format(report, "  - Mean: %.1f ns ± %.1f ns (95%% CI), stddev %.1f ns\n",
+                             kernel->mean_time_ms * 1e6, kernel->ci95_time_ms * 1e6, kernel->stddev_time_ms * 1e6);
+        dstring_append_format(report, "  - Min / P95: %.1f ns / %.1f ns\n",
+                             kernel->min_time_ms * 1e6, kernel->p95_time_ms * 1e6);
+        dstring_append_format(report, "  - Samples: %d batches of %lld calls, %d warmup, %.1f ns loop and input copy removed\n",
+                             kernel->sample_count, kernel->calls_per_batch, kernel->warmup_runs,
+                             kernel->startup_overhead_ms * 1e6);
+    } else if (result->performance.sample_count > 0) {
+        dstring_append_format(report, "  - Mean: %.2f ms ± %.2f ms (95%% CI), stddev %.2f ms\n",
+                             result->performance.mean_time_ms, result->performance.ci95_time_ms,
+                             result->performance.stddev_time_ms);
+        dstring_append_format(report, "  - Min / P95: %.2f ms / %.2f ms\n",
+                             result->performance.min_time_ms, result->performance.p95_time_ms);
+        dstring_append_format(report, "  - Samples: %d timed, %d warmup, %.2f ms start-up overhead removed\n",
+                             result->performance.sample_count, result->performance.warmup_runs,
+                             result->performance.startup_overhead_ms);
+    }
+    // The kernel runner serves many candidates, so it has no per-candidate memory or CPU figures
+    if (result->performance.ns_per_call <= 0) {
+        dstring_append_format(report, "  - Memory Usage: %ld KB\n", result->performance.memory_usage_kb);
+        dstring_append_format(report, "  - CPU Usage: %d%%\n", result->performance.cpu_usage_percent);
+    }
     dstring_append_format(report, "  - Throughput: %.1f ops/sec\n\n", result->performance.throughput);
     
+    // Hardware counters (whole-run benchmarks only)
+    if (result->performance.sample_count > 0 && result->performance.ns_per_call <= 0) {
+        dstring_append(report, "HARDWARE COUNTERS:\n");
+        if (result->performance.counters_available) {
+            append_counter_profile(report, &result->performance);
+        } else {
+            dstring_append(report, "  - Not available (perf_event_open unsupported or not permitted)\n");
+        }
+        dstring_append(report, "\n");
+    }
+    
+    // Heap profile from the allocation shim
+    if (result->performance.allocations_available) {
+        dstring_append(report, "ALLOCATIONS:\n");
+        append_allocation_profile(report, &result->performance);
+        dstring_append(report, "\n");
+    }
+    
+    // Input-size sweep
+    char *scaling = generate_scaling_report(&result->performance.scaling);
+    if (scaling) {
+        dstring_append(report, "SCALING ANALYSIS:\n");
+        dstring_append(report, scaling);
+        dstring_append(report, "\n");
+        free(scaling);
+    }
+    
     // Quality metrics
     dstring_append(report, "CODE QUALITY ANALYSIS:\n");
     dstring_append_format(report, "  - Lines of Code: %d\n", result->quality.lines_of_code);
@@ -282,8 +556,7 @@ char* generate_evaluation_report(const evaluation_result_t *result) {
         dstring_append_format(report, "\nPROGRAM OUTPUT:\n%s\n", result->test_result.output);
     }
     
-    char *result_str = strdup(dstring_get(report));
-    dstring_destroy(report);
+    char *result_str = dstring_steal(report);
     return result_str;
 }
 
@@ -327,6 +600,44 @@ char* generate_improvement_recommendations(const evaluation_result_t *result) {
             dstring_append(recommendations, "  - Reduce CPU-intensive operations\n");
             dstring_append(recommendations, "  - Consider algorithmic optimizations\n");
         }
+        const char *advice = performance_bottleneck_advice(&result->performance);
+        if (advice) {
+            dstring_append_format(recommendations, "  - %s\n", advice);
+        }
+        dstring_append(recommendations, "\n");
+    }
+    
+    // Scaling recommendations follow the fitted curve, not the single-size timing
+    const scaling_profile_t *scaling = &result->performance.scaling;
+    if (scaling->point_count > 0 && (scaling->exponent >= 1.5 || scaling->complexity >= COMPLEXITY_QUADRATIC)) {
+        dstring_append(recommendations, "SCALING IMPROVEMENTS:\n");
+        dstring_append_format(recommendations,
+                             "  - Run time grows as about n^%.2f (fitted %s): %.3f ms at n = %ld, %.3f ms at n = %ld\n",
+                             scaling->exponent, complexity_class_name(scaling->complexity),
+                             scaling->times_ms[0], scaling->sizes[0],
+                             scaling->times_ms[scaling->point_count - 1], scaling->sizes[scaling->point_count - 1]);
+        dstring_append(recommendations, "  - Replace nested passes over the input with sorting, hashing, "
+                                        "divide and conquer or incremental updates\n");
+        dstring_append(recommendations, "\n");
+    } else if (scaling->point_count > 0 && scaling->shift_count > 0) {
+        dstring_append(recommendations, "SCALING IMPROVEMENTS:\n");
+        dstring_append_format(recommendations,
+                             "  - Run time changes slope near n = %ld; check whether the working set outgrows a cache "
+                             "level there and block or compact the data accordingly\n", scaling->shift_sizes[0]);
+        dstring_append(recommendations, "\n");
+    }
+    
+    // Allocation counts predict throughput under load better than a single timing
+    if (result->performance.allocations_available && allocation_calls(&result->performance) > ALLOCATION_HEAVY_CALLS) {
+        dstring_append(recommendations, "ALLOCATION IMPROVEMENTS:\n");
+        dstring_append_format(recommendations, "  - %lld heap allocations per run; move them out of inner loops "
+                                               "and reuse buffers between iterations\n",
+                             allocation_calls(&result->performance));
+        if (result->performance.allocation_histogram[0] + result->performance.allocation_histogram[1] >
+            allocation_calls(&result->performance) / 2) {
+            dstring_append(recommendations, "  - Most requests are 64 bytes or less; store small objects "
+                                            "inline, in arrays or in an arena\n");
+        }
         dstring_append(recommendations, "\n");
     }
     
@@ -358,8 +669,7 @@ char* generate_improvement_recommendations(const evaluation_result_t *result) {
     dstring_append(recommendations, "  - Include robust error handling and input validation\n");
     dstring_append(recommendations, "  - Consider using static analysis tools for additional insights\n");
     
-    char *result_str = strdup(dstring_get(recommendations));
-    dstring_destroy(recommendations);
+    char *result_str = dstring_steal(recommendations);
     return result_str;
 }
 
@@ -369,18 +679,15 @@ evaluation_result_t evaluate_code_comprehensive(const char *file_path, const cha
     evaluation_result_t result = {0};
     
     if (!file_path || !code_content || !config) return result;
+    trace_span_t span = trace_begin("evaluate", TRACE_NO_AGENT);
     
     // Initialize result structure
     result.evaluation_timestamp = time(NULL);
     result.detailed_report = NULL;
     result.recommendations = NULL;
     
-    // Basic correctness testing
-    if (strlen(config->test_command) > 0) {
-        result.test_result = run_custom_test(config->test_command, file_path, config);
-    } else {
-        result.test_result = test_generated_code(code_content, "Evaluation", config);
-    }
+    // Basic correctness testing (reuses the result of an earlier test of the same code)
+    result.test_result = test_solution_code(code_content, "Evaluation", config, NULL);
     
     // Calculate correctness score
     result.correctness_score = 0.0;
@@ -390,7 +697,9 @@ evaluation_result_t evaluate_code_comprehensive(const char *file_path, const cha
     
     // Performance evaluation
     if (criteria && criteria->enable_performance_profiling && result.test_result.compilation_ok) {
+        trace_span_t benchmark_span = trace_begin("benchmark", TRACE_NO_AGENT);
         result.performance = measure_performance(file_path, config);
+        trace_end(&benchmark_span);
         
         // Calculate performance score based on criteria
         result.performance_score = 100.0;
@@ -410,6 +719,11 @@ evaluation_result_t evaluate_code_comprehensive(const char *file_path, const cha
             result.performance_score *= throughput_ratio;
         }
         
+        // Code that is fast at the default size but scales badly is penalized
+        if (scaling_exceeds_limit(&result.performance.scaling, criteria)) {
+            result.performance_score -= (result.performance.scaling.exponent - criteria->max_scaling_exponent) * 50.0;
+        }
+        
         result.performance_score = fmax(0.0, fmin(100.0, result.performance_score));
     } else {
         result.performance_score = result.test_result.execution_ok ? 75.0 : 0.0;
@@ -417,7 +731,9 @@ evaluation_result_t evaluate_code_comprehensive(const char *file_path, const cha
     
     // Code quality analysis
     if (criteria && criteria->enable_quality_analysis) {
+        trace_span_t quality_span = trace_begin("quality_analysis", TRACE_NO_AGENT);
         result.quality = analyze_code_quality(code_content);
+        trace_end(&quality_span);
         
         // Calculate quality score
         result.quality_score = 100.0;
@@ -453,6 +769,7 @@ evaluation_result_t evaluate_code_comprehensive(const char *file_path, const cha
     result.detailed_report = generate_evaluation_report(&result);
     result.recommendations = generate_improvement_recommendations(&result);
     
+    trace_end(&span);
     return result;
 }
 
@@ -475,6 +792,9 @@ int evaluate_against_criteria(const evaluation_result_t *result, const evaluatio
     if (criteria->min_test_coverage_percent > 0 && 
         result->quality.test_coverage_percent < criteria->min_test_coverage_percent) return 0;
     
+    // Check the fitted scaling exponent
+    if (scaling_exceeds_limit(&result->performance.scaling, criteria)) return 0;
+    
     // Check complexity limit
     if (criteria->max_cyclomatic_complexity > 0 && 
         result->quality.cyclomatic_complexity > criteria->max_cyclomatic_complexity) return 0;
@@ -517,8 +837,13 @@ void save_evaluation_history(code_evolution_t *evolution, const evaluation_resul
         if (!evolution->evaluation_history) return;
     }
     
-    // Copy the evaluation result
-    evolution->evaluation_history[evolution->evaluation_count] = *result;
+    // Copy the evaluation result; its strings belong to the caller, so the copy keeps only the numbers
+    evaluation_result_t *entry = &evolution->evaluation_history[evolution->evaluation_count];
+    *entry = *result;
+    entry->detailed_report = NULL;
+    entry->recommendations = NULL;
+    entry->test_result.output = NULL;
+    entry->test_result.error_message = NULL;
     evolution->evaluation_count++;
 }
 
@@ -562,10 +887,17 @@ void compare_evaluations(const evaluation_result_t *eval1, const evaluation_resu
     dstring_append_format(report, "  Time: %.2fms → %.2fms (%+.2fms)\n", 
                          eval2->performance.execution_time_ms, eval1->performance.execution_time_ms,
                          eval1->performance.execution_time_ms - eval2->performance.execution_time_ms);
-    dstring_append_format(report, "  Memory: %ldKB → %ldKB (%+ldKB)\n\n", 
+    dstring_append_format(report, "  Memory: %ldKB → %ldKB (%+ldKB)\n", 
                          eval2->performance.memory_usage_kb, eval1->performance.memory_usage_kb,
                          eval1->performance.memory_usage_kb - eval2->performance.memory_usage_kb);
     
+    // Timing differences inside the benchmark noise are not reported as changes
+    int timing = benchmark_compare(&eval1->performance, &eval2->performance);
+    dstring_append_format(report, "  Significance: %s\n\n",
+                         timing < 0 ? "faster (p < 0.05)" :
+                         timing > 0 ? "slower (p < 0.05)" : "within noise");
+    
+    
     dstring_append_format(report, "CODE QUALITY:\n");
     dstring_append_format(report, "  Current: %.1f/100\n", eval1->quality_score);
     dstring_append_format(report, "  Previous: %.1f/100\n", eval2->quality_score);
@@ -575,7 +907,11 @@ void compare_evaluations(const evaluation_result_t *eval1, const evaluation_resu
     dstring_append_format(report, "  Test Coverage: %.1f%% → %.1f%%\n\n", 
                          eval2->quality.test_coverage_percent, eval1->quality.test_coverage_percent);
     
-    if (eval1->overall_score > eval2->overall_score) {
+    int only_performance_changed = eval1->correctness_score == eval2->correctness_score &&
+                                   eval1->quality_score == eval2->quality_score;
+    if (only_performance_changed && timing == 0) {
+        dstring_append(report, "➡️  NO SIGNIFICANT CHANGE\n");
+    } else if (eval1->overall_score > eval2->overall_score) {
         dstring_append(report, "✅ IMPROVEMENT DETECTED\n");
     } else if (eval1->overall_score < eval2->overall_score) {
         dstring_append(report, "⚠️  REGRESSION DETECTED\n");
@@ -583,6 +919,5 @@ void compare_evaluations(const evaluation_result_t *eval1, const evaluation_resu
         dstring_append(report, "➡️  NO SIGNIFICANT CHANGE\n");
     }
     
-    *comparison_report = strdup(dstring_get(report));
-    dstring_destroy(report);
+    *comparison_report = dstring_steal(report);
 }
@@ -1,5 +1,13 @@
 #include "beta_evolve.h"
+#include "benchmark.h"
+#include "metrics.h"
+#include "scaling.h"
+#include "region_prompt.h"
+#include "test_suite.h"
+#include "trace.h"
+#include "workspace.h"
 #include <regex.h>
+#include <sys/wait.h>
 
 // Initialize code evolution context
 void init_code_evolution(code_evolution_t *evolution) {
@@ -13,17 +21,24 @@ void init_code_evolution(code_evolution_t *evolution) {
     evolution->region_count = 0;
 }
 
-// Cleanup code evolution context
-void cleanup_code_evolution(code_evolution_t *evolution) {
-    if (!evolution) return;
-    
-    // Free all region contents
+// Free region contents, keeping history and generation counters
+static void clear_evolution_regions(code_evolution_t *evolution) {
     for (int i = 0; i < evolution->region_count; i++) {
         if (evolution->regions[i].content) {
             free(evolution->regions[i].content);
             evolution->regions[i].content = NULL;
         }
     }
+    memset(evolution->regions, 0, sizeof(evolution->regions));
+    evolution->region_count = 0;
+}
+
+// Cleanup code evolution context
+void cleanup_code_evolution(code_evolution_t *evolution) {
+    if (!evolution) return;
+    
+    // Free all region contents
+    clear_evolution_regions(evolution);
     
     // Free base code
     if (evolution->base_code) {
@@ -31,135 +46,136 @@ void cleanup_code_evolution(code_evolution_t *evolution) {
         evolution->base_code = NULL;
     }
     
+    // Free evaluation history
+    if (evolution->evaluation_history) {
+        free(evolution->evaluation_history);
+        evolution->evaluation_history = NULL;
+    }
+    evolution->evaluation_count = 0;
+    
     evolution->region_count = 0;
     evolution->evolution_enabled = 0;
 }
 
-// Parse evolution regions from code using comment markers
-int parse_evolution_regions(code_evolution_t *evolution, const char *code) {
-    if (!evolution || !code) return -1;
-    
-    // Clear existing regions
-    cleanup_code_evolution(evolution);
-    init_code_evolution(evolution);
+// One region located in a source buffer, as byte offsets
+typedef struct {
+    size_t start;                                // First byte of the START marker line
+    size_t content_start;                        // First byte after the START marker line
+    size_t content_end;                          // First byte of the END marker line
+    int start_line;                              // Line numbers of the two markers
+    int end_line;
+    char description[MAX_EVOLUTION_DESCRIPTION];
+} region_span_t;
+
+// Description following the START marker on its line, or region_<n>
+static void region_description(const char *marker, const char *line_end, int index, char *out) {
+    const char *desc = marker + strlen(EVOLUTION_MARKER_START);
     
-    // Check if code contains evolution markers
-    if (!strstr(code, EVOLUTION_MARKER_START)) {
-        evolution->evolution_enabled = 0;
-        return 0; // No evolution regions found, not an error
+    // Skip whitespace and potential colon
+    while (desc < line_end && (*desc == ' ' || *desc == '\t' || *desc == ':')) {
+        desc++;
     }
     
-    evolution->evolution_enabled = 1;
-    
-    // Create a copy of the code to work with
-    char *code_copy = strdup(code);
-    if (!code_copy) return -1;
-    
-    // Split code into lines for easier processing
-    char *lines[4096]; // Support up to 4096 lines
-    int line_count = 0;
-    char *line = strtok(code_copy, "\n");
-    
-    while (line && line_count < 4095) {
-        lines[line_count] = strdup(line);
-        line_count++;
-        line = strtok(NULL, "\n");
+    // Remove trailing whitespace
+    const char *end = line_end;
+    while (end > desc && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) {
+        end--;
     }
     
-    // Parse evolution regions
-    int region_idx = 0;
+    size_t length = end - desc;
+    if (length == 0) {
+        snprintf(out, MAX_EVOLUTION_DESCRIPTION, "region_%d", index + 1);
+        return;
+    }
+    if (length > MAX_EVOLUTION_DESCRIPTION - 1) length = MAX_EVOLUTION_DESCRIPTION - 1;
+    memcpy(out, desc, length);
+    out[length] = '\0';
+}
+
+// Single pass over code recording every complete region, without copying any text.
+// Returns the number of regions found (at most max_spans).
+static int index_evolution_regions(const char *code, region_span_t *spans, int max_spans, int warn) {
+    size_t start_length = strlen(EVOLUTION_MARKER_START);
+    size_t end_length = strlen(EVOLUTION_MARKER_END);
+    int count = 0;
     int in_region = 0;
-    int start_line = -1;
-    char current_description[MAX_EVOLUTION_DESCRIPTION] = {0};
-    dstring_t *current_content = NULL;
-    
-    for (int i = 0; i < line_count && region_idx < MAX_EVOLUTION_REGIONS; i++) {
-        char *trimmed = lines[i];
-        
-        // Skip leading whitespace
-        while (*trimmed && (*trimmed == ' ' || *trimmed == '\t')) {
-            trimmed++;
-        }
+    int line_number = 0;
+    const char *line = code;
+    
+    while (*line) {
+        const char *newline = strchr(line, '\n');
+        const char *line_end = newline ? newline : line + strlen(line);
+        size_t length = line_end - line;
+        const char *start_marker = memmem(line, length, EVOLUTION_MARKER_START, start_length);
         
-        if (strstr(trimmed, EVOLUTION_MARKER_START)) {
+        if (start_marker) {
             if (in_region) {
-                // Error: nested regions not allowed
-                fprintf(stderr, "Warning: Nested evolution regions detected at line %d\n", i + 1);
-                continue;
-            }
-            
-            in_region = 1;
-            start_line = i;
-            
-            // Extract description if present
-            char *desc_start = strstr(trimmed, EVOLUTION_MARKER_START);
-            desc_start += strlen(EVOLUTION_MARKER_START);
-            
-            // Skip whitespace and potential colon
-            while (*desc_start && (*desc_start == ' ' || *desc_start == '\t' || *desc_start == ':')) {
-                desc_start++;
+                if (warn) fprintf(stderr, "Warning: Nested evolution regions detected at line %d\n", line_number + 1);
+            } else if (count < max_spans) {
+                in_region = 1;
+                spans[count].start = line - code;
+                spans[count].content_start = newline ? (size_t)(newline + 1 - code) : (size_t)(line_end - code);
+                spans[count].start_line = line_number;
+                region_description(start_marker, line_end, count, spans[count].description);
+            } else if (warn) {
+                fprintf(stderr, "Warning: More than %d evolution regions, line %d is left as is\n", max_spans, line_number + 1);
+                warn = 0;
             }
-            
-            if (*desc_start) {
-                strncpy(current_description, desc_start, MAX_EVOLUTION_DESCRIPTION - 1);
-                current_description[MAX_EVOLUTION_DESCRIPTION - 1] = '\0';
-                
-                // Remove trailing whitespace and comments
-                char *end = current_description + strlen(current_description) - 1;
-                while (end > current_description && (*end == ' ' || *end == '\t' || *end == '\n' || *end == '\r')) {
-                    *end = '\0';
-                    end--;
-                }
-            } else {
-                snprintf(current_description, sizeof(current_description), "region_%d", region_idx + 1);
-            }
-            
-            current_content = dstring_create(1024);
-            
-        } else if (strstr(trimmed, EVOLUTION_MARKER_END)) {
-            if (!in_region) {
-                fprintf(stderr, "Warning: Evolution end marker without start at line %d\n", i + 1);
-                continue;
-            }
-            
-            // Save the current region
-            if (current_content && region_idx < MAX_EVOLUTION_REGIONS) {
-                evolution->regions[region_idx].content = strdup(dstring_get(current_content));
-                strncpy(evolution->regions[region_idx].description, current_description, MAX_EVOLUTION_DESCRIPTION - 1);
-                evolution->regions[region_idx].start_line = start_line;
-                evolution->regions[region_idx].end_line = i;
-                evolution->regions[region_idx].generation = 0;
-                evolution->regions[region_idx].fitness_score = 0.0;
-                
-                region_idx++;
-            }
-            
-            if (current_content) {
-                dstring_destroy(current_content);
-                current_content = NULL;
+        } else if (memmem(line, length, EVOLUTION_MARKER_END, end_length)) {
+            if (in_region) {
+                spans[count].content_end = line - code;
+                spans[count].end_line = line_number;
+                count++;
+                in_region = 0;
+            } else if (warn) {
+                fprintf(stderr, "Warning: Evolution end marker without start at line %d\n", line_number + 1);
             }
-            
-            in_region = 0;
-            start_line = -1;
-            memset(current_description, 0, sizeof(current_description));
-            
-        } else if (in_region && current_content) {
-            // Add line to current region content
-            dstring_append(current_content, lines[i]);
-            dstring_append(current_content, "\n");
         }
+        
+        if (!newline) break;
+        line = newline + 1;
+        line_number++;
     }
     
-    evolution->region_count = region_idx;
+    return count;
+}
+
+// Parse evolution regions from code using comment markers
+int parse_evolution_regions(code_evolution_t *evolution, const char *code) {
+    if (!evolution || !code) return -1;
+    
+    // Clear existing regions (history and counters survive a re-parse)
+    clear_evolution_regions(evolution);
     
-    // Clean up line copies
-    for (int i = 0; i < line_count; i++) {
-        free(lines[i]);
+    // Check if code contains evolution markers
+    if (!strstr(code, EVOLUTION_MARKER_START)) {
+        evolution->evolution_enabled = 0;
+        return 0; // No evolution regions found, not an error
     }
-    free(code_copy);
     
-    if (current_content) {
-        dstring_destroy(current_content);
+    evolution->evolution_enabled = 1;
+    
+    region_span_t spans[MAX_EVOLUTION_REGIONS];
+    int count = index_evolution_regions(code, spans, MAX_EVOLUTION_REGIONS, 1);
+    
+    // Each region body is copied once, byte for byte
+    for (int i = 0; i < count; i++) {
+        evolution_region_t *region = &evolution->regions[i];
+        size_t length = spans[i].content_end - spans[i].content_start;
+        
+        region->content = malloc(length + 1);
+        if (!region->content) break;
+        memcpy(region->content, code + spans[i].content_start, length);
+        region->content[length] = '\0';
+        
+        memcpy(region->description, spans[i].description, MAX_EVOLUTION_DESCRIPTION);
+        region->start_line = spans[i].start_line;
+        region->end_line = spans[i].end_line;
+        region->start_offset = spans[i].content_start;
+        region->end_offset = spans[i].content_end;
+        region->generation = 0;
+        region->fitness_score = 0.0;
+        evolution->region_count = i + 1;
     }
     
     return evolution->region_count;
@@ -176,96 +192,49 @@ char* assemble_evolved_code(const code_evolution_t *evolution, const char *origi
         return strdup(original_code);
     }
     
-    dstring_t *assembled = dstring_create(strlen(original_code) * 2);
-    if (!assembled) return NULL;
-    
-    // Split original code into lines for processing
-    char *code_copy = strdup(original_code);
-    char **lines = NULL;
-    int line_count = 0;
-    int capacity = 100;
+    region_span_t spans[MAX_EVOLUTION_REGIONS];
+    int count = index_evolution_regions(original_code, spans, MAX_EVOLUTION_REGIONS, 0);
     
-    lines = malloc(capacity * sizeof(char*));
-    if (!lines) {
-        free(code_copy);
-        dstring_destroy(assembled);
-        return NULL;
-    }
-    
-    // Parse lines
-    char *line = strtok(code_copy, "\n");
-    while (line) {
-        if (line_count >= capacity) {
-            capacity *= 2;
-            lines = realloc(lines, capacity * sizeof(char*));
-            if (!lines) {
-                free(code_copy);
-                dstring_destroy(assembled);
-                return NULL;
+    // Match regions to spans by their START line, falling back to file order
+    const char *contents[MAX_EVOLUTION_REGIONS];
+    size_t total = strlen(original_code) + 1;
+    for (int k = 0; k < count; k++) {
+        int match = -1;
+        for (int r = 0; r < evolution->region_count; r++) {
+            if (evolution->regions[r].start_line == spans[k].start_line) {
+                match = r;
+                break;
             }
         }
-        lines[line_count] = strdup(line);
-        line_count++;
-        line = strtok(NULL, "\n");
-    }
-    
-    // Reconstruct the file, replacing evolved regions
-    int i = 0;
-    while (i < line_count) {
-        char *current_line = lines[i];
-        
-        // Check if this line is an evolution region start
-        if (strstr(current_line, EVOLUTION_MARKER_START)) {
-            // Find corresponding region in evolution context
-            int region_idx = -1;
-            for (int r = 0; r < evolution->region_count; r++) {
-                if (evolution->regions[r].start_line <= i && evolution->regions[r].end_line >= i) {
-                    region_idx = r;
-                    break;
-                }
-            }
-            
-            // Add the start marker with original description
-            dstring_append_format(assembled, "%s\n", current_line);
-            
-            // Add evolved content if available
-            if (region_idx >= 0 && evolution->regions[region_idx].content) {
-                dstring_append(assembled, evolution->regions[region_idx].content);
-                if (evolution->regions[region_idx].content[strlen(evolution->regions[region_idx].content)-1] != '\n') {
-                    dstring_append(assembled, "\n");
-                }
-            } else {
-                // Fall back to original content between markers
-                i++; // Skip start marker
-                while (i < line_count && !strstr(lines[i], EVOLUTION_MARKER_END)) {
-                    dstring_append_format(assembled, "%s\n", lines[i]);
-                    i++;
-                }
-            }
-            
-            // Find and add the end marker
-            while (i < line_count && !strstr(lines[i], EVOLUTION_MARKER_END)) {
-                i++;
-            }
-            if (i < line_count) {
-                dstring_append_format(assembled, "%s\n", lines[i]);
+        if (match < 0 && k < evolution->region_count) match = k;
+        
+        contents[k] = match >= 0 ? evolution->regions[match].content : NULL;
+        if (contents[k]) total += strlen(contents[k]) + 1;
+    }
+    
+    dstring_t *assembled = dstring_create(total);
+    if (!assembled) return NULL;
+    
+    // Copy the original bytes up to each region body, then the evolved body
+    size_t position = 0;
+    for (int k = 0; k < count; k++) {
+        dstring_append_len(assembled, original_code + position, spans[k].content_start - position);
+        
+        if (contents[k]) {
+            size_t length = strlen(contents[k]);
+            dstring_append_len(assembled, contents[k], length);
+            if (length > 0 && contents[k][length - 1] != '\n') {
+                dstring_append(assembled, "\n");
             }
         } else {
-            // Regular line, add as-is
-            dstring_append_format(assembled, "%s\n", current_line);
+            dstring_append_len(assembled, original_code + spans[k].content_start,
+                               spans[k].content_end - spans[k].content_start);
         }
-        i++;
+        position = spans[k].content_end;
     }
+    dstring_append(assembled, original_code + position);
     
-    // Clean up
-    for (int j = 0; j < line_count; j++) {
-        free(lines[j]);
-    }
-    free(lines);
-    free(code_copy);
-    
-    char *result = strdup(dstring_get(assembled));
-    dstring_destroy(assembled);
+    char *result = dstring_steal(assembled);
     
     return result;
 }
@@ -357,13 +326,21 @@ double evaluate_evolution_fitness(const char *file_path, config_t *config) {
     
     // Use custom test command if specified
     if (strlen(config->test_command) > 0) {
-        test_result_t result = run_custom_test(config->test_command, file_path, config);
+        test_result_t result = run_test_suite(file_path, config);
         
         // Base fitness components
         if (result.syntax_ok) fitness += 0.3;
         if (result.compilation_ok) fitness += 0.3;
         if (result.execution_ok) fitness += 0.4;
         
+        // Reported metrics replace the pass/fail sum when they are configured
+        if (config->metric_count > 0) {
+            char *code = read_evolution_file(file_path);
+            metric_set_t metrics;
+            if (metrics_measure(code, &result, config, &metrics)) fitness = metrics.fitness;
+            free(code);
+        }
+        
         cleanup_test_result(&result);
     } else {
         // Fallback to basic file existence check
@@ -375,7 +352,6 @@ double evaluate_evolution_fitness(const char *file_path, config_t *config) {
     }
     
     // Additional fitness factors could include:
-    // - Performance metrics (timing tests)
     // - Code complexity analysis
     // - Memory usage profiling
     // - Test coverage analysis
@@ -383,6 +359,57 @@ double evaluate_evolution_fitness(const char *file_path, config_t *config) {
     return fitness;
 }
 
+// Region-scoped code context: the region bodies plus the declarations they depend on.
+// Returns -1 (nothing appended) when the current solution has no parseable regions.
+static int append_region_scoped_code(dstring_t *prompt, const conversation_t *conv) {
+    code_evolution_t regions;
+    init_code_evolution(&regions);
+    if (parse_evolution_regions(&regions, conv->current_solution) <= 0) {
+        cleanup_code_evolution(&regions);
+        return -1;
+    }
+    
+    char *region_text = format_evolution_regions(&regions);
+    cleanup_code_evolution(&regions);
+    if (!region_text) return -1;
+    
+    region_context_stats_t stats;
+    char *context = extract_region_context(conv->current_solution, region_text,
+                                           conv->config->region_prompt_token_budget, &stats);
+    
+    dstring_append(prompt, "FILE CONTEXT (declarations from outside the regions; the rest of the file is not shown):\n```c\n");
+    dstring_append(prompt, context && strlen(context) > 0 ? context : "// (none)\n");
+    dstring_append(prompt, "```\n\nEVOLUTION REGIONS:\n```c\n");
+    dstring_append(prompt, region_text);
+    dstring_append(prompt, "```\n\n");
+    
+    log_message(conv->config, VERBOSITY_DEBUG,
+               "Region-scoped prompt: %d of %d declarations as context, %d over budget, ~%d skeleton tokens omitted\n",
+               stats.included, stats.declarations, stats.over_budget, stats.skeleton_tokens);
+    
+    free(context);
+    free(region_text);
+    return 0;
+}
+
+// Response format of per-region patch responses
+static void append_region_patch_format(dstring_t *prompt) {
+    dstring_append(prompt,
+        "RESPONSE FORMAT (per-region patches):\n"
+        "Evolution Analysis: [Brief description of what you evolved and the expected improvements]\n\n"
+        "Then one ```c block per region you change, and nothing else:\n"
+        "```c\n"
+        "// BETA EVOLVE START: <description exactly as shown>\n"
+        "// ... complete new body of this region ...\n"
+        "// BETA EVOLVE END\n"
+        "```\n"
+        "Regions you leave out stay exactly as they are, so only send the ones you change. "
+        "#include lines your code needs may be placed above the START marker of a block. "
+        "If no region needs to change, reply with the analysis only.\n\n"
+        
+        "Your response:");
+}
+
 // Generate evolution-specific prompt for AI agents
 char* generate_evolution_prompt(const conversation_t *conv, const code_evolution_t *evolution, agent_type_t agent) {
     if (!conv || !conv->config || !evolution) return NULL;
@@ -435,6 +462,43 @@ char* generate_evolution_prompt(const conversation_t *conv, const code_evolution
             "3. Add error handling and edge case coverage\n"
             "4. Include any missing #include headers needed for your implementations\n"
             "5. Evaluate and refine the evolutionary changes\n\n");
+        
+        // Hardware counters tell memory-bound code apart from compute-bound code
+        char *profile = generate_performance_profile(&conv->last_performance);
+        if (profile && conv->last_performance.ns_per_call > 0) {
+            dstring_append_format(prompt, "PERFORMANCE PROFILE (current solution, %s() in-process):\n%s\n",
+                                 conv->config->kernel_entry, profile);
+            free(profile);
+        } else if (profile) {
+            dstring_append_format(prompt, "PERFORMANCE PROFILE (current solution, median %.2f ms):\n%s\n",
+                                 conv->last_performance.execution_time_ms, profile);
+            free(profile);
+        }
+
+        // The fitted curve shows how the solution behaves beyond the default size
+        char *scaling = generate_scaling_report(&conv->last_performance.scaling);
+        if (scaling) {
+            dstring_append(prompt, "SCALING PROFILE (run time over input sizes):\n");
+            dstring_append(prompt, scaling);
+            dstring_append(prompt, "\n");
+            free(scaling);
+        }
+    }
+    
+    // What the benchmark measured is the target both agents optimize
+    char *metrics_report = generate_metrics_report(&conv->last_metrics, conv->config);
+    if (metrics_report) {
+        dstring_append(prompt, metrics_report);
+        dstring_append(prompt, "Improve these measured values without failing any gate.\n\n");
+        free(metrics_report);
+    }
+
+    // The sweep only measures code that sizes its workload from the input size
+    if (conv->config->enable_scaling_sweep) {
+        dstring_append(prompt,
+            "INPUT SIZE: Benchmarks run the program with the input size n as argv[1] (also in the "
+            SCALING_SIZE_ENV " environment variable). main() must size its workload from it and fall back "
+            "to a default when it is absent.\n\n");
     }
     
     // Add current problem and code context
@@ -444,8 +508,51 @@ char* generate_evolution_prompt(const conversation_t *conv, const code_evolution
     const char *errors = (conv->last_test_result.error_message && strlen(conv->last_test_result.error_message) > 0) ? 
                          conv->last_test_result.error_message : "None";
     
-    dstring_append_format(prompt, "PROBLEM: %s\n\nCURRENT CODE: %s\n\nERRORS TO FIX: %s\n\n", 
-                         problem_desc, current_code, errors);
+    int scoped = 0;
+    if (conv->config->region_scoped_prompts && strcmp(current_code, "None") != 0) {
+        dstring_append_format(prompt, "PROBLEM: %s\n\n", problem_desc);
+        scoped = append_region_scoped_code(prompt, conv) == 0;
+        if (scoped) {
+            dstring_append_format(prompt, "ERRORS TO FIX: %s\n\n", errors);
+        } else {
+            dstring_append_format(prompt, "CURRENT CODE: %s\n\nERRORS TO FIX: %s\n\n", current_code, errors);
+        }
+    } else {
+        dstring_append_format(prompt, "PROBLEM: %s\n\nCURRENT CODE: %s\n\nERRORS TO FIX: %s\n\n", 
+                             problem_desc, current_code, errors);
+    }
+    
+    if (scoped) {
+        // Only the regions come back; they are merged into the unchanged file
+        dstring_append(prompt,
+            "EVOLUTION INSTRUCTIONS:\n"
+            "1. Only the evolution regions and the declarations they use are shown; the rest of the file stays as it is\n");
+        dstring_append(prompt, conv->config->region_patch_responses ?
+            "2. Return the regions you change with their START/END marker lines exactly as shown, and nothing from the rest of the file\n"
+            "3. Put any #include lines your code needs above a region's START marker; missing ones are added to the file\n" :
+            "2. Return every region with its START/END marker lines exactly as shown, and nothing from the rest of the file\n"
+            "3. Put any #include lines your code needs first in the code block; missing ones are added to the file\n");
+        dstring_append(prompt,
+            "4. Keep the signatures used by the rest of the file unchanged\n"
+            "5. Focus on algorithmic improvements while ensuring code compiles\n"
+            "6. Provide analysis of what you evolved and why\n\n");
+        
+        if (conv->config->region_patch_responses) {
+            append_region_patch_format(prompt);
+        } else {
+            dstring_append(prompt,
+                "RESPONSE FORMAT:\n"
+                "Evolution Analysis: [Brief description of what you evolved and the expected improvements]\n\n"
+                "```c\n"
+                "// Needed #include lines, then each evolved region with its markers\n"
+                "```\n\n"
+                
+                "Your response:");
+        }
+        
+        char* result = dstring_steal(prompt);
+        return result;
+    }
     
     // Add evolution-specific instructions
     dstring_append(prompt,
@@ -460,18 +567,22 @@ char* generate_evolution_prompt(const conversation_t *conv, const code_evolution
         "   - Add any other headers your evolved code requires\n"
         "4. Focus on algorithmic improvements while ensuring code compiles\n"
         "5. Test your changes thoroughly\n"
-        "6. Provide analysis of what you evolved and why\n\n"
-        
-        "RESPONSE FORMAT:\n"
-        "Evolution Analysis: [Brief description of what you evolved and the expected improvements]\n\n"
-        "```c\n"
-        "// Your complete evolved code with all necessary headers and regions\n"
-        "```\n\n"
-        
-        "Your response:");
+        "6. Provide analysis of what you evolved and why\n\n");
     
-    char* result = strdup(dstring_get(prompt));
-    dstring_destroy(prompt);
+    if (conv->config->region_patch_responses) {
+        append_region_patch_format(prompt);
+    } else {
+        dstring_append(prompt,
+            "RESPONSE FORMAT:\n"
+            "Evolution Analysis: [Brief description of what you evolved and the expected improvements]\n\n"
+            "```c\n"
+            "// Your complete evolved code with all necessary headers and regions\n"
+            "```\n\n"
+            
+            "Your response:");
+    }
+    
+    char* result = dstring_steal(prompt);
     
     return result;
 }
@@ -483,64 +594,73 @@ void evolve_code_regions(conversation_t *conv, code_evolution_t *evolution) {
     
     // Parse current solution for evolution regions
     if (conv->current_solution && strlen(conv->current_solution) > 0) {
+        trace_span_t span = trace_begin("parse_regions", TRACE_NO_AGENT);
         parse_evolution_regions(evolution, conv->current_solution);
+        trace_end(&span);
     }
     
     // Use custom test command if specified
     if (strlen(conv->config->test_command) > 0) {
         log_message(conv->config, VERBOSITY_VERBOSE, "%s🧬 Running evolution test with custom command...%s\n", C_INFO, C_RESET);
         
-        // Write current solution to evolution file for testing
-        if (write_evolution_file(conv->config->evolution_file_path, conv->current_solution) == 0) {
-            // Create evolved file path for testing
-            char evolved_file_path[1024];
-            snprintf(evolved_file_path, sizeof(evolved_file_path), "%s.evolved", conv->config->evolution_file_path);
-            
-            // Run custom test command with evolved file
-            test_result_t test_result = run_custom_test(conv->config->test_command, 
-                                                       evolved_file_path, 
-                                                       conv->config);
-            
-            // Update conversation test result for consistency
-            cleanup_test_result(&conv->last_test_result);
-            conv->last_test_result = test_result;
-            
-            // Evaluate fitness based on test results
-            double current_fitness = 0.0;
-            if (test_result.syntax_ok) current_fitness += 0.3;
-            if (test_result.compilation_ok) current_fitness += 0.3;
-            if (test_result.execution_ok) current_fitness += 0.4;
-            
-            // Update fitness scores for all regions
-            for (int i = 0; i < evolution->region_count; i++) {
-                evolution->regions[i].fitness_score = current_fitness;
-            }
-            
-            log_message(conv->config, VERBOSITY_VERBOSE, 
-                       "%s🧬 Evolution fitness: %.2f (generation %d)%s\n", 
-                       C_INFO, current_fitness, evolution->current_generation, C_RESET);
-            
-            if (current_fitness >= 1.0) {
-                log_message(conv->config, VERBOSITY_NORMAL, "%s🧬 Evolution target achieved! Code passes all tests.%s\n", C_SUCCESS, C_RESET);
-            } else if (current_fitness >= 0.6) {
-                log_message(conv->config, VERBOSITY_NORMAL, "%s🧬 Evolution making good progress (fitness: %.2f)%s\n", C_INFO, current_fitness, C_RESET);
-            } else {
-                log_message(conv->config, VERBOSITY_NORMAL, "%s🧬 Evolution needs improvement (fitness: %.2f)%s\n", C_WARNING, current_fitness, C_RESET);
-            }
-            
-            // Show test output if available and verbosity is high enough
-            if (conv->config->verbosity >= VERBOSITY_VERBOSE && test_result.output && strlen(test_result.output) > 0) {
-                log_message(conv->config, VERBOSITY_VERBOSE, "%sTest Output:%s\n%s\n", C_INFO, C_RESET, test_result.output);
-            }
-            
-            // Show errors if any
-            if (test_result.error_message && strlen(test_result.error_message) > 0) {
-                log_message(conv->config, VERBOSITY_NORMAL, "%sEvolution Test Errors:%s %s\n", C_ERROR, C_RESET, test_result.error_message);
-            }
-        } else {
+        // Keep the evolved file as an artifact, but test in a private workspace
+        if (write_evolution_file(conv->config->evolution_file_path, conv->current_solution) != 0) {
             log_message(conv->config, VERBOSITY_NORMAL, "%s❌ Failed to write evolved code to file: %s%s\n", 
                        C_ERROR, conv->config->evolution_file_path, C_RESET);
         }
+        
+        test_result_t test_result = test_solution_code(conv->current_solution, conv->problem_description, conv->config,
+                                                       conv->scratch);
+        
+        // Update conversation test result for consistency
+        cleanup_test_result(&conv->last_test_result);
+        conv->last_test_result = test_result;
+        
+        // Evaluate fitness based on test results
+        double current_fitness = 0.0;
+        if (test_result.syntax_ok) current_fitness += 0.3;
+        if (test_result.compilation_ok) current_fitness += 0.3;
+        if (test_result.execution_ok) current_fitness += 0.4;
+        int target_met = current_fitness >= 1.0;
+        
+        // The solution update already measured this code; measure here only if it did not
+        if (conv->config->metric_count > 0) {
+            if (!conv->last_metrics.measured) {
+                metrics_measure(conv->current_solution, &conv->last_test_result, conv->config, &conv->last_metrics);
+            }
+            current_fitness = conv->last_metrics.fitness;
+            target_met = conv->last_metrics.gates_passed;
+        }
+        
+        // Update fitness scores for all regions
+        for (int i = 0; i < evolution->region_count; i++) {
+            evolution->regions[i].fitness_score = current_fitness;
+        }
+        
+        log_message(conv->config, VERBOSITY_VERBOSE, 
+                   "%s🧬 Evolution fitness: %.2f (generation %d)%s\n", 
+                   C_INFO, current_fitness, evolution->current_generation, C_RESET);
+        
+        if (target_met && conv->config->metric_count > 0) {
+            log_message(conv->config, VERBOSITY_NORMAL, "%s🧬 Code passes all tests and metric gates (fitness: %.3f)%s\n",
+                       C_SUCCESS, current_fitness, C_RESET);
+        } else if (target_met) {
+            log_message(conv->config, VERBOSITY_NORMAL, "%s🧬 Evolution target achieved! Code passes all tests.%s\n", C_SUCCESS, C_RESET);
+        } else if (current_fitness >= 0.6) {
+            log_message(conv->config, VERBOSITY_NORMAL, "%s🧬 Evolution making good progress (fitness: %.2f)%s\n", C_INFO, current_fitness, C_RESET);
+        } else {
+            log_message(conv->config, VERBOSITY_NORMAL, "%s🧬 Evolution needs improvement (fitness: %.2f)%s\n", C_WARNING, current_fitness, C_RESET);
+        }
+        
+        // Show test output if available and verbosity is high enough
+        if (conv->config->verbosity >= VERBOSITY_VERBOSE && test_result.output && strlen(test_result.output) > 0) {
+            log_message(conv->config, VERBOSITY_VERBOSE, "%sTest Output:%s\n%s\n", C_INFO, C_RESET, test_result.output);
+        }
+        
+        // Show errors if any
+        if (test_result.error_message && strlen(test_result.error_message) > 0) {
+            log_message(conv->config, VERBOSITY_NORMAL, "%sEvolution Test Errors:%s %s\n", C_ERROR, C_RESET, test_result.error_message);
+        }
     } else {
         // Fallback to basic fitness evaluation without custom testing
         double current_fitness = evaluate_evolution_fitness(conv->config->evolution_file_path, conv->config);
@@ -561,17 +681,39 @@ void evolve_code_regions(conversation_t *conv, code_evolution_t *evolution) {
         
         log_message(conv->config, VERBOSITY_NORMAL, "%s📊 Running comprehensive evaluation...%s\n", C_INFO, C_RESET);
         
+        // Evaluate a private copy that keeps the evolution file's name
+        workspace_t workspace;
         char evolved_file_path[1024];
-        snprintf(evolved_file_path, sizeof(evolved_file_path), "%s.evolved", conv->config->evolution_file_path);
+        const char *base_name = strrchr(conv->config->evolution_file_path, '/');
+        base_name = base_name ? base_name + 1 : conv->config->evolution_file_path;
+        
+        if (workspace_create(&workspace, "eval") != 0 ||
+            workspace_write_file(&workspace, base_name, conv->current_solution, 
+                                 evolved_file_path, sizeof(evolved_file_path)) != 0) {
+            log_message(conv->config, VERBOSITY_NORMAL, "%s❌ Failed to prepare evaluation workspace%s\n", C_ERROR, C_RESET);
+            workspace_destroy(&workspace);
+            return;
+        }
         
         evaluation_result_t eval_result = evaluate_code_comprehensive(
             evolved_file_path, conv->current_solution, &conv->config->eval_criteria, conv->config);
+        workspace_destroy(&workspace);
+        conv->last_performance = eval_result.performance; // Shown to the next reasoning prompt
         
-        // Update fitness score based on comprehensive evaluation
-        for (int i = 0; i < evolution->region_count; i++) {
+        // Update fitness score based on comprehensive evaluation, unless metrics define it
+        for (int i = 0; i < evolution->region_count && conv->config->metric_count == 0; i++) {
             evolution->regions[i].fitness_score = eval_result.overall_score / 100.0;
         }
         
+        // The benchmark's own metrics (run time, allocations) can be fitness terms too
+        if (conv->config->metric_count > 0 && conv->last_metrics.measured) {
+            metrics_add_performance(&conv->last_metrics, &eval_result.performance);
+            metrics_score(&conv->last_test_result, &conv->last_metrics, conv->config);
+            for (int i = 0; i < evolution->region_count; i++) {
+                evolution->regions[i].fitness_score = conv->last_metrics.fitness;
+            }
+        }
+        
         // Log evaluation results
         log_message(conv->config, VERBOSITY_NORMAL, 
                    "%s📊 Comprehensive Score: %.1f/100 (Correctness: %.1f, Performance: %.1f, Quality: %.1f)%s\n",
@@ -586,10 +728,15 @@ void evolve_code_regions(conversation_t *conv, code_evolution_t *evolution) {
         
         // Show detailed metrics in verbose mode
         if (conv->config->verbosity >= VERBOSITY_VERBOSE) {
-            log_message(conv->config, VERBOSITY_VERBOSE, 
-                       "%sPerformance: %.2fms execution, %ldKB memory, %.1f ops/sec%s\n",
-                       C_INFO, eval_result.performance.execution_time_ms, 
-                       eval_result.performance.memory_usage_kb, eval_result.performance.throughput, C_RESET);
+            if (eval_result.performance.ns_per_call > 0) {
+                log_message(conv->config, VERBOSITY_VERBOSE, "%sPerformance: %.1fns per call, %.0f calls/sec%s\n",
+                           C_INFO, eval_result.performance.ns_per_call, eval_result.performance.throughput, C_RESET);
+            } else {
+                log_message(conv->config, VERBOSITY_VERBOSE, 
+                           "%sPerformance: %.2fms execution, %ldKB memory, %.1f ops/sec%s\n",
+                           C_INFO, eval_result.performance.execution_time_ms, 
+                           eval_result.performance.memory_usage_kb, eval_result.performance.throughput, C_RESET);
+            }
             
             log_message(conv->config, VERBOSITY_VERBOSE, 
                        "%sCode Quality: %d complexity, %.1f%% coverage, %.1f maintainability%s\n",
@@ -703,11 +850,18 @@ int write_evolution_file(const char *file_path, const char *content) {
 
 // Run custom test command on a file
 test_result_t run_custom_test(const char *test_command, const char *file_path, config_t *config) {
+    process_limits_t limits = candidate_process_limits(config);
+    return run_custom_test_limited(test_command, file_path, config, &limits);
+}
+
+// Run custom test command on a file under the given limits
+test_result_t run_custom_test_limited(const char *test_command, const char *file_path, config_t *config,
+                                      const process_limits_t *limits) {
     test_result_t result = {0};
     
-    // Allocate memory for result strings
-    result.error_message = malloc(config->max_response_size);
-    result.output = malloc(config->max_response_size);
+    // Allocate zeroed memory for result strings
+    result.error_message = calloc(1, config->max_response_size);
+    result.output = calloc(1, config->max_response_size);
     
     if (!result.error_message || !result.output) {
         if (result.error_message) free(result.error_message);
@@ -717,10 +871,6 @@ test_result_t run_custom_test(const char *test_command, const char *file_path, c
         return result;
     }
     
-    // Initialize strings
-    memset(result.error_message, 0, config->max_response_size);
-    memset(result.output, 0, config->max_response_size);
-    
     if (!test_command || !file_path || strlen(test_command) == 0) {
         snprintf(result.error_message, config->max_response_size, 
                 "Invalid test command or file path");
@@ -753,32 +903,30 @@ test_result_t run_custom_test(const char *test_command, const char *file_path, c
         snprintf(expanded_command, sizeof(expanded_command), "%s %s", test_command, file_path);
     }
     
-    // Execute the test command and capture output
-    FILE *pipe = popen(expanded_command, "r");
-    if (!pipe) {
+    // Execute the test command under the limits and capture output
+    process_result_t run;
+    trace_span_t span = trace_begin("custom_test", TRACE_NO_AGENT);
+    int actual_exit_code = execute_command(expanded_command, result.output, config->max_response_size,
+                                           limits, &run);
+    trace_end(&span);
+    result.run_status = run.status;
+    
+    char limit_message[256];
+    describe_limit_violation(&run, config, limit_message, sizeof(limit_message));
+    if (strlen(limit_message) > 0) {
+        result.syntax_ok = 1;
+        result.compilation_ok = 1;
+        result.execution_ok = 0;
+        snprintf(result.error_message, config->max_response_size, "%s\nOutput:\n%s",
+                limit_message, result.output);
+        return result;
+    }
+    if (run.status == PROCESS_SPAWN_FAILED) {
         snprintf(result.error_message, config->max_response_size, 
                 "Failed to execute test command: %s", expanded_command);
         return result;
     }
     
-    // Read command output
-    size_t total_read = 0;
-    char buffer[1024];
-    while (fgets(buffer, sizeof(buffer), pipe) && total_read < (size_t)config->max_response_size - 1) {
-        size_t len = strlen(buffer);
-        if (total_read + len < (size_t)config->max_response_size - 1) {
-            strcpy(result.output + total_read, buffer);
-            total_read += len;
-        } else {
-            break;
-        }
-    }
-    result.output[total_read] = '\0';
-    
-    // Get exit code
-    int exit_code = pclose(pipe);
-    int actual_exit_code = WEXITSTATUS(exit_code);
-    
     // Determine test results based on exit code
     if (actual_exit_code == 0) {
         result.syntax_ok = 1;
@@ -796,13 +944,18 @@ test_result_t run_custom_test(const char *test_command, const char *file_path, c
             result.execution_ok = 0;
             snprintf(result.error_message, config->max_response_size, 
                     "Compilation failed: %s", result.output);
-        } else if (strstr(output_lower, "segmentation fault") || strstr(output_lower, "abort") ||
+        } else if (run.signal > 0 || strstr(output_lower, "segmentation fault") || strstr(output_lower, "abort") ||
                    strstr(output_lower, "core dumped")) {
             result.syntax_ok = 1;
             result.compilation_ok = 1;
             result.execution_ok = 0;
-            snprintf(result.error_message, config->max_response_size, 
-                    "Runtime error: %s", result.output);
+            if (run.signal > 0) {
+                snprintf(result.error_message, config->max_response_size, 
+                        "Runtime error (signal %d, %s): %s", run.signal, strsignal(run.signal), result.output);
+            } else {
+                snprintf(result.error_message, config->max_response_size, 
+                        "Runtime error: %s", result.output);
+            }
         } else {
             // Assume compilation succeeded but test failed
             result.syntax_ok = 1;
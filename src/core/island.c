@@ -0,0 +1,169 @@
+#include "island.h"
+#include <dirent.h>
+
+#define ISLAND_SUFFIX ".archive"
+
+// A parent candidate while local survivors and migrants are merged
+typedef struct {
+    char *code;
+    char *errors;
+    double fitness;
+    double screen_score;                         // Cascade score (a migrant's archived fitness)
+    uint64_t archive_id;                         // Local record (0 for a migrant not yet recorded)
+    archive_record_t meta;                       // Migrant's record in its home archive
+    int migrant;
+} island_entry_t;
+
+// Whether code is already among the first count entries
+static int has_code(const island_entry_t *entries, int count, const char *code) {
+    for (int i = 0; i < count; i++) {
+        if (entries[i].code && strcmp(entries[i].code, code) == 0) return 1;
+    }
+    return 0;
+}
+
+// Insert into entries sorted by fitness, earlier entries winning ties; drops the worst beyond capacity
+static void insert_entry(island_entry_t *entries, int *count, int capacity, const island_entry_t *entry) {
+    int pos = *count;
+    if (pos == capacity) {
+        if (capacity == 0 || entries[capacity - 1].fitness >= entry->fitness) {
+            free(entry->code);
+            free(entry->errors);
+            return;
+        }
+        free(entries[capacity - 1].code);
+        free(entries[capacity - 1].errors);
+        pos = capacity - 1;
+    } else {
+        (*count)++;
+    }
+
+    while (pos > 0 && entries[pos - 1].fitness < entry->fitness) {
+        entries[pos] = entries[pos - 1];
+        pos--;
+    }
+    entries[pos] = *entry;
+}
+
+// Collect the best survivors of every peer archive in island_dir
+static int collect_migrants(config_t *config, const char *problem, const island_entry_t *locals,
+                            int local_count, island_entry_t *migrants, int capacity, int *islands) {
+    DIR *dir = opendir(config->island_dir);
+    if (!dir) {
+        log_message(config, VERBOSITY_NORMAL, "%sWarning: Cannot open island directory %s%s\n",
+                    C_WARNING, config->island_dir, C_RESET);
+        return 0;
+    }
+
+    int count = 0;
+    int *indices = malloc(capacity * sizeof(int));
+    struct dirent *entry;
+    while (indices && (entry = readdir(dir))) {
+        size_t length = strlen(entry->d_name);
+        size_t suffix = strlen(ISLAND_SUFFIX);
+        if (length <= suffix || strcmp(entry->d_name + length - suffix, ISLAND_SUFFIX) != 0) continue;
+
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/%s", config->island_dir, entry->d_name);
+        if (strcmp(path, config->archive_file) == 0) continue; // Our own island
+
+        archive_t *peer = archive_open_peer(path, problem);
+        if (!peer) continue;
+        (*islands)++;
+
+        int found = archive_latest_survivors(peer, indices, capacity);
+        for (int i = 0; i < found; i++) {
+            const archive_record_t *record = archive_get(peer, indices[i]);
+            const char *code = archive_code(record);
+            if (has_code(locals, local_count, code) || has_code(migrants, count, code)) continue;
+
+            island_entry_t migrant = {0};
+            migrant.code = strdup(code);
+            migrant.errors = record->error_length > 0 ? strdup(archive_errors(record)) : NULL;
+            migrant.fitness = record->fitness;
+            migrant.screen_score = record->fitness;
+            migrant.meta = *record;
+            migrant.migrant = 1;
+            if (!migrant.code) {
+                free(migrant.errors);
+                continue;
+            }
+            insert_entry(migrants, &count, capacity, &migrant);
+        }
+        archive_close(peer);
+    }
+
+    free(indices);
+    closedir(dir);
+    return count;
+}
+
+// Merge the elites of peer islands into the survivors
+int island_migrate(population_t *population, const char *problem, int iteration) {
+    if (!population || !population->archive) return 0;
+    config_t *config = population->config;
+    if (strlen(config->island_dir) == 0 || config->island_migrants <= 0) return 0;
+
+    int capacity = config->population_survivors;
+    island_entry_t *merged = calloc(capacity + config->island_migrants, sizeof(island_entry_t));
+    island_entry_t *migrants = calloc(config->island_migrants, sizeof(island_entry_t));
+    if (!merged || !migrants) {
+        free(merged);
+        free(migrants);
+        return 0;
+    }
+
+    // Local survivors are already in fitness order
+    int local_count = population->survivor_count;
+    for (int i = 0; i < local_count; i++) {
+        population_survivor_t *survivor = &population->survivors[i];
+        merged[i].code = survivor->code;
+        merged[i].errors = survivor->errors;
+        merged[i].fitness = survivor->fitness_score;
+        merged[i].screen_score = survivor->screen_score;
+        merged[i].archive_id = survivor->archive_id;
+        survivor->code = NULL;
+        survivor->errors = NULL;
+    }
+
+    int islands = 0;
+    int migrant_count = collect_migrants(config, problem, merged, local_count, migrants,
+                                         config->island_migrants, &islands);
+
+    // Parents are drawn from the merged elite set; locals win ties
+    int count = local_count;
+    for (int i = 0; i < migrant_count; i++) {
+        insert_entry(merged, &count, capacity, &migrants[i]);
+    }
+
+    int adopted = 0;
+    for (int i = 0; i < count; i++) {
+        island_entry_t *entry = &merged[i];
+        if (entry->migrant) {
+            archive_record_t meta = entry->meta;
+            meta.parent_id = 0; // Its lineage lives in the home island's archive
+            meta.iteration = iteration;
+            meta.generation = population->generation;
+            meta.flags = (entry->meta.flags & (ARCHIVE_SYNTAX_OK | ARCHIVE_COMPILED | ARCHIVE_EXECUTED |
+                                               ARCHIVE_EVALUATED | ARCHIVE_PASSED)) |
+                         ARCHIVE_SURVIVOR | ARCHIVE_MIGRANT;
+            entry->archive_id = archive_append(population->archive, &meta, entry->code, entry->errors);
+            adopted++;
+        }
+
+        population_survivor_t *survivor = &population->survivors[i];
+        survivor->code = entry->code;
+        survivor->errors = entry->errors;
+        survivor->fitness_score = entry->fitness;
+        survivor->screen_score = entry->screen_score;
+        survivor->archive_id = entry->archive_id;
+    }
+    population->survivor_count = count;
+
+    log_message(config, VERBOSITY_NORMAL, "%s🏝️  Migration: adopted %d of %d elites from %d peer islands%s\n",
+               C_INFO, adopted, migrant_count, islands, C_RESET);
+
+    free(migrants);
+    free(merged);
+    return adopted;
+}
@@ -0,0 +1,231 @@
+#include "metrics.h"
+#include "workspace.h"
+#include <ctype.h>
+
+// Add or replace a metric
+static void set_metric(metric_set_t *set, const char *name, size_t name_length, double value) {
+    if (name_length == 0 || name_length >= sizeof(set->values[0].name)) return;
+
+    for (int i = 0; i < set->count; i++) {
+        if (strlen(set->values[i].name) == name_length && strncmp(set->values[i].name, name, name_length) == 0) {
+            set->values[i].value = value;
+            return;
+        }
+    }
+    if (set->count == MAX_MEASURED_METRICS) return;
+
+    memcpy(set->values[set->count].name, name, name_length);
+    set->values[set->count].name[name_length] = '\0';
+    set->values[set->count].value = value;
+    set->count++;
+}
+
+// Parse "name=value name=value ..." up to the end of the line
+static void parse_metric_line(const char *line, metric_set_t *set) {
+    const char *p = line;
+    while (*p && *p != '\n') {
+        while (*p == ' ' || *p == '\t') p++;
+        const char *name = p;
+        while (*p && *p != '=' && *p != '\n' && !isspace((unsigned char)*p)) p++;
+        if (*p != '=') {
+            while (*p && *p != '\n' && !isspace((unsigned char)*p)) p++;
+            continue;
+        }
+        size_t name_length = p - name;
+        char *end;
+        double value = strtod(p + 1, &end);
+        if (end != p + 1) set_metric(set, name, name_length, value);
+        p = end;
+        while (*p && *p != '\n' && !isspace((unsigned char)*p)) p++;
+    }
+}
+
+// Take the numeric members of a JSON object
+static void add_json_numbers(const cJSON *object, metric_set_t *set) {
+    const cJSON *item;
+    cJSON_ArrayForEach(item, object) {
+        if (cJSON_IsNumber(item) && item->string) {
+            set_metric(set, item->string, strlen(item->string), cJSON_GetNumberValue(item));
+        }
+    }
+}
+
+// Parse METRIC lines and JSON objects out of command output
+int metrics_parse(const char *output, metric_set_t *set) {
+    if (!set) return 0;
+    if (!output) return set->count;
+
+    const char *line = output;
+    while (*line) {
+        const char *start = line;
+        while (*start == ' ' || *start == '\t') start++;
+
+        if (strncmp(start, "METRIC ", 7) == 0 || strncmp(start, "METRIC\t", 7) == 0) {
+            parse_metric_line(start + 7, set);
+        } else if (*start == '{') {
+            // The object may span several lines; cJSON stops at its end
+            cJSON *json = cJSON_Parse(start);
+            if (json && cJSON_IsObject(json)) {
+                add_json_numbers(json, set);
+                const cJSON *nested = cJSON_GetObjectItem(json, "metrics");
+                if (cJSON_IsObject(nested)) add_json_numbers(nested, set);
+            }
+            cJSON_Delete(json);
+        }
+
+        const char *next = strchr(line, '\n');
+        if (!next) break;
+        line = next + 1;
+    }
+    return set->count;
+}
+
+// Value of a metric, NULL if it was not reported
+const metric_value_t* metrics_find(const metric_set_t *set, const char *name) {
+    if (!set || !name) return NULL;
+    for (int i = 0; i < set->count; i++) {
+        if (strcmp(set->values[i].name, name) == 0) return &set->values[i];
+    }
+    return NULL;
+}
+
+// Combine the reported metrics into set->fitness and set->gates_passed
+double metrics_score(const test_result_t *result, metric_set_t *set, const config_t *config) {
+    int gates_passed = result && result->execution_ok;
+    double weighted = 0.0;
+    double total_weight = 0.0;
+
+    for (int i = 0; i < config->metric_count; i++) {
+        const fitness_metric_t *metric = &config->metrics[i];
+        const metric_value_t *reported = metrics_find(set, metric->name);
+        total_weight += metric->weight;
+
+        if (!reported) {
+            // A metric that is not reported cannot satisfy its gate and scores nothing
+            if (metric->has_min || metric->has_max) gates_passed = 0;
+            continue;
+        }
+
+        double value = reported->value;
+        if ((metric->has_min && value < metric->min) || (metric->has_max && value > metric->max)) {
+            gates_passed = 0;
+        }
+
+        // Bounded, monotonic score: scale itself scores 0.5
+        double magnitude = value > 0.0 ? value : 0.0;
+        double score = metric->minimize ? metric->scale / (metric->scale + magnitude)
+                                        : magnitude / (metric->scale + magnitude);
+        weighted += metric->weight * score;
+    }
+
+    double performance = total_weight > 0.0 ? weighted / total_weight : 0.0;
+    if (gates_passed && set->benchmark_failed) {
+        // Correct but unmeasured code ranks first among the failures
+        gates_passed = 0;
+        set->fitness = 0.5;
+    } else if (gates_passed) {
+        set->fitness = 0.5 + 0.5 * performance;
+    } else {
+        double test_fitness = 0.0;
+        if (result && result->syntax_ok) test_fitness += 0.3;
+        if (result && result->compilation_ok) test_fitness += 0.3;
+        if (result && result->execution_ok) test_fitness += 0.4;
+        set->fitness = 0.5 * test_fitness;
+    }
+    set->gates_passed = gates_passed;
+    return set->fitness;
+}
+
+// Collect metrics for tested code, from benchmark_command or the test output
+int metrics_measure(const char *code, const test_result_t *result, config_t *config, metric_set_t *set) {
+    if (!set) return 0;
+    memset(set, 0, sizeof(metric_set_t));
+    if (!config || config->metric_count == 0 || !result) return 0;
+
+    test_result_t benchmark = {0};
+    const test_result_t *source = result;
+    if (strlen(config->benchmark_command) > 0 && result->execution_ok && code) {
+        const char *file_name = "test.c";
+        if (config->enable_evolution && strlen(config->evolution_file_path) > 0) {
+            const char *base_name = strrchr(config->evolution_file_path, '/');
+            file_name = base_name ? base_name + 1 : config->evolution_file_path;
+        }
+
+        workspace_t workspace;
+        char file_path[1024];
+        if (workspace_create(&workspace, "benchmark") == 0 &&
+            workspace_write_file(&workspace, file_name, code, file_path, sizeof(file_path)) == 0) {
+            benchmark = run_custom_test(config->benchmark_command, file_path, config);
+            source = &benchmark;
+            if (!benchmark.execution_ok) {
+                log_message(config, VERBOSITY_VERBOSE, "%sBenchmark command failed: %.200s%s\n", C_WARNING,
+                           benchmark.error_message ? benchmark.error_message : "", C_RESET);
+            }
+        }
+        workspace_destroy(&workspace);
+    }
+
+    metrics_parse(source->output, set);
+    if (source == &benchmark) {
+        metrics_parse(benchmark.error_message, set); // A failing benchmark reports its output here
+        set->benchmark_failed = !benchmark.execution_ok;
+    }
+    metrics_score(result, set, config);
+    set->measured = 1;
+    cleanup_test_result(&benchmark);
+
+    log_message(config, VERBOSITY_VERBOSE, "%sMetric fitness %.3f (%d metrics reported, gates %s)%s\n",
+               C_INFO, set->fitness, set->count, set->gates_passed ? "passed" : "failed", C_RESET);
+    return 1;
+}
+
+// Add the built-in metrics of a benchmark (time_ms, ns_per_call and the allocation profile)
+void metrics_add_performance(metric_set_t *set, const performance_metrics_t *performance) {
+    if (!set || !performance || performance->sample_count == 0) return;
+
+    set_metric(set, "time_ms", 7, performance->execution_time_ms);
+    if (performance->ns_per_call > 0) {
+        set_metric(set, "ns_per_call", 11, performance->ns_per_call);
+    }
+    if (performance->allocations_available) {
+        set_metric(set, "alloc_calls", 11, (double)(performance->malloc_calls + performance->calloc_calls +
+                                                    performance->realloc_calls));
+        set_metric(set, "free_calls", 10, (double)performance->free_calls);
+        set_metric(set, "alloc_bytes", 11, (double)performance->allocated_bytes);
+        set_metric(set, "peak_heap_bytes", 15, (double)performance->peak_heap_bytes);
+    }
+}
+
+// Describe measured metrics for an agent prompt
+char* generate_metrics_report(const metric_set_t *set, const config_t *config) {
+    if (!set || !set->measured || !config || config->metric_count == 0) return NULL;
+
+    dstring_t *report = dstring_create(512);
+    if (!report) return NULL;
+
+    dstring_append_format(report, "MEASURED METRICS (fitness %.3f of 1.0%s):\n", set->fitness,
+                          set->gates_passed ? "" : ", correctness gates FAILED");
+    for (int i = 0; i < config->metric_count; i++) {
+        const fitness_metric_t *metric = &config->metrics[i];
+        const metric_value_t *reported = metrics_find(set, metric->name);
+
+        char gate[96] = "";
+        if (metric->has_min && metric->has_max) {
+            snprintf(gate, sizeof(gate), ", must be within [%g, %g]", metric->min, metric->max);
+        } else if (metric->has_min) {
+            snprintf(gate, sizeof(gate), ", must be >= %g", metric->min);
+        } else if (metric->has_max) {
+            snprintf(gate, sizeof(gate), ", must be <= %g", metric->max);
+        }
+
+        if (reported) {
+            dstring_append_format(report, "- %s = %g (%s%s)\n", metric->name, reported->value,
+                                  metric->minimize ? "lower is better" : "higher is better", gate);
+        } else {
+            dstring_append_format(report, "- %s: not reported (%s%s)\n", metric->name,
+                                  metric->minimize ? "lower is better" : "higher is better", gate);
+        }
+    }
+
+    return dstring_steal(report);
+}
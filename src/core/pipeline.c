@@ -0,0 +1,226 @@
+#include "pipeline.h"
+#include "cache.h"
+#include <pthread.h>
+
+struct speculative_call {
+    config_t *config;
+    char *prompt;
+    char *response;                              // Raw response, valid once done
+    int done;
+    int abandoned;                               // Set by the main thread when the prompt no longer matches
+    pthread_mutex_t mutex;
+    pthread_cond_t finished;
+};
+
+// Free a speculative call
+static void free_speculative_call(speculative_call_t *call) {
+    pthread_mutex_destroy(&call->mutex);
+    pthread_cond_destroy(&call->finished);
+    free(call->prompt);
+    free(call->response);
+    free(call);
+}
+
+// Speculative fast turn running on the model pool
+static void speculative_call_task(void *arg) {
+    speculative_call_t *call = (speculative_call_t *)arg;
+    char *response = call_ai_model(call->prompt, AGENT_FAST, call->config);
+
+    pthread_mutex_lock(&call->mutex);
+    call->response = response;
+    call->done = 1;
+    int abandoned = call->abandoned;
+    pthread_cond_signal(&call->finished);
+    pthread_mutex_unlock(&call->mutex);
+
+    if (abandoned) {
+        free_speculative_call(call);
+    }
+}
+
+// Background test whose only effect is filling the evaluation cache
+static void prewarm_test_task(void *arg) {
+    pipeline_t *pipeline = (pipeline_t *)arg;
+    test_result_t result = test_solution_code(pipeline->prewarm_code, "Prewarm", pipeline->config, NULL);
+    cleanup_test_result(&result);
+
+    pthread_mutex_lock(&pipeline->prewarm_mutex);
+    pipeline->prewarm_done = 1;
+    pthread_mutex_unlock(&pipeline->prewarm_mutex);
+}
+
+// Initialize pipeline workers
+int init_pipeline(pipeline_t *pipeline, config_t *config) {
+    if (!pipeline || !config) return -1;
+
+    memset(pipeline, 0, sizeof(pipeline_t));
+    pipeline->config = config;
+    pthread_mutex_init(&pipeline->prewarm_mutex, NULL);
+    pipeline->model_pool = threadpool_create(2);
+    pipeline->test_pool = threadpool_create(1);
+
+    if (!pipeline->model_pool || !pipeline->test_pool) {
+        fprintf(stderr, "Error: Failed to start pipeline workers\n");
+        cleanup_pipeline(pipeline);
+        return -1;
+    }
+
+    return 0;
+}
+
+// Drop the in-flight speculation without waiting; its worker frees it when the call returns
+static void discard_speculation(pipeline_t *pipeline) {
+    speculative_call_t *call = pipeline->speculation;
+    if (!call) return;
+    pipeline->speculation = NULL;
+
+    pthread_mutex_lock(&call->mutex);
+    int done = call->done;
+    call->abandoned = 1;
+    pthread_mutex_unlock(&call->mutex);
+
+    if (done) {
+        free_speculative_call(call);
+    }
+}
+
+// Wait for any background test and forget its code
+static void finish_prewarm(pipeline_t *pipeline) {
+    if (!pipeline->prewarm_pending) return;
+
+    threadpool_wait(pipeline->test_pool);
+    free(pipeline->prewarm_code);
+    pipeline->prewarm_code = NULL;
+    pipeline->prewarm_pending = 0;
+    pipeline->prewarm_done = 0;
+}
+
+// Wait for background work and free pipeline state
+void cleanup_pipeline(pipeline_t *pipeline) {
+    if (!pipeline || !pipeline->config) return;
+
+    discard_speculation(pipeline);
+    finish_prewarm(pipeline);
+
+    if (pipeline->speculations > 0 || pipeline->prewarm_hits > 0) {
+        log_message(pipeline->config, VERBOSITY_VERBOSE,
+                   "%s⚡ Pipeline: %d/%d speculative fast turns used, %d tests prewarmed%s\n",
+                   C_INFO, pipeline->speculation_hits, pipeline->speculations, pipeline->prewarm_hits, C_RESET);
+    }
+
+    threadpool_destroy(pipeline->model_pool);
+    threadpool_destroy(pipeline->test_pool);
+    pthread_mutex_destroy(&pipeline->prewarm_mutex);
+    memset(pipeline, 0, sizeof(pipeline_t));
+}
+
+// Start testing the fast agent's code while the reasoning agent runs
+void pipeline_prewarm_test(pipeline_t *pipeline, const conversation_t *conv, const char *fast_response) {
+    if (!pipeline || !conv || !fast_response || !pipeline->config->enable_eval_cache) return;
+
+    // Only one background test at a time; a still-running older one is left alone
+    if (pipeline->prewarm_pending) {
+        pthread_mutex_lock(&pipeline->prewarm_mutex);
+        int done = pipeline->prewarm_done;
+        pthread_mutex_unlock(&pipeline->prewarm_mutex);
+        if (!done) return;
+        finish_prewarm(pipeline);
+    }
+
+    char *code = extract_candidate_code(fast_response, conv->current_solution, pipeline->config);
+    if (!code) return;
+
+    pipeline->prewarm_code = code;
+    pipeline->prewarm_key = eval_cache_key(code, "", NULL, NULL);
+    pipeline->prewarm_pending = 1;
+    if (threadpool_submit(pipeline->test_pool, prewarm_test_task, pipeline) != 0) {
+        free(pipeline->prewarm_code);
+        pipeline->prewarm_code = NULL;
+        pipeline->prewarm_pending = 0;
+    }
+}
+
+// Before testing the reasoning agent's code: wait for a background test of the same code
+void pipeline_before_test(pipeline_t *pipeline, const conversation_t *conv, const char *reasoning_response) {
+    if (!pipeline || !conv || !pipeline->prewarm_pending) return;
+
+    char *code = extract_candidate_code(reasoning_response, conv->current_solution, pipeline->config);
+    if (!code) return;
+
+    // Different code would be tested twice in parallel for nothing; let the background test finish alone
+    if (eval_cache_key(code, "", NULL, NULL) == pipeline->prewarm_key) {
+        finish_prewarm(pipeline);
+        pipeline->prewarm_hits++;
+        log_message(pipeline->config, VERBOSITY_DEBUG, "Pipeline: reasoning agent kept the prewarmed code\n");
+    }
+    free(code);
+}
+
+// Issue the next fast turn for the state the reasoning response would produce if its test passes
+void pipeline_speculate_fast_turn(pipeline_t *pipeline, const conversation_t *conv, const char *reasoning_response) {
+    if (!pipeline || !conv || !reasoning_response) return;
+
+    discard_speculation(pipeline);
+
+    // Predicted state: the solution update_solution_with_testing() will store, with no errors
+    conversation_t predicted = *conv;
+    predicted.iterations = conv->iterations + 1;
+    memset(&predicted.last_test_result, 0, sizeof(test_result_t));
+
+    char *code = extract_candidate_code(reasoning_response, conv->current_solution, pipeline->config);
+    if (code) {
+        predicted.current_solution = code;
+    }
+
+    char *prompt = generate_agent_prompt(&predicted, AGENT_FAST);
+    free(code);
+    if (!prompt) return;
+
+    speculative_call_t *call = calloc(1, sizeof(speculative_call_t));
+    if (!call) {
+        free(prompt);
+        return;
+    }
+    call->config = pipeline->config;
+    call->prompt = prompt;
+    pthread_mutex_init(&call->mutex, NULL);
+    pthread_cond_init(&call->finished, NULL);
+
+    if (threadpool_submit(pipeline->model_pool, speculative_call_task, call) != 0) {
+        free_speculative_call(call);
+        return;
+    }
+    pipeline->speculation = call;
+
+    pipeline->speculations++;
+    log_message(pipeline->config, VERBOSITY_DEBUG, "Pipeline: next fast turn issued speculatively\n");
+}
+
+// Take the speculative fast response if it was requested with exactly this prompt
+char* pipeline_take_fast_response(pipeline_t *pipeline, const char *prompt) {
+    if (!pipeline || !prompt || !pipeline->speculation) return NULL;
+
+    speculative_call_t *call = pipeline->speculation;
+    if (strcmp(call->prompt, prompt) != 0) {
+        // The test failed or evolution changed the state: the serial call must be made
+        log_message(pipeline->config, VERBOSITY_VERBOSE, "%s⚡ Speculative fast turn discarded (state changed)%s\n",
+                   C_INFO, C_RESET);
+        discard_speculation(pipeline);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&call->mutex);
+    while (!call->done) {
+        pthread_cond_wait(&call->finished, &call->mutex);
+    }
+    char *response = call->response;
+    call->response = NULL;
+    pthread_mutex_unlock(&call->mutex);
+    discard_speculation(pipeline);
+
+    if (response) {
+        pipeline->speculation_hits++;
+        log_message(pipeline->config, VERBOSITY_VERBOSE, "%s⚡ Using speculative fast turn%s\n", C_INFO, C_RESET);
+    }
+    return response;
+}
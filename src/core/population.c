@@ -0,0 +1,570 @@
+#include "population.h"
+#include "benchmark.h"
+#include "cache.h"
+#include "metrics.h"
+#include "scaling.h"
+#include "trace.h"
+#include "workspace.h"
+
+// Work item shared by the model and evaluation stages of one candidate
+typedef struct population_job {
+    population_t *population;
+    const conversation_t *conv;
+    int index;
+    struct population_job *jobs;                 // Every job of the generation, indexed like the candidates
+} population_job_t;
+
+// Duplicate a string that may be NULL
+static char* copy_or_null(const char *str) {
+    return str ? strdup(str) : NULL;
+}
+
+// Free the data owned by a candidate
+static void clear_candidate(population_candidate_t *candidate) {
+    free(candidate->fast_response);
+    free(candidate->reasoning_response);
+    free(candidate->code);
+    cleanup_test_result(&candidate->test_result);
+    memset(candidate, 0, sizeof(population_candidate_t));
+}
+
+// Free the data owned by a survivor
+static void clear_survivor(population_survivor_t *survivor) {
+    free(survivor->code);
+    free(survivor->errors);
+    memset(survivor, 0, sizeof(population_survivor_t));
+}
+
+// Initialize population state, seeding the first parent from the conversation
+int init_population(population_t *population, const conversation_t *conv, config_t *config) {
+    if (!population || !conv || !config) return -1;
+
+    memset(population, 0, sizeof(population_t));
+    population->config = config;
+    population->candidate_count = config->population_size;
+    pthread_mutex_init(&population->cascade_mutex, NULL);
+
+    population->candidates = calloc(config->population_size, sizeof(population_candidate_t));
+    population->survivors = calloc(config->population_survivors, sizeof(population_survivor_t));
+    population->model_pool = threadpool_create(config->population_size);
+    population->evaluation_pool = threadpool_create(config->evaluation_workers);
+
+    if (!population->candidates || !population->survivors ||
+        !population->model_pool || !population->evaluation_pool) {
+        fprintf(stderr, "Error: Failed to allocate population\n");
+        cleanup_population(population);
+        return -1;
+    }
+
+    // The starting solution (possibly empty) is the only parent of generation 1
+    population->survivors[0].code = strdup(conv->current_solution ? conv->current_solution : "");
+    population->survivors[0].errors = copy_or_null(conv->last_test_result.error_message);
+    population->survivor_count = 1;
+
+    return 0;
+}
+
+// Free population state and stop its workers
+void cleanup_population(population_t *population) {
+    if (!population) return;
+
+    threadpool_destroy(population->model_pool);
+    threadpool_destroy(population->evaluation_pool);
+
+    if (population->candidates) {
+        for (int i = 0; i < population->candidate_count; i++) {
+            clear_candidate(&population->candidates[i]);
+        }
+        free(population->candidates);
+    }
+
+    if (population->survivors) {
+        for (int i = 0; i < population->survivor_count; i++) {
+            clear_survivor(&population->survivors[i]);
+        }
+        free(population->survivors);
+    }
+
+    free(population->seen_hashes);
+    if (population->config) pthread_mutex_destroy(&population->cascade_mutex);
+    memset(population, 0, sizeof(population_t));
+}
+
+// Prompt, call and clean one agent turn on a candidate conversation
+static char* run_candidate_turn(conversation_t *candidate_conv, agent_type_t agent) {
+    trace_span_t span = trace_begin("prompt", agent);
+    char *prompt = generate_agent_prompt(candidate_conv, agent);
+    trace_end(&span);
+    if (!prompt) return NULL;
+
+    char *response = call_ai_model(prompt, agent, candidate_conv->config);
+    log_ai_interaction(candidate_conv->config, agent, prompt, response);
+    free(prompt);
+
+    if (!response) return NULL;
+
+    span = trace_begin("validate", agent);
+    char *cleaned_response = validate_and_clean_response(response);
+    trace_end(&span);
+    free(response);
+    return cleaned_response;
+}
+
+// Record code as evaluated; returns 0 if its token hash was already seen (caller holds cascade_mutex)
+static int remember_code(population_t *population, const char *code) {
+    uint64_t hash = source_token_hash(code);
+    for (int i = 0; i < population->seen_count; i++) {
+        if (population->seen_hashes[i] == hash) return 0;
+    }
+    if (population->seen_count == population->seen_capacity) {
+        int capacity = population->seen_capacity > 0 ? population->seen_capacity * 2 : 64;
+        uint64_t *hashes = realloc(population->seen_hashes, capacity * sizeof(uint64_t));
+        if (!hashes) return 1; // Evaluate it rather than drop it
+        population->seen_hashes = hashes;
+        population->seen_capacity = capacity;
+    }
+    population->seen_hashes[population->seen_count++] = hash;
+    return 1;
+}
+
+// Whether a screened candidate is close enough to the best so far to be benchmarked
+static int cascade_admits_benchmark(population_t *population, double screen_score) {
+    pthread_mutex_lock(&population->cascade_mutex);
+    if (screen_score > population->cascade_best) population->cascade_best = screen_score;
+    int admitted = screen_score >= population->cascade_best - population->config->cascade_threshold;
+    pthread_mutex_unlock(&population->cascade_mutex);
+    return admitted;
+}
+
+// Count the stage a candidate stopped at
+static void cascade_count(population_t *population, cascade_stage_t stage) {
+    pthread_mutex_lock(&population->cascade_mutex);
+    population->cascade_counts[stage]++;
+    pthread_mutex_unlock(&population->cascade_mutex);
+}
+
+// Evaluation stage: test the candidate's code and compute its fitness
+static void evaluate_candidate_task(void *arg) {
+    population_job_t *job = (population_job_t *)arg;
+    population_t *population = job->population;
+    config_t *config = population->config;
+    population_candidate_t *candidate = &population->candidates[job->index];
+
+    candidate->code = extract_candidate_code(candidate->reasoning_response, job->conv->current_solution, config);
+    if (!candidate->code) {
+        candidate->fitness_score = 0.0;
+        return;
+    }
+
+    // Cheapest stages first: near-duplicates are dropped, then syntax and smoke test
+    int cascade = config->enable_eval_cascade;
+    if (cascade) {
+        pthread_mutex_lock(&population->cascade_mutex);
+        int is_new = remember_code(population, candidate->code);
+        pthread_mutex_unlock(&population->cascade_mutex);
+        if (!is_new) {
+            candidate->cascade_stage = CASCADE_DUPLICATE;
+            candidate->fitness_score = 0.0;
+            cascade_count(population, CASCADE_DUPLICATE);
+            log_message(config, VERBOSITY_VERBOSE, "%sCandidate %d: near-duplicate of evaluated code, skipped%s\n",
+                       C_INFO, job->index + 1, C_RESET);
+            return;
+        }
+        candidate->cascade_stage = cascade_screen(candidate->code, config, &candidate->test_result);
+        if (candidate->cascade_stage != CASCADE_TESTS) {
+            log_message(config, VERBOSITY_VERBOSE, "%sCandidate %d: failed the %s stage%s\n", C_WARNING,
+                       job->index + 1, cascade_stage_name(candidate->cascade_stage), C_RESET);
+        }
+    }
+    if (!cascade || candidate->cascade_stage == CASCADE_TESTS) {
+        candidate->test_result = test_solution_code(candidate->code, job->conv->problem_description, config, NULL);
+    }
+
+    double fitness = 0.0;
+    if (candidate->test_result.syntax_ok) fitness += 0.3;
+    if (candidate->test_result.compilation_ok) fitness += 0.3;
+    if (candidate->test_result.execution_ok) fitness += 0.4;
+    // A candidate killed by a limit ranks below one that merely failed its run
+    if (test_result_hit_limit(&candidate->test_result)) {
+        fitness -= 0.2;
+        log_message(config, VERBOSITY_VERBOSE, "%sCandidate %d: killed (%s)%s\n", C_WARNING, job->index + 1,
+                   process_status_name(candidate->test_result.run_status), C_RESET);
+    }
+    candidate->test_fitness = fitness;
+
+    // Reported metrics, when configured, are what the candidate is ranked on
+    if (metrics_measure(candidate->code, &candidate->test_result, config, &candidate->metrics)) {
+        candidate->has_metrics = 1;
+    }
+    candidate->screen_score = candidate->has_metrics ? candidate->metrics.fitness : fitness;
+
+    // Rank working candidates by the comprehensive score when it is enabled
+    int benchmark = config->enable_comprehensive_evaluation && candidate->test_result.execution_ok;
+    if (benchmark && cascade && !cascade_admits_benchmark(population, candidate->screen_score)) {
+        benchmark = 0;
+        log_message(config, VERBOSITY_VERBOSE, "%sCandidate %d: screened %.3f, too far below the best to benchmark%s\n",
+                   C_INFO, job->index + 1, candidate->screen_score, C_RESET);
+    }
+    if (benchmark) {
+        const char *file_name = "candidate.c";
+        if (config->enable_evolution && strlen(config->evolution_file_path) > 0) {
+            const char *base_name = strrchr(config->evolution_file_path, '/');
+            file_name = base_name ? base_name + 1 : config->evolution_file_path;
+        }
+
+        workspace_t workspace;
+        char file_path[1024];
+        if (workspace_create(&workspace, "candidate") == 0 &&
+            workspace_write_file(&workspace, file_name, candidate->code, file_path, sizeof(file_path)) == 0) {
+            evaluation_result_t eval_result = evaluate_code_comprehensive(
+                file_path, candidate->code, &config->eval_criteria, config);
+            fitness = eval_result.overall_score / 100.0;
+            if (eval_result.performance.sample_count > 0) {
+                candidate->has_performance = 1;
+                candidate->performance = eval_result.performance;
+                candidate->non_performance_score = eval_result.correctness_score + eval_result.quality_score;
+                candidate->scaling_rejected = scaling_exceeds_limit(&eval_result.performance.scaling,
+                                                                    &config->eval_criteria);
+            }
+            cleanup_evaluation_result(&eval_result);
+        }
+        workspace_destroy(&workspace);
+        if (cascade) candidate->cascade_stage = CASCADE_BENCHMARK;
+    }
+
+    if (candidate->has_metrics) {
+        if (candidate->has_performance) {
+            metrics_add_performance(&candidate->metrics, &candidate->performance);
+            metrics_score(&candidate->test_result, &candidate->metrics, config);
+        }
+        fitness = candidate->metrics.fitness;
+    }
+
+    candidate->fitness_score = fitness;
+    if (cascade) cascade_count(population, candidate->cascade_stage);
+}
+
+// Whether candidate a ranks above candidate b
+static int candidate_is_better(const population_candidate_t *a, const population_candidate_t *b) {
+    if (a->test_fitness != b->test_fitness) return a->test_fitness > b->test_fitness;
+    // A candidate that scales worse than allowed never wins on its single-size timing
+    if (a->scaling_rejected != b->scaling_rejected) return b->scaling_rejected;
+    // The cascade only lets the better candidates through to later stages
+    if (a->cascade_stage != b->cascade_stage) return a->cascade_stage > b->cascade_stage;
+    if (a->has_metrics && b->has_metrics) return a->fitness_score > b->fitness_score;
+
+    // Only a statistically significant timing difference decides on speed
+    if (a->has_performance && b->has_performance) {
+        int timing = benchmark_compare(&a->performance, &b->performance);
+        if (timing != 0) return timing < 0;
+        return a->non_performance_score > b->non_performance_score;
+    }
+
+    return a->fitness_score > b->fitness_score;
+}
+
+// Private view of the conversation: shared read-only context, own solution and history
+static int open_candidate_conv(conversation_t *candidate_conv, const conversation_t *conv,
+                               const population_survivor_t *parent) {
+    config_t *config = conv->config;
+    *candidate_conv = *conv;
+    candidate_conv->scratch = NULL; // The iteration arena belongs to the main thread
+    candidate_conv->current_solution = malloc(config->max_code_size);
+    candidate_conv->messages = calloc(conv->max_messages, sizeof(message_t));
+    if (!candidate_conv->current_solution || !candidate_conv->messages) {
+        free(candidate_conv->current_solution);
+        free(candidate_conv->messages);
+        return -1;
+    }
+
+    snprintf(candidate_conv->current_solution, config->max_code_size, "%s", parent->code ? parent->code : "");
+    candidate_conv->last_test_result.error_message = parent->errors;
+    for (int i = 0; i < conv->message_count; i++) {
+        candidate_conv->messages[i].sender = conv->messages[i].sender;
+        candidate_conv->messages[i].content = copy_or_null(conv->messages[i].content);
+        candidate_conv->messages[i].timestamp = conv->messages[i].timestamp;
+    }
+    return 0;
+}
+
+// Free what open_candidate_conv allocated
+static void close_candidate_conv(conversation_t *candidate_conv) {
+    for (int i = 0; i < candidate_conv->message_count; i++) {
+        free(candidate_conv->messages[i].content);
+    }
+    free(candidate_conv->messages);
+    free(candidate_conv->current_solution);
+}
+
+// Model stage: run the fast -> reasoning exchange for one candidate, then queue its evaluation.
+// A fast response already sampled for the candidate's parent is used as is.
+static void breed_candidate_task(void *arg) {
+    population_job_t *job = (population_job_t *)arg;
+    population_t *population = job->population;
+    config_t *config = population->config;
+    population_candidate_t *candidate = &population->candidates[job->index];
+
+    conversation_t candidate_conv;
+    if (open_candidate_conv(&candidate_conv, job->conv, &population->survivors[candidate->parent_index]) != 0) {
+        return;
+    }
+
+    if (!candidate->fast_response) {
+        candidate->fast_response = run_candidate_turn(&candidate_conv, AGENT_FAST);
+    }
+    if (candidate->fast_response) {
+        add_message(&candidate_conv, AGENT_FAST, candidate->fast_response);
+        candidate->reasoning_response = run_candidate_turn(&candidate_conv, AGENT_REASONING);
+    }
+
+    close_candidate_conv(&candidate_conv);
+
+    if (!candidate->reasoning_response) {
+        log_message(config, VERBOSITY_NORMAL, "%sCandidate %d: agents failed to respond%s\n",
+                   C_WARNING, job->index + 1, C_RESET);
+        return;
+    }
+
+    // Start testing right away instead of waiting for the slowest model call
+    if (threadpool_submit(population->evaluation_pool, evaluate_candidate_task, job) != 0) {
+        evaluate_candidate_task(job);
+    }
+}
+
+// Model stage for all candidates of one parent: their fast prompts are identical,
+// so one request samples every fast response, then each candidate continues alone
+static void breed_parent_task(void *arg) {
+    population_job_t *job = (population_job_t *)arg;
+    population_t *population = job->population;
+    config_t *config = population->config;
+    int parent_index = job->index;
+    int stride = population->survivor_count;
+    int siblings = (population->candidate_count - parent_index + stride - 1) / stride;
+
+    conversation_t candidate_conv;
+    char **samples = calloc(siblings, sizeof(char *));
+    if (samples && open_candidate_conv(&candidate_conv, job->conv, &population->survivors[parent_index]) == 0) {
+        trace_span_t span = trace_begin("prompt", AGENT_FAST);
+        char *prompt = generate_agent_prompt(&candidate_conv, AGENT_FAST);
+        trace_end(&span);
+        if (prompt) {
+            int received = call_ai_model_n(prompt, AGENT_FAST, config, siblings, samples);
+            log_ai_interaction(config, AGENT_FAST, prompt, received > 0 ? samples[0] : NULL);
+            free(prompt);
+
+            log_message(config, VERBOSITY_VERBOSE, "%sParent %d: %d of %d fast samples in one request%s\n",
+                       C_INFO, parent_index + 1, received, siblings, C_RESET);
+            for (int k = 0; k < received; k++) {
+                span = trace_begin("validate", AGENT_FAST);
+                population->candidates[parent_index + k * stride].fast_response =
+                    validate_and_clean_response(samples[k]);
+                trace_end(&span);
+                free(samples[k]);
+            }
+        }
+        close_candidate_conv(&candidate_conv);
+    }
+    free(samples);
+
+    // Candidates without a sample make their own fast request
+    for (int k = 1; k < siblings; k++) {
+        population_job_t *sibling = &job->jobs[parent_index + k * stride];
+        if (threadpool_submit(population->model_pool, breed_candidate_task, sibling) != 0) {
+            breed_candidate_task(sibling);
+        }
+    }
+    breed_candidate_task(job);
+}
+
+// Append a ranked candidate to the archive; returns its record id
+static uint64_t archive_candidate(population_t *population, const population_candidate_t *candidate,
+                                  const conversation_t *conv, int selected, int survivor) {
+    archive_record_t meta = {0};
+    archive_record_test(&meta, &candidate->test_result);
+    meta.parent_id = candidate->parent_id;
+    meta.iteration = conv->iterations;
+    meta.generation = population->generation;
+    meta.fitness = candidate->fitness_score;
+    if (selected) meta.flags |= ARCHIVE_SELECTED;
+    if (survivor) meta.flags |= ARCHIVE_SURVIVOR;
+    if (candidate->has_performance) {
+        meta.execution_time_ms = candidate->performance.execution_time_ms;
+        meta.p95_time_ms = candidate->performance.p95_time_ms;
+        meta.stddev_time_ms = candidate->performance.stddev_time_ms;
+        meta.throughput = candidate->performance.throughput;
+        meta.memory_usage_kb = candidate->performance.memory_usage_kb;
+    }
+    return archive_append(population->archive, &meta, candidate->code, candidate->test_result.error_message);
+}
+
+// Restore the survivors of the last archived generation
+int restore_population(population_t *population, archive_t *archive) {
+    if (!population || !archive) return 0;
+
+    // Migrants may have been archived next to the generation's own survivors; keep the best
+    int *indices = malloc(population->config->population_survivors * sizeof(int));
+    if (!indices) return 0;
+    int restored = archive_latest_survivors(archive, indices, population->config->population_survivors);
+
+    if (restored > 0) {
+        for (int i = 0; i < population->survivor_count; i++) {
+            clear_survivor(&population->survivors[i]);
+        }
+        for (int i = 0; i < restored; i++) {
+            const archive_record_t *record = archive_get(archive, indices[i]);
+            population_survivor_t *survivor = &population->survivors[i];
+            survivor->code = strdup(archive_code(record));
+            survivor->errors = record->error_length > 0 ? strdup(archive_errors(record)) : NULL;
+            survivor->fitness_score = record->fitness;
+            survivor->screen_score = record->fitness; // The archive keeps no separate screening score
+            survivor->archive_id = record->id;
+            population->generation = record->generation;
+        }
+        population->survivor_count = restored;
+    }
+    free(indices);
+    return restored;
+}
+
+// Breed, evaluate and select one generation
+int run_population_generation(population_t *population, conversation_t *conv) {
+    if (!population || !conv || !conv->config) return -1;
+
+    config_t *config = population->config;
+    population->generation++;
+
+    log_message(config, VERBOSITY_NORMAL, "%s🧬 Generation %d: breeding %d candidates from %d parents...%s\n",
+               C_INFO, population->generation, population->candidate_count, population->survivor_count, C_RESET);
+
+    population_job_t *jobs = calloc(population->candidate_count, sizeof(population_job_t));
+    if (!jobs) return -1;
+
+    // Parents count as evaluated code and set the score the cascade compares against
+    if (config->enable_eval_cascade) {
+        memset(population->cascade_counts, 0, sizeof(population->cascade_counts));
+        population->cascade_best = 0.0;
+        for (int i = 0; i < population->survivor_count; i++) {
+            if (population->survivors[i].code && strlen(population->survivors[i].code) > 0) {
+                remember_code(population, population->survivors[i].code);
+            }
+            if (population->survivors[i].screen_score > population->cascade_best) {
+                population->cascade_best = population->survivors[i].screen_score;
+            }
+        }
+    }
+
+    for (int i = 0; i < population->candidate_count; i++) {
+        clear_candidate(&population->candidates[i]);
+        population->candidates[i].parent_index = i % population->survivor_count;
+        population->candidates[i].parent_id = population->survivors[i % population->survivor_count].archive_id;
+
+        jobs[i].population = population;
+        jobs[i].conv = conv;
+        jobs[i].index = i;
+        jobs[i].jobs = jobs;
+    }
+
+    // With shared samples the first candidate of each parent breeds its siblings
+    int shared = config->population_shared_samples && population->candidate_count > population->survivor_count;
+    int tasks = shared ? population->survivor_count : population->candidate_count;
+    for (int i = 0; i < tasks; i++) {
+        threadpool_task_fn task = shared ? breed_parent_task : breed_candidate_task;
+        if (threadpool_submit(population->model_pool, task, &jobs[i]) != 0) {
+            task(&jobs[i]);
+        }
+    }
+
+    // Model tasks queue their own evaluations, so drain the model pool first
+    threadpool_wait(population->model_pool);
+    threadpool_wait(population->evaluation_pool);
+    free(jobs);
+
+    // Rank candidates; earlier candidates win ties
+    int *order = malloc(population->candidate_count * sizeof(int));
+    if (!order) return -1;
+
+    int ranked = 0;
+    for (int i = 0; i < population->candidate_count; i++) {
+        if (!population->candidates[i].code || population->candidates[i].cascade_stage == CASCADE_DUPLICATE) continue;
+
+        int pos = ranked++;
+        while (pos > 0 && candidate_is_better(&population->candidates[i], &population->candidates[order[pos - 1]])) {
+            order[pos] = order[pos - 1];
+            pos--;
+        }
+        order[pos] = i;
+
+        log_message(config, VERBOSITY_VERBOSE, "%sCandidate %d (parent %d): fitness %.2f%s\n",
+                   C_INFO, i + 1, population->candidates[i].parent_index + 1,
+                   population->candidates[i].fitness_score, C_RESET);
+    }
+
+    if (config->enable_eval_cascade) {
+        const int *counts = population->cascade_counts;
+        log_message(config, VERBOSITY_VERBOSE,
+                   "%sCascade: %d duplicate, %d failed syntax, %d failed smoke, %d stopped after tests, %d benchmarked%s\n",
+                   C_INFO, counts[CASCADE_DUPLICATE], counts[CASCADE_SYNTAX], counts[CASCADE_SMOKE],
+                   counts[CASCADE_TESTS], counts[CASCADE_BENCHMARK], C_RESET);
+    }
+
+    if (ranked == 0 && population->cascade_counts[CASCADE_DUPLICATE] > 0) {
+        // Nothing new was bred; the parents and the current solution stay
+        log_message(config, VERBOSITY_NORMAL, "%s⚠️  Every candidate duplicated evaluated code, keeping the parents%s\n\n",
+                   C_WARNING, C_RESET);
+        free(order);
+        return 0;
+    }
+    if (ranked == 0) {
+        log_message(config, VERBOSITY_NORMAL, "%sError: No candidate produced a code solution%s\n", C_ERROR, C_RESET);
+        free(order);
+        return -1;
+    }
+
+    // Top-k become the parents of the next generation
+    int survivor_count = ranked < config->population_survivors ? ranked : config->population_survivors;
+    for (int i = 0; i < population->survivor_count; i++) {
+        clear_survivor(&population->survivors[i]);
+    }
+    for (int i = 0; i < survivor_count; i++) {
+        population_candidate_t *candidate = &population->candidates[order[i]];
+        population->survivors[i].code = strdup(candidate->code);
+        population->survivors[i].errors = copy_or_null(candidate->test_result.error_message);
+        population->survivors[i].fitness_score = candidate->fitness_score;
+        population->survivors[i].screen_score = candidate->screen_score;
+    }
+    population->survivor_count = survivor_count;
+
+    // Archive the generation in rank order, so a resume can pick the survivors back up
+    for (int i = 0; population->archive && i < ranked; i++) {
+        uint64_t id = archive_candidate(population, &population->candidates[order[i]], conv,
+                                        i == 0, i < survivor_count);
+        if (i < survivor_count) population->survivors[i].archive_id = id;
+    }
+
+    // The best candidate becomes the conversation's solution
+    population_candidate_t *best = &population->candidates[order[0]];
+    log_message(config, VERBOSITY_NORMAL, "%s🏆 Best candidate %d of %d (fitness %.2f), keeping top %d%s\n\n",
+               C_SUCCESS, order[0] + 1, population->candidate_count, best->fitness_score, survivor_count, C_RESET);
+
+    add_message(conv, AGENT_FAST, best->fast_response);
+    add_message(conv, AGENT_REASONING, best->reasoning_response);
+    snprintf(conv->current_solution, config->max_code_size, "%s", best->code);
+    if (config->enable_evolution && strlen(config->evolution_file_path) > 0) {
+        write_evolution_file(config->evolution_file_path, conv->current_solution);
+    }
+    if (best->has_performance) {
+        conv->last_performance = best->performance;
+    } else {
+        memset(&conv->last_performance, 0, sizeof(performance_metrics_t));
+    }
+    if (best->has_metrics) {
+        conv->last_metrics = best->metrics;
+    } else {
+        memset(&conv->last_metrics, 0, sizeof(metric_set_t));
+    }
+    apply_test_result(conv, best->test_result);
+    memset(&best->test_result, 0, sizeof(test_result_t)); // Ownership moved to conv
+
+    free(order);
+    return 0;
+}
@@ -0,0 +1,694 @@
+#include "region_prompt.h"
+#include <ctype.h>
+#include <stdint.h>
+
+#define MAX_ITEM_NAMES 16
+#define MAX_RELEVANCE_ROUNDS 8
+
+// Priority when the budget is tight: includes first, then types and macros, then signatures and globals
+typedef enum {
+    TIER_INCLUDE = 0,
+    TIER_TYPE,
+    TIER_SIGNATURE,
+    TIER_COUNT
+} context_tier_t;
+
+// One top-level declaration from outside the regions
+typedef struct {
+    char *text;                                  // As sent to the model (function bodies removed)
+    context_tier_t tier;
+    uint64_t names[MAX_ITEM_NAMES];              // Hashes of the identifiers it declares
+    int name_count;
+    int relevant;                                // Used by the regions, directly or transitively
+    int included;                                // Fits in the budget
+} context_item_t;
+
+typedef struct {
+    context_item_t *items;
+    int count;
+    int capacity;
+} context_items_t;
+
+// Open-addressing set of identifier hashes
+typedef struct {
+    uint64_t *slots;
+    size_t capacity;
+    size_t count;
+} identifier_set_t;
+
+// Keywords that can sit where a declared name is expected
+static const char *c_keywords[] = {
+    "auto", "break", "case", "char", "const", "continue", "default", "do", "double", "else", "enum",
+    "extern", "float", "for", "goto", "if", "inline", "int", "long", "register", "restrict", "return",
+    "short", "signed", "sizeof", "static", "struct", "switch", "typedef", "union", "unsigned", "void",
+    "volatile", "while", "_Bool", NULL
+};
+
+// Rough token estimate for a piece of text (about four bytes per token)
+int estimate_tokens(const char *text) {
+    if (!text) return 0;
+    return (int)((strlen(text) + 3) / 4);
+}
+
+static int is_ident_start(char c) {
+    return isalpha((unsigned char)c) || c == '_';
+}
+
+static int is_ident_char(char c) {
+    return isalnum((unsigned char)c) || c == '_';
+}
+
+// FNV-1a hash of an identifier (0 is reserved for empty slots)
+static uint64_t hash_identifier(const char *name, size_t length) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)name[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash ? hash : 1;
+}
+
+static int is_keyword(const char *name, size_t length) {
+    for (int i = 0; c_keywords[i]; i++) {
+        if (strlen(c_keywords[i]) == length && strncmp(c_keywords[i], name, length) == 0) return 1;
+    }
+    return 0;
+}
+
+static int set_contains(const identifier_set_t *set, uint64_t hash) {
+    if (set->capacity == 0) return 0;
+    for (size_t i = hash & (set->capacity - 1); set->slots[i]; i = (i + 1) & (set->capacity - 1)) {
+        if (set->slots[i] == hash) return 1;
+    }
+    return 0;
+}
+
+// Add a hash, growing the table at half load
+static void set_add(identifier_set_t *set, uint64_t hash) {
+    if (set_contains(set, hash)) return;
+
+    if ((set->count + 1) * 2 > set->capacity) {
+        size_t capacity = set->capacity ? set->capacity * 2 : 256;
+        uint64_t *slots = calloc(capacity, sizeof(uint64_t));
+        if (!slots) return;
+        for (size_t i = 0; i < set->capacity; i++) {
+            if (!set->slots[i]) continue;
+            size_t j = set->slots[i] & (capacity - 1);
+            while (slots[j]) j = (j + 1) & (capacity - 1);
+            slots[j] = set->slots[i];
+        }
+        free(set->slots);
+        set->slots = slots;
+        set->capacity = capacity;
+    }
+
+    size_t i = hash & (set->capacity - 1);
+    while (set->slots[i]) i = (i + 1) & (set->capacity - 1);
+    set->slots[i] = hash;
+    set->count++;
+}
+
+// Add every identifier in text to the set
+static void collect_identifiers(const char *text, identifier_set_t *set) {
+    const char *p = text;
+    while (*p) {
+        if (is_ident_start(*p)) {
+            const char *start = p;
+            while (is_ident_char(*p)) p++;
+            set_add(set, hash_identifier(start, p - start));
+        } else if (isdigit((unsigned char)*p)) {
+            while (is_ident_char(*p)) p++; // Skip numeric literals such as 0x1f
+        } else {
+            p++;
+        }
+    }
+}
+
+// Index just past a string or character literal starting at i
+static size_t skip_literal(const char *s, size_t n, size_t i) {
+    char quote = s[i++];
+    while (i < n && s[i] != quote && s[i] != '\n') {
+        if (s[i] == '\\' && i + 1 < n) i++;
+        i++;
+    }
+    return i < n ? i + 1 : n;
+}
+
+// Blank out comments in place, keeping newlines and string literals
+static void strip_comments(char *s) {
+    size_t n = strlen(s);
+    size_t i = 0;
+    while (i < n) {
+        if (s[i] == '"' || s[i] == '\'') {
+            i = skip_literal(s, n, i);
+        } else if (s[i] == '/' && s[i + 1] == '/') {
+            while (i < n && s[i] != '\n') s[i++] = ' ';
+        } else if (s[i] == '/' && s[i + 1] == '*') {
+            s[i++] = ' ';
+            s[i++] = ' ';
+            while (i < n && !(s[i] == '*' && s[i + 1] == '/')) {
+                if (s[i] != '\n') s[i] = ' ';
+                i++;
+            }
+            if (i < n) {
+                s[i++] = ' ';
+                s[i++] = ' ';
+            }
+        } else {
+            i++;
+        }
+    }
+}
+
+// The code outside the evolution regions, markers included in neither
+static char* build_skeleton(const char *code) {
+    dstring_t *skeleton = dstring_create(strlen(code) + 1);
+    if (!skeleton) return NULL;
+
+    int in_region = 0;
+    const char *line = code;
+    while (*line) {
+        const char *end = strchr(line, '\n');
+        size_t length = end ? (size_t)(end - line) + 1 : strlen(line);
+
+        // Markers are searched within the line only
+        if (memmem(line, length, EVOLUTION_MARKER_START, strlen(EVOLUTION_MARKER_START))) {
+            in_region = 1;
+        } else if (memmem(line, length, EVOLUTION_MARKER_END, strlen(EVOLUTION_MARKER_END))) {
+            in_region = 0;
+        } else if (!in_region) {
+            dstring_append_len(skeleton, line, length);
+        }
+        line += length;
+    }
+
+    char *result = dstring_steal(skeleton);
+    return result;
+}
+
+// Copy of text[0..length) without surrounding whitespace, with an optional suffix
+static char* trimmed_copy(const char *text, size_t length, const char *suffix) {
+    while (length > 0 && isspace((unsigned char)*text)) {
+        text++;
+        length--;
+    }
+    while (length > 0 && isspace((unsigned char)text[length - 1])) length--;
+
+    size_t suffix_length = suffix ? strlen(suffix) : 0;
+    char *copy = malloc(length + suffix_length + 1);
+    if (!copy) return NULL;
+    memcpy(copy, text, length);
+    if (suffix_length) memcpy(copy + length, suffix, suffix_length);
+    copy[length + suffix_length] = '\0';
+    return copy;
+}
+
+static void add_name(context_item_t *item, const char *name, size_t length) {
+    if (item->name_count < MAX_ITEM_NAMES && !is_keyword(name, length)) {
+        item->names[item->name_count++] = hash_identifier(name, length);
+    }
+}
+
+// Position of the first '=' outside parentheses and braces, or -1
+static long find_initializer(const char *text, size_t length) {
+    int depth = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (text[i] == '"' || text[i] == '\'') {
+            i = skip_literal(text, length, i) - 1;
+        } else if (text[i] == '(' || text[i] == '{' || text[i] == '[') {
+            depth++;
+        } else if (text[i] == ')' || text[i] == '}' || text[i] == ']') {
+            depth--;
+        } else if (text[i] == '=' && depth == 0) {
+            return (long)i;
+        }
+    }
+    return -1;
+}
+
+// Record the names a declaration introduces: declarators, function and (*pointer) names,
+// struct/union/enum tags and enumerators
+static void find_declared_names(context_item_t *item, const char *text, size_t length) {
+    int parens = 0;
+    int braces = 0;
+    int in_enum = 0;
+    int tag_next = 0;
+    char previous = '\0';                        // Last non-space character before the identifier
+
+    for (size_t i = 0; i < length;) {
+        char c = text[i];
+        if (c == '"' || c == '\'') {
+            i = skip_literal(text, length, i);
+            previous = c;
+            continue;
+        }
+        if (!is_ident_start(c)) {
+            if (c == '(') parens++;
+            else if (c == ')') parens--;
+            else if (c == '{') braces++;
+            else if (c == '}') braces--;
+            if (isdigit((unsigned char)c)) {
+                while (i < length && is_ident_char(text[i])) i++;
+                previous = '0';
+                continue;
+            }
+            if (!isspace((unsigned char)c)) previous = c;
+            i++;
+            continue;
+        }
+
+        size_t start = i;
+        while (i < length && is_ident_char(text[i])) i++;
+        size_t name_length = i - start;
+
+        size_t next_pos = i;
+        while (next_pos < length && isspace((unsigned char)text[next_pos])) next_pos++;
+        char next = next_pos < length ? text[next_pos] : ';';
+
+        if (braces == 0) {
+            if (tag_next) {
+                add_name(item, text + start, name_length);
+                tag_next = 0;
+            } else if (name_length == 4 && strncmp(text + start, "enum", 4) == 0) {
+                in_enum = 1;
+                tag_next = 1;
+            } else if ((name_length == 6 && strncmp(text + start, "struct", 6) == 0) ||
+                       (name_length == 5 && strncmp(text + start, "union", 5) == 0)) {
+                tag_next = 1;
+            } else if (parens == 0 && (next == ',' || next == ';' || next == '=' || next == '[' || next == '(')) {
+                add_name(item, text + start, name_length);
+            } else if (parens == 1 && previous == '*' && next == ')') {
+                add_name(item, text + start, name_length); // Function pointer
+            }
+        } else if (braces == 1 && in_enum && (previous == '{' || previous == ',')) {
+            add_name(item, text + start, name_length); // Enumerator
+        }
+        // A tag must follow its keyword immediately; `struct {` has none
+        if (next == '{') tag_next = 0;
+        previous = 'a';
+    }
+}
+
+// Whether the text before a top-level '{' is a function definition header
+static int is_function_header(const char *header, size_t length) {
+    while (length > 0 && isspace((unsigned char)header[length - 1])) length--;
+    return length > 0 && header[length - 1] == ')' && find_initializer(header, length) < 0;
+}
+
+static context_item_t* new_item(context_items_t *items) {
+    if (items->count >= items->capacity) {
+        int capacity = items->capacity ? items->capacity * 2 : 64;
+        context_item_t *grown = realloc(items->items, capacity * sizeof(context_item_t));
+        if (!grown) return NULL;
+        items->items = grown;
+        items->capacity = capacity;
+    }
+    context_item_t *item = &items->items[items->count++];
+    memset(item, 0, sizeof(context_item_t));
+    return item;
+}
+
+// Record a preprocessor line: includes are always relevant, macros by name, the rest is dropped
+static void add_directive(context_items_t *items, const char *text, size_t length) {
+    const char *p = text + 1;
+    while (p < text + length && (*p == ' ' || *p == '\t')) p++;
+
+    int is_include = strncmp(p, "include", 7) == 0;
+    int is_define = strncmp(p, "define", 6) == 0;
+    if (!is_include && !is_define) return;
+
+    context_item_t *item = new_item(items);
+    if (!item) return;
+    item->text = trimmed_copy(text, length, NULL);
+    if (is_include) {
+        item->tier = TIER_INCLUDE;
+        return;
+    }
+
+    item->tier = TIER_TYPE;
+    p += 6;
+    while (p < text + length && (*p == ' ' || *p == '\t')) p++;
+    const char *name = p;
+    while (p < text + length && is_ident_char(*p)) p++;
+    add_name(item, name, p - name);
+}
+
+// Record a top-level declaration; brace is the offset of its first '{' or -1
+static void add_declaration(context_items_t *items, const char *text, size_t length, long brace) {
+    context_item_t *item = new_item(items);
+    if (!item) return;
+
+    long initializer = find_initializer(text, brace >= 0 ? (size_t)brace : length);
+    if (brace >= 0 && is_function_header(text, brace)) {
+        // Function definition: its signature is enough
+        item->text = trimmed_copy(text, brace, ";");
+        item->tier = TIER_SIGNATURE;
+        find_declared_names(item, text, brace);
+    } else if (brace >= 0 && initializer >= 0) {
+        // Initialized table: the declaration without its data
+        item->text = trimmed_copy(text, initializer, ";");
+        item->tier = TIER_SIGNATURE;
+        find_declared_names(item, text, initializer);
+    } else {
+        item->text = trimmed_copy(text, length, NULL);
+        int is_type = strncmp(item->text ? item->text : "", "typedef", 7) == 0 || brace >= 0;
+        item->tier = is_type ? TIER_TYPE : TIER_SIGNATURE;
+        find_declared_names(item, text, length);
+    }
+}
+
+// Split comment-free skeleton code into top-level declarations
+static void parse_declarations(const char *s, context_items_t *items) {
+    size_t n = strlen(s);
+    size_t i = 0;
+
+    while (i < n) {
+        while (i < n && isspace((unsigned char)s[i])) i++;
+        if (i >= n) break;
+
+        size_t start = i;
+        if (s[i] == '#') {
+            while (i < n && !(s[i] == '\n' && s[i - 1] != '\\')) i++;
+            add_directive(items, s + start, i - start);
+            continue;
+        }
+
+        int depth = 0;
+        long brace = -1;
+        while (i < n) {
+            char c = s[i];
+            if (c == '"' || c == '\'') {
+                i = skip_literal(s, n, i);
+                continue;
+            }
+            i++;
+            if (c == '{') {
+                if (depth == 0 && brace < 0) brace = (long)(i - 1 - start);
+                depth++;
+            } else if (c == '}' && depth > 0) {
+                depth--;
+                // A function body ends the declaration; a struct body still needs its ';'
+                if (depth == 0 && brace >= 0 && is_function_header(s + start, brace)) break;
+            } else if (c == ';' && depth == 0) {
+                break;
+            }
+        }
+        add_declaration(items, s + start, i - start, brace);
+    }
+}
+
+// The evolution regions of code as marker-wrapped text, in file order
+char* format_evolution_regions(const code_evolution_t *regions) {
+    if (!regions) return NULL;
+
+    dstring_t *text = dstring_create(4096);
+    if (!text) return NULL;
+
+    for (int i = 0; i < regions->region_count; i++) {
+        const char *content = regions->regions[i].content ? regions->regions[i].content : "";
+        dstring_append_format(text, "%s: %s\n", EVOLUTION_MARKER_START, regions->regions[i].description);
+        dstring_append(text, content);
+        if (strlen(content) > 0 && content[strlen(content) - 1] != '\n') {
+            dstring_append(text, "\n");
+        }
+        dstring_append_format(text, "%s\n\n", EVOLUTION_MARKER_END);
+    }
+
+    char *result = dstring_steal(text);
+    return result;
+}
+
+// Declarations outside the regions of code that the region bodies depend on
+char* extract_region_context(const char *code, const char *region_text, int token_budget,
+                             region_context_stats_t *stats) {
+    region_context_stats_t local_stats;
+    if (!stats) stats = &local_stats;
+    memset(stats, 0, sizeof(region_context_stats_t));
+    if (!code || !region_text) return NULL;
+
+    char *skeleton = build_skeleton(code);
+    if (!skeleton) return NULL;
+    stats->skeleton_tokens = estimate_tokens(skeleton);
+    strip_comments(skeleton);
+
+    context_items_t items = {0};
+    parse_declarations(skeleton, &items);
+    free(skeleton);
+    stats->declarations = items.count;
+
+    // Everything the regions mention, then everything the kept declarations mention
+    identifier_set_t used = {0};
+    collect_identifiers(region_text, &used);
+    int changed = 1;
+    for (int round = 0; changed && round < MAX_RELEVANCE_ROUNDS; round++) {
+        changed = 0;
+        for (int i = 0; i < items.count; i++) {
+            context_item_t *item = &items.items[i];
+            if (item->relevant || !item->text) continue;
+
+            if (item->tier == TIER_INCLUDE) {
+                item->relevant = 1;
+                continue;
+            }
+            for (int j = 0; j < item->name_count; j++) {
+                if (set_contains(&used, item->names[j])) {
+                    item->relevant = 1;
+                    collect_identifiers(item->text, &used);
+                    changed = 1;
+                    break;
+                }
+            }
+        }
+    }
+    free(used.slots);
+
+    // Fill the budget tier by tier; regions themselves are always sent
+    int used_tokens = estimate_tokens(region_text);
+    for (int tier = 0; tier < TIER_COUNT; tier++) {
+        for (int i = 0; i < items.count; i++) {
+            context_item_t *item = &items.items[i];
+            if (!item->relevant || (int)item->tier != tier) continue;
+
+            int tokens = estimate_tokens(item->text) + 1;
+            if (token_budget <= 0 || used_tokens + tokens <= token_budget) {
+                item->included = 1;
+                used_tokens += tokens;
+                stats->included++;
+            } else {
+                stats->over_budget++;
+            }
+        }
+    }
+
+    // Emit in file order so types still precede their uses
+    dstring_t *context = dstring_create(4096);
+    for (int i = 0; i < items.count; i++) {
+        if (context && items.items[i].included) {
+            dstring_append(context, items.items[i].text);
+            dstring_append(context, "\n");
+        }
+        free(items.items[i].text);
+    }
+    free(items.items);
+
+    if (!context) return NULL;
+    char *result = dstring_steal(context);
+    return result;
+}
+
+// Add #include lines from outside the response's regions that the file lacks
+static char* add_missing_includes(char *merged, const char *response_code) {
+    dstring_t *additions = dstring_create(256);
+    if (!additions) return merged;
+
+    int in_region = 0;
+    const char *line = response_code;
+    while (*line) {
+        const char *end = strchr(line, '\n');
+        size_t length = end ? (size_t)(end - line) : strlen(line);
+        char text[512];
+        size_t copy = length < sizeof(text) - 1 ? length : sizeof(text) - 1;
+        memcpy(text, line, copy);
+        text[copy] = '\0';
+
+        if (strstr(text, EVOLUTION_MARKER_START)) {
+            in_region = 1;
+        } else if (strstr(text, EVOLUTION_MARKER_END)) {
+            in_region = 0;
+        } else if (!in_region) {
+            char *include = trimmed_copy(text, copy, NULL);
+            if (include && strncmp(include, "#include", 8) == 0 && !strstr(merged, include)) {
+                dstring_append_format(additions, "%s\n", include);
+            }
+            free(include);
+        }
+        line += end ? length + 1 : length;
+    }
+
+    if (additions->length == 0) {
+        dstring_destroy(additions);
+        return merged;
+    }
+
+    // Insert after the file's last #include line
+    size_t insert_at = 0;
+    for (const char *p = merged; (p = strstr(p, "#include")) != NULL; p++) {
+        if (p == merged || p[-1] == '\n') {
+            const char *line_end = strchr(p, '\n');
+            insert_at = line_end ? (size_t)(line_end - merged) + 1 : strlen(merged);
+        }
+    }
+
+    dstring_t *result = dstring_create(strlen(merged) + additions->length + 2);
+    if (!result) {
+        dstring_destroy(additions);
+        return merged;
+    }
+    dstring_append_len(result, merged, insert_at);
+    if (insert_at > 0 && merged[insert_at - 1] != '\n') dstring_append(result, "\n");
+    dstring_append(result, dstring_get(additions));
+    dstring_append(result, merged + insert_at);
+
+    char *with_includes = dstring_steal(result);
+    dstring_destroy(additions);
+    if (!with_includes) return merged;
+    free(merged);
+    return with_includes;
+}
+
+// Whether every region of merged that was not patched kept its content, and the code outside the regions is unchanged
+static int patch_preserves_rest(const char *current_solution, const code_evolution_t *original,
+                                const int *patched, const char *merged) {
+    char *skeleton_before = build_skeleton(current_solution);
+    char *skeleton_after = build_skeleton(merged);
+    int same = skeleton_before && skeleton_after && strcmp(skeleton_before, skeleton_after) == 0;
+    free(skeleton_before);
+    free(skeleton_after);
+
+    code_evolution_t result;
+    init_code_evolution(&result);
+    parse_evolution_regions(&result, merged);
+    if (result.region_count != original->region_count) same = 0;
+
+    for (int i = 0; same && i < original->region_count; i++) {
+        const char *before = original->regions[i].content ? original->regions[i].content : "";
+        const char *after = result.regions[i].content ? result.regions[i].content : "";
+        if (!patched[i] && strcmp(before, after) != 0) same = 0;
+    }
+
+    cleanup_code_evolution(&result);
+    return same;
+}
+
+// Replace the regions of current_solution named in patches; include_source supplies extra #include lines.
+// Returns the number of regions whose content changed, -1 if no patch names a region of the file,
+// -2 if the result does not keep the rest of the file byte-identical.
+static int apply_patches(const char *current_solution, const code_evolution_t *patches,
+                         const char *include_source, char **merged) {
+    *merged = NULL;
+
+    code_evolution_t current, original;
+    init_code_evolution(&current);
+    init_code_evolution(&original);
+    parse_evolution_regions(&current, current_solution);
+    parse_evolution_regions(&original, current_solution);
+
+    // Only regions the file already has are replaced; unknown descriptions are ignored
+    int patched[MAX_EVOLUTION_REGIONS] = {0};
+    int matched = 0;
+    int changed = 0;
+    for (int i = 0; i < patches->region_count; i++) {
+        for (int j = 0; j < current.region_count; j++) {
+            if (strcmp(patches->regions[i].description, current.regions[j].description) != 0) continue;
+
+            const char *content = patches->regions[i].content ? patches->regions[i].content : "";
+            const char *before = current.regions[j].content ? current.regions[j].content : "";
+            matched++;
+            if (strcmp(content, before) != 0) {
+                update_evolution_region(&current, current.regions[j].description, content);
+                patched[j] = 1;
+                changed++;
+            }
+            break;
+        }
+    }
+
+    int status = matched > 0 ? changed : -1;
+    if (status >= 0) {
+        *merged = assemble_evolved_code(&current, current_solution);
+        if (!*merged) {
+            status = -1;
+        } else if (!patch_preserves_rest(current_solution, &original, patched, *merged)) {
+            free(*merged);
+            *merged = NULL;
+            status = -2;
+        } else if (include_source) {
+            *merged = add_missing_includes(*merged, include_source);
+        }
+    }
+
+    cleanup_code_evolution(&current);
+    cleanup_code_evolution(&original);
+    return status;
+}
+
+// Apply a region-only response to the current file
+char* merge_region_response(const char *current_solution, const char *response_code) {
+    if (!current_solution || !response_code) return NULL;
+
+    code_evolution_t response;
+    init_code_evolution(&response);
+    parse_evolution_regions(&response, response_code);
+
+    char *merged = NULL;
+    apply_patches(current_solution, &response, response_code, &merged);
+    cleanup_code_evolution(&response);
+    return merged;
+}
+
+// Collect the regions of every fenced code block in a response
+static void collect_region_patches(const char *response, code_evolution_t *patches) {
+    const char *fence = strstr(response, "```");
+    while (fence) {
+        const char *body = strchr(fence, '\n');
+        if (!body) break;
+        body++;
+        const char *close = strstr(body, "```");
+        if (!close) break;
+
+        char *block = malloc(close - body + 1);
+        if (!block) break;
+        memcpy(block, body, close - body);
+        block[close - body] = '\0';
+
+        code_evolution_t block_regions;
+        init_code_evolution(&block_regions);
+        parse_evolution_regions(&block_regions, block);
+        for (int i = 0; i < block_regions.region_count; i++) {
+            update_evolution_region(patches, block_regions.regions[i].description,
+                                    block_regions.regions[i].content ? block_regions.regions[i].content : "");
+        }
+        cleanup_code_evolution(&block_regions);
+        free(block);
+
+        fence = strstr(close + 3, "```");
+    }
+}
+
+// Apply a per-region patch response to the current file
+int apply_region_patches(const char *current_solution, const char *response, char **patched) {
+    if (!patched) return -1;
+    *patched = NULL;
+    if (!current_solution || !response) return -1;
+
+    code_evolution_t patches;
+    init_code_evolution(&patches);
+    collect_region_patches(response, &patches);
+
+    int status = -1;
+    if (patches.region_count > 0) {
+        status = apply_patches(current_solution, &patches, response, patched);
+    }
+    cleanup_code_evolution(&patches);
+    return status;
+}
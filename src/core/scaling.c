@@ -0,0 +1,228 @@
+#include "scaling.h"
+#include "benchmark.h"
+#include "trace.h"
+#include <limits.h>
+#include <math.h>
+
+// Times below this are start-up noise rather than work (ms)
+#define SCALING_TIME_FLOOR_MS 0.01
+
+// Slope changes between segments shorter than this are ignored (ms)
+#define SCALING_RELIABLE_MS 0.05
+
+// A higher class must fit this much better to be chosen over a lower one
+#define SCALING_FIT_MARGIN 0.95
+
+static const char *complexity_names[COMPLEXITY_CLASS_COUNT] = {
+    "O(1)", "O(log n)", "O(n)", "O(n log n)", "O(n^2)", "O(n^3)"
+};
+
+// Growth term f(n) of a complexity class
+static double complexity_term(complexity_class_t complexity, double n) {
+    switch (complexity) {
+        case COMPLEXITY_LOG: return log(n);
+        case COMPLEXITY_LINEAR: return n;
+        case COMPLEXITY_N_LOG_N: return n * log(n);
+        case COMPLEXITY_QUADRATIC: return n * n;
+        case COMPLEXITY_CUBIC: return n * n * n;
+        default: return 0.0;
+    }
+}
+
+const char* complexity_class_name(complexity_class_t complexity) {
+    if (complexity < 0 || complexity >= COMPLEXITY_CLASS_COUNT) return "unknown";
+    return complexity_names[complexity];
+}
+
+// Fit t = a + b * f(n) with a, b >= 0, minimizing the relative error; returns the RMS relative error
+static double fit_class(const scaling_profile_t *profile, complexity_class_t complexity, double *a, double *b) {
+    int count = profile->point_count;
+    // f is normalized to 1 at the largest size so n^3 stays well conditioned
+    double norm = complexity_term(complexity, (double)profile->sizes[count - 1]);
+    double sw = 0.0, sg = 0.0, sgg = 0.0, st = 0.0, sgt = 0.0;
+
+    for (int i = 0; i < count; i++) {
+        double t = fmax(profile->times_ms[i], SCALING_TIME_FLOOR_MS);
+        double w = 1.0 / (t * t);
+        double g = norm > 0.0 ? complexity_term(complexity, (double)profile->sizes[i]) / norm : 0.0;
+        sw += w;
+        sg += w * g;
+        sgg += w * g * g;
+        st += w * t;
+        sgt += w * g * t;
+    }
+
+    double fa = st / sw, fb = 0.0;
+    double det = sw * sgg - sg * sg;
+    if (norm > 0.0 && det > 0.0) {
+        fa = (st * sgg - sg * sgt) / det;
+        fb = (sw * sgt - sg * st) / det;
+        if (fa < 0.0) {
+            fa = 0.0;
+            fb = sgt / sgg;
+        }
+        if (fb < 0.0) {
+            fa = st / sw;
+            fb = 0.0;
+        }
+    }
+
+    double error = 0.0;
+    for (int i = 0; i < count; i++) {
+        double t = fmax(profile->times_ms[i], SCALING_TIME_FLOOR_MS);
+        double g = norm > 0.0 ? complexity_term(complexity, (double)profile->sizes[i]) / norm : 0.0;
+        double relative = (fa + fb * g - t) / t;
+        error += relative * relative;
+    }
+
+    *a = fa;
+    *b = norm > 0.0 ? fb / norm : 0.0;
+    return sqrt(error / count);
+}
+
+// Least-squares slope of log t over log n for points first..count-1
+static double log_log_slope(const scaling_profile_t *profile, int first) {
+    double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+    int used = 0;
+    for (int i = first; i < profile->point_count; i++) {
+        double x = log((double)profile->sizes[i]);
+        double y = log(fmax(profile->times_ms[i], SCALING_TIME_FLOOR_MS));
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+        used++;
+    }
+    double det = used * sxx - sx * sx;
+    return (used >= 2 && det > 0.0) ? (used * sxy - sx * sy) / det : 0.0;
+}
+
+// Fit complexity class, exponent, crossover and slope changes to measured points
+void fit_scaling(scaling_profile_t *profile) {
+    if (!profile || profile->point_count < 2) return;
+    int count = profile->point_count;
+
+    // The largest sizes show the asymptotic behaviour
+    int first = count / 2;
+    if (count - first < 2) first = count - 2;
+    profile->exponent = log_log_slope(profile, first);
+
+    double best_a = 0.0, best_b = 0.0, best_error = INFINITY;
+    profile->complexity = COMPLEXITY_CONSTANT;
+    for (int c = 0; c < COMPLEXITY_CLASS_COUNT; c++) {
+        double a, b;
+        double error = fit_class(profile, (complexity_class_t)c, &a, &b);
+        if (error < best_error * SCALING_FIT_MARGIN) {
+            best_error = error;
+            best_a = a;
+            best_b = b;
+            profile->complexity = (complexity_class_t)c;
+        }
+    }
+    profile->fit_error = best_error;
+    profile->fixed_ms = best_a;
+
+    // Size where the growth term overtakes the fixed cost (bisection on log n)
+    profile->crossover_size = 0.0;
+    if (profile->complexity != COMPLEXITY_CONSTANT && best_a > 0.0 && best_b > 0.0) {
+        double low = 0.0, high = log(1e15);
+        if (best_b * complexity_term(profile->complexity, exp(high)) >= best_a) {
+            for (int i = 0; i < 100; i++) {
+                double mid = (low + high) / 2.0;
+                if (best_b * complexity_term(profile->complexity, exp(mid)) < best_a) low = mid;
+                else high = mid;
+            }
+            profile->crossover_size = exp(high);
+        }
+    }
+
+    // Sizes where the local slope changes, e.g. a working set leaving a cache level
+    profile->shift_count = 0;
+    double previous_slope = 0.0;
+    int have_previous = 0;
+    for (int i = 0; i + 1 < count; i++) {
+        double t0 = profile->times_ms[i], t1 = profile->times_ms[i + 1];
+        if (t0 < SCALING_RELIABLE_MS || t1 < SCALING_RELIABLE_MS) {
+            have_previous = 0;
+            continue;
+        }
+        double slope = log(t1 / t0) / log((double)profile->sizes[i + 1] / profile->sizes[i]);
+        if (have_previous && fabs(slope - previous_slope) >= 0.5) {
+            profile->shift_sizes[profile->shift_count++] = profile->sizes[i];
+        }
+        previous_slope = slope;
+        have_previous = 1;
+    }
+}
+
+// Time the binary over the configured sizes and fit the profile
+int measure_scaling(const char *binary_path, config_t *config, scaling_profile_t *profile) {
+    if (!binary_path || !config || !profile) return -1;
+    memset(profile, 0, sizeof(scaling_profile_t));
+
+    trace_span_t span = trace_begin("scaling_sweep", TRACE_NO_AGENT);
+    long factor = config->scaling_factor < 2 ? 2 : config->scaling_factor;
+    long size = config->scaling_min_size > 0 ? config->scaling_min_size : 1;
+    while (size <= config->scaling_max_size && profile->point_count < MAX_SCALING_POINTS) {
+        performance_metrics_t point = {0};
+        // Kernel benchmarks pass the size as the element count of their inputs
+        int status = strlen(config->kernel_entry) > 0 ? benchmark_kernel(binary_path, size, config, &point)
+                                                      : benchmark_binary_size(binary_path, size, config, &point);
+        if (status != 0) {
+            log_message(config, VERBOSITY_VERBOSE, "%sScaling sweep: run failed at n = %ld, stopping%s\n",
+                       C_WARNING, size, C_RESET);
+            break;
+        }
+        profile->sizes[profile->point_count] = size;
+        profile->times_ms[profile->point_count] = point.median_time_ms;
+        profile->point_count++;
+        log_message(config, VERBOSITY_DEBUG, "Scaling sweep: n = %ld, median %.3fms\n", size, point.median_time_ms);
+
+        if (config->scaling_max_point_ms > 0 && point.median_time_ms > config->scaling_max_point_ms) break;
+        if (size > LONG_MAX / factor) break;
+        size *= factor;
+    }
+    trace_end(&span);
+
+    if (profile->point_count < 3) {
+        log_message(config, VERBOSITY_VERBOSE, "%sScaling sweep: only %d sizes measured, no fit%s\n",
+                   C_WARNING, profile->point_count, C_RESET);
+        memset(profile, 0, sizeof(scaling_profile_t));
+        return -1;
+    }
+
+    fit_scaling(profile);
+    log_message(config, VERBOSITY_VERBOSE, "%sScaling: %s, exponent %.2f over n = %ld..%ld%s\n", C_INFO,
+               complexity_class_name(profile->complexity), profile->exponent,
+               profile->sizes[0], profile->sizes[profile->point_count - 1], C_RESET);
+    return 0;
+}
+
+// Whether a measured profile grows faster than criteria allow
+int scaling_exceeds_limit(const scaling_profile_t *profile, const evaluation_criteria_t *criteria) {
+    if (!profile || !criteria || profile->point_count == 0 || criteria->max_scaling_exponent <= 0.0) return 0;
+    return profile->exponent > criteria->max_scaling_exponent;
+}
+
+// Describe a measured profile, one "  - " line per fact
+char* generate_scaling_report(const scaling_profile_t *profile) {
+    if (!profile || profile->point_count == 0) return NULL;
+
+    dstring_t *report = dstring_create(1024);
+    if (!report) return NULL;
+
+    dstring_append_format(report, "  - Fitted Complexity: %s (%.1f%% RMS error), empirical exponent %.2f\n",
+                         complexity_class_name(profile->complexity), profile->fit_error * 100.0, profile->exponent);
+    if (profile->crossover_size > 0.0) {
+        dstring_append_format(report, "  - Fixed Cost: %.3f ms, growth term dominates above n = %.0f\n",
+                             profile->fixed_ms, profile->crossover_size);
+    }
+    for (int i = 0; i < profile->shift_count; i++) {
+        dstring_append_format(report, "  - Slope Change: near n = %ld\n", profile->shift_sizes[i]);
+    }
+    for (int i = 0; i < profile->point_count; i++) {
+        dstring_append_format(report, "  - n = %ld: %.3f ms\n", profile->sizes[i], profile->times_ms[i]);
+    }
+
+    return dstring_steal(report);
+}
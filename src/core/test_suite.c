@@ -0,0 +1,217 @@
+#include "test_suite.h"
+#include "cache.h"
+#include "threadpool.h"
+#include "trace.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+
+typedef enum {
+    CASE_PENDING = 0,
+    CASE_PASSED,
+    CASE_FAILED,
+    CASE_CANCELLED
+} test_case_state_t;
+
+typedef struct test_suite_run test_suite_run_t;
+
+// One case of a suite run
+typedef struct {
+    test_suite_run_t *suite;
+    int index;
+    test_case_state_t state;
+    test_result_t result;
+    double wall_time_ms;
+} test_case_run_t;
+
+// Shared state of a suite run
+struct test_suite_run {
+    const char *file_path;
+    config_t *config;
+    process_limits_t limits;                     // Candidate limits plus the cancel pipe
+    int cancel_pipe[2];                          // Readable once a case failed (fail-fast only)
+    int cancelled;                               // Set with the pipe; queued cases skip themselves
+    int first_failure;                           // Index of the first case that failed (-1 = none)
+    pthread_mutex_t mutex;
+};
+
+// Milliseconds since start
+static double elapsed_since(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000.0 + (now.tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+// Run one case and cancel the rest of the suite when it fails (pool task)
+static void run_test_case(void *arg) {
+    test_case_run_t *run = (test_case_run_t *)arg;
+    test_suite_run_t *suite = run->suite;
+
+    if (__atomic_load_n(&suite->cancelled, __ATOMIC_ACQUIRE)) {
+        run->state = CASE_CANCELLED;
+        return;
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    run->result = run_custom_test_limited(suite->config->test_cases[run->index], suite->file_path,
+                                          suite->config, &suite->limits);
+    run->wall_time_ms = elapsed_since(&start);
+
+    pthread_mutex_lock(&suite->mutex);
+    if (run->result.run_status == PROCESS_CANCELLED) {
+        run->state = CASE_CANCELLED;
+    } else if (run->result.execution_ok) {
+        run->state = CASE_PASSED;
+    } else {
+        run->state = CASE_FAILED;
+        if (suite->first_failure < 0) {
+            suite->first_failure = run->index;
+            if (suite->config->test_fail_fast && suite->cancel_pipe[1] >= 0) {
+                __atomic_store_n(&suite->cancelled, 1, __ATOMIC_RELEASE);
+                ssize_t written = write(suite->cancel_pipe[1], "x", 1); // Never drained: stays readable
+                (void)written;
+            }
+        }
+    }
+    pthread_mutex_unlock(&suite->mutex);
+}
+
+// Name of a case outcome in the suite output
+static const char* case_state_name(test_case_state_t state) {
+    switch (state) {
+        case CASE_PASSED: return "PASS";
+        case CASE_FAILED: return "FAIL";
+        case CASE_CANCELLED: return "CANCELLED";
+        default: return "NOT RUN";
+    }
+}
+
+// Fold the case outcomes into one test result
+static test_result_t aggregate_cases(test_suite_run_t *suite, test_case_run_t *runs, double wall_time_ms) {
+    config_t *config = suite->config;
+    int count = config->test_case_count;
+    test_result_t result = {0};
+    result.error_message = calloc(1, config->max_response_size);
+    result.output = calloc(1, config->max_response_size);
+
+    int passed = 0, cancelled = 0;
+    for (int i = 0; i < count; i++) {
+        if (runs[i].state == CASE_PASSED) passed++;
+        else if (runs[i].state == CASE_CANCELLED) cancelled++;
+    }
+
+    if (suite->first_failure >= 0) {
+        const test_case_run_t *failed = &runs[suite->first_failure];
+        result.syntax_ok = failed->result.syntax_ok;
+        result.compilation_ok = failed->result.compilation_ok;
+        result.execution_ok = 0;
+        result.run_status = failed->result.run_status;
+        if (result.error_message) {
+            snprintf(result.error_message, config->max_response_size,
+                    "Test case %d/%d failed (%d passed, %d cancelled): %s\n%s", suite->first_failure + 1, count,
+                    passed, cancelled, config->test_cases[suite->first_failure],
+                    failed->result.error_message ? failed->result.error_message : "");
+        }
+    } else {
+        result.syntax_ok = 1;
+        result.compilation_ok = 1;
+        result.execution_ok = 1;
+    }
+
+    // One line per case, then each case's output
+    dstring_t *output = dstring_create(4096);
+    if (output && result.output) {
+        dstring_append_format(output, "Test suite: %d/%d cases passed, %d cancelled (%.1f ms)\n",
+                              passed, count, cancelled, wall_time_ms);
+        for (int i = 0; i < count; i++) {
+            dstring_append_format(output, "[case %d/%d] %s", i + 1, count, case_state_name(runs[i].state));
+            if (runs[i].state == CASE_PASSED || runs[i].state == CASE_FAILED) {
+                dstring_append_format(output, " %.1f ms", runs[i].wall_time_ms);
+            }
+            dstring_append_format(output, ": %s\n", config->test_cases[i]);
+        }
+        for (int i = 0; i < count; i++) {
+            const char *case_output = runs[i].result.output;
+            if (runs[i].state == CASE_CANCELLED || !case_output || strlen(case_output) == 0) continue;
+            dstring_append_format(output, "--- case %d output ---\n%s", i + 1, case_output);
+            if (case_output[strlen(case_output) - 1] != '\n') dstring_append(output, "\n");
+        }
+        snprintf(result.output, config->max_response_size, "%s", dstring_get(output));
+    }
+    dstring_destroy(output);
+
+    log_message(config, VERBOSITY_DEBUG, "Test suite: %d/%d cases passed, %d cancelled in %.1fms\n",
+               passed, count, cancelled, wall_time_ms);
+    return result;
+}
+
+// Run the configured test command on file_path, or every case of the suite
+test_result_t run_test_suite(const char *file_path, config_t *config) {
+    if (config->test_case_count <= 1) {
+        return run_custom_test(config->test_command, file_path, config);
+    }
+
+    int count = config->test_case_count;
+    test_case_run_t *runs = calloc(count, sizeof(test_case_run_t));
+    if (!runs) return run_custom_test(config->test_command, file_path, config);
+
+    test_suite_run_t suite;
+    memset(&suite, 0, sizeof(suite));
+    suite.file_path = file_path;
+    suite.config = config;
+    suite.limits = candidate_process_limits(config);
+    suite.cancel_pipe[0] = suite.cancel_pipe[1] = -1;
+    suite.first_failure = -1;
+    pthread_mutex_init(&suite.mutex, NULL);
+
+    if (config->test_fail_fast && pipe(suite.cancel_pipe) == 0) {
+        fcntl(suite.cancel_pipe[0], F_SETFD, FD_CLOEXEC);
+        fcntl(suite.cancel_pipe[1], F_SETFD, FD_CLOEXEC);
+        suite.limits.cancel_fd = suite.cancel_pipe[0];
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    trace_span_t span = trace_begin("test_suite", TRACE_NO_AGENT);
+
+    // Cases are queued in manifest order and taken by whichever worker is free
+    int workers = config->test_jobs < count ? config->test_jobs : count;
+    threadpool_t *pool = workers > 1 ? threadpool_create(workers) : NULL;
+    for (int i = 0; i < count; i++) {
+        runs[i].suite = &suite;
+        runs[i].index = i;
+        if (!pool || threadpool_submit(pool, run_test_case, &runs[i]) != 0) {
+            run_test_case(&runs[i]);
+        }
+    }
+    if (pool) threadpool_destroy(pool);
+
+    trace_end(&span);
+    test_result_t result = aggregate_cases(&suite, runs, elapsed_since(&start));
+
+    for (int i = 0; i < count; i++) {
+        cleanup_test_result(&runs[i].result);
+    }
+    free(runs);
+    if (suite.cancel_pipe[0] >= 0) close(suite.cancel_pipe[0]);
+    if (suite.cancel_pipe[1] >= 0) close(suite.cancel_pipe[1]);
+    pthread_mutex_destroy(&suite.mutex);
+    return result;
+}
+
+// Cache key component naming the configured test command(s)
+void format_test_suite_key(const config_t *config, char *out, size_t out_size) {
+    if (config->test_case_count <= 1) {
+        snprintf(out, out_size, "%s", config->test_command);
+        return;
+    }
+
+    uint64_t hash = 0;
+    for (int i = 0; i < config->test_case_count; i++) {
+        char previous[32];
+        snprintf(previous, sizeof(previous), "%016llx", (unsigned long long)hash);
+        hash = eval_cache_key("", "test_case", previous, config->test_cases[i]);
+    }
+    snprintf(out, out_size, "suite:%d:%016llx", config->test_case_count, (unsigned long long)hash);
+}
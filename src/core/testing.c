@@ -1,41 +1,100 @@
 #include "beta_evolve.h"
+#include "arena.h"
+#include "cache.h"
+#include "log_writer.h"
+#include "metrics.h"
+#include "region_prompt.h"
+#include "test_suite.h"
+#include "trace.h"
+#include "workspace.h"
+#include <sys/wait.h>
+
+// Compiler invocations of the built-in tests, part of the cache key
+#define BUILTIN_TEST_FLAGS "gcc -Wall -Wextra -Wpedantic -std=c99 -fsyntax-only; gcc -Wall -Wextra -std=c99"
 
 // Forward declarations for evolution functions
 extern int write_evolution_file(const char *file_path, const char *content);
 extern test_result_t run_custom_test(const char *test_command, const char *file_path, config_t *config);
 
-// Execute a shell command and capture output
-int execute_command(const char* command, char* output, size_t output_size) {
-    FILE* pipe = popen(command, "r");
-    if (!pipe) {
+// Execute a shell command under limits and capture output
+int execute_command(const char* command, char* output, size_t output_size,
+                    const process_limits_t *limits, process_result_t *result) {
+    int exit_code = process_run(command, limits, output, output_size, result);
+    if (exit_code < 0) {
         snprintf(output, output_size, "Failed to execute command: %s", command);
-        return -1;
     }
-    
-    size_t total_read = 0;
-    char buffer[1024];
-    while (fgets(buffer, sizeof(buffer), pipe) && total_read < output_size - 1) {
-        size_t len = strlen(buffer);
-        if (total_read + len < output_size - 1) {
-            strcpy(output + total_read, buffer);
-            total_read += len;
-        } else {
+    return exit_code;
+}
+
+// Limits for running candidate code (or a test command that builds and runs it)
+process_limits_t candidate_process_limits(const config_t *config) {
+    process_limits_t limits = {0};
+    limits.wall_time_ms = config->candidate_timeout_ms;
+    limits.cpu_time_s = config->candidate_cpu_time_s;
+    limits.memory_mb = config->candidate_memory_mb;
+    limits.max_processes = config->candidate_max_processes;
+    limits.output_bytes = (size_t)config->candidate_output_kb * 1024;
+    return limits;
+}
+
+// Limits for compiler invocations: bounded in time only
+process_limits_t compile_process_limits(const config_t *config) {
+    process_limits_t limits = {0};
+    limits.wall_time_ms = config->compile_timeout_ms;
+    return limits;
+}
+
+// Whether a test was cut short by a resource limit
+int test_result_hit_limit(const test_result_t *test_result) {
+    return test_result->run_status == PROCESS_TIMEOUT ||
+           test_result->run_status == PROCESS_OOM ||
+           test_result->run_status == PROCESS_OUTPUT_LIMIT;
+}
+
+// Describe a limit violation of a candidate run (empty if none was hit)
+void describe_limit_violation(const process_result_t *run, config_t *config, char *out, size_t out_size) {
+    switch (run->status) {
+        case PROCESS_TIMEOUT:
+            snprintf(out, out_size, "Program killed: timeout (limit %dms wall, %ds CPU) - check for infinite loops",
+                     config->candidate_timeout_ms, config->candidate_cpu_time_s);
+            break;
+        case PROCESS_OOM:
+            snprintf(out, out_size, "Program killed: OOM (limit %dMB address space) - reduce memory usage",
+                     config->candidate_memory_mb);
+            break;
+        case PROCESS_OUTPUT_LIMIT:
+            snprintf(out, out_size, "Program killed: output limit (%dKB) exceeded - print less",
+                     config->candidate_output_kb);
+            break;
+        default:
+            out[0] = '\0';
             break;
-        }
     }
-    output[total_read] = '\0';
-    
-    int exit_code = pclose(pipe);
-    return WEXITSTATUS(exit_code);
+}
+
+// Cache key component for the execution limits a result was produced under
+static void format_limits_key(const config_t *config, char *out, size_t out_size) {
+    snprintf(out, out_size, "limits:%d/%d/%d/%d/%d", config->candidate_timeout_ms, config->candidate_cpu_time_s,
+             config->candidate_memory_mb, config->candidate_output_kb, config->candidate_max_processes);
 }
 
 // Test generated C code for compilation and basic syntax
-test_result_t test_generated_code(const char* code_content, const char* problem_description, config_t *config) {
+test_result_t test_generated_code(const char* code_content, const char* problem_description, config_t *config,
+                                  arena_t *scratch) {
     test_result_t result = {0};
     
-    // Allocate dynamic memory for error message and output
-    result.error_message = malloc(config->max_response_size);
-    result.output = malloc(config->max_response_size);
+    // Identical (modulo whitespace) code has already been built and run under the same limits
+    char limits_key[128];
+    format_limits_key(config, limits_key, sizeof(limits_key));
+    uint64_t cache_key = eval_cache_key(code_content, BUILTIN_TEST_FLAGS, config->args, limits_key);
+    if (eval_cache_get_test(cache_key, &result, config)) {
+        log_message(config, VERBOSITY_DEBUG, "Test result reused from evaluation cache\n");
+        return result;
+    }
+    
+    // Allocate zeroed memory for error message and output (calloc leaves untouched pages unmapped)
+    result.error_message = calloc(1, config->max_response_size);
+    result.output = calloc(1, config->max_response_size);
     
     if (!result.error_message || !result.output) {
         if (result.error_message) free(result.error_message);
@@ -45,51 +104,49 @@ test_result_t test_generated_code(const char* code_content, const char* problem_
         return result;
     }
     
-    // Initialize the strings
-    memset(result.error_message, 0, config->max_response_size);
-    memset(result.output, 0, config->max_response_size);
-    
-    // Get system temp directory
-    const char* temp_dir = getenv("TMPDIR");
-    if (!temp_dir) {
-        temp_dir = "/tmp";  // fallback for Unix systems
-    }
-    
-    // Create a temporary file with the generated code
-    char temp_filename[512];
-    snprintf(temp_filename, sizeof(temp_filename), "%s/test.c", temp_dir);
-    
-    FILE* temp_file = fopen(temp_filename, "w");
-    if (!temp_file) {
+    // Create a private workspace with the generated code
+    workspace_t workspace;
+    char temp_filename[1024];
+    if (workspace_create(&workspace, "test") != 0 ||
+        workspace_write_file(&workspace, "test.c", code_content, temp_filename, sizeof(temp_filename)) != 0) {
         snprintf(result.error_message, config->max_response_size, 
                 "Failed to create temporary file for problem: %s", problem_description);
+        workspace_destroy(&workspace);
         return result;
     }
     
-    fprintf(temp_file, "%s\n", code_content);
-    fclose(temp_file);
+    // Command outputs only live until the verdict is written: they come from the caller's
+    // iteration arena, or from a private one whose single block holds all three
+    arena_t *private_scratch = scratch ? NULL : arena_create(3 * (size_t)config->max_response_size);
+    if (!scratch) scratch = private_scratch;
     
     // Test 1: Syntax check
-    char syntax_command[512];
+    char syntax_command[1536];
     snprintf(syntax_command, sizeof(syntax_command), 
              "gcc -Wall -Wextra -Wpedantic -std=c99 -fsyntax-only %s 2>&1", temp_filename);
     
-    char *syntax_output = malloc(config->max_response_size);
+    char *syntax_output = arena_alloc(scratch, config->max_response_size);
     if (!syntax_output) {
         snprintf(result.error_message, config->max_response_size, "Memory allocation failed for syntax output");
-        unlink(temp_filename);
+        arena_destroy(private_scratch);
+        workspace_destroy(&workspace);
         return result;
     }
     
-    int syntax_result = execute_command(syntax_command, syntax_output, config->max_response_size);
+    process_limits_t compile_limits = compile_process_limits(config);
+    trace_span_t span = trace_begin("syntax_check", TRACE_NO_AGENT);
+    int syntax_result = execute_command(syntax_command, syntax_output, config->max_response_size,
+                                        &compile_limits, NULL);
+    trace_end(&span);
     
     if (syntax_result == 0) {
         result.syntax_ok = 1;
         
         // Test 2: Simple compilation check
-        char compile_command[1024];
-        char binary_name[512];
-        snprintf(binary_name, sizeof(binary_name), "%s/test", temp_dir);
+        char binary_name[1024];
+        workspace_path(&workspace, "test", binary_name, sizeof(binary_name));
+        // Room for both paths, the args and the fixed part, so the command is never cut short
+        char compile_command[sizeof(binary_name) + sizeof(temp_filename) + sizeof(config->args) + 64];
         
         // Include additional args from config if specified
         if (strlen(config->args) > 0) {
@@ -102,41 +159,59 @@ test_result_t test_generated_code(const char* code_content, const char* problem_
                      binary_name, temp_filename);
         }
         
-        char *compile_output = malloc(config->max_response_size);
+        char *compile_output = arena_alloc(scratch, config->max_response_size);
         if (!compile_output) {
             snprintf(result.error_message, config->max_response_size, "Memory allocation failed for compile output");
-            free(syntax_output);
-            unlink(temp_filename);
+            arena_destroy(private_scratch);
+            workspace_destroy(&workspace);
             return result;
         }
         
-        int compile_result = execute_command(compile_command, compile_output, config->max_response_size);
+        span = trace_begin("compile", TRACE_NO_AGENT);
+        int compile_result = execute_command(compile_command, compile_output, config->max_response_size,
+                                             &compile_limits, NULL);
+        trace_end(&span);
         
         if (compile_result == 0) {
             result.compilation_ok = 1;
             
             // Test 3: Simple execution check - capture both stdout and stderr
             if (strstr(code_content, "int main") || strstr(code_content, "void main")) {
-                char exec_command[1024];
+                char exec_command[1536];
                 // Capture both stdout and stderr for better error reporting
                 snprintf(exec_command, sizeof(exec_command), "%s 2>&1", binary_name);
                 
-                char *exec_output = malloc(config->max_response_size);
+                char *exec_output = arena_alloc(scratch, config->max_response_size);
                 if (!exec_output) {
                     snprintf(result.error_message, config->max_response_size, "Memory allocation failed for exec output");
-                    free(compile_output);
-                    free(syntax_output);
-                    unlink(temp_filename);
+                    arena_destroy(private_scratch);
+                    workspace_destroy(&workspace);
                     return result;
                 }
                 
-                int exec_result = execute_command(exec_command, exec_output, config->max_response_size);
+                process_limits_t run_limits = candidate_process_limits(config);
+                process_result_t run;
+                span = trace_begin("run", TRACE_NO_AGENT);
+                int exec_result = execute_command(exec_command, exec_output, config->max_response_size,
+                                                  &run_limits, &run);
+                trace_end(&span);
+                result.run_status = run.status;
+                
+                char limit_message[256];
+                describe_limit_violation(&run, config, limit_message, sizeof(limit_message));
                 
                 // Consider any exit code 0 as success
-                if (exec_result == 0) {
+                if (strlen(limit_message) > 0) {
+                    snprintf(result.error_message, config->max_response_size, "%s\nOutput:\n%s",
+                            limit_message, exec_output);
+                } else if (exec_result == 0) {
                     result.execution_ok = 1;
                     strncpy(result.output, exec_output, config->max_response_size - 1);
                     result.output[config->max_response_size - 1] = '\0';
+                } else if (run.signal > 0) {
+                    snprintf(result.error_message, config->max_response_size,
+                            "Program terminated by signal %d (%s)\nOutput:\n%s",
+                            run.signal, strsignal(run.signal), exec_output);
                 } else {
                     // Include program output in error message for better debugging
                     if (strlen(exec_output) > 0) {
@@ -147,41 +222,39 @@ test_result_t test_generated_code(const char* code_content, const char* problem_
                                 "Program exited with non-zero exit code: %d", exec_result);
                     }
                 }
-                
-                free(exec_output);
             } else {
                 result.execution_ok = 1; // No main function, so execution test is not applicable
                 strcpy(result.output, "No main function found - library code compiled successfully");
             }
-            
-            // Clean up binary
-            unlink(binary_name);
         } else {
             snprintf(result.error_message, config->max_response_size,
                     "Compilation failed:\n%s", compile_output);
         }
-        
-        free(compile_output);
     } else {
         snprintf(result.error_message, config->max_response_size,
                 "Syntax check failed:\n%s", syntax_output);
     }
     
-    // Clean up temporary file and syntax output
-    free(syntax_output);
-    unlink(temp_filename);
+    // Clean up workspace and command outputs
+    arena_destroy(private_scratch);
+    workspace_destroy(&workspace);
+    
+    // Limit hits depend on machine load, so they are retried rather than cached
+    if (!test_result_hit_limit(&result)) {
+        eval_cache_put_test(cache_key, &result);
+    }
     
     return result;
 }
 
 // Generate a simple test report for the AI agents
-char* generate_test_report(const test_result_t* test_result, const char* problem_description) {
+char* generate_test_report(const test_result_t* test_result, const char* problem_description, arena_t *scratch) {
     (void)problem_description; // Suppress unused parameter warning
     
     // Use a reasonable default size if we can't determine the actual config size
     int report_size = 4096; // Fallback size
     
-    char* report = malloc(report_size);
+    char* report = scratch ? arena_alloc(scratch, report_size) : malloc(report_size);
     if (!report) return NULL;
     
     // Just return the program output if it ran successfully
@@ -202,128 +275,209 @@ char* generate_test_report(const test_result_t* test_result, const char* problem
     return report;
 }
 
+// Extract the first fenced code block of a response, trimmed of trailing whitespace.
+// Returns a malloc'd string, or NULL if there is no complete block that fits max_code_size.
+char* extract_solution_code(const char *response, int max_code_size) {
+    if (!response) return NULL;
+    
+    const char *code_start = strstr(response, "```c");
+    if (!code_start) {
+        code_start = strstr(response, "```");
+    }
+    if (!code_start) return NULL;
+    
+    // Skip the opening ```c or ```
+    code_start = strchr(code_start, '\n');
+    if (!code_start) return NULL;
+    code_start++;
+    
+    const char *code_end = strstr(code_start, "```");
+    if (!code_end) return NULL;
+    
+    size_t code_length = code_end - code_start;
+    if (code_length >= (size_t)(max_code_size - 1)) return NULL;
+    
+    // Remove trailing whitespace
+    while (code_length > 0 && (code_start[code_length - 1] == ' ' || code_start[code_length - 1] == '\t' ||
+                               code_start[code_length - 1] == '\n' || code_start[code_length - 1] == '\r')) {
+        code_length--;
+    }
+    
+    char *code = malloc(code_length + 1);
+    if (!code) return NULL;
+    
+    memcpy(code, code_start, code_length);
+    code[code_length] = '\0';
+    return code;
+}
+
+// Extract a response's code as a complete file; region-only responses are merged into the current solution
+char* extract_candidate_code(const char *response, const char *current_solution, config_t *config) {
+    int has_regions = current_solution && strstr(current_solution, EVOLUTION_MARKER_START) != NULL;
+    
+    // Per-region patches: only the changed regions come back, each in its own block
+    if (config->region_patch_responses && has_regions && response) {
+        char *patched = NULL;
+        int changed = apply_region_patches(current_solution, response, &patched);
+        if (changed == -2) {
+            log_message(config, VERBOSITY_NORMAL, "%s⚠️  Region patch rejected: it would change code outside the patched regions%s\n",
+                       C_WARNING, C_RESET);
+            return NULL;
+        }
+        if (changed >= 0) {
+            log_message(config, VERBOSITY_VERBOSE, "%sRegion patch: %d region(s) changed%s\n", C_INFO, changed, C_RESET);
+            if (strlen(patched) >= (size_t)(config->max_code_size - 1)) {
+                free(patched);
+                return NULL;
+            }
+            return patched;
+        }
+        // An answer without any code block keeps every region as it is
+        if (!strstr(response, "```")) {
+            log_message(config, VERBOSITY_VERBOSE, "%sRegion patch: no region changed%s\n", C_INFO, C_RESET);
+            return strdup(current_solution);
+        }
+        // No region blocks: fall back to a whole-file or region-scoped answer
+    }
+    
+    char *code = extract_solution_code(response, config->max_code_size);
+    if (!code || !config->region_scoped_prompts || !has_regions) {
+        return code;
+    }
+    
+    char *merged = merge_region_response(current_solution, code);
+    if (!merged) {
+        // No region of the current file: the model sent something else, test it as a whole file
+        log_message(config, VERBOSITY_VERBOSE, "%sResponse contains no known evolution region, using it as the whole file%s\n",
+                   C_WARNING, C_RESET);
+        return code;
+    }
+    free(code);
+    
+    if (strlen(merged) >= (size_t)(config->max_code_size - 1)) {
+        free(merged);
+        return NULL;
+    }
+    return merged;
+}
+
+// Build an error-only test result for failures that happen before testing starts
+static test_result_t make_error_test_result(config_t *config, const char *message) {
+    test_result_t result = {0};
+    result.error_message = calloc(1, config->max_response_size);
+    result.output = calloc(1, config->max_response_size);
+    if (result.error_message && result.output) {
+        snprintf(result.error_message, config->max_response_size, "%s", message);
+    }
+    return result;
+}
+
+// Test a candidate solution with the custom test command if configured, otherwise built-in testing
+test_result_t test_solution_code(const char *code, const char *problem_description, config_t *config,
+                                 arena_t *scratch) {
+    if (strlen(config->test_command) == 0) {
+        // Standard mode: Use built-in testing
+        return test_generated_code(code, problem_description, config, scratch);
+    }
+    
+    char cache_extra[1200];
+    format_limits_key(config, cache_extra, sizeof(cache_extra));
+    size_t used = strlen(cache_extra);
+    char suite_key[1024];
+    format_test_suite_key(config, suite_key, sizeof(suite_key));
+    snprintf(cache_extra + used, sizeof(cache_extra) - used, ";%s", suite_key);
+    uint64_t cache_key = eval_cache_key(code, "custom", config->args, cache_extra);
+    test_result_t result;
+    if (eval_cache_get_test(cache_key, &result, config)) {
+        log_message(config, VERBOSITY_DEBUG, "Test result reused from evaluation cache\n");
+        return result;
+    }
+    
+    // Custom test command mode
+    log_message(config, VERBOSITY_DEBUG, "%s🧪 Testing code with custom command...%s\n", C_INFO, C_RESET);
+    
+    // Test inside a private workspace; evolution files keep their name so the command sees the same file
+    workspace_t workspace;
+    if (workspace_create(&workspace, "custom") != 0) {
+        return make_error_test_result(config, "Failed to create temporary file for custom testing");
+    }
+    
+    const char *file_name = "test.c";
+    if (config->enable_evolution && strlen(config->evolution_file_path) > 0) {
+        const char *base_name = strrchr(config->evolution_file_path, '/');
+        file_name = base_name ? base_name + 1 : config->evolution_file_path;
+    }
+    
+    char file_path[1024];
+    if (workspace_write_file(&workspace, file_name, code, file_path, sizeof(file_path)) != 0) {
+        workspace_destroy(&workspace);
+        return make_error_test_result(config, "Failed to create temporary file for custom testing");
+    }
+    
+    result = run_test_suite(file_path, config);
+    
+    workspace_destroy(&workspace);
+    
+    if (!test_result_hit_limit(&result)) {
+        eval_cache_put_test(cache_key, &result);
+    }
+    
+    return result;
+}
+
+// Store a test result on the conversation and report it
+void apply_test_result(conversation_t *conv, test_result_t test_result) {
+    // Clean up previous test result
+    cleanup_test_result(&conv->last_test_result);
+    
+    // Store test result in conversation
+    conv->last_test_result = test_result;
+    
+    // The report only lives until it is logged; the iteration arena reclaims it
+    char* test_report = generate_test_report(&test_result, conv->problem_description, conv->scratch);
+    
+    if (test_report) {
+        // Show the output based on verbosity level
+        if (conv->config->verbosity >= VERBOSITY_VERBOSE) {
+            log_message(conv->config, VERBOSITY_VERBOSE, "%sProgram Output:%s %s\n", C_INFO, C_RESET, test_report);
+        }
+        
+        // Log test results (minimal)
+        log_writer_printf(VERBOSITY_NORMAL, "Output: %s\n", test_report);
+        
+        if (!conv->scratch) free(test_report);
+    }
+}
+
 // Enhanced solution update that includes testing
 void update_solution_with_testing(conversation_t *conv, const char *reasoning_response) {
     if (!conv || !conv->config || !conv->current_solution) return;
     
     // Extract code from the reasoning response
-    const char *code_start = strstr(reasoning_response, "```c");
-    if (!code_start) {
-        code_start = strstr(reasoning_response, "```");
+    char *code = extract_candidate_code(reasoning_response, conv->current_solution, conv->config);
+    if (!code) return;
+    
+    // A patch that leaves every region unchanged needs no new test run
+    if (conv->config->region_patch_responses && strcmp(code, conv->current_solution) == 0) {
+        log_message(conv->config, VERBOSITY_VERBOSE, "%sNo region changed, keeping the previous test result%s\n",
+                   C_INFO, C_RESET);
+        free(code);
+        return;
     }
     
-    if (code_start) {
-        // Skip the opening ```c or ```
-        code_start = strchr(code_start, '\n');
-        if (code_start) code_start++;
-        
-        const char *code_end = strstr(code_start, "```");
-        if (code_end) {
-            // Extract the code
-            size_t code_length = code_end - code_start;
-            if (code_length < (size_t)(conv->config->max_code_size - 1)) {
-                strncpy(conv->current_solution, code_start, code_length);
-                conv->current_solution[code_length] = '\0';
-                
-                // Remove trailing whitespace
-                char *end = conv->current_solution + strlen(conv->current_solution) - 1;
-                while (end > conv->current_solution && (*end == ' ' || *end == '\t' || *end == '\n' || *end == '\r')) {
-                    *end = '\0';
-                    end--;
-                }
-                
-                // Test the generated code - use custom test command if specified, otherwise built-in testing
-                test_result_t test_result = {0};
-                
-                if (strlen(conv->config->test_command) > 0) {
-                    // Custom test command mode
-                    log_message(conv->config, VERBOSITY_DEBUG, "%s🧪 Testing code with custom command...%s\n", C_INFO, C_RESET);
-                    
-                    if (conv->config->enable_evolution && strlen(conv->config->evolution_file_path) > 0) {
-                        // Evolution mode: Write to evolved file and test
-                        if (write_evolution_file(conv->config->evolution_file_path, conv->current_solution) == 0) {
-                            // Create evolved file path for testing
-                            char evolved_file_path[1024];
-                            snprintf(evolved_file_path, sizeof(evolved_file_path), "%s.evolved", conv->config->evolution_file_path);
-                            
-                            test_result = run_custom_test(conv->config->test_command, evolved_file_path, conv->config);
-                        } else {
-                            // Failed to write file, create error result
-                            test_result.error_message = malloc(conv->config->max_response_size);
-                            test_result.output = malloc(conv->config->max_response_size);
-                            if (test_result.error_message && test_result.output) {
-                                snprintf(test_result.error_message, conv->config->max_response_size, 
-                                        "Failed to write evolved code to file: %s.evolved", conv->config->evolution_file_path);
-                                memset(test_result.output, 0, conv->config->max_response_size);
-                                test_result.syntax_ok = 0;
-                                test_result.compilation_ok = 0;
-                                test_result.execution_ok = 0;
-                            }
-                        }
-                    } else {
-                        // Standard mode: Write to temporary file and test
-                        const char* temp_dir = getenv("TMPDIR");
-                        if (!temp_dir) {
-                            temp_dir = "/tmp";
-                        }
-                        
-                        char temp_file_path[1024];
-                        snprintf(temp_file_path, sizeof(temp_file_path), "%s/test.c", temp_dir);
-                        
-                        FILE* temp_file = fopen(temp_file_path, "w");
-                        if (temp_file) {
-                            fprintf(temp_file, "%s\n", conv->current_solution);
-                            fclose(temp_file);
-                            
-                            test_result = run_custom_test(conv->config->test_command, temp_file_path, conv->config);
-                            
-                            // Clean up temporary file
-                            unlink(temp_file_path);
-                        } else {
-                            // Failed to write temp file, create error result
-                            test_result.error_message = malloc(conv->config->max_response_size);
-                            test_result.output = malloc(conv->config->max_response_size);
-                            if (test_result.error_message && test_result.output) {
-                                snprintf(test_result.error_message, conv->config->max_response_size, 
-                                        "Failed to create temporary file for custom testing");
-                                memset(test_result.output, 0, conv->config->max_response_size);
-                                test_result.syntax_ok = 0;
-                                test_result.compilation_ok = 0;
-                                test_result.execution_ok = 0;
-                            }
-                        }
-                    }
-                } else {
-                    // Standard mode: Use built-in testing
-                    test_result = test_generated_code(conv->current_solution, conv->problem_description, conv->config);
-                }
-                
-                // Clean up previous test result
-                cleanup_test_result(&conv->last_test_result);
-                
-                // Store test result in conversation
-                conv->last_test_result = test_result;
-                
-                char* test_report = generate_test_report(&test_result, conv->problem_description);
-                
-                if (test_report) {
-                    // Show the output based on verbosity level
-                    if (conv->config->verbosity >= VERBOSITY_VERBOSE) {
-                        log_message(conv->config, VERBOSITY_VERBOSE, "%sProgram Output:%s %s\n", C_INFO, C_RESET, test_report);
-                    }
-                    
-                    // Log test results (minimal)
-                    FILE *log_file = fopen("beta-evolve.log", "a");
-                    if (log_file) {
-                        fprintf(log_file, "Output: %s\n", test_report);
-                        fclose(log_file);
-                    }
-                    
-                    free(test_report);
-                }
-            }
-        }
+    strcpy(conv->current_solution, code);
+    free(code);
+    
+    // Keep the latest evolved solution next to the original file for the user
+    if (conv->config->enable_evolution && strlen(conv->config->evolution_file_path) > 0) {
+        write_evolution_file(conv->config->evolution_file_path, conv->current_solution);
     }
+    
+    // Test the generated code - use custom test command if specified, otherwise built-in testing
+    test_result_t test_result = test_solution_code(conv->current_solution, conv->problem_description, conv->config,
+                                                   conv->scratch);
+    apply_test_result(conv, test_result);
+    metrics_measure(conv->current_solution, &conv->last_test_result, conv->config, &conv->last_metrics);
 }
 
 // Check if there are any code errors in the test result
@@ -1,320 +1,13 @@
 #include "beta_evolve.h"
 #include "argparse.h"
-
-// Run the dual-AI collaboration
-int run_collaboration(const char *problem, config_t *config) {
-    conversation_t conv;
-    init_conversation(&conv, problem, config);
-    
-    // Initialize evolution if enabled
-    if (config->enable_evolution && strlen(config->evolution_file_path) > 0) {
-        log_message(config, VERBOSITY_NORMAL, "%s🧬 Evolution mode enabled for file: %s%s\n", 
-                   C_INFO, config->evolution_file_path, C_RESET);
-        
-        // Read the initial evolution file
-        char *file_content = read_evolution_file(config->evolution_file_path);
-        if (file_content) {
-            // Parse evolution regions
-            parse_evolution_regions(&conv.evolution, file_content);
-            
-            if (conv.evolution.region_count > 0) {
-                log_message(config, VERBOSITY_NORMAL, "%s🧬 Found %d evolution regions%s\n", 
-                           C_INFO, conv.evolution.region_count, C_RESET);
-                conv.evolution.evolution_enabled = 1;
-                
-                // Set the current solution to the file content
-                if (strlen(file_content) < (unsigned long)config->max_code_size) {
-                    strcpy(conv.current_solution, file_content);
-                }
-            }
-            free(file_content);
-        } else {
-            log_message(config, VERBOSITY_NORMAL, "%s❌ Failed to read evolution file: %s%s\n", 
-                       C_ERROR, config->evolution_file_path, C_RESET);
-        }
-    }
-    
-    print_header("Beta Evolve: Starting dual-AI collaboration");
-    log_message(config, VERBOSITY_NORMAL, "%sProblem:%s %s\n\n", C_EMPHASIS, C_RESET, problem);
-    
-    int max_error_iterations = config->iterations * 3; // Allow up to 3x normal iterations for error fixing
-    int total_iterations = 0;
-    
-    for (int iteration = 0; iteration < config->iterations || has_code_errors(&conv.last_test_result); iteration++) {
-        // Safety check to prevent infinite loops
-        if (total_iterations >= max_error_iterations) {
-            log_message(config, VERBOSITY_NORMAL, 
-                       "%s🛑 Maximum iterations reached (%d). Stopping to prevent infinite loop.%s\n", 
-                       C_WARNING, max_error_iterations, C_RESET);
-            break;
-        }
-        
-        conv.iterations = iteration + 1;
-        total_iterations++;
-        
-        // Log iteration start with appropriate verbosity
-        log_iteration_start(config, conv.iterations, total_iterations);
-        
-        // Show current error status if we have a solution
-        if (strlen(conv.current_solution) > 0) {
-            log_code_status(config, &conv.last_test_result);
-        }
-        
-        // Check if this is a normal iteration or error fix iteration
-        if (iteration < config->iterations) {
-            // Normal iteration: Use both fast and reasoning agents
-            
-            // Fast Agent turn
-            log_message(config, VERBOSITY_NORMAL, "%s🏃 Fast Agent thinking...%s\n", C_INFO, C_RESET);
-            char *fast_prompt = generate_agent_prompt(&conv, AGENT_FAST);
-            if (!fast_prompt) {
-                log_message(config, VERBOSITY_NORMAL, "%sError: Failed to generate fast agent prompt%s\n", C_ERROR, C_RESET);
-                return -1;
-            }
-            
-            char *fast_response = call_ai_model(fast_prompt, AGENT_FAST, config);
-            
-            // Log the AI interaction in debug mode
-            log_ai_interaction(config, AGENT_FAST, fast_prompt, fast_response);
-            free(fast_prompt);
-            
-            if (!fast_response) {
-                log_message(config, VERBOSITY_NORMAL, "%sError: Fast agent failed to respond%s\n", C_ERROR, C_RESET);
-                return -1;
-            }
-            
-            // Validate and clean the response
-            char *cleaned_fast_response = validate_and_clean_response(fast_response);
-            free(fast_response);
-            
-            if (!cleaned_fast_response) {
-                log_message(config, VERBOSITY_NORMAL, "%sError: Failed to validate fast agent response%s\n", C_ERROR, C_RESET);
-                return -1;
-            }
-            
-            add_message(&conv, AGENT_FAST, cleaned_fast_response);
-            
-            // Extract and show analysis if present
-            const char *analysis = strstr(cleaned_fast_response, "Analysis:");
-            if (analysis && config->verbosity >= VERBOSITY_VERBOSE) {
-                const char *analysis_end = strstr(analysis, "\n\n```");
-                if (analysis_end) {
-                    int analysis_len = analysis_end - analysis;
-                    log_message(config, VERBOSITY_VERBOSE, "%sFast Agent Analysis:%s %.*s\n", 
-                               C_INFO, C_RESET, analysis_len, analysis);
-                }
-            }
-            log_message(config, VERBOSITY_NORMAL, "%s🏃 Fast Agent provided code solution%s\n\n", C_SUCCESS, C_RESET);
-            
-            // Reasoning Agent turn
-            log_message(config, VERBOSITY_NORMAL, "%s🧠 Reasoning Agent analyzing...%s\n", C_INFO, C_RESET);
-            char *reasoning_prompt = generate_agent_prompt(&conv, AGENT_REASONING);
-            if (!reasoning_prompt) {
-                log_message(config, VERBOSITY_NORMAL, "%sError: Failed to generate reasoning agent prompt%s\n", C_ERROR, C_RESET);
-                free(cleaned_fast_response);
-                return -1;
-            }
-            
-            char *reasoning_response = call_ai_model(reasoning_prompt, AGENT_REASONING, config);
-            
-            // Log the AI interaction in debug mode
-            log_ai_interaction(config, AGENT_REASONING, reasoning_prompt, reasoning_response);
-            free(reasoning_prompt);
-            
-            if (!reasoning_response) {
-                log_message(config, VERBOSITY_NORMAL, "%sError: Reasoning agent failed to respond%s\n", C_ERROR, C_RESET);
-                free(cleaned_fast_response);
-                return -1;
-            }
-            
-            // Validate and clean the response
-            char *cleaned_reasoning_response = validate_and_clean_response(reasoning_response);
-            free(reasoning_response);
-            
-            if (!cleaned_reasoning_response) {
-                log_message(config, VERBOSITY_NORMAL, "%sError: Failed to validate reasoning agent response%s\n", C_ERROR, C_RESET);
-                free(cleaned_fast_response);
-                return -1;
-            }
-            
-            add_message(&conv, AGENT_REASONING, cleaned_reasoning_response);
-            
-            // Extract and show analysis if present
-            const char *reasoning_analysis = strstr(cleaned_reasoning_response, "Analysis:");
-            if (reasoning_analysis && config->verbosity >= VERBOSITY_VERBOSE) {
-                const char *analysis_end = strstr(reasoning_analysis, "\n\n```");
-                if (analysis_end) {
-                    int analysis_len = analysis_end - reasoning_analysis;
-                    log_message(config, VERBOSITY_VERBOSE, "%sReasoning Agent Analysis:%s %.*s\n", 
-                               C_INFO, C_RESET, analysis_len, reasoning_analysis);
-                }
-            }
-            log_message(config, VERBOSITY_NORMAL, "%s🧠 Reasoning Agent provided refined solution%s\n\n", C_SUCCESS, C_RESET);
-            
-            // Update solution with testing
-            update_solution_with_testing(&conv, cleaned_reasoning_response);
-            
-            // Run code evolution if evolution markers are detected
-            if (conv.current_solution && strstr(conv.current_solution, EVOLUTION_MARKER_START)) {
-                log_message(config, VERBOSITY_NORMAL, "%s🧬 Evolution markers detected - running code evolution...%s\n", 
-                           C_INFO, C_RESET);
-                evolve_code_regions(&conv, &conv.evolution);
-                
-                if (config->verbosity >= VERBOSITY_VERBOSE) {
-                    log_message(config, VERBOSITY_VERBOSE, 
-                               "%s🧬 Evolution status: %d regions, generation %d%s\n",
-                               C_INFO, conv.evolution.region_count, 
-                               conv.evolution.current_generation, C_RESET);
-                }
-            }
-            
-            // Cleanup
-            free(cleaned_fast_response);
-            free(cleaned_reasoning_response);
-        } else {
-            // Error fix iteration: Only use reasoning agent for bug fixes
-            log_message(config, VERBOSITY_NORMAL, "%s🧠 Reasoning Agent fixing bugs...%s\n", C_INFO, C_RESET);
-            char *reasoning_prompt = generate_agent_prompt(&conv, AGENT_REASONING);
-            if (!reasoning_prompt) {
-                log_message(config, VERBOSITY_NORMAL, "%sError: Failed to generate reasoning agent prompt%s\n", C_ERROR, C_RESET);
-                return -1;
-            }
-            
-            char *reasoning_response = call_ai_model(reasoning_prompt, AGENT_REASONING, config);
-            
-            // Log the AI interaction in debug mode
-            log_ai_interaction(config, AGENT_REASONING, reasoning_prompt, reasoning_response);
-            free(reasoning_prompt);
-            
-            if (!reasoning_response) {
-                log_message(config, VERBOSITY_NORMAL, "%sError: Reasoning agent failed to respond%s\n", C_ERROR, C_RESET);
-                return -1;
-            }
-            
-            // Validate and clean the response
-            char *cleaned_reasoning_response = validate_and_clean_response(reasoning_response);
-            free(reasoning_response);
-            
-            if (!cleaned_reasoning_response) {
-                log_message(config, VERBOSITY_NORMAL, "%sError: Failed to validate reasoning agent response%s\n", C_ERROR, C_RESET);
-                return -1;
-            }
-            
-            add_message(&conv, AGENT_REASONING, cleaned_reasoning_response);
-            
-            // Extract and show analysis if present
-            const char *reasoning_analysis = strstr(cleaned_reasoning_response, "Analysis:");
-            if (reasoning_analysis && config->verbosity >= VERBOSITY_VERBOSE) {
-                const char *analysis_end = strstr(reasoning_analysis, "\n\n```");
-                if (analysis_end) {
-                    int analysis_len = analysis_end - reasoning_analysis;
-                    log_message(config, VERBOSITY_VERBOSE, "%sReasoning Agent Analysis:%s %.*s\n", 
-                               C_INFO, C_RESET, analysis_len, reasoning_analysis);
-                }
-            }
-            log_message(config, VERBOSITY_NORMAL, "%s🧠 Reasoning Agent provided bug fix%s\n\n", C_SUCCESS, C_RESET);
-            
-            // Update solution with testing
-            update_solution_with_testing(&conv, cleaned_reasoning_response);
-            
-            // Cleanup
-            free(cleaned_reasoning_response);
-        }
-        
-        // Show progress
-        if (strlen(conv.current_solution) > 0) {
-            log_message(config, VERBOSITY_NORMAL, "%s💡 Current solution updated!%s\n", C_SUCCESS, C_RESET);
-            
-            // Check if we've resolved all errors
-            if (!has_code_errors(&conv.last_test_result)) {
-                log_message(config, VERBOSITY_NORMAL, "%s🎉 All code errors resolved! Code compiles and runs successfully.%s\n", C_SUCCESS, C_RESET);
-                if (iteration >= config->iterations) {
-                    log_message(config, VERBOSITY_NORMAL, "%s✅ Error fixing phase completed.%s\n", C_SUCCESS, C_RESET);
-                    break;
-                }
-            }
-            printf("\n");
-        }
-        
-        // Add delay between iterations
-        sleep(1);
-    }
-    
-    // Print final conversation and solution
-    print_conversation(&conv);
-    
-    // Save solution to file
-    if (strlen(conv.current_solution) > 0) {
-        char filename[256];
-        time_t now = time(NULL);
-        struct tm *tm_info = localtime(&now);
-        snprintf(filename, sizeof(filename), "solution_%04d%02d%02d_%02d%02d%02d.c",
-                tm_info->tm_year + 1900, tm_info->tm_mon + 1, tm_info->tm_mday,
-                tm_info->tm_hour, tm_info->tm_min, tm_info->tm_sec);
-        
-        FILE *file = fopen(filename, "w");
-        if (file) {
-            fprintf(file, "%s\n", conv.current_solution);
-            fclose(file);
-            log_message(config, VERBOSITY_NORMAL, "%s💾 Solution saved to: %s%s\n", C_SUCCESS, filename, C_RESET);
-            
-            // Run final comprehensive evaluation if enabled
-            if (config->enable_comprehensive_evaluation) {
-                log_message(config, VERBOSITY_NORMAL, "%s🏁 Running final comprehensive evaluation...%s\n", C_INFO, C_RESET);
-                
-                evaluation_result_t final_eval = evaluate_code_comprehensive(
-                    filename, conv.current_solution, &config->eval_criteria, config);
-                
-                // Display final evaluation summary
-                printf("\n%s=== FINAL EVALUATION SUMMARY ===%s\n", C_HEADER, C_RESET);
-                printf("%sOverall Score:%s %.1f/100\n", C_EMPHASIS, C_RESET, final_eval.overall_score);
-                printf("%sCorrectness:%s %.1f/100\n", C_EMPHASIS, C_RESET, final_eval.correctness_score);
-                printf("%sPerformance:%s %.1f/100\n", C_EMPHASIS, C_RESET, final_eval.performance_score);
-                printf("%sCode Quality:%s %.1f/100\n", C_EMPHASIS, C_RESET, final_eval.quality_score);
-                
-                if (final_eval.passed_criteria) {
-                    printf("%s✅ All evaluation criteria met!%s\n", C_SUCCESS, C_RESET);
-                } else {
-                    printf("%s⚠️  Some criteria not met - see evaluation report for details%s\n", C_WARNING, C_RESET);
-                }
-                
-                // Save final evaluation report
-                if (final_eval.detailed_report && strlen(config->evaluation_output_file) > 0) {
-                    char final_report_path[1024];
-                    snprintf(final_report_path, sizeof(final_report_path), "final_%s", config->evaluation_output_file);
-                    
-                    FILE *report_file = fopen(final_report_path, "w");
-                    if (report_file) {
-                        fprintf(report_file, "%s", final_eval.detailed_report);
-                        fclose(report_file);
-                        printf("%s📄 Final evaluation report saved to: %s%s\n", C_INFO, final_report_path, C_RESET);
-                    }
-                }
-                
-                // Show performance summary
-                if (config->verbosity >= VERBOSITY_NORMAL) {
-                    printf("\n%sPerformance Summary:%s\n", C_EMPHASIS, C_RESET);
-                    printf("  Execution Time: %.2f ms\n", final_eval.performance.execution_time_ms);
-                    printf("  Memory Usage: %ld KB\n", final_eval.performance.memory_usage_kb);
-                    printf("  Throughput: %.1f ops/sec\n", final_eval.performance.throughput);
-                    
-                    printf("\n%sCode Quality Summary:%s\n", C_EMPHASIS, C_RESET);
-                    printf("  Lines of Code: %d\n", final_eval.quality.lines_of_code);
-                    printf("  Cyclomatic Complexity: %d\n", final_eval.quality.cyclomatic_complexity);
-                    printf("  Test Coverage: %.1f%%\n", final_eval.quality.test_coverage_percent);
-                    printf("  Maintainability Index: %.1f/100\n", final_eval.quality.maintainability_index);
-                }
-                
-                cleanup_evaluation_result(&final_eval);
-            }
-        } else {
-            log_message(config, VERBOSITY_NORMAL, "%s❌ Failed to save solution to file%s\n", C_ERROR, C_RESET);
-        }
-    }
-    
-    cleanup_conversation(&conv);
-    return 0;
-}
+#include "batch.h"
+#include "cache.h"
+#include "http.h"
+#include "log_writer.h"
+#include "model_cache.h"
+#include "rate_limit.h"
+#include "router.h"
+#include "trace.h"
 
 int main(int argc, char *argv[]) {
     // Create argument parser
@@ -330,6 +23,10 @@ int main(int argc, char *argv[]) {
         "Configuration file to use", false, "config.toml");
     argparse_add_int(parser, "iterations", 'i', 
         "Number of collaboration iterations", false, 10);
+    argparse_add_string(parser, "batch", 'b', 
+        "File listing prompt files and evolution targets to run as one batch", false, NULL);
+    argparse_add_int(parser, "jobs", 'j', 
+        "Number of batch jobs to run at once", false, 0);
     argparse_add_flag(parser, "verbose", 'v', 
         "Enable verbose output");
     argparse_add_flag(parser, "debug", 'd', 
@@ -358,6 +55,11 @@ int main(int argc, char *argv[]) {
     const char *prompt_file_override = argparse_get_string(parser, "prompt-file");
     const char *config_file = argparse_get_string(parser, "config");
     int iterations_override = argparse_get_int(parser, "iterations");
+    const char *batch_file = argparse_get_string(parser, "batch");
+    if (batch_file && strlen(batch_file) == 0) {
+        batch_file = NULL;
+    }
+    int jobs_override = argparse_get_int(parser, "jobs");
     bool verbose = argparse_get_bool(parser, "verbose");
     
     // Handle positional arguments (backward compatibility)
@@ -375,9 +77,6 @@ int main(int argc, char *argv[]) {
         printf("Verbose mode: %s\n\n", verbose ? "enabled" : "disabled");
     }
 
-    // Delete any existing log file
-    remove("beta-evolve.log");
-    
     // Load configuration
     config_t config;
     if (load_config(&config, config_file) != 0) {
@@ -402,6 +101,11 @@ int main(int argc, char *argv[]) {
         }
     }
     
+    // Override batch concurrency if specified
+    if (jobs_override > 0) {
+        config.batch_jobs = jobs_override;
+    }
+    
     // Override prompt file if specified via command line
     if (prompt_file_override && strlen(prompt_file_override) > 0) {
         if (load_problem_prompt_file(&config, prompt_file_override) != 0) {
@@ -432,7 +136,7 @@ int main(int argc, char *argv[]) {
                                      : config.problem_prompt_file;
             printf("Info: Using problem description from file: %s\n", source_file);
         }
-    } else {
+    } else if (!batch_file) {
         fprintf(stderr, "Error: No problem description provided.\n");
         fprintf(stderr, "Either provide it using --problem/-p or specify a prompt file with --prompt-file/-f\n");
         fprintf(stderr, "Or set problem_prompt_file in the config file.\n");
@@ -441,6 +145,9 @@ int main(int argc, char *argv[]) {
         return 1;
     }
     
+    // Start the run log (replaces any earlier one)
+    log_writer_init(&config);
+    
     // Validate configuration - allow null API keys
     if ((strlen(config.fast_model_api_key) == 0 || strcmp(config.fast_model_api_key, "null") == 0) &&
         (strlen(config.reasoning_model_api_key) == 0 || strcmp(config.reasoning_model_api_key, "null") == 0)) {
@@ -455,12 +162,58 @@ int main(int argc, char *argv[]) {
     log_message(&config, VERBOSITY_NORMAL, "%sIteration Count:%s %d\n\n", C_EMPHASIS, C_RESET, config.iterations);
     
     // Show problem description
-    log_message(&config, VERBOSITY_NORMAL, "%s🎯 Problem:%s %s\n\n", C_EMPHASIS, C_RESET, final_problem);
+    if (batch_file) {
+        log_message(&config, VERBOSITY_NORMAL, "%s📦 Batch:%s %s\n\n", C_EMPHASIS, C_RESET, batch_file);
+    } else {
+        log_message(&config, VERBOSITY_NORMAL, "%s🎯 Problem:%s %s\n\n", C_EMPHASIS, C_RESET, final_problem);
+    }
+    
+    // Keep model API connections alive for the whole run
+    if (http_client_init() != 0) {
+        fprintf(stderr, "Error: Failed to initialize HTTP client\n");
+        log_writer_shutdown();
+        free_config(&config);
+        argparse_destroy(parser);
+        return 1;
+    }
+    
+    // Serve recorded or repeated model responses when configured
+    if (model_cache_init(&config) != 0) {
+        http_client_cleanup();
+        log_writer_shutdown();
+        free_config(&config);
+        argparse_destroy(parser);
+        return 1;
+    }
+    
+    // Share the API quota between every call, and the CPUs between local runs
+    rate_limit_init(&config);
+    if (batch_file && config.eval_slots <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        process_set_slots(cpus > 0 ? (int)cpus : 1);
+    } else {
+        process_set_slots(config.eval_slots);
+    }
+    
+    // Reuse evaluation work for identical candidates
+    eval_cache_init(&config);
+    trace_init(&config);
     
     // Run collaboration
-    int result = run_collaboration(final_problem, &config);
+    int result = batch_file ? run_batch(batch_file, final_problem, &config)
+                            : run_collaboration(final_problem, &config);
+    log_rate_limit_stats(&config);
+    log_router_stats(&config);
+    log_trace_summary(&config);
     
     // Cleanup
+    ai_wait_hedged_requests();
+    trace_cleanup();
+    rate_limit_cleanup();
+    router_cleanup();
+    eval_cache_cleanup();
+    model_cache_cleanup();
+    http_client_cleanup();
     free_config(&config);
     argparse_destroy(parser);
     
@@ -469,6 +222,7 @@ int main(int argc, char *argv[]) {
     } else {
         log_message(&config, VERBOSITY_NORMAL, "%s❌ Beta Evolve collaboration failed.%s\n", C_ERROR, C_RESET);
     }
+    log_writer_shutdown();
     
     return result;
 }
@@ -0,0 +1,238 @@
+// In-process kernel benchmark runner (beta_kernel_runner).
+// Loads candidates built as shared objects and times their entry symbol over
+// pre-generated inputs in tight loops, so microsecond-scale kernels are not
+// drowned out by process start-up. Started and supervised by beta_evolve over
+// the protocol in kernel_runner.h. Built on its own by the Makefile; it must
+// not use anything from the rest of the tree.
+#include "kernel_runner.h"
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Pointer arguments share one calling convention, so every array kernel is called through this type
+typedef void (*array_entry_t)(void *data, int n);
+typedef void (*void_entry_t)(void);
+
+// One loaded candidate and its inputs
+typedef struct {
+    void *library;
+    int signature;
+    array_entry_t array_entry;
+    void_entry_t void_entry;
+    int elements;                                // Elements of one input
+    size_t input_bytes;                          // Bytes of one input
+    int inputs;
+    unsigned char *data;                         // inputs pristine inputs back to back
+    unsigned char *work;                         // Copy the kernel runs on
+} kernel_t;
+
+static int channel = -1;
+
+static int read_full(void *buffer, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = read(channel, (char *)buffer + done, size - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        done += (size_t)n;
+    }
+    return 0;
+}
+
+static int write_full(const void *buffer, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = write(channel, (const char *)buffer + done, size - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        done += (size_t)n;
+    }
+    return 0;
+}
+
+static double now_ns(clockid_t clock) {
+    struct timespec now;
+    clock_gettime(clock, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+// Stand-ins of the same shape, timed to measure what the loop costs without a kernel
+__attribute__((noinline)) static void empty_array_entry(void *data, int n) {
+    __asm__ volatile("" : : "r"(data), "r"(n) : "memory");
+}
+
+__attribute__((noinline)) static void empty_void_entry(void) {
+    __asm__ volatile("" : : : "memory");
+}
+
+// Call the kernel calls times, each on a fresh copy of the next input
+__attribute__((noinline, noclone)) static void run_calls(const kernel_t *kernel, array_entry_t array_entry, void_entry_t void_entry, int64_t calls) {
+    if (kernel->signature == KERNEL_VOID) {
+        for (int64_t i = 0; i < calls; i++) void_entry();
+        return;
+    }
+
+    int input = 0;
+    for (int64_t i = 0; i < calls; i++) {
+        memcpy(kernel->work, kernel->data + (size_t)input * kernel->input_bytes, kernel->input_bytes);
+        // The copy must happen even though only the opaque call reads it
+        __asm__ volatile("" : : "r"(kernel->work) : "memory");
+        array_entry(kernel->work, kernel->elements);
+        if (++input == kernel->inputs) input = 0;
+    }
+}
+
+// Wall nanoseconds of one batch of calls
+static double time_calls(const kernel_t *kernel, array_entry_t array_entry, void_entry_t void_entry, int64_t calls) {
+    double start = now_ns(CLOCK_MONOTONIC);
+    run_calls(kernel, array_entry, void_entry, calls);
+    return now_ns(CLOCK_MONOTONIC) - start;
+}
+
+// Fill the inputs with the same pseudo-random data for every candidate
+static void generate_inputs(kernel_t *kernel) {
+    uint64_t state = KERNEL_INPUT_SEED;
+    size_t elements = (size_t)kernel->elements * (size_t)kernel->inputs;
+
+    for (size_t i = 0; i < elements; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        switch (kernel->signature) {
+            case KERNEL_INT_ARRAY: ((int *)kernel->data)[i] = (int)(state >> 33); break;
+            case KERNEL_LONG_ARRAY: ((long *)kernel->data)[i] = (long)(state >> 1); break;
+            case KERNEL_DOUBLE_ARRAY: ((double *)kernel->data)[i] = (double)(state >> 11) / 9007199254740992.0; break;
+            default: kernel->data[i] = (unsigned char)(state >> 56); break;
+        }
+    }
+}
+
+// Load the candidate and its inputs; fills reply->error and returns -1 on failure
+static int load_kernel(const kernel_request_t *request, kernel_t *kernel, kernel_reply_t *reply) {
+    memset(kernel, 0, sizeof(kernel_t));
+    kernel->signature = request->signature;
+    if (request->signature < KERNEL_INT_ARRAY || request->signature > KERNEL_VOID) {
+        snprintf(reply->error, sizeof(reply->error), "unknown kernel signature %d", request->signature);
+        return -1;
+    }
+
+    kernel->library = dlopen(request->library, RTLD_NOW | RTLD_LOCAL);
+    if (!kernel->library) {
+        snprintf(reply->error, sizeof(reply->error), "%s", dlerror());
+        return -1;
+    }
+    void *symbol = dlsym(kernel->library, request->entry);
+    if (!symbol) {
+        snprintf(reply->error, sizeof(reply->error), "entry symbol '%s' not found", request->entry);
+        return -1;
+    }
+    if (request->signature == KERNEL_VOID) {
+        kernel->void_entry = (void_entry_t)symbol;
+        return 0;
+    }
+    kernel->array_entry = (array_entry_t)symbol;
+
+    size_t element_size = 1;
+    if (request->signature == KERNEL_INT_ARRAY) element_size = sizeof(int);
+    if (request->signature == KERNEL_LONG_ARRAY) element_size = sizeof(long);
+    if (request->signature == KERNEL_DOUBLE_ARRAY) element_size = sizeof(double);
+    kernel->elements = request->input_size > 0 ? request->input_size : 1;
+    kernel->input_bytes = (size_t)kernel->elements * element_size;
+    kernel->inputs = request->inputs > 0 ? request->inputs : 1;
+    kernel->data = malloc(kernel->input_bytes * (size_t)kernel->inputs);
+    kernel->work = malloc(kernel->input_bytes);
+    if (!kernel->data || !kernel->work) {
+        snprintf(reply->error, sizeof(reply->error), "cannot allocate %d inputs of %zu bytes",
+                 kernel->inputs, kernel->input_bytes);
+        return -1;
+    }
+    generate_inputs(kernel);
+    return 0;
+}
+
+static void unload_kernel(kernel_t *kernel) {
+    free(kernel->data);
+    free(kernel->work);
+    if (kernel->library) dlclose(kernel->library);
+    memset(kernel, 0, sizeof(kernel_t));
+}
+
+// Calibrate, warm up and measure the loop overhead of a loaded kernel
+static void prepare_batches(const kernel_t *kernel, const kernel_request_t *request, kernel_reply_t *reply) {
+    // Double the calls until one batch takes long enough for the clock to resolve it well
+    int64_t calls = 1;
+    while (time_calls(kernel, kernel->array_entry, kernel->void_entry, calls) < KERNEL_BATCH_NS &&
+           calls < ((int64_t)1 << 40)) {
+        calls *= 2;
+    }
+    for (int i = 0; i < request->warmup_batches; i++) {
+        time_calls(kernel, kernel->array_entry, kernel->void_entry, calls);
+    }
+
+    // The least disturbed of a few batches of empty calls is the overhead
+    double overhead = 0.0;
+    for (int i = 0; i < 5; i++) {
+        double elapsed = time_calls(kernel, empty_array_entry, empty_void_entry, calls);
+        if (i == 0 || elapsed < overhead) overhead = elapsed;
+    }
+    reply->calls_per_batch = calls;
+    reply->overhead_ns = overhead / (double)calls;
+}
+
+// Serve one request: load, prepare, then answer batch commands until done
+static int serve(const kernel_request_t *request) {
+    kernel_reply_t reply;
+    memset(&reply, 0, sizeof(reply));
+    reply.magic = KERNEL_RUNNER_MAGIC;
+
+    if (request->magic != KERNEL_RUNNER_MAGIC) {
+        reply.status = -1;
+        snprintf(reply.error, sizeof(reply.error), "malformed request");
+        return write_full(&reply, sizeof(reply));
+    }
+
+    kernel_t kernel;
+    if (load_kernel(request, &kernel, &reply) != 0) {
+        reply.status = -1;
+        unload_kernel(&kernel);
+        return write_full(&reply, sizeof(reply));
+    }
+    prepare_batches(&kernel, request, &reply);
+    if (write_full(&reply, sizeof(reply)) != 0) return -1;
+
+    unsigned char command;
+    while (read_full(&command, 1) == 0 && command == KERNEL_COMMAND_BATCH) {
+        kernel_sample_t sample;
+        sample.wall_ns = time_calls(&kernel, kernel.array_entry, kernel.void_entry, reply.calls_per_batch) /
+                         (double)reply.calls_per_batch;
+        if (write_full(&sample, sizeof(sample)) != 0) break;
+    }
+    unload_kernel(&kernel);
+    return 0;
+}
+
+int main(void) {
+    // Keep the channel away from the standard streams the candidate may use
+    channel = fcntl(STDIN_FILENO, F_DUPFD_CLOEXEC, 3);
+    if (channel < 0) return 1;
+    int null_fd = open("/dev/null", O_RDWR);
+    if (null_fd >= 0) {
+        dup2(null_fd, STDIN_FILENO);
+        dup2(null_fd, STDOUT_FILENO);
+        dup2(null_fd, STDERR_FILENO);
+        if (null_fd > STDERR_FILENO) close(null_fd);
+    }
+
+    kernel_request_t request;
+    while (read_full(&request, sizeof(request)) == 0) {
+        request.library[sizeof(request.library) - 1] = '\0';
+        request.entry[sizeof(request.entry) - 1] = '\0';
+        if (serve(&request) != 0) break;
+    }
+    return 0;
+}
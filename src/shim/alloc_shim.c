@@ -0,0 +1,160 @@
+// LD_PRELOAD allocation profiler (libbeta_alloc.so).
+// Counts malloc/calloc/realloc/free calls, requested and peak live bytes and
+// a size histogram of the candidate it is preloaded into, and writes them as
+// one alloc_profile_t to the fd in ALLOC_PROFILE_FD_ENV at exit. Built on its
+// own by the Makefile; it must not use anything from the rest of the tree.
+#include "alloc_profile.h"
+#include <dlfcn.h>
+#include <errno.h>
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static void* (*real_malloc)(size_t);
+static void* (*real_calloc)(size_t, size_t);
+static void* (*real_realloc)(void *, size_t);
+static void (*real_free)(void *);
+static int (*real_posix_memalign)(void **, size_t, size_t);
+static void* (*real_aligned_alloc)(size_t, size_t);
+
+static alloc_profile_t profile;
+static int64_t live_bytes;
+static int resolving;
+
+// dlsym may allocate before the real functions are known; serve it from here
+static char bootstrap[8192] __attribute__((aligned(16)));
+static size_t bootstrap_used;
+
+static void* bootstrap_alloc(size_t size) {
+    size = (size + 15) & ~(size_t)15;
+    if (size > sizeof(bootstrap) - bootstrap_used) return NULL;
+    void *block = bootstrap + bootstrap_used;
+    bootstrap_used += size;
+    return block; // Static memory is already zeroed, which also serves calloc
+}
+
+static int is_bootstrap(const void *block) {
+    return (const char *)block >= bootstrap && (const char *)block < bootstrap + sizeof(bootstrap);
+}
+
+// Look up the next definitions of the allocation functions
+static void resolve(void) {
+    if (real_malloc || resolving) return;
+    resolving = 1;
+    real_calloc = (void* (*)(size_t, size_t))dlsym(RTLD_NEXT, "calloc");
+    real_realloc = (void* (*)(void *, size_t))dlsym(RTLD_NEXT, "realloc");
+    real_free = (void (*)(void *))dlsym(RTLD_NEXT, "free");
+    real_posix_memalign = (int (*)(void **, size_t, size_t))dlsym(RTLD_NEXT, "posix_memalign");
+    real_aligned_alloc = (void* (*)(size_t, size_t))dlsym(RTLD_NEXT, "aligned_alloc");
+    real_malloc = (void* (*)(size_t))dlsym(RTLD_NEXT, "malloc");
+    resolving = 0;
+}
+
+// Account one successful request of size bytes that holds usable bytes
+static void record_allocation(uint64_t size, int64_t usable) {
+    __atomic_fetch_add(&profile.allocated_bytes, size, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&profile.histogram[alloc_histogram_bucket(size)], 1, __ATOMIC_RELAXED);
+
+    int64_t live = __atomic_add_fetch(&live_bytes, usable, __ATOMIC_RELAXED);
+    uint64_t peak = __atomic_load_n(&profile.peak_live_bytes, __ATOMIC_RELAXED);
+    while (live > 0 && (uint64_t)live > peak &&
+           !__atomic_compare_exchange_n(&profile.peak_live_bytes, &peak, (uint64_t)live, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+void* malloc(size_t size) {
+    resolve();
+    if (!real_malloc) return bootstrap_alloc(size);
+
+    __atomic_fetch_add(&profile.malloc_calls, 1, __ATOMIC_RELAXED);
+    void *block = real_malloc(size);
+    if (block) record_allocation(size, (int64_t)malloc_usable_size(block));
+    return block;
+}
+
+void* calloc(size_t count, size_t size) {
+    resolve();
+    if (!real_calloc) return bootstrap_alloc(count * size);
+
+    __atomic_fetch_add(&profile.calloc_calls, 1, __ATOMIC_RELAXED);
+    void *block = real_calloc(count, size);
+    if (block) record_allocation((uint64_t)count * size, (int64_t)malloc_usable_size(block));
+    return block;
+}
+
+void* realloc(void *block, size_t size) {
+    resolve();
+    if (!real_realloc) return bootstrap_alloc(size);
+    if (is_bootstrap(block)) {
+        // Move a bootstrap block to the real heap; its size is at most what is left of the buffer
+        void *moved = malloc(size);
+        if (moved) {
+            size_t available = (size_t)(bootstrap + sizeof(bootstrap) - (char *)block);
+            memcpy(moved, block, size < available ? size : available);
+        }
+        return moved;
+    }
+
+    __atomic_fetch_add(&profile.realloc_calls, 1, __ATOMIC_RELAXED);
+    int64_t old_usable = block ? (int64_t)malloc_usable_size(block) : 0;
+    void *moved = real_realloc(block, size);
+    if (moved) {
+        __atomic_fetch_sub(&live_bytes, old_usable, __ATOMIC_RELAXED);
+        record_allocation(size, (int64_t)malloc_usable_size(moved));
+    } else if (size == 0 && block) {
+        __atomic_fetch_sub(&live_bytes, old_usable, __ATOMIC_RELAXED); // realloc(p, 0) freed p
+    }
+    return moved;
+}
+
+void free(void *block) {
+    if (!block || is_bootstrap(block)) return;
+    resolve();
+    if (!real_free) return;
+
+    __atomic_fetch_add(&profile.free_calls, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_sub(&live_bytes, (int64_t)malloc_usable_size(block), __ATOMIC_RELAXED);
+    real_free(block);
+}
+
+int posix_memalign(void **result, size_t alignment, size_t size) {
+    resolve();
+    if (!real_posix_memalign) return ENOMEM;
+
+    __atomic_fetch_add(&profile.malloc_calls, 1, __ATOMIC_RELAXED);
+    int status = real_posix_memalign(result, alignment, size);
+    if (status == 0) record_allocation(size, (int64_t)malloc_usable_size(*result));
+    return status;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    resolve();
+    if (!real_aligned_alloc) return NULL;
+
+    __atomic_fetch_add(&profile.malloc_calls, 1, __ATOMIC_RELAXED);
+    void *block = real_aligned_alloc(alignment, size);
+    if (block) record_allocation(size, (int64_t)malloc_usable_size(block));
+    return block;
+}
+
+__attribute__((constructor))
+static void alloc_shim_start(void) {
+    resolve();
+}
+
+// Report the totals to beta_evolve when the candidate exits normally
+__attribute__((destructor))
+static void alloc_shim_report(void) {
+    const char *fd_text = getenv(ALLOC_PROFILE_FD_ENV);
+    if (!fd_text) return;
+    int fd = atoi(fd_text);
+    if (fd < 0) return;
+
+    alloc_profile_t record = profile; // Other threads may still be running; totals are approximate then
+    record.magic = ALLOC_PROFILE_MAGIC;
+    record.pid = (int32_t)getpid();
+    ssize_t written = write(fd, &record, sizeof(record));
+    (void)written;
+}
@@ -0,0 +1,165 @@
+#include "arena.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_OWNED_BATCH 32
+
+// Strictest alignment of the basic types (max_align_t is C11)
+typedef union {
+    long long integer;
+    long double floating;
+    void *pointer;
+    void (*function)(void);
+} arena_align_t;
+
+#define ARENA_ALIGNMENT sizeof(arena_align_t)
+
+typedef struct arena_block {
+    struct arena_block *next;
+    size_t capacity;
+    size_t used;
+    arena_align_t data[];                        // Aligned storage follows the header
+} arena_block_t;
+
+// Heap pointers freed at the next reset, kept in batches
+typedef struct arena_owned {
+    struct arena_owned *next;
+    int count;
+    void *ptrs[ARENA_OWNED_BATCH];
+} arena_owned_t;
+
+struct arena {
+    arena_block_t *blocks;                       // Current block first
+    arena_owned_t *owned;
+    size_t block_size;
+    size_t used;                                 // Bytes handed out since the last reset
+    size_t peak;
+};
+
+// Round size up to the allocation alignment
+static size_t align_up(size_t size) {
+    return (size + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+}
+
+static arena_block_t* new_block(size_t capacity) {
+    arena_block_t *block = malloc(sizeof(arena_block_t) + capacity);
+    if (!block) return NULL;
+    block->next = NULL;
+    block->capacity = capacity;
+    block->used = 0;
+    return block;
+}
+
+// Create an arena whose blocks hold at least block_size bytes; the first block
+// is allocated by the first arena_alloc()
+arena_t* arena_create(size_t block_size) {
+    arena_t *arena = calloc(1, sizeof(arena_t));
+    if (!arena) return NULL;
+
+    arena->block_size = align_up(block_size < 4096 ? 4096 : block_size);
+    return arena;
+}
+
+// Free owned pointers and every block but the last (the first one created)
+static void release(arena_t *arena) {
+    while (arena->owned) {
+        arena_owned_t *batch = arena->owned;
+        arena->owned = batch->next;
+        for (int i = 0; i < batch->count; i++) {
+            free(batch->ptrs[i]);
+        }
+        free(batch);
+    }
+
+    while (arena->blocks && arena->blocks->next) {
+        arena_block_t *block = arena->blocks;
+        arena->blocks = block->next;
+        free(block);
+    }
+    if (arena->blocks) arena->blocks->used = 0;
+    arena->used = 0;
+}
+
+// Free every block and owned pointer, then the arena itself
+void arena_destroy(arena_t *arena) {
+    if (!arena) return;
+    release(arena);
+    free(arena->blocks);
+    free(arena);
+}
+
+// Release all allocations and owned pointers, keeping the first block
+void arena_reset(arena_t *arena) {
+    if (!arena) return;
+    release(arena);
+}
+
+// Allocate size bytes aligned for any type
+void* arena_alloc(arena_t *arena, size_t size) {
+    if (!arena) return NULL;
+
+    size_t needed = align_up(size ? size : 1);
+    arena_block_t *block = arena->blocks;
+    if (!block || block->capacity - block->used < needed) {
+        // Oversized requests get a block of their own
+        block = new_block(needed > arena->block_size ? needed : arena->block_size);
+        if (!block) return NULL;
+        block->next = arena->blocks;
+        arena->blocks = block;
+    }
+
+    void *ptr = (char *)block->data + block->used;
+    block->used += needed;
+    arena->used += needed;
+    if (arena->used > arena->peak) arena->peak = arena->used;
+    return ptr;
+}
+
+// Allocate size zeroed bytes
+void* arena_calloc(arena_t *arena, size_t size) {
+    void *ptr = arena_alloc(arena, size);
+    if (ptr) memset(ptr, 0, size);
+    return ptr;
+}
+
+// Copy the first length bytes of text into the arena
+char* arena_strndup(arena_t *arena, const char *text, size_t length) {
+    if (!text) return NULL;
+    char *copy = arena_alloc(arena, length + 1);
+    if (!copy) return NULL;
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+// Copy a string into the arena
+char* arena_strdup(arena_t *arena, const char *text) {
+    return text ? arena_strndup(arena, text, strlen(text)) : NULL;
+}
+
+// Free ptr (from malloc) at the next reset
+void* arena_own(arena_t *arena, void *ptr) {
+    if (!ptr) return NULL;
+    if (!arena) return ptr;
+
+    if (!arena->owned || arena->owned->count == ARENA_OWNED_BATCH) {
+        arena_owned_t *batch = malloc(sizeof(arena_owned_t));
+        if (!batch) return ptr; // Out of memory: ptr leaks rather than being freed early
+        batch->next = arena->owned;
+        batch->count = 0;
+        arena->owned = batch;
+    }
+    arena->owned->ptrs[arena->owned->count++] = ptr;
+    return ptr;
+}
+
+// Bytes handed out since the last reset
+size_t arena_used(const arena_t *arena) {
+    return arena ? arena->used : 0;
+}
+
+// Largest number of bytes handed out between two resets
+size_t arena_peak(const arena_t *arena) {
+    return arena ? arena->peak : 0;
+}
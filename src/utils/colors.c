@@ -191,7 +191,8 @@ void print_code_block(const char* code, const char* language) {
     
     // Split code into lines and print with line numbers
     char* code_copy = strdup(code);
-    char* line = strtok(code_copy, "\n");
+    char* saveptr = NULL;
+    char* line = code_copy ? strtok_r(code_copy, "\n", &saveptr) : NULL;
     int line_num = 1;
     
     while (line) {
@@ -199,7 +200,7 @@ void print_code_block(const char* code, const char* language) {
                C_SUBTLE, C_RESET,
                C_DIM, line_num, C_RESET,
                line);
-        line = strtok(NULL, "\n");
+        line = strtok_r(NULL, "\n", &saveptr);
         line_num++;
     }
     
@@ -50,6 +50,12 @@ static int dstring_expand(dstring_t* ds, size_t needed_capacity) {
     return 0;
 }
 
+// Make room for at least capacity bytes (including the terminator) without changing the content
+int dstring_reserve(dstring_t* ds, size_t capacity) {
+    if (!ds) return -1;
+    return dstring_expand(ds, capacity);
+}
+
 // Append a string to the dynamic string
 int dstring_append(dstring_t* ds, const char* str) {
     if (!ds || !str) return -1;
@@ -67,6 +73,21 @@ int dstring_append(dstring_t* ds, const char* str) {
     return 0;
 }
 
+// Append length bytes from data (which need not be NUL terminated)
+int dstring_append_len(dstring_t* ds, const char* data, size_t length) {
+    if (!ds || (!data && length > 0)) return -1;
+    
+    if (dstring_expand(ds, ds->length + length + 1) != 0) {
+        return -1;
+    }
+    
+    memcpy(ds->data + ds->length, data, length);
+    ds->length += length;
+    ds->data[ds->length] = '\0';
+    
+    return 0;
+}
+
 // Append formatted string to the dynamic string
 int dstring_append_format(dstring_t* ds, const char* format, ...) {
     if (!ds || !format) return -1;
@@ -107,6 +128,15 @@ void dstring_clear(dstring_t* ds) {
     ds->length = 0;
 }
 
+// Destroy the dynamic string and hand its buffer to the caller, who must free() it
+char* dstring_steal(dstring_t* ds) {
+    if (!ds) return NULL;
+    
+    char *data = ds->data;
+    free(ds);
+    return data;
+}
+
 // Get the string content (read-only)
 char* dstring_get(const dstring_t* ds) {
     if (!ds || !ds->data) return NULL;
@@ -2,7 +2,7 @@
 #include <string.h>
 
 // Create a chat request JSON object using cJSON
-cJSON* json_create_chat_request(const char *model, const char *message, double temperature) {
+cJSON* json_create_chat_request(const char *model, const char *message, double temperature, bool stream) {
     cJSON *request = cJSON_CreateObject();
     if (!request) return NULL;
     
@@ -54,6 +54,11 @@ cJSON* json_create_chat_request(const char *model, const char *message, double t
         cJSON_AddItemToObject(request, "temperature", temp);
     }
     
+    // Ask for server-sent event deltas instead of a single completion
+    if (stream) {
+        cJSON_AddItemToObject(request, "stream", cJSON_CreateTrue());
+    }
+    
     return request;
 }
 
@@ -77,3 +82,24 @@ const char* json_extract_chat_response(cJSON *response) {
     
     return cJSON_GetStringValue(content);
 }
+
+// Extract delta content from a streamed chat completion chunk
+const char* json_extract_chat_delta(cJSON *chunk) {
+    if (!chunk) return NULL;
+    
+    cJSON *choices = cJSON_GetObjectItem(chunk, "choices");
+    if (!choices || !cJSON_IsArray(choices) || cJSON_GetArraySize(choices) == 0) {
+        return NULL;
+    }
+    
+    cJSON *first_choice = cJSON_GetArrayItem(choices, 0);
+    if (!first_choice) return NULL;
+    
+    cJSON *delta = cJSON_GetObjectItem(first_choice, "delta");
+    if (!delta) return NULL;
+    
+    cJSON *content = cJSON_GetObjectItem(delta, "content");
+    if (!content || !cJSON_IsString(content)) return NULL;
+    
+    return cJSON_GetStringValue(content);
+}
@@ -0,0 +1,279 @@
+#include "log_writer.h"
+#include <pthread.h>
+#include <spawn.h>
+#include <stdint.h>
+#include <sys/wait.h>
+
+extern char **environ;
+
+static struct {
+    int enabled;
+    int level;                                   // Highest level written
+    int prompt_hashes;
+    int compress;
+    size_t rotate_bytes;                         // 0 = never rotate
+    int max_files;
+    char path[512];
+    FILE *file;
+    size_t file_bytes;
+    char *pending;                               // Records queued by producers
+    size_t pending_length;
+    char *writing;                               // Records being written by the thread
+    size_t capacity;                             // Size of each buffer
+    long dropped;                                // Records rejected since the last write
+    long total_dropped;
+    int stop;
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t available;
+} writer = { .mutex = PTHREAD_MUTEX_INITIALIZER, .available = PTHREAD_COND_INITIALIZER };
+
+// FNV-1a of a prompt, so repeated prompts can be matched without storing them
+static uint64_t content_hash(const char *text) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (const unsigned char *p = (const unsigned char *)text; *p; p++) {
+        hash ^= *p;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Queue the concatenation of parts as one record, or drop it if the queue is full
+static void enqueue(const char **parts, const size_t *lengths, int count) {
+    size_t total = 0;
+    for (int i = 0; i < count; i++) total += lengths[i];
+
+    pthread_mutex_lock(&writer.mutex);
+    if (!writer.enabled || writer.pending_length + total > writer.capacity) {
+        if (writer.enabled) writer.dropped++;
+        pthread_mutex_unlock(&writer.mutex);
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        memcpy(writer.pending + writer.pending_length, parts[i], lengths[i]);
+        writer.pending_length += lengths[i];
+    }
+    pthread_cond_signal(&writer.available);
+    pthread_mutex_unlock(&writer.mutex);
+}
+
+// Rotated file name for generation n (n >= 1)
+static void rotated_path(int n, int compressed, char *out, size_t out_size) {
+    snprintf(out, out_size, "%s.%d%s", writer.path, n, compressed ? ".gz" : "");
+}
+
+// Compress path in place with gzip, waiting for it (runs on the writer thread)
+static void compress_file(const char *path) {
+    char *argv[] = { "gzip", "-f", (char *)path, NULL };
+    pid_t pid;
+    if (posix_spawnp(&pid, "gzip", NULL, NULL, argv, environ) != 0) {
+        fprintf(stderr, "Warning: Cannot run gzip on %s\n", path);
+        return;
+    }
+    int status;
+    waitpid(pid, &status, 0);
+}
+
+// Shift <path>.1 ... .N up by one, move the current file to .1 and start a new one
+static void rotate(void) {
+    fclose(writer.file);
+    writer.file = NULL;
+
+    char from[600], to[600];
+    for (int compressed = 0; compressed <= 1; compressed++) {
+        rotated_path(writer.max_files, compressed, from, sizeof(from));
+        remove(from);
+        for (int n = writer.max_files - 1; n >= 1; n--) {
+            rotated_path(n, compressed, from, sizeof(from));
+            rotated_path(n + 1, compressed, to, sizeof(to));
+            rename(from, to);
+        }
+    }
+    if (writer.max_files > 0) {
+        rotated_path(1, 0, to, sizeof(to));
+        rename(writer.path, to);
+        if (writer.compress) compress_file(to);
+    }
+
+    writer.file = fopen(writer.path, "w");
+    writer.file_bytes = 0;
+    if (!writer.file) {
+        fprintf(stderr, "Warning: Cannot reopen log file %s after rotation\n", writer.path);
+    }
+}
+
+// Background thread: write whatever has been queued, then wait for more
+static void* writer_thread(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&writer.mutex);
+    for (;;) {
+        while (writer.pending_length == 0 && writer.dropped == 0 && !writer.stop) {
+            pthread_cond_wait(&writer.available, &writer.mutex);
+        }
+        if (writer.pending_length == 0 && writer.dropped == 0 && writer.stop) break;
+
+        // Swap buffers so producers keep queuing while this batch is written
+        char *batch = writer.pending;
+        size_t length = writer.pending_length;
+        long dropped = writer.dropped;
+        writer.pending = writer.writing;
+        writer.writing = batch;
+        writer.pending_length = 0;
+        writer.dropped = 0;
+        writer.total_dropped += dropped;
+        pthread_mutex_unlock(&writer.mutex);
+
+        if (writer.file) {
+            if (dropped > 0) {
+                writer.file_bytes += fprintf(writer.file, "[... %ld log records dropped, queue full ...]\n", dropped);
+            }
+            writer.file_bytes += fwrite(batch, 1, length, writer.file);
+            fflush(writer.file);
+            if (writer.rotate_bytes > 0 && writer.file_bytes >= writer.rotate_bytes) {
+                rotate();
+            }
+        }
+
+        pthread_mutex_lock(&writer.mutex);
+    }
+    pthread_mutex_unlock(&writer.mutex);
+    return NULL;
+}
+
+// Truncate the log file and start the writer thread
+int log_writer_init(config_t *config) {
+    if (!config || strlen(config->log_file) == 0) return 0;
+
+    writer.capacity = (size_t)config->log_queue_kb * 1024;
+    writer.pending = malloc(writer.capacity);
+    writer.writing = malloc(writer.capacity);
+    writer.file = fopen(config->log_file, "w");
+    if (!writer.pending || !writer.writing || !writer.file) {
+        fprintf(stderr, "Warning: Cannot open log file %s, logging to it is disabled\n", config->log_file);
+        free(writer.pending);
+        free(writer.writing);
+        if (writer.file) fclose(writer.file);
+        writer.pending = writer.writing = NULL;
+        writer.file = NULL;
+        return -1;
+    }
+
+    snprintf(writer.path, sizeof(writer.path), "%s", config->log_file);
+    writer.level = config->log_level;
+    writer.prompt_hashes = config->log_prompt_hashes;
+    writer.compress = config->log_compress;
+    writer.rotate_bytes = (size_t)config->log_rotate_mb * 1024 * 1024;
+    writer.max_files = config->log_max_files;
+    writer.file_bytes = 0;
+    writer.pending_length = 0;
+    writer.dropped = writer.total_dropped = 0;
+    writer.stop = 0;
+
+    if (pthread_create(&writer.thread, NULL, writer_thread, NULL) != 0) {
+        fprintf(stderr, "Warning: Cannot start log writer thread, logging to %s is disabled\n", config->log_file);
+        fclose(writer.file);
+        free(writer.pending);
+        free(writer.writing);
+        writer.pending = writer.writing = NULL;
+        writer.file = NULL;
+        return -1;
+    }
+    writer.enabled = 1;
+    return 0;
+}
+
+// Write everything still queued and stop the writer thread
+void log_writer_shutdown(void) {
+    pthread_mutex_lock(&writer.mutex);
+    if (!writer.enabled) {
+        pthread_mutex_unlock(&writer.mutex);
+        return;
+    }
+    writer.enabled = 0;
+    writer.stop = 1;
+    pthread_cond_signal(&writer.available);
+    pthread_mutex_unlock(&writer.mutex);
+
+    pthread_join(writer.thread, NULL);
+    if (writer.total_dropped > 0) {
+        fprintf(stderr, "Warning: %ld log records were dropped because the log queue was full\n",
+                writer.total_dropped);
+    }
+
+    if (writer.file) fclose(writer.file);
+    free(writer.pending);
+    free(writer.writing);
+    writer.file = NULL;
+    writer.pending = writer.writing = NULL;
+}
+
+// Whether a record at level would be written
+int log_writer_enabled(int level) {
+    return writer.enabled && level <= writer.level;
+}
+
+// Remove terminal escape sequences (ESC [ ... letter) in place; returns the new length
+static size_t strip_colors(char *text, size_t length) {
+    size_t out = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (text[i] == '\033' && i + 1 < length && text[i + 1] == '[') {
+            i += 2;
+            while (i < length && !((text[i] >= 'A' && text[i] <= 'Z') || (text[i] >= 'a' && text[i] <= 'z'))) i++;
+            continue;
+        }
+        text[out++] = text[i];
+    }
+    return out;
+}
+
+// Queue a formatted record
+void log_writer_vprintf(int level, const char *format, va_list args) {
+    if (!log_writer_enabled(level) || !format) return;
+
+    char stack_buffer[1024];
+    char *buffer = stack_buffer;
+    va_list copy;
+    va_copy(copy, args);
+    int length = vsnprintf(stack_buffer, sizeof(stack_buffer), format, copy);
+    va_end(copy);
+    if (length < 0) return;
+
+    if ((size_t)length >= sizeof(stack_buffer)) {
+        buffer = malloc(length + 1);
+        if (!buffer) return;
+        vsnprintf(buffer, length + 1, format, args);
+    }
+
+    size_t stripped = strip_colors(buffer, length);
+    const char *parts[] = { buffer };
+    size_t lengths[] = { stripped };
+    enqueue(parts, lengths, 1);
+
+    if (buffer != stack_buffer) free(buffer);
+}
+
+void log_writer_printf(int level, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    log_writer_vprintf(level, format, args);
+    va_end(args);
+}
+
+// Queue one prompt/response exchange of an agent
+void log_writer_exchange(agent_type_t agent, const char *prompt, const char *response) {
+    if (!log_writer_enabled(VERBOSITY_NORMAL)) return;
+
+    const char *agent_line = agent == AGENT_FAST ? "Agent: Fast\nPrompt: " : "Agent: Reasoning\nPrompt: ";
+    char prompt_hash[96];
+    if (!prompt) prompt = "";
+    if (writer.prompt_hashes) {
+        snprintf(prompt_hash, sizeof(prompt_hash), "[fnv1a64 %016llx, %zu bytes]",
+                 (unsigned long long)content_hash(prompt), strlen(prompt));
+        prompt = prompt_hash;
+    }
+    if (!response) response = "No response";
+
+    const char *parts[] = { agent_line, prompt, "\nResponse: ", response, "\n\n" };
+    size_t lengths[] = { strlen(agent_line), strlen(prompt), 11, strlen(response), 2 };
+    enqueue(parts, lengths, 5);
+}
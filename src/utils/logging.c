@@ -1,12 +1,26 @@
 #include "beta_evolve.h"
+#include "log_writer.h"
 
-// Log a message based on verbosity level
+// Log a message based on verbosity level, mirroring it to the log file
 void log_message(config_t *config, int level, const char* format, ...) {
-    if (!config || !format || level > config->verbosity) {
+    if (!config || !format) return;
+    
+    // Gate before formatting anything
+    int to_file = log_writer_enabled(level);
+    if (level > config->verbosity && !to_file) {
         return;
     }
     
     va_list args;
+    if (to_file) {
+        va_start(args, format);
+        log_writer_vprintf(level, format, args);
+        va_end(args);
+    }
+    if (level > config->verbosity) {
+        return;
+    }
+    
     va_start(args, format);
     
     // Choose appropriate prefix and color based on level
@@ -0,0 +1,602 @@
+#include "process.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+// Messages that identify an allocation failure under RLIMIT_AS
+static const char *oom_markers[] = {
+    "Cannot allocate memory", "out of memory", "Out of memory", "bad_alloc",
+    "memory exhausted", "allocation failed", NULL
+};
+
+// Run slots shared by every thread; the key counts the slots a thread holds
+static pthread_mutex_t slot_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t slot_free = PTHREAD_COND_INITIALIZER;
+static pthread_once_t slot_once = PTHREAD_ONCE_INIT;
+static pthread_key_t slot_depth_key;
+static int slot_limit = 0;
+static int slots_used = 0;
+
+// Milliseconds between two monotonic timestamps
+static double elapsed_ms(const struct timespec *start, const struct timespec *end) {
+    return (end->tv_sec - start->tv_sec) * 1000.0 + (end->tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+// Milliseconds left before the wall-time limit (-1 = no limit)
+static int remaining_ms(const process_limits_t *limits, const struct timespec *start) {
+    if (!limits || limits->wall_time_ms <= 0) return -1;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double left = limits->wall_time_ms - elapsed_ms(start, &now);
+    return left > 0 ? (int)left + 1 : 0;
+}
+
+// Name of a status for reports and logs
+const char* process_status_name(process_status_t status) {
+    switch (status) {
+        case PROCESS_OK: return "ok";
+        case PROCESS_CRASHED: return "crashed";
+        case PROCESS_TIMEOUT: return "timeout";
+        case PROCESS_OOM: return "OOM";
+        case PROCESS_OUTPUT_LIMIT: return "output limit";
+        case PROCESS_SPAWN_FAILED: return "spawn failed";
+        case PROCESS_CANCELLED: return "cancelled";
+        default: return "unknown";
+    }
+}
+
+// Start a new process group and apply resource limits (child side)
+void process_apply_limits(const process_limits_t *limits) {
+    setpgid(0, 0);
+
+    // Crashing candidates should not litter the workspace with core files
+    struct rlimit no_core = { 0, 0 };
+    setrlimit(RLIMIT_CORE, &no_core);
+
+    if (!limits) return;
+
+    if (limits->cpu_time_s > 0) {
+        // SIGXCPU at the soft limit, SIGKILL one second later
+        struct rlimit cpu = { (rlim_t)limits->cpu_time_s, (rlim_t)limits->cpu_time_s + 1 };
+        setrlimit(RLIMIT_CPU, &cpu);
+    }
+
+    if (limits->memory_mb > 0) {
+        rlim_t bytes = (rlim_t)limits->memory_mb * 1024 * 1024;
+        struct rlimit memory = { bytes, bytes };
+        setrlimit(RLIMIT_AS, &memory);
+    }
+
+    if (limits->max_processes > 0) {
+        // Stops fork bombs; the kernel checks it against every process of the real user
+        struct rlimit processes = { (rlim_t)limits->max_processes, (rlim_t)limits->max_processes };
+        setrlimit(RLIMIT_NPROC, &processes);
+    }
+}
+
+// Whether the run was cancelled through limits->cancel_fd
+static int cancel_requested(const process_limits_t *limits) {
+    if (!limits || limits->cancel_fd <= 0) return 0;
+    struct pollfd pfd = { limits->cancel_fd, POLLIN, 0 };
+    return poll(&pfd, 1, 0) > 0;
+}
+
+// Wait until pid has exited without reaping it; returns 1 on exit, 0 on timeout, -1 when cancelled
+static int wait_for_exit(pid_t pid, const process_limits_t *limits, const struct timespec *start) {
+    int has_cancel = limits && limits->cancel_fd > 0;
+#if defined(__linux__) && defined(SYS_pidfd_open)
+    // A pidfd wakes us the moment the child exits
+    int pidfd = (int)syscall(SYS_pidfd_open, pid, 0);
+    if (pidfd >= 0) {
+        struct pollfd pfds[2] = { { pidfd, POLLIN, 0 }, { has_cancel ? limits->cancel_fd : -1, POLLIN, 0 } };
+        int ready;
+        do {
+            ready = poll(pfds, 2, remaining_ms(limits, start));
+        } while (ready < 0 && errno == EINTR);
+        close(pidfd);
+        if (ready > 0 && !(pfds[0].revents & POLLIN) && (pfds[1].revents & POLLIN)) return -1;
+        return ready != 0;
+    }
+#endif
+
+    // Portable fallback: poll the child's state every millisecond
+    for (;;) {
+        siginfo_t info;
+        memset(&info, 0, sizeof(info));
+        if (waitid(P_PID, pid, &info, WEXITED | WNOHANG | WNOWAIT) != 0 && errno != EINTR) return 1;
+        if (info.si_pid == pid) return 1;
+        if (remaining_ms(limits, start) == 0) return 0;
+        if (has_cancel && cancel_requested(limits)) return -1;
+
+        struct timespec pause = { 0, 1000000 };
+        nanosleep(&pause, NULL);
+    }
+}
+
+// Wait for pid under the wall-time limit, killing its group when exceeded
+process_status_t process_wait(pid_t pid, const process_limits_t *limits, const struct timespec *start,
+                              int *status, struct rusage *usage) {
+    int local_status = 0;
+    struct rusage local_usage;
+    if (!status) status = &local_status;
+    if (!usage) usage = &local_usage;
+    memset(usage, 0, sizeof(struct rusage));
+
+    // Also set from the parent so killpg cannot race the child's setpgid
+    setpgid(pid, pid);
+
+    int exited = wait_for_exit(pid, limits, start);
+
+    // Kill the whole group: the limit was hit, or the child left background processes behind
+    killpg(pid, SIGKILL);
+
+    while (wait4(pid, status, 0, usage) < 0) {
+        if (errno != EINTR) return PROCESS_SPAWN_FAILED;
+    }
+
+    if (exited < 0) return PROCESS_CANCELLED;
+    if (!exited) return PROCESS_TIMEOUT;
+
+    int signal_number = 0;
+    if (WIFSIGNALED(*status)) {
+        signal_number = WTERMSIG(*status);
+    } else if (WIFEXITED(*status) && WEXITSTATUS(*status) > 128) {
+        signal_number = WEXITSTATUS(*status) - 128; // Reported by an intermediate shell
+    }
+
+    double cpu_seconds = usage->ru_utime.tv_sec + usage->ru_stime.tv_sec +
+                         (usage->ru_utime.tv_usec + usage->ru_stime.tv_usec) / 1000000.0;
+
+    if (signal_number == SIGXCPU) return PROCESS_TIMEOUT;
+    if (signal_number == SIGKILL) {
+        // Nobody but the kernel sent it: the CPU hard limit or the OOM killer
+        if (limits && limits->cpu_time_s > 0 && cpu_seconds >= limits->cpu_time_s) return PROCESS_TIMEOUT;
+        return PROCESS_OOM;
+    }
+    if (WIFSIGNALED(*status)) return PROCESS_CRASHED;
+    return PROCESS_OK;
+}
+
+// Allocate the head buffer and tail ring of a stream, splitting keep_bytes between them
+static int stream_init(process_stream_t *stream, size_t keep_bytes) {
+    memset(stream, 0, sizeof(process_stream_t));
+    stream->head_size = keep_bytes / 2;
+    stream->tail_size = keep_bytes - stream->head_size;
+    if (keep_bytes == 0) return 0;
+
+    stream->head = malloc(stream->head_size + 1);
+    stream->tail = malloc(stream->tail_size + 1);
+    if (!stream->head || !stream->tail) {
+        free(stream->head);
+        free(stream->tail);
+        stream->head = stream->tail = NULL;
+        return -1;
+    }
+    stream->head[0] = '\0';
+    return 0;
+}
+
+// Keep data in the head until it is full, then in the tail ring
+static void stream_append(process_stream_t *stream, const char *data, size_t length) {
+    stream->total_bytes += length;
+    if (!stream->head) return;
+
+    size_t to_head = stream->head_size - stream->head_length;
+    if (to_head > length) to_head = length;
+    memcpy(stream->head + stream->head_length, data, to_head);
+    stream->head_length += to_head;
+    stream->head[stream->head_length] = '\0';
+    data += to_head;
+    length -= to_head;
+
+    if (length == 0 || stream->tail_size == 0) return;
+
+    // Only the last tail_size bytes can survive
+    if (length > stream->tail_size) {
+        data += length - stream->tail_size;
+        length = stream->tail_size;
+    }
+    while (length > 0) {
+        size_t chunk = stream->tail_size - stream->tail_pos;
+        if (chunk > length) chunk = length;
+        memcpy(stream->tail + stream->tail_pos, data, chunk);
+        stream->tail_pos = (stream->tail_pos + chunk) % stream->tail_size;
+        stream->tail_length = stream->tail_length + chunk > stream->tail_size ? stream->tail_size
+                                                                             : stream->tail_length + chunk;
+        data += chunk;
+        length -= chunk;
+    }
+}
+
+// Copy the last count bytes of the tail ring into dest
+static void stream_copy_tail(const process_stream_t *stream, size_t count, char *dest) {
+    size_t start = (stream->tail_pos + stream->tail_size - count) % stream->tail_size;
+    size_t first = stream->tail_size - start < count ? stream->tail_size - start : count;
+    memcpy(dest, stream->tail + start, first);
+    memcpy(dest + first, stream->tail, count - first);
+}
+
+// Render head, omission marker and tail into dest
+size_t process_stream_text(const process_stream_t *stream, char *dest, size_t dest_size) {
+    if (!dest || dest_size == 0) return 0;
+    dest[0] = '\0';
+    if (!stream || !stream->head) return 0;
+
+    size_t space = dest_size - 1;
+    size_t kept = stream->head_length + stream->tail_length;
+    size_t omitted = stream->total_bytes - kept;
+
+    // Everything that was written fits: no marker
+    if (omitted == 0 && kept <= space) {
+        memcpy(dest, stream->head, stream->head_length);
+        if (stream->tail_length > 0) stream_copy_tail(stream, stream->tail_length, dest + stream->head_length);
+        dest[kept] = '\0';
+        return kept;
+    }
+
+    // Sized for the largest possible number of omitted bytes
+    char marker[96];
+    int marker_length = snprintf(marker, sizeof(marker), "\n[... %zu bytes omitted ...]\n", stream->total_bytes);
+    if ((size_t)marker_length >= space) {
+        size_t length = stream->head_length < space ? stream->head_length : space;
+        memcpy(dest, stream->head, length);
+        dest[length] = '\0';
+        return length;
+    }
+
+    size_t budget = space - (size_t)marker_length;
+    size_t head = stream->head_length < budget / 2 ? stream->head_length : budget / 2;
+    size_t tail = stream->tail_length < budget - head ? stream->tail_length : budget - head;
+    if (head + tail < budget && head < stream->head_length) {
+        head = stream->head_length < budget - tail ? stream->head_length : budget - tail;
+    }
+    marker_length = snprintf(marker, sizeof(marker), "\n[... %zu bytes omitted ...]\n",
+                             stream->total_bytes - head - tail);
+
+    memcpy(dest, stream->head, head);
+    memcpy(dest + head, marker, (size_t)marker_length);
+    if (tail > 0) stream_copy_tail(stream, tail, dest + head + marker_length);
+    size_t length = head + (size_t)marker_length + tail;
+    dest[length] = '\0';
+    return length;
+}
+
+// Free the buffers of a capture
+void process_capture_free(process_capture_t *capture) {
+    if (!capture) return;
+    free(capture->out.head);
+    free(capture->out.tail);
+    free(capture->err.head);
+    free(capture->err.tail);
+    memset(capture, 0, sizeof(process_capture_t));
+}
+
+// Whether a kept part of a stream shows an allocation failure (markers split
+// across the head/tail boundary or the ring wrap are not seen)
+static int stream_shows_oom(const process_stream_t *stream) {
+    if (!stream->head) return 0;
+
+    const char *parts[3] = { stream->head, stream->tail, stream->tail };
+    size_t lengths[3] = { stream->head_length, 0, 0 };
+    if (stream->tail_length == stream->tail_size) {
+        lengths[1] = stream->tail_size - stream->tail_pos;
+        parts[1] = stream->tail + stream->tail_pos;
+        lengths[2] = stream->tail_pos;
+    } else {
+        lengths[1] = stream->tail_length;
+    }
+
+    for (int part = 0; part < 3; part++) {
+        for (int i = 0; oom_markers[i]; i++) {
+            if (lengths[part] > 0 && memmem(parts[part], lengths[part], oom_markers[i], strlen(oom_markers[i]))) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+// Open a close-on-exec pipe, so concurrent spawns do not hold our ends open
+static int open_pipe(int fds[2]) {
+#ifdef __linux__
+    return pipe2(fds, O_CLOEXEC);
+#else
+    if (pipe(fds) != 0) return -1;
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    return 0;
+#endif
+}
+
+// Start /bin/sh -c command with stdin from /dev/null and stdout/stderr on the
+// given pipe ends. posix_spawn avoids copying the page tables of a large
+// parent; fork is only needed when resource limits must be set in the child.
+static pid_t spawn_shell(const char *command, const process_limits_t *limits, int out_fd, int err_fd) {
+    extern char **environ;
+    int needs_rlimits = limits && (limits->cpu_time_s > 0 || limits->memory_mb > 0 || limits->max_processes > 0);
+
+    if (!needs_rlimits) {
+        posix_spawnattr_t attr;
+        posix_spawn_file_actions_t actions;
+        if (posix_spawnattr_init(&attr) != 0) return -1;
+        if (posix_spawn_file_actions_init(&actions) != 0) {
+            posix_spawnattr_destroy(&attr);
+            return -1;
+        }
+        posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP);
+        posix_spawnattr_setpgroup(&attr, 0);
+        posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+        posix_spawn_file_actions_adddup2(&actions, out_fd, STDOUT_FILENO);
+        posix_spawn_file_actions_adddup2(&actions, err_fd, STDERR_FILENO);
+
+        char *argv[] = { "sh", "-c", (char *)command, NULL };
+        pid_t pid;
+        int error = posix_spawn(&pid, "/bin/sh", &actions, &attr, argv, environ);
+        posix_spawn_file_actions_destroy(&actions);
+        posix_spawnattr_destroy(&attr);
+        return error == 0 ? pid : -1;
+    }
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        process_apply_limits(limits);
+
+        int null_fd = open("/dev/null", O_RDONLY);
+        if (null_fd >= 0) {
+            dup2(null_fd, STDIN_FILENO);
+            close(null_fd);
+        }
+        dup2(out_fd, STDOUT_FILENO);
+        dup2(err_fd, STDERR_FILENO);
+
+        execl("/bin/sh", "sh", "-c", command, (char *)NULL);
+        _exit(127);
+    }
+    return pid;
+}
+
+static void slot_key_create(void) {
+    pthread_key_create(&slot_depth_key, NULL);
+}
+
+// Allow at most slots commands to run at once
+void process_set_slots(int slots) {
+    pthread_mutex_lock(&slot_mutex);
+    slot_limit = slots > 0 ? slots : 0;
+    pthread_cond_broadcast(&slot_free);
+    pthread_mutex_unlock(&slot_mutex);
+}
+
+// Take a run slot; nested runs of the same thread (a benchmark compiling) reuse it
+int process_slot_acquire(const process_limits_t *limits) {
+    pthread_once(&slot_once, slot_key_create);
+    intptr_t depth = (intptr_t)pthread_getspecific(slot_depth_key);
+    if (depth > 0) {
+        pthread_setspecific(slot_depth_key, (void *)(depth + 1));
+        return 0;
+    }
+
+    pthread_mutex_lock(&slot_mutex);
+    while (slot_limit > 0 && slots_used >= slot_limit) {
+        // Wake up now and then to notice a cancelled run
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += 50 * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&slot_free, &slot_mutex, &deadline);
+        if (cancel_requested(limits)) {
+            pthread_mutex_unlock(&slot_mutex);
+            return -1;
+        }
+    }
+    slots_used++;
+    pthread_mutex_unlock(&slot_mutex);
+    pthread_setspecific(slot_depth_key, (void *)1);
+    return 0;
+}
+
+// Give back a run slot
+void process_slot_release(void) {
+    pthread_once(&slot_once, slot_key_create);
+    intptr_t depth = (intptr_t)pthread_getspecific(slot_depth_key);
+    if (depth <= 0) return;
+    pthread_setspecific(slot_depth_key, (void *)(depth - 1));
+    if (depth > 1) return;
+
+    pthread_mutex_lock(&slot_mutex);
+    slots_used--;
+    pthread_cond_signal(&slot_free);
+    pthread_mutex_unlock(&slot_mutex);
+}
+
+// Run a shell command under limits, capturing stdout and stderr separately (holding a slot)
+static int capture_command(const char *command, const process_limits_t *limits, size_t keep_bytes,
+                           process_capture_t *capture, process_result_t *result) {
+    process_result_t local_result;
+    if (!result) result = &local_result;
+    memset(result, 0, sizeof(process_result_t));
+    result->status = PROCESS_SPAWN_FAILED;
+    result->exit_code = -1;
+
+    process_capture_t local_capture;
+    if (!capture) {
+        capture = &local_capture;
+        keep_bytes = 0;
+    }
+    if (!command) {
+        memset(capture, 0, sizeof(process_capture_t));
+        return -1;
+    }
+    if (stream_init(&capture->out, keep_bytes) != 0 || stream_init(&capture->err, keep_bytes) != 0) {
+        process_capture_free(capture);
+        return -1;
+    }
+
+    // The caller frees its own capture; a local one is freed on every exit
+    int out_pipe[2], err_pipe[2];
+    if (open_pipe(out_pipe) != 0) {
+        if (capture == &local_capture) process_capture_free(capture);
+        return -1;
+    }
+    if (open_pipe(err_pipe) != 0) {
+        close(out_pipe[0]);
+        close(out_pipe[1]);
+        if (capture == &local_capture) process_capture_free(capture);
+        return -1;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    pid_t pid = spawn_shell(command, limits, out_pipe[1], err_pipe[1]);
+    close(out_pipe[1]);
+    close(err_pipe[1]);
+    if (pid < 0) {
+        close(out_pipe[0]);
+        close(err_pipe[0]);
+        if (capture == &local_capture) process_capture_free(capture);
+        return -1;
+    }
+
+    // Drain both streams until EOF, keeping head and tail and counting the rest
+    int cancel_fd = limits && limits->cancel_fd > 0 ? limits->cancel_fd : -1;
+    struct pollfd pfds[3] = { { out_pipe[0], POLLIN, 0 }, { err_pipe[0], POLLIN, 0 }, { cancel_fd, POLLIN, 0 } };
+    process_stream_t *streams[2] = { &capture->out, &capture->err };
+    int open_streams = 2;
+    int killed = 0;
+    char buffer[16384];
+    while (open_streams > 0 && !killed) {
+        int ready = poll(pfds, 3, remaining_ms(limits, &start));
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready <= 0) {
+            killed = PROCESS_TIMEOUT;
+            break;
+        }
+        if (pfds[2].revents & POLLIN) {
+            killed = PROCESS_CANCELLED;
+            break;
+        }
+
+        for (int i = 0; i < 2; i++) {
+            if (pfds[i].fd < 0 || !(pfds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+
+            ssize_t count = read(pfds[i].fd, buffer, sizeof(buffer));
+            if (count < 0 && errno == EINTR) continue;
+            if (count <= 0) {
+                close(pfds[i].fd);
+                pfds[i].fd = -1; // poll ignores negative descriptors
+                open_streams--;
+                continue;
+            }
+
+            stream_append(streams[i], buffer, (size_t)count);
+            result->output_bytes += (size_t)count;
+            if (limits && limits->output_bytes > 0 && result->output_bytes > limits->output_bytes) {
+                killed = PROCESS_OUTPUT_LIMIT;
+                break;
+            }
+        }
+    }
+    for (int i = 0; i < 2; i++) {
+        if (pfds[i].fd >= 0) close(pfds[i].fd);
+    }
+    result->stdout_bytes = capture->out.total_bytes;
+    result->stderr_bytes = capture->err.total_bytes;
+
+    if (killed) {
+        killpg(pid, SIGKILL);
+    }
+
+    int status = 0;
+    struct rusage usage;
+    process_status_t wait_status = process_wait(pid, limits, &start, &status, &usage);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    result->wall_time_ms = elapsed_ms(&start, &end);
+    result->status = killed ? (process_status_t)killed : wait_status;
+
+    if (WIFEXITED(status)) {
+        result->exit_code = WEXITSTATUS(status);
+        if (result->exit_code > 128) result->signal = result->exit_code - 128;
+    } else if (WIFSIGNALED(status)) {
+        result->signal = WTERMSIG(status);
+        result->exit_code = 128 + result->signal;
+    }
+
+    // RLIMIT_AS surfaces as a failed allocation inside the candidate
+    if (limits && limits->memory_mb > 0 && result->exit_code != 0 &&
+        (result->status == PROCESS_OK || result->status == PROCESS_CRASHED) &&
+        (stream_shows_oom(&capture->out) || stream_shows_oom(&capture->err))) {
+        result->status = PROCESS_OOM;
+    }
+
+    if (capture == &local_capture) process_capture_free(capture);
+    return result->exit_code;
+}
+
+// Run a shell command under limits once a run slot is free
+int process_capture(const char *command, const process_limits_t *limits, size_t keep_bytes,
+                    process_capture_t *capture, process_result_t *result) {
+    if (process_slot_acquire(limits) != 0) {
+        if (capture) memset(capture, 0, sizeof(process_capture_t));
+        if (result) {
+            memset(result, 0, sizeof(process_result_t));
+            result->status = PROCESS_CANCELLED;
+            result->exit_code = -1;
+        }
+        return -1;
+    }
+    int exit_code = capture_command(command, limits, keep_bytes, capture, result);
+    process_slot_release();
+    return exit_code;
+}
+
+// Run a shell command under limits and capture its output into one buffer
+int process_run(const char *command, const process_limits_t *limits,
+                char *output, size_t output_size, process_result_t *result) {
+    if (output && output_size > 0) output[0] = '\0';
+    if (!output || output_size == 0) {
+        return process_capture(command, limits, 0, NULL, result);
+    }
+
+    // OOM markers are searched in the capture, so keep something even for small buffers
+    process_capture_t capture;
+    int exit_code = process_capture(command, limits, output_size < 4096 ? 4096 : output_size, &capture, result);
+
+    // stdout then stderr; stderr gets at most half the buffer when both do not fit
+    size_t space = output_size - 1;
+    size_t out_bytes = capture.out.total_bytes;
+    size_t err_bytes = space >= 2 ? capture.err.total_bytes : 0;
+    size_t separator = out_bytes > 0 && err_bytes > 0 ? 1 : 0;
+    size_t err_budget = 0;
+    if (err_bytes > 0) {
+        if (out_bytes + separator + err_bytes <= space) err_budget = err_bytes;
+        else if (out_bytes + separator < space / 2) err_budget = space - out_bytes - separator;
+        else err_budget = err_bytes < space / 2 ? err_bytes : space / 2;
+    }
+
+    size_t length = process_stream_text(&capture.out, output, space - err_budget - separator + 1);
+    if (err_budget > 0) {
+        if (length > 0 && output[length - 1] != '\n') output[length++] = '\n';
+        process_stream_text(&capture.err, output + length, output_size - length);
+    }
+
+    process_capture_free(&capture);
+    return exit_code;
+}
@@ -0,0 +1,148 @@
+#include "threadpool.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Queued unit of work
+typedef struct threadpool_task {
+    threadpool_task_fn fn;
+    void *arg;
+    struct threadpool_task *next;
+} threadpool_task_t;
+
+struct threadpool {
+    pthread_t *workers;
+    int worker_count;
+    threadpool_task_t *head;
+    threadpool_task_t *tail;
+    int pending;                                 // Tasks queued or running
+    int shutting_down;
+    pthread_mutex_t mutex;
+    pthread_cond_t task_available;
+    pthread_cond_t all_done;
+};
+
+// Worker loop: pop tasks until the pool shuts down
+static void* threadpool_worker(void *arg) {
+    threadpool_t *pool = (threadpool_t *)arg;
+    
+    pthread_mutex_lock(&pool->mutex);
+    for (;;) {
+        while (!pool->head && !pool->shutting_down) {
+            pthread_cond_wait(&pool->task_available, &pool->mutex);
+        }
+        if (!pool->head && pool->shutting_down) break;
+        
+        threadpool_task_t *task = pool->head;
+        pool->head = task->next;
+        if (!pool->head) pool->tail = NULL;
+        pthread_mutex_unlock(&pool->mutex);
+        
+        task->fn(task->arg);
+        free(task);
+        
+        pthread_mutex_lock(&pool->mutex);
+        if (--pool->pending == 0) {
+            pthread_cond_broadcast(&pool->all_done);
+        }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    
+    return NULL;
+}
+
+// Create a pool with worker_count threads
+threadpool_t* threadpool_create(int worker_count) {
+    if (worker_count < 1) worker_count = 1;
+    
+    threadpool_t *pool = calloc(1, sizeof(threadpool_t));
+    if (!pool) return NULL;
+    
+    pool->workers = calloc(worker_count, sizeof(pthread_t));
+    if (!pool->workers) {
+        free(pool);
+        return NULL;
+    }
+    
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->task_available, NULL);
+    pthread_cond_init(&pool->all_done, NULL);
+    
+    for (int i = 0; i < worker_count; i++) {
+        if (pthread_create(&pool->workers[i], NULL, threadpool_worker, pool) != 0) {
+            fprintf(stderr, "Error: Failed to start worker thread %d\n", i);
+            break;
+        }
+        pool->worker_count++;
+    }
+    
+    if (pool->worker_count == 0) {
+        threadpool_destroy(pool);
+        return NULL;
+    }
+    
+    return pool;
+}
+
+// Queue a task for the next free worker
+int threadpool_submit(threadpool_t *pool, threadpool_task_fn fn, void *arg) {
+    if (!pool || !fn) return -1;
+    
+    threadpool_task_t *task = malloc(sizeof(threadpool_task_t));
+    if (!task) return -1;
+    
+    task->fn = fn;
+    task->arg = arg;
+    task->next = NULL;
+    
+    pthread_mutex_lock(&pool->mutex);
+    if (pool->tail) {
+        pool->tail->next = task;
+    } else {
+        pool->head = task;
+    }
+    pool->tail = task;
+    pool->pending++;
+    pthread_cond_signal(&pool->task_available);
+    pthread_mutex_unlock(&pool->mutex);
+    
+    return 0;
+}
+
+// Block until the queue is drained and no task is running
+void threadpool_wait(threadpool_t *pool) {
+    if (!pool) return;
+    
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->pending > 0) {
+        pthread_cond_wait(&pool->all_done, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+// Stop all workers and free the pool
+void threadpool_destroy(threadpool_t *pool) {
+    if (!pool) return;
+    
+    threadpool_wait(pool);
+    
+    pthread_mutex_lock(&pool->mutex);
+    pool->shutting_down = 1;
+    pthread_cond_broadcast(&pool->task_available);
+    pthread_mutex_unlock(&pool->mutex);
+    
+    for (int i = 0; i < pool->worker_count; i++) {
+        pthread_join(pool->workers[i], NULL);
+    }
+    
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_cond_destroy(&pool->task_available);
+    pthread_cond_destroy(&pool->all_done);
+    free(pool->workers);
+    free(pool);
+}
+
+// Number of worker threads in the pool
+int threadpool_size(const threadpool_t *pool) {
+    return pool ? pool->worker_count : 0;
+}
@@ -0,0 +1,186 @@
+#include "trace.h"
+#include <pthread.h>
+#include <sys/syscall.h>
+
+#define TRACE_MAX_PHASES 64
+
+// Aggregate of every span with the same name and agent
+typedef struct {
+    const char *name;
+    int agent;
+    long count;
+    double total_ms;
+    double max_ms;
+} trace_phase_t;
+
+static struct {
+    int enabled;
+    int chrome;                                  // trace_event format instead of JSON lines
+    FILE *file;                                  // NULL = summary only
+    long events;                                 // Spans written to file
+    int iteration;
+    struct timespec epoch;                       // Run start, time zero of the trace
+    trace_phase_t phases[TRACE_MAX_PHASES];
+    int phase_count;
+    pthread_mutex_t mutex;
+} tracer = { .mutex = PTHREAD_MUTEX_INITIALIZER };
+
+// Microseconds from the trace epoch to t
+static double since_epoch_us(const struct timespec *t) {
+    return (t->tv_sec - tracer.epoch.tv_sec) * 1000000.0 + (t->tv_nsec - tracer.epoch.tv_nsec) / 1000.0;
+}
+
+static const char* agent_name(int agent) {
+    if (agent == AGENT_FAST) return "fast";
+    if (agent == AGENT_REASONING) return "reasoning";
+    return "";
+}
+
+// Start tracing if enable_tracing or trace_file is set
+int trace_init(config_t *config) {
+    if (!config || (!config->enable_tracing && strlen(config->trace_file) == 0)) return 0;
+
+    pthread_mutex_lock(&tracer.mutex);
+    clock_gettime(CLOCK_MONOTONIC, &tracer.epoch);
+    tracer.chrome = strcmp(config->trace_format, "chrome") == 0;
+    tracer.phase_count = 0;
+    tracer.events = 0;
+    tracer.iteration = 0;
+
+    if (strlen(config->trace_file) > 0) {
+        tracer.file = fopen(config->trace_file, "w");
+        if (!tracer.file) {
+            fprintf(stderr, "Warning: Cannot open trace file %s, printing the summary only\n", config->trace_file);
+        } else if (tracer.chrome) {
+            fputs("[\n", tracer.file);
+        }
+    }
+    tracer.enabled = 1;
+    pthread_mutex_unlock(&tracer.mutex);
+    return 0;
+}
+
+// Finish the trace file and stop tracing
+void trace_cleanup(void) {
+    pthread_mutex_lock(&tracer.mutex);
+    if (tracer.file) {
+        if (tracer.chrome) fputs("\n]\n", tracer.file);
+        fclose(tracer.file);
+        tracer.file = NULL;
+    }
+    tracer.enabled = 0;
+    pthread_mutex_unlock(&tracer.mutex);
+}
+
+// Tag spans begun from now on with a collaboration iteration
+void trace_set_iteration(int iteration) {
+    pthread_mutex_lock(&tracer.mutex);
+    tracer.iteration = iteration;
+    pthread_mutex_unlock(&tracer.mutex);
+}
+
+// Open a span; a no-op while tracing is off
+trace_span_t trace_begin(const char *name, int agent) {
+    trace_span_t span = {0};
+    if (!tracer.enabled) return span;
+
+    span.name = name;
+    span.agent = agent;
+    pthread_mutex_lock(&tracer.mutex);
+    span.iteration = tracer.iteration;
+    pthread_mutex_unlock(&tracer.mutex);
+    clock_gettime(CLOCK_MONOTONIC, &span.start);
+    return span;
+}
+
+// Fold a finished span into its phase (caller holds the mutex)
+static void record_phase(const trace_span_t *span, double duration_ms) {
+    trace_phase_t *phase = NULL;
+    for (int i = 0; i < tracer.phase_count; i++) {
+        if (tracer.phases[i].agent == span->agent && strcmp(tracer.phases[i].name, span->name) == 0) {
+            phase = &tracer.phases[i];
+            break;
+        }
+    }
+    if (!phase) {
+        if (tracer.phase_count == TRACE_MAX_PHASES) return;
+        phase = &tracer.phases[tracer.phase_count++];
+        phase->name = span->name;
+        phase->agent = span->agent;
+    }
+
+    phase->count++;
+    phase->total_ms += duration_ms;
+    if (duration_ms > phase->max_ms) phase->max_ms = duration_ms;
+}
+
+// Close a span: aggregate it and write it to the trace file
+void trace_end(trace_span_t *span) {
+    if (!span || !span->name) return;
+
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    long thread = (long)syscall(SYS_gettid);
+
+    pthread_mutex_lock(&tracer.mutex);
+    if (tracer.enabled) {
+        double start_us = since_epoch_us(&span->start);
+        double duration_us = since_epoch_us(&end) - start_us;
+        record_phase(span, duration_us / 1000.0);
+
+        if (tracer.file && tracer.chrome) {
+            fprintf(tracer.file,
+                    "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.0f,\"dur\":%.0f,"
+                    "\"pid\":%ld,\"tid\":%ld,\"args\":{\"iteration\":%d,\"agent\":\"%s\"}}",
+                    tracer.events > 0 ? ",\n" : "", span->name,
+                    span->agent == TRACE_NO_AGENT ? "phase" : agent_name(span->agent),
+                    start_us, duration_us, (long)getpid(), thread, span->iteration, agent_name(span->agent));
+        } else if (tracer.file) {
+            fprintf(tracer.file,
+                    "{\"name\":\"%s\",\"agent\":\"%s\",\"iteration\":%d,\"thread\":%ld,"
+                    "\"start_us\":%.0f,\"duration_us\":%.0f}\n",
+                    span->name, agent_name(span->agent), span->iteration, thread, start_us, duration_us);
+        }
+        tracer.events++;
+    }
+    pthread_mutex_unlock(&tracer.mutex);
+    span->name = NULL;
+}
+
+// Print count, total, mean and max time per phase and agent, largest total first
+void log_trace_summary(config_t *config) {
+    pthread_mutex_lock(&tracer.mutex);
+    if (!tracer.enabled || tracer.phase_count == 0) {
+        pthread_mutex_unlock(&tracer.mutex);
+        return;
+    }
+
+    trace_phase_t phases[TRACE_MAX_PHASES];
+    int count = tracer.phase_count;
+    memcpy(phases, tracer.phases, count * sizeof(trace_phase_t));
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double wall_ms = since_epoch_us(&now) / 1000.0;
+    pthread_mutex_unlock(&tracer.mutex);
+
+    for (int i = 1; i < count; i++) {
+        trace_phase_t phase = phases[i];
+        int pos = i;
+        while (pos > 0 && phases[pos - 1].total_ms < phase.total_ms) {
+            phases[pos] = phases[pos - 1];
+            pos--;
+        }
+        phases[pos] = phase;
+    }
+
+    log_message(config, VERBOSITY_NORMAL, "\n%sTrace summary%s (%.0fms wall time, spans may nest and overlap)\n",
+               C_EMPHASIS, C_RESET, wall_ms);
+    log_message(config, VERBOSITY_NORMAL, "%-20s %-10s %7s %12s %10s %10s %7s\n",
+               "Phase", "Agent", "Count", "Total ms", "Mean ms", "Max ms", "Wall %");
+    for (int i = 0; i < count; i++) {
+        log_message(config, VERBOSITY_NORMAL, "%-20s %-10s %7ld %12.1f %10.1f %10.1f %6.1f%%\n",
+                   phases[i].name, agent_name(phases[i].agent), phases[i].count, phases[i].total_ms,
+                   phases[i].total_ms / phases[i].count, phases[i].max_ms,
+                   wall_ms > 0 ? 100.0 * phases[i].total_ms / wall_ms : 0.0);
+    }
+}
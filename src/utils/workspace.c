@@ -0,0 +1,156 @@
+#include "workspace.h"
+#include <ftw.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Live workspace directory, tracked for cleanup at exit
+typedef struct workspace_entry {
+    char path[512];
+    struct workspace_entry *next;
+} workspace_entry_t;
+
+static pthread_mutex_t workspace_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t workspace_once = PTHREAD_ONCE_INIT;
+static workspace_entry_t *workspace_live = NULL;
+static char workspace_root[512] = "";
+
+// nftw callback removing files before their directories
+static int workspace_remove_entry(const char *path, const struct stat *sb, int typeflag, struct FTW *ftwbuf) {
+    (void)sb; (void)typeflag; (void)ftwbuf;
+    remove(path);
+    return 0;
+}
+
+// Recursively delete a directory tree
+static void workspace_remove_tree(const char *path) {
+    nftw(path, workspace_remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+// Remove every workspace that was not destroyed explicitly
+static void workspace_cleanup_all(void) {
+    pthread_mutex_lock(&workspace_mutex);
+    workspace_entry_t *entry = workspace_live;
+    while (entry) {
+        workspace_entry_t *next = entry->next;
+        workspace_remove_tree(entry->path);
+        free(entry);
+        entry = next;
+    }
+    workspace_live = NULL;
+    pthread_mutex_unlock(&workspace_mutex);
+}
+
+static void workspace_register_cleanup(void) {
+    atexit(workspace_cleanup_all);
+}
+
+// Check that a directory exists and is writable
+static int workspace_usable_dir(const char *path) {
+    struct stat st;
+    return path && stat(path, &st) == 0 && S_ISDIR(st.st_mode) && access(path, W_OK | X_OK) == 0;
+}
+
+// Pick the directory new workspaces are created in
+static const char* workspace_base_dir(void) {
+    if (workspace_root[0] != '\0') return workspace_root;
+    if (workspace_usable_dir("/dev/shm")) return "/dev/shm"; // tmpfs: no disk I/O for builds
+    
+    const char *temp_dir = getenv("TMPDIR");
+    if (workspace_usable_dir(temp_dir)) return temp_dir;
+    return "/tmp";
+}
+
+// Override the directory new workspaces are created in
+void workspace_set_root(const char *root) {
+    pthread_mutex_lock(&workspace_mutex);
+    snprintf(workspace_root, sizeof(workspace_root), "%s", root ? root : "");
+    pthread_mutex_unlock(&workspace_mutex);
+}
+
+// Create a fresh, uniquely named workspace directory
+int workspace_create(workspace_t *workspace, const char *tag) {
+    if (!workspace) return -1;
+    workspace->path[0] = '\0';
+    
+    pthread_once(&workspace_once, workspace_register_cleanup);
+    
+    workspace_entry_t *entry = malloc(sizeof(workspace_entry_t));
+    if (!entry) return -1;
+    
+    pthread_mutex_lock(&workspace_mutex);
+    snprintf(entry->path, sizeof(entry->path), "%s/beta-evolve-%s-XXXXXX", workspace_base_dir(), tag ? tag : "work");
+    pthread_mutex_unlock(&workspace_mutex);
+    
+    if (!mkdtemp(entry->path)) {
+        fprintf(stderr, "Error: Failed to create workspace %s\n", entry->path);
+        free(entry);
+        return -1;
+    }
+    
+    snprintf(workspace->path, sizeof(workspace->path), "%s", entry->path);
+    
+    pthread_mutex_lock(&workspace_mutex);
+    entry->next = workspace_live;
+    workspace_live = entry;
+    pthread_mutex_unlock(&workspace_mutex);
+    
+    return 0;
+}
+
+// Build the path of a file inside the workspace
+int workspace_path(const workspace_t *workspace, const char *name, char *out, size_t out_size) {
+    if (!workspace || workspace->path[0] == '\0' || !name || !out) return -1;
+    
+    int written = snprintf(out, out_size, "%s/%s", workspace->path, name);
+    return (written < 0 || (size_t)written >= out_size) ? -1 : 0;
+}
+
+// Write content to a file in the workspace
+int workspace_write_file(const workspace_t *workspace, const char *name, const char *content,
+                         char *out_path, size_t out_size) {
+    if (!content) return -1;
+    
+    char path[1024];
+    if (workspace_path(workspace, name, path, sizeof(path)) != 0) return -1;
+    
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot create workspace file: %s\n", path);
+        return -1;
+    }
+    
+    int ok = fprintf(file, "%s\n", content) >= 0;
+    ok = (fclose(file) == 0) && ok;
+    if (!ok) return -1;
+    
+    if (out_path && out_size > 0) {
+        snprintf(out_path, out_size, "%s", path);
+    }
+    return 0;
+}
+
+// Remove the workspace directory and everything in it
+void workspace_destroy(workspace_t *workspace) {
+    if (!workspace || workspace->path[0] == '\0') return;
+    
+    workspace_remove_tree(workspace->path);
+    
+    pthread_mutex_lock(&workspace_mutex);
+    workspace_entry_t **link = &workspace_live;
+    while (*link) {
+        if (strcmp((*link)->path, workspace->path) == 0) {
+            workspace_entry_t *entry = *link;
+            *link = entry->next;
+            free(entry);
+            break;
+        }
+        link = &(*link)->next;
+    }
+    pthread_mutex_unlock(&workspace_mutex);
+    
+    workspace->path[0] = '\0';
+}
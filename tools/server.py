@@ -13,11 +13,16 @@ Example:
 import sys
 import argparse
 import logging
-from flask import Flask, request, jsonify, render_template
+import json
+import threading
+from flask import Flask, Response, request, jsonify, render_template
 from transformers import (
     AutoTokenizer, 
     AutoModelForCausalLM, 
     AutoModelForSeq2SeqLM,
+    StoppingCriteria,
+    StoppingCriteriaList,
+    TextIteratorStreamer,
 )
 from transformers.pipelines import pipeline
 import torch
@@ -31,11 +36,12 @@ logger = logging.getLogger(__name__)
 app = Flask(__name__)
 
 class LocalAIServer:
-    def __init__(self, model_name, temperature=0.7, max_length=1024):
+    def __init__(self, model_name, temperature=0.7, max_length=1024, max_batch_size=16):
         """Initialize the local AI server with a HuggingFace model."""
         self.model_name = model_name
         self.temperature = temperature
         self.max_length = max_length
+        self.max_batch_size = max_batch_size
         self.tokenizer = None
         self.model = None
         self.pipeline = None
@@ -164,6 +170,90 @@ class LocalAIServer:
             logger.error(f"Error generating response: {e}")
             return f"Error: Failed to generate response - {str(e)}"
 
+    def generate_batch(self, prompts, n=1, temperature=None, max_tokens=None):
+        """Generate n samples for every prompt with padded model.generate calls.
+
+        Prompts are padded to a common length and decoded together, so a batch
+        of prompts (or samples) costs about as much as one on a GPU. At most
+        max_batch_size sequences are generated per call. Returns one list of n
+        strings per prompt.
+        """
+        temp = temperature if temperature is not None else self.temperature
+        max_len = max_tokens if max_tokens is not None else self.max_length
+
+        # Causal models continue the prompt, so padding has to go on the left
+        self.tokenizer.padding_side = "left" if self.model_type == "causal" else "right"
+        prompts_per_call = max(1, self.max_batch_size // n)
+
+        results = []
+        for start in range(0, len(prompts), prompts_per_call):
+            chunk = prompts[start:start + prompts_per_call]
+            inputs = self.tokenizer(chunk, return_tensors="pt", padding=True).to(self.model.device)
+            generate_kwargs = dict(
+                inputs,
+                max_new_tokens=max_len,
+                temperature=temp,
+                do_sample=True,
+                num_return_sequences=n
+            )
+            if self.tokenizer.eos_token_id is not None:
+                generate_kwargs["pad_token_id"] = self.tokenizer.eos_token_id
+
+            with torch.no_grad():
+                outputs = self.model.generate(**generate_kwargs)
+            if self.model_type == "causal":
+                outputs = outputs[:, inputs["input_ids"].shape[1]:]
+
+            texts = self.tokenizer.batch_decode(outputs, skip_special_tokens=True)
+            for i in range(len(chunk)):
+                results.append([text.strip() for text in texts[i * n:(i + 1) * n]])
+
+        return results
+
+    def stream_response(self, prompt, temperature=None, max_tokens=None):
+        """Yield generated text pieces as soon as the model produces them.
+
+        Closing the generator (client disconnected or stopped reading) stops
+        generation at the next token instead of finishing the full completion.
+        """
+        temp = temperature if temperature is not None else self.temperature
+        max_len = max_tokens if max_tokens is not None else self.max_length
+        stop_event = threading.Event()
+
+        class _StopOnEvent(StoppingCriteria):
+            def __call__(self, input_ids, scores, **kwargs):
+                return stop_event.is_set()
+
+        inputs = self.tokenizer(prompt, return_tensors="pt").to(self.model.device)
+        streamer = TextIteratorStreamer(
+            self.tokenizer,
+            skip_prompt=(self.model_type == "causal"),
+            skip_special_tokens=True
+        )
+        generate_kwargs = dict(
+            inputs,
+            streamer=streamer,
+            max_new_tokens=max_len,
+            temperature=temp,
+            do_sample=True,
+            stopping_criteria=StoppingCriteriaList([_StopOnEvent()])
+        )
+        if self.tokenizer.eos_token_id is not None:
+            generate_kwargs["pad_token_id"] = self.tokenizer.eos_token_id
+
+        worker = threading.Thread(target=self.model.generate, kwargs=generate_kwargs, daemon=True)
+        worker.start()
+        try:
+            for text in streamer:
+                if text:
+                    yield text
+        finally:
+            stop_event.set()
+            # Drain so the generation thread can finish and release the model
+            for _ in streamer:
+                pass
+            worker.join()
+
 # Global AI server instance
 ai_server = None
 
@@ -171,82 +261,195 @@ ai_server = None
 def index():
     return render_template('index.html')
 
+def server_error(message, status=500, code="internal_error"):
+    """OpenAI-style error response."""
+    error_type = "server_error" if status >= 500 else "invalid_request_error"
+    return jsonify({
+        "error": {
+            "message": message,
+            "type": error_type,
+            "code": code
+        }
+    }), status
+
+def messages_to_prompt(messages):
+    """Flatten chat messages into a single prompt for the model."""
+    prompt = ""
+    for message in messages:
+        role = message.get('role', 'user')
+        content = message.get('content', '')
+        
+        if role == 'system':
+            prompt += f"System: {content}\n"
+        elif role == 'user':
+            prompt += f"User: {content}\n"
+        elif role == 'assistant':
+            prompt += f"Assistant: {content}\n"
+    
+    # Add assistant prompt for response
+    prompt += "Assistant:"
+    return prompt
+
+def completion_payload(prompt, texts, model):
+    """OpenAI-compatible chat completion with one choice per generated text."""
+    completion_tokens = sum(len(text.split()) for text in texts)
+    return {
+        "id": f"chatcmpl-{uuid.uuid4().hex[:10]}",
+        "object": "chat.completion",
+        "created": int(datetime.now().timestamp()),
+        "model": model,
+        "choices": [
+            {
+                "index": index,
+                "message": {
+                    "role": "assistant",
+                    "content": text
+                },
+                "finish_reason": "stop"
+            }
+            for index, text in enumerate(texts)
+        ],
+        "usage": {
+            "prompt_tokens": len(prompt.split()),
+            "completion_tokens": completion_tokens,
+            "total_tokens": len(prompt.split()) + completion_tokens
+        }
+    }
+
+def sample_count(data):
+    """The OpenAI "n" parameter, validated against the batch size."""
+    n = int(data.get('n', 1))
+    if n < 1 or n > ai_server.max_batch_size:
+        raise ValueError(f"n must be between 1 and {ai_server.max_batch_size}")
+    return n
+
 @app.route('/v1/chat/completions', methods=['POST'])
 def chat_completions():
-    """OpenAI-compatible chat completions endpoint."""
+    """OpenAI-compatible chat completions endpoint (supports "n" samples)."""
     try:
         data = request.get_json()
 
         if not ai_server:
-            return jsonify({
-                "error": {
-                    "message": "AI server is not initialized",
-                    "type": "server_error",
-                    "code": "internal_error"
-                }
-            }), 500
+            return server_error("AI server is not initialized")
         
         # Extract parameters
         messages = data.get('messages', [])
         temperature = data.get('temperature', ai_server.temperature)
         max_tokens = data.get('max_tokens', ai_server.max_length)
         model = data.get('model', ai_server.model_name)
+        try:
+            n = sample_count(data)
+        except ValueError as e:
+            return server_error(str(e), 400, "invalid_n")
         
-        # Convert messages to a single prompt
-        prompt = ""
-        for message in messages:
-            role = message.get('role', 'user')
-            content = message.get('content', '')
-            
-            if role == 'system':
-                prompt += f"System: {content}\n"
-            elif role == 'user':
-                prompt += f"User: {content}\n"
-            elif role == 'assistant':
-                prompt += f"Assistant: {content}\n"
+        prompt = messages_to_prompt(messages)
         
-        # Add assistant prompt for response
-        prompt += "Assistant:"
+        logger.info(f"Generating {n} response(s) for prompt length: {len(prompt)} chars")
         
-        logger.info(f"Generating response for prompt length: {len(prompt)} chars")
+        if data.get('stream', False):
+            if n > 1:
+                return server_error("Streaming supports n = 1 only", 400, "invalid_n")
+            return Response(stream_chat_completion(prompt, temperature, max_tokens, model),
+                            mimetype='text/event-stream',
+                            headers={'Cache-Control': 'no-cache', 'X-Accel-Buffering': 'no'})
         
-        # Generate response
-        response_text = ai_server.generate_response(prompt, temperature, max_tokens)
+        # Generate response(s); several samples share one padded generate call
+        if n == 1:
+            texts = [ai_server.generate_response(prompt, temperature, max_tokens)]
+        else:
+            texts = ai_server.generate_batch([prompt], n, temperature, max_tokens)[0]
         
-        # Format as OpenAI-compatible response
-        response = {
-            "id": f"chatcmpl-{uuid.uuid4().hex[:10]}",
-            "object": "chat.completion",
-            "created": int(datetime.now().timestamp()),
+        return jsonify(completion_payload(prompt, texts, model))
+        
+    except Exception as e:
+        logger.error(f"Error in chat_completions: {e}")
+        return server_error(str(e))
+
+@app.route('/v1/batch/chat/completions', methods=['POST'])
+def batch_chat_completions():
+    """Run many chat completion requests as one padded batch.
+
+    Body: {"requests": [<chat completion request>, ...], "n": 1,
+    "temperature": ..., "max_tokens": ...}. Sampling parameters are shared by
+    the whole batch (top-level values, else those of the first request).
+    Returns {"object": "list", "data": [<chat completion>, ...]} in request order.
+    """
+    try:
+        data = request.get_json()
+
+        if not ai_server:
+            return server_error("AI server is not initialized")
+
+        requests_data = data.get('requests', [])
+        if not requests_data:
+            return server_error("No requests in batch", 400, "empty_batch")
+
+        first = requests_data[0]
+        temperature = data.get('temperature', first.get('temperature', ai_server.temperature))
+        max_tokens = data.get('max_tokens', first.get('max_tokens', ai_server.max_length))
+        model = data.get('model', first.get('model', ai_server.model_name))
+        try:
+            n = sample_count(data if 'n' in data else first)
+        except ValueError as e:
+            return server_error(str(e), 400, "invalid_n")
+
+        prompts = [messages_to_prompt(item.get('messages', [])) for item in requests_data]
+        logger.info(f"Generating a batch of {len(prompts)} prompts x {n} samples")
+
+        results = ai_server.generate_batch(prompts, n, temperature, max_tokens)
+        return jsonify({
+            "object": "list",
+            "data": [completion_payload(prompt, texts, model) for prompt, texts in zip(prompts, results)]
+        })
+
+    except Exception as e:
+        logger.error(f"Error in batch_chat_completions: {e}")
+        return server_error(str(e))
+
+def stream_chat_completion(prompt, temperature, max_tokens, model):
+    """Yield an OpenAI-compatible server-sent event stream of chat completion chunks."""
+    completion_id = f"chatcmpl-{uuid.uuid4().hex[:10]}"
+    created = int(datetime.now().timestamp())
+
+    def chunk(delta, finish_reason=None, usage=None):
+        payload = {
+            "id": completion_id,
+            "object": "chat.completion.chunk",
+            "created": created,
             "model": model,
             "choices": [
                 {
                     "index": 0,
-                    "message": {
-                        "role": "assistant",
-                        "content": response_text
-                    },
-                    "finish_reason": "stop"
+                    "delta": delta,
+                    "finish_reason": finish_reason
                 }
-            ],
-            "usage": {
-                "prompt_tokens": len(prompt.split()),
-                "completion_tokens": len(response_text.split()),
-                "total_tokens": len(prompt.split()) + len(response_text.split())
-            }
+            ]
         }
-        
-        return jsonify(response)
-        
+        if usage is not None:
+            payload["usage"] = usage
+        return f"data: {json.dumps(payload)}\n\n"
+
+    yield chunk({"role": "assistant"})
+
+    completion_tokens = 0
+    try:
+        for text in ai_server.stream_response(prompt, temperature, max_tokens):
+            completion_tokens += 1
+            yield chunk({"content": text})
+    except GeneratorExit:
+        logger.info(f"Client closed stream after {completion_tokens} chunks")
+        raise
     except Exception as e:
-        logger.error(f"Error in chat_completions: {e}")
-        return jsonify({
-            "error": {
-                "message": str(e),
-                "type": "server_error",
-                "code": "internal_error"
-            }
-        }), 500
+        logger.error(f"Error while streaming response: {e}")
+        yield f"data: {json.dumps({'error': {'message': str(e), 'type': 'server_error', 'code': 'internal_error'}})}\n\n"
+        return
+
+    yield chunk({}, "stop", {
+        "prompt_tokens": len(prompt.split()),
+        "completion_tokens": completion_tokens,
+        "total_tokens": len(prompt.split()) + completion_tokens
+    })
+    yield "data: [DONE]\n\n"
 
 @app.route('/v1/models', methods=['GET'])
 def list_models():
@@ -364,6 +567,13 @@ Examples:
         help='Maximum length for generated responses (default: 1024)'
     )
     
+    parser.add_argument(
+        '--max-batch-size', '-b',
+        type=int,
+        default=16,
+        help='Maximum sequences (prompts x samples) per generate call (default: 16)'
+    )
+    
     parser.add_argument(
         '--debug',
         action='store_true',
@@ -388,6 +598,7 @@ def main():
     print(f"Model: {args.model_name}")
     print(f"Temperature: {args.temperature}")
     print(f"Max Length: {args.max_length}")
+    print(f"Max Batch Size: {args.max_batch_size}")
     print(f"Host: {args.host}:{args.port}")
     print("=" * 50)
     
@@ -396,7 +607,8 @@ def main():
         ai_server = LocalAIServer(
             model_name=args.model_name,
             temperature=args.temperature,
-            max_length=args.max_length
+            max_length=args.max_length,
+            max_batch_size=args.max_batch_size
         )
         
         print(f"✅ Model loaded successfully!")